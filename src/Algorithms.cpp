@@ -19,11 +19,8 @@
  */
 #include <cmath>
 #include "Algorithms.h"
-#include "PhysicalConstants.h"
+#include "BrewCalc.h"
 
-Polynomial Algorithms::platoFromSG_20C20C(
-   Polynomial() << -616.868 << 1111.14 << -630.272 << 135.997
-);
 Polynomial Algorithms::waterDensityPoly_C(
    Polynomial() << 0.9999776532 << 6.557692037e-5 << -1.007534371e-5
       << 1.372076106e-7 << -1.414581892e-9 << 5.6890971e-12
@@ -44,25 +41,17 @@ double Algorithms::hydrometer15CCorrection( double celsius )
 
 double Algorithms::SG_20C20C_toPlato( double sg )
 {
-   return platoFromSG_20C20C.eval(sg);
+   return BrewCalc::sgToPlato(sg);
 }
 
 double Algorithms::PlatoToSG_20C20C( double plato )
 {
-   // Copy the polynomial, cuz we need to alter it.
-   Polynomial poly(platoFromSG_20C20C);
-
-   // After this, finding the root of the polynomial will be finding the SG.
-   poly[0] -= plato;
-
-   return poly.rootFind( 1.000, 1.050 );
+   return BrewCalc::platoToSg(plato);
 }
 
 double Algorithms::getPlato( double sugar_kg, double wort_l )
 {
-   double water_kg = wort_l - sugar_kg/PhysicalConstants::sucroseDensity_kgL; // Assumes sucrose vol and water vol add to wort vol.
-
-   return sugar_kg/(sugar_kg+water_kg) * 100.0;
+   return BrewCalc::plato(sugar_kg, wort_l);
 }
 
 double Algorithms::getWaterDensity_kgL( double celsius )
@@ -106,15 +95,7 @@ double Algorithms::sgByStartingPlato( double startingPlato, double currentPlato
 
 double Algorithms::ogFgToPlato( double og, double fg )
 {
-   double sp = SG_20C20C_toPlato( og );
-
-   Polynomial poly(
-      Polynomial()
-         << 1.001843 - 0.002318474*sp - 0.000007775*sp*sp - 0.000000034*sp*sp*sp - fg
-         << 0.00574 << 0.00003344 << 0.000000086
-   );
-
-   return poly.rootFind(3, 5);
+   return BrewCalc::ogFgToPlato(og, fg);
 }
 
 double Algorithms::refractiveIndex( double plato )
@@ -27,16 +27,22 @@
 #include "brewtarget.h"
 #include "database.h"
 
+QAtomicInt BeerXMLElement::_lastChangeVersion(0);
+
 BeerXMLElement::BeerXMLElement()
    : QObject(0), _key(-1), _table(Brewtarget::NOTABLE)
 {
    valid = true;
+   bumpChangeVersion();
+   connect( this, SIGNAL(changed(QMetaProperty,QVariant)), this, SLOT(bumpChangeVersion()) );
 }
 
 BeerXMLElement::BeerXMLElement(BeerXMLElement const& other)
    : QObject(0), _key(other._key), _table(other._table)
 {
    valid = true;
+   bumpChangeVersion();
+   connect( this, SIGNAL(changed(QMetaProperty,QVariant)), this, SLOT(bumpChangeVersion()) );
 }
 
 bool BeerXMLElement::deleted() const { return get("deleted").toBool(); }
@@ -58,6 +64,13 @@ Brewtarget::DBTable BeerXMLElement::table() const{ return _table; }
 
 int BeerXMLElement::version() const { return QString(metaObject()->classInfo(metaObject()->indexOfClassInfo("version")).value()).toInt(); }
 
+unsigned int BeerXMLElement::changeVersion() const { return static_cast<unsigned int>(_changeVersion.loadAcquire()); }
+
+void BeerXMLElement::bumpChangeVersion()
+{
+   _changeVersion.storeRelease(_lastChangeVersion.fetchAndAddOrdered(1) + 1);
+}
+
 QMetaProperty BeerXMLElement::metaProperty(const char* name) const
 {
    return metaObject()->property(metaObject()->indexOfProperty(name));
@@ -205,29 +218,20 @@ QVariant BeerXMLElement::get( const char* col_name ) const
 
 void BeerXMLElement::setInventory( const char* prop_name, const char* col_name, QVariant const& value, bool notify )
 {
-    // Get the meta property.
-    int ndx = metaObject()->indexOfProperty(prop_name);
-    
-    int invkey = Database::instance().getInventoryID(_table, _key);
-    Brewtarget::DBTable invtable = Database::instance().getInventoryTable(_table);
-    if(invkey == 0){ //no inventory row in the database so lets make one
-      Database::instance().newInventory(_table,_key);
-      invkey = Database::instance().getInventoryID(_table, _key);
-      Database::instance().updateEntry( invtable, invkey, col_name, value, metaObject()->property(ndx), this, notify );
-    }else{//it's already there so lets just update it
-      Database::instance().updateEntry( invtable, invkey, col_name, value, metaObject()->property(ndx), this, notify );
-    }
+   Q_UNUSED(col_name); // The inventory column depends only on _table.
+   
+   // Get the meta property.
+   int ndx = metaObject()->indexOfProperty(prop_name);
+   
+   Database::instance().setInventory( this, value, metaObject()->property(ndx), notify );
 }
 
 QVariant BeerXMLElement::getInventory( const char* col_name ) const
 {
-   int invkey = Database::instance().getInventoryID(_table, _key);
-   Brewtarget::DBTable invtable = Database::instance().getInventoryTable(_table);
-   QVariant val = 0.0;
-   if(invkey != 0){
-      val = Database::instance().get( invtable , invkey, col_name );
-   }
-   return val;
+   Q_UNUSED(col_name);
+   
+   // Balances are cached by the database, so this does not hit the disk.
+   return Database::instance().inventory( _table, _key );
 }
 
 bool BeerXMLElement::isValid()
@@ -28,6 +28,7 @@
 #include <QDomDocument>
 #include <QString>
 #include <QObject>
+#include <QAtomicInt>
 #include <QMetaProperty>
 #include <QVariant>
 #include <QDateTime>
@@ -87,6 +88,11 @@ public:
    Brewtarget::DBTable table() const;
    //! \returns the BeerXML version of this element.
    int version() const;
+   /*!
+    * \returns a number that changes every time we emit \c changed(). It is
+    * unique across all elements, so it makes a good cache key.
+    */
+   unsigned int changeVersion() const;
    //! Convenience method to get a meta property by name.
    QMetaProperty metaProperty(const char* name) const;
    //! Convenience method to get a meta property by name.
@@ -133,6 +139,10 @@ signals:
    void changed(QMetaProperty, QVariant value = QVariant());
    void changedFolder(QString);
    
+protected slots:
+   //! Give us a new \c changeVersion().
+   void bumpChangeVersion();
+   
 protected:
    
    //! The key of this ingredient in its table.
@@ -168,6 +178,10 @@ private:
     * XML. I'm hoping this helps fix it
     */
   bool valid;
+  
+  //! Read from the pools too, hence atomic.
+  QAtomicInt _changeVersion;
+  static QAtomicInt _lastChangeVersion;
 };
 
 
@@ -0,0 +1,303 @@
+/*
+ * Benchmark.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmark.h"
+#include <QDomDocument>
+#include <QFile>
+#include <QTextStream>
+#include "brewtarget.h"
+#include "database.h"
+#include "DatabaseGenerator.h"
+#include "recipe.h"
+#include "unit.h"
+#include "BtTreeModel.h"
+#include "BtTreeFilterProxyModel.h"
+#include "FermentableTableModel.h"
+#include "FermentableSortFilterProxyModel.h"
+
+QTEST_MAIN(Benchmark)
+
+namespace
+{
+   int const sizes[] = { 100, 1000, 10000 };
+   int const numSizes = sizeof(sizes)/sizeof(int);
+}
+
+void Benchmark::initTestCase()
+{
+   int i;
+
+   // Create a different set of options to avoid clobbering real options
+   QCoreApplication::setOrganizationName("brewtarget-benchmark");
+   QCoreApplication::setOrganizationDomain("brewtarget.org/benchmark");
+   QCoreApplication::setApplicationName("brewtarget-benchmark");
+
+   QVERIFY( tmpDir.isValid() );
+   Brewtarget::setOption("user_data_dir", tmpDir.path());
+   Brewtarget::setOption("color_formula", "morey");
+   Brewtarget::setOption("ibu_formula", "tinseth");
+
+   // We open the databases ourselves.
+   QVERIFY( Brewtarget::initialize(true) );
+
+   for( i = 0; i < numSizes; ++i )
+      QVERIFY2( DatabaseGenerator(sizes[i]).generate(dbFile(sizes[i])), "Could not generate database" );
+
+   openRecipes = 0;
+
+   unitStrings << "5.5 gal" << "20 L" << "20" << "1,5 kg" << "3.25 lb"
+               << "0.5 oz" << "28 g" << "2 qt" << "750 mL" << "12.5";
+}
+
+void Benchmark::cleanupTestCase()
+{
+   Database::dropInstance();
+   Database::setFileName(QString());
+   Brewtarget::cleanup();
+   // Clear all persistent properties linked with this benchmark suite.
+   QSettings().clear();
+}
+
+QString Benchmark::dbFile( int recipes ) const
+{
+   return QDir(tmpDir.path()).filePath(QString("benchmark-%1.sqlite").arg(recipes));
+}
+
+void Benchmark::addSizes()
+{
+   int i;
+
+   QTest::addColumn<int>("recipes");
+   for( i = 0; i < numSizes; ++i )
+      QTest::newRow(QByteArray::number(sizes[i])) << sizes[i];
+}
+
+void Benchmark::openDatabase( int recipes )
+{
+   if( openRecipes == recipes )
+      return;
+
+   Database::dropInstance();
+   Database::setFileName(dbFile(recipes));
+   QVERIFY( Database::instance().loadSuccessful() );
+   openRecipes = recipes;
+}
+
+bool Benchmark::exportRecipes( QString const& fileName, int max )
+{
+   QDomDocument doc;
+   QFile file(fileName);
+   QList<Recipe*> recs = Database::instance().recipes().mid(0, max);
+
+   if( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) )
+      return false;
+
+   doc.appendChild(doc.createProcessingInstruction("xml", "version=\"1.0\" encoding=\"ISO-8859-1\""));
+   QDomElement root = doc.createElement("RECIPES");
+   doc.appendChild(root);
+   foreach( Recipe* rec, recs )
+      Database::instance().toXml(rec, doc, root);
+
+   QTextStream out(&file);
+   out << doc.toString().toLatin1();
+   file.close();
+
+   return true;
+}
+
+void Benchmark::load_data()
+{
+   addSizes();
+}
+
+void Benchmark::load()
+{
+   QFETCH(int, recipes);
+
+   Database::dropInstance();
+   Database::setFileName(dbFile(recipes));
+   QBENCHMARK
+   {
+      Database::dropInstance();
+      Database::instance();
+   }
+   QVERIFY( Database::instance().loadSuccessful() );
+   QCOMPARE( Database::instance().recipes().size(), recipes );
+   openRecipes = recipes;
+}
+
+void Benchmark::get_data()
+{
+   addSizes();
+}
+
+void Benchmark::get()
+{
+   QFETCH(int, recipes);
+   openDatabase(recipes);
+
+   QList<int> keys;
+   foreach( Recipe* rec, Database::instance().recipes() )
+      keys.append(rec->key());
+
+   QBENCHMARK
+   {
+      foreach( int key, keys )
+         Database::instance().get(Brewtarget::RECTABLE, key, "batch_size");
+   }
+}
+
+void Benchmark::recalcAll_data()
+{
+   addSizes();
+}
+
+void Benchmark::recalcAll()
+{
+   QFETCH(int, recipes);
+   openDatabase(recipes);
+
+   QList<Recipe*> recs = Database::instance().recipes();
+   QBENCHMARK
+   {
+      foreach( Recipe* rec, recs )
+         rec->recalcAll();
+   }
+}
+
+void Benchmark::exportXml_data()
+{
+   addSizes();
+}
+
+void Benchmark::exportXml()
+{
+   QFETCH(int, recipes);
+   openDatabase(recipes);
+
+   QList<Recipe*> recs = Database::instance().recipes();
+   QBENCHMARK
+   {
+      QDomDocument doc;
+      QDomElement root = doc.createElement("RECIPES");
+      doc.appendChild(root);
+      foreach( Recipe* rec, recs )
+         Database::instance().toXml(rec, doc, root);
+      doc.toString();
+   }
+}
+
+void Benchmark::loadTreeModel_data()
+{
+   addSizes();
+}
+
+void Benchmark::loadTreeModel()
+{
+   QFETCH(int, recipes);
+   openDatabase(recipes);
+
+   QBENCHMARK
+   {
+      BtTreeModel model(0, BtTreeModel::RECIPEMASK);
+   }
+}
+
+void Benchmark::sortTree_data()
+{
+   addSizes();
+}
+
+void Benchmark::sortTree()
+{
+   QFETCH(int, recipes);
+   openDatabase(recipes);
+
+   BtTreeModel model(0, BtTreeModel::RECIPEMASK);
+   BtTreeFilterProxyModel proxy(0, BtTreeModel::RECIPEMASK);
+   proxy.setSourceModel(&model);
+   proxy.setDynamicSortFilter(false);
+
+   QBENCHMARK
+   {
+      proxy.sort(0, Qt::DescendingOrder);
+      proxy.sort(0, Qt::AscendingOrder);
+   }
+}
+
+void Benchmark::sortFermentables_data()
+{
+   addSizes();
+}
+
+void Benchmark::sortFermentables()
+{
+   QFETCH(int, recipes);
+   openDatabase(recipes);
+
+   FermentableTableModel model(0, false);
+   FermentableSortFilterProxyModel proxy(0, false);
+   model.observeDatabase(true);
+   proxy.setSourceModel(&model);
+   proxy.setDynamicSortFilter(false);
+
+   QBENCHMARK
+   {
+      proxy.sort(FERMNAMECOL, Qt::AscendingOrder);
+      proxy.sort(FERMAMOUNTCOL, Qt::AscendingOrder);
+   }
+}
+
+void Benchmark::parseUnits()
+{
+   int i;
+
+   QBENCHMARK
+   {
+      for( i = 0; i < 100; ++i )
+      {
+         foreach( QString const& str, unitStrings )
+         {
+            Brewtarget::qStringToSI(str, Units::liters);
+            Brewtarget::qStringToSI(str, Units::kilograms);
+         }
+      }
+   }
+}
+
+void Benchmark::importXml_data()
+{
+   addSizes();
+}
+
+void Benchmark::importXml()
+{
+   QFETCH(int, recipes);
+   QString xmlFile = QDir(tmpDir.path()).filePath("benchmark-import.xml");
+
+   // Always import the same 100 recipes, so only the database size changes.
+   openDatabase(sizes[0]);
+   QVERIFY( exportRecipes(xmlFile, 100) );
+
+   openDatabase(recipes);
+   QBENCHMARK_ONCE
+   {
+      QVERIFY( Database::instance().importFromXML(xmlFile) );
+   }
+}
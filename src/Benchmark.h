@@ -0,0 +1,104 @@
+/*
+ * Benchmark.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+
+/*!
+ * \class Benchmark
+ * \author agent
+ *
+ * \brief Timings of the slow paths, against generated databases of
+ * 100, 1,000 and 10,000 recipes.
+ *
+ * Run it through the "benchmark" make target, which writes the results as
+ * QtTest XML for tracking over time. Each size gets its own database from
+ * \b DatabaseGenerator, made fresh for every run.
+ */
+class Benchmark : public QObject
+{
+   Q_OBJECT
+
+private:
+   //! \brief Add the "recipes" column and one row per database size.
+   void addSizes();
+   //! \brief Make the database with \c recipes recipes the open one.
+   void openDatabase( int recipes );
+   //! \returns the generated database file with \c recipes recipes.
+   QString dbFile( int recipes ) const;
+   //! \brief Write the first \c max recipes of the open database to \c fileName.
+   bool exportRecipes( QString const& fileName, int max );
+
+   QTemporaryDir tmpDir;
+   int openRecipes;
+   QStringList unitStrings;
+
+private slots:
+
+   // Run once before all benchmarks
+   void initTestCase();
+
+   // Run once after all benchmarks
+   void cleanupTestCase();
+
+   //! \brief Database::load(), by way of dropping and recreating the instance
+   void load_data();
+   void load();
+
+   //! \brief Database::get() on one column of every recipe
+   void get_data();
+   void get();
+
+   //! \brief Recipe::recalcAll() on every recipe
+   void recalcAll_data();
+   void recalcAll();
+
+   //! \brief BeerXML export of every recipe
+   void exportXml_data();
+   void exportXml();
+
+   //! \brief Constructing the recipe tree, which calls loadTreeModel()
+   void loadTreeModel_data();
+   void loadTreeModel();
+
+   //! \brief Sorting the recipe tree
+   void sortTree_data();
+   void sortTree();
+
+   //! \brief Sorting the fermentable table
+   void sortFermentables_data();
+   void sortFermentables();
+
+   //! \brief Parsing amounts typed in by the user
+   void parseUnits();
+
+   //! \brief BeerXML import of 100 recipes into each database
+   //
+   // This adds recipes, so it goes last.
+   void importXml_data();
+   void importXml();
+};
+
+#endif /*BENCHMARK_H*/
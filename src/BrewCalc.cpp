@@ -0,0 +1,985 @@
+/*
+ * BrewCalc.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrewCalc.h"
+#include "PhysicalConstants.h"
+#include "matrix.h"
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+   // Conversion factor for lb/gal to kg/l.
+   const double lbGalToKgL = 8.34538;
+   // Units::us_gallons->toSI(5.0) and Units::ounces->toSI(1.0).
+   const double fiveUsGallons_l = 5.0 * 3.78541178;
+   const double ounce_kg = 0.0283495231;
+
+   // Plato from SG (20C/20C), lowest order first.
+   const double platoFromSgCoeffs[] = { -616.868, 1111.14, -630.272, 135.997 };
+   const unsigned int platoFromSgOrder = 3;
+
+   // Noonan's utilization versus boil minutes, lowest order first.
+   const double noonanUtilizationCoeffs[] = {
+      0.7000029428, -0.08868853463, 0.02720809386, -0.002340415323,
+      0.00009925450081, -0.000002102006144, 0.00000002132644293, -0.00000000008229488217
+   };
+   const unsigned int noonanUtilizationOrder = 7;
+
+   // SG (20C/20C) from Plato, lowest order first, in x = (plato-25)/35 so
+   // that it covers -10 to 60 plato. A Chebyshev fit to the root of
+   // platoFromSgCoeffs, multiplied out, and within 4e-8 of it on its own.
+   const double sgFromPlatoCoeffs[] = {
+      1.105668499515706, 0.16191232240897283, 0.021727618956536909,
+      0.003161702309603498, 0.00017068000878728284, -0.00014300344331219517,
+      -9.0643990746208658e-05, -2.6569175453072802e-05
+   };
+   const double sgFromPlatoMin = -10.0;
+   const double sgFromPlatoMax = 60.0;
+
+   // SG from the current plato, leaving out the original plato's terms.
+   // Same formula as Algorithms::sgByStartingPlato().
+   const double fgFromPlatoCoeffs[] = { 1.001843, 0.00574, 0.00003344, 0.000000086 };
+   const unsigned int fgFromPlatoOrder = 3;
+
+   // The current plato whose fgFromPlatoCoeffs terms add up to y, for y in
+   // cpFromFgMin to cpFromFgMax, which is -5 to 45 plato. Lowest order first,
+   // in x = (2y - min - max)/(max - min). A Chebyshev fit, multiplied out,
+   // and within 1e-8 plato of the root.
+   const double cpFromFgCoeffs[] = {
+      23.30066081896853, 24.314801684385674, -3.135631237577833,
+      0.6425411122011594, -0.1535702496208694, 0.03951171942745997,
+      -0.010593611681093809, 0.0029054973983846104, -0.0007877736602057971,
+      0.00021780997998085549, -7.793725975722354e-05, 2.2176516552390403e-05
+   };
+   const double cpFromFgMin = -0.02787475;
+   const double cpFromFgMax = 0.33385275;
+
+   // Bump whenever a change here gives recipes different results, so that
+   // statistics stored with an older calcStamp() are redone.
+   const unsigned int calcVersion = 1;
+
+   // Same precision as Polynomial::rootFind().
+   const double rootPrecision = 0.0000001;
+   const int maxNewtonSteps = 50;
+
+   double evalPoly( double const* coeffs, unsigned int order, double x )
+   {
+      double ret = coeffs[order];
+      unsigned int i;
+
+      for( i = order; i > 0; --i )
+         ret = ret * x + coeffs[i-1];
+
+      return ret;
+   }
+
+   //! \brief evalPoly() of order 7, unrolled in pairs so the multiplies do not all wait on each other.
+   double evalPoly7( double const* coeffs, double x )
+   {
+      double x2 = x*x;
+      double x4 = x2*x2;
+
+      return (coeffs[0] + coeffs[1]*x) + (coeffs[2] + coeffs[3]*x)*x2
+           + ((coeffs[4] + coeffs[5]*x) + (coeffs[6] + coeffs[7]*x)*x2)*x4;
+   }
+
+   //! \brief evalPoly() of order 11, unrolled like evalPoly7().
+   double evalPoly11( double const* coeffs, double x )
+   {
+      double x2 = x*x;
+      double x4 = x2*x2;
+
+      return evalPoly7(coeffs, x)
+           + ((coeffs[8] + coeffs[9]*x) + (coeffs[10] + coeffs[11]*x)*x2)*x4*x4;
+   }
+
+   //! \brief The derivative of evalPoly() with respect to \c x.
+   double evalPolyDeriv( double const* coeffs, unsigned int order, double x )
+   {
+      double ret = 0.0;
+      unsigned int i;
+
+      for( i = order; i > 0; --i )
+         ret = ret * x + i*coeffs[i];
+
+      return ret;
+   }
+
+   // Secant method on sgToPlato(sg) - plato, starting from 1.000 and 1.050.
+   double platoToSgSecant( double plato )
+   {
+      double guesses[] = { 1.000, 1.050 };
+      double newGuess = guesses[0];
+      double maxAllowableSeparation = std::fabs( guesses[0] - guesses[1] ) * 1e3;
+      double f0 = evalPoly(platoFromSgCoeffs, platoFromSgOrder, guesses[0]) - plato;
+      double f1 = evalPoly(platoFromSgCoeffs, platoFromSgOrder, guesses[1]) - plato;
+
+      while( std::fabs( guesses[0] - guesses[1] ) > rootPrecision )
+      {
+         newGuess = guesses[1] - (guesses[1] - guesses[0]) * f1 / ( f1 - f0 );
+
+         guesses[0] = guesses[1];
+         f0 = f1;
+         guesses[1] = newGuess;
+         f1 = evalPoly(platoFromSgCoeffs, platoFromSgOrder, newGuess) - plato;
+
+         if( std::fabs( guesses[0] - guesses[1] ) > maxAllowableSeparation )
+            return HUGE_VAL;
+      }
+
+      return newGuess;
+   }
+
+   /*
+    * Each formula comes down to alpha acids * grams * hopFactor(minutes) *
+    * wortFactor(volume, gravity). The wort factor is the same for every
+    * hop in a recipe, so ibuKernel() works it out once and the loop over
+    * the hops is left with plain arithmetic and one call.
+    */
+   struct TinsethKernel
+   {
+      static double wortFactor( double finalVolume_liters, double wort_grav )
+      {
+         return 1000.0 / finalVolume_liters * 1.65 * std::pow(0.000125, (wort_grav - 1)) / 4.15;
+      }
+      static double hopFactor( double minutes )
+      {
+         return 1.0 - std::exp(-0.04 * minutes);
+      }
+   };
+
+   struct RagerKernel
+   {
+      static double wortFactor( double finalVolume_liters, double wort_grav )
+      {
+         double gravityFactor = (wort_grav > 1.050)? (wort_grav - 1.050)/0.2 : 0.0;
+         return 1000.0 / (finalVolume_liters * (1+gravityFactor));
+      }
+      static double hopFactor( double minutes )
+      {
+         return (18.11 + 13.86*std::tanh((minutes-31.32)/18.17)) / 100.0;
+      }
+   };
+
+   struct NoonanKernel
+   {
+      static double wortFactor( double finalVolume_liters, double wort_grav )
+      {
+         double utilizationFactor;
+
+         // Using 60 minutes as a general table.
+         if( wort_grav <= 1.050 )
+            utilizationFactor = 1;
+         else if( wort_grav <= 1.065 )
+            utilizationFactor = 0.9286;
+         else if( wort_grav <= 1.085 )
+            utilizationFactor = 0.8571;
+         else
+            utilizationFactor = 0.75;
+
+         // Per 5 gallons and ounce, with alpha acids in percent.
+         return (fiveUsGallons_l / finalVolume_liters) * 100.0 / (ounce_kg * 1000.0) * utilizationFactor;
+      }
+      static double hopFactor( double minutes )
+      {
+         return evalPoly(noonanUtilizationCoeffs, noonanUtilizationOrder, minutes);
+      }
+   };
+
+   template<class Kernel> double ibuKernel( BrewCalc::HopSchedule const& schedule, double finalVolume_liters, double wort_grav, double* hopIbus )
+   {
+      unsigned int const n = schedule.size();
+      double const wortFactor = Kernel::wortFactor(finalVolume_liters, wort_grav);
+      double ret = 0.0;
+      unsigned int i;
+
+      if( n == 0 )
+         return 0.0;
+
+      double const* AArating = &schedule.AArating[0];
+      double const* grams = &schedule.grams[0];
+      double const* minutes = &schedule.minutes[0];
+      double const* scale = &schedule.scale[0];
+
+      for( i = 0; i < n; ++i )
+         hopIbus[i] = scale[i] * AArating[i] * grams[i] * Kernel::hopFactor(minutes[i]) * wortFactor;
+
+      // Summed apart, so the loop above has no chain from one hop to the next.
+      for( i = 0; i < n; ++i )
+         ret += hopIbus[i];
+
+      return ret;
+   }
+}
+
+//==============================Constructors====================================
+
+BrewCalc::Fermentable::Fermentable()
+   : type(Grain),
+     amount_kg(0.0),
+     yield_pct(0.0),
+     moisture_pct(0.0),
+     color_srm(0.0),
+     ibuGalPerLb(0.0),
+     isMashed(true),
+     addAfterBoil(false),
+     isFermentable(true)
+{
+}
+
+BrewCalc::Hop::Hop()
+   : alpha_pct(0.0),
+     amount_kg(0.0),
+     time_min(0.0),
+     use(Boil),
+     form(Leaf)
+{
+}
+
+unsigned int BrewCalc::HopSchedule::size() const
+{
+   return AArating.size();
+}
+
+void BrewCalc::HopSchedule::clear()
+{
+   AArating.clear();
+   grams.clear();
+   minutes.clear();
+   scale.clear();
+}
+
+BrewCalc::Yeast::Yeast()
+   : attenuation_pct(0.0)
+{
+}
+
+BrewCalc::Equipment::Equipment()
+   : boilTime_min(60.0),
+     evapRate_lHr(0.0),
+     lauterDeadspace_l(0.0),
+     topUpKettle_l(0.0),
+     topUpWater_l(0.0),
+     trubChillerLoss_l(0.0),
+     grainAbsorption_LKg(PhysicalConstants::grainAbsorption_Lkg),
+     hopUtilization_pct(100.0)
+{
+}
+
+BrewCalc::Mash::Mash()
+   : totalMashWater_l(0.0)
+{
+}
+
+BrewCalc::Recipe::Recipe()
+   : batchSize_l(0.0),
+     boilSize_l(0.0),
+     efficiency_pct(0.0),
+     hasEquipment(false),
+     equipment(),
+     hasMash(false),
+     mash(),
+     fermentables(),
+     hops(),
+     yeasts()
+{
+}
+
+BrewCalc::Options::Options()
+   : ibuFormula(Tinseth),
+     colorFormula(Morey),
+     firstWortHopAdjustment(1.1),
+     mashHopAdjustment(0.0)
+{
+}
+
+BrewCalc::Sugars::Sugars()
+   : sugar_kg(0.0),
+     sugar_kg_ignoreEfficiency(0.0),
+     nonFermentableSugars_kg(0.0),
+     lateAddition_kg(0.0),
+     lateAddition_kg_ignoreEff(0.0)
+{
+}
+
+BrewCalc::Volumes::Volumes()
+   : wortFromMash_l(0.0),
+     boilVolume_l(0.0),
+     postBoilVolume_l(0.0),
+     finalVolume_l(0.0),
+     finalVolumeNoLosses_l(0.0)
+{
+}
+
+BrewCalc::Gravities::Gravities()
+   : og(1.0),
+     fg(1.0),
+     og_fermentable(1.0),
+     fg_fermentable(1.0)
+{
+}
+
+BrewCalc::Results::Results()
+   : grainsInMash_kg(0.0),
+     grains_kg(0.0),
+     volumes(),
+     color_srm(0.0),
+     gravities(),
+     ABV_pct(0.0),
+     boilGrav(1.0),
+     IBU(0.0),
+     hopIbus(),
+     calories12oz(0.0)
+{
+}
+
+//=========================Gravity conversions==================================
+
+double BrewCalc::sgToPlato( double sg )
+{
+   return evalPoly( platoFromSgCoeffs, platoFromSgOrder, sg );
+}
+
+double BrewCalc::platoToSg( double plato )
+{
+   double x;
+
+   if( plato < sgFromPlatoMin || plato > sgFromPlatoMax )
+      return platoToSgSecant(plato);
+
+   // The fit is within 4e-8 of the root, closer than the 1e-7 the root
+   // finder stops at, so there is nothing left to refine.
+   x = (2.0*plato - sgFromPlatoMin - sgFromPlatoMax) / (sgFromPlatoMax - sgFromPlatoMin);
+   return evalPoly7( sgFromPlatoCoeffs, x );
+}
+
+void BrewCalc::sgToPlato( double const* sg, double* plato, unsigned int n )
+{
+   unsigned int i;
+   for( i = 0; i < n; ++i )
+      plato[i] = sgToPlato(sg[i]);
+}
+
+void BrewCalc::platoToSg( double const* plato, double* sg, unsigned int n )
+{
+   unsigned int i;
+   for( i = 0; i < n; ++i )
+      sg[i] = platoToSg(plato[i]);
+}
+
+double BrewCalc::ogFgToPlato( double og, double fg )
+{
+   double sp = sgToPlato(og);
+   double coeffs[fgFromPlatoOrder+1];
+   double cp, step;
+   int i;
+
+   // Solve fg = f(sp, cp) for cp. Only the constant term depends on og and
+   // fg, so the rest of the cubic is always the same.
+   coeffs[0] = fgFromPlatoCoeffs[0] - sp*(0.002318474 + sp*(0.000007775 + sp*0.000000034)) - fg;
+   for( i = 1; i <= static_cast<int>(fgFromPlatoOrder); ++i )
+      coeffs[i] = fgFromPlatoCoeffs[i];
+
+   // The fit is closer than the 1e-7 Newton's method stops at.
+   if( -coeffs[0] >= cpFromFgMin && -coeffs[0] <= cpFromFgMax )
+      return evalPoly11( cpFromFgCoeffs, (-2.0*coeffs[0] - cpFromFgMin - cpFromFgMax) / (cpFromFgMax - cpFromFgMin) );
+
+   // Outside the fit. The cubic has no turning points, so Newton's method
+   // from the linear guess is safe.
+   cp = -coeffs[0] / coeffs[1];
+   for( i = 0; i < maxNewtonSteps; ++i )
+   {
+      step = evalPoly(coeffs, fgFromPlatoOrder, cp) / evalPolyDeriv(coeffs, fgFromPlatoOrder, cp);
+      cp -= step;
+      if( std::fabs(step) <= rootPrecision )
+         return cp;
+   }
+
+   return HUGE_VAL;
+}
+
+double BrewCalc::plato( double sugar_kg, double wort_l )
+{
+   double water_kg = wort_l - sugar_kg/PhysicalConstants::sucroseDensity_kgL; // Assumes sucrose vol and water vol add to wort vol.
+
+   return sugar_kg/(sugar_kg+water_kg) * 100.0;
+}
+
+//================================Recipes=======================================
+
+BrewCalc::Results BrewCalc::calculate( Recipe const& rec, Options const& opts )
+{
+   Results ret;
+
+   ret.grainsInMash_kg = grainsInMash_kg(rec);
+   ret.grains_kg = grains_kg(rec);
+   ret.volumes = volumes(rec, ret.grainsInMash_kg);
+   ret.color_srm = color_srm(rec, ret.volumes.finalVolumeNoLosses_l, opts.colorFormula);
+   ret.gravities = ogFg(rec, ret.volumes.wortFromMash_l, ret.volumes.finalVolumeNoLosses_l);
+   ret.ABV_pct = ABV_pct(ret.gravities.og_fermentable, ret.gravities.fg_fermentable);
+   ret.boilGrav = boilGrav(rec);
+   ret.IBU = IBU(rec, ret.gravities.og, ret.volumes.finalVolumeNoLosses_l, opts, &ret.hopIbus);
+   ret.calories12oz = calories12oz(ret.gravities.og, ret.gravities.fg);
+
+   return ret;
+}
+
+int BrewCalc::calcStamp( Options const& opts )
+{
+   unsigned int i;
+   // FNV-1a over everything that changes the results. The adjustments only
+   // count to 4 decimals, so reading them back from text does not matter.
+   unsigned int parts[] = {
+      calcVersion,
+      static_cast<unsigned int>(opts.ibuFormula),
+      static_cast<unsigned int>(opts.colorFormula),
+      static_cast<unsigned int>(std::floor(opts.firstWortHopAdjustment * 1e4 + 0.5)),
+      static_cast<unsigned int>(std::floor(opts.mashHopAdjustment * 1e4 + 0.5))
+   };
+   unsigned int hash = 2166136261u;
+
+   for( i = 0; i < sizeof(parts)/sizeof(parts[0]); ++i )
+   {
+      hash ^= parts[i];
+      hash *= 16777619u;
+   }
+
+   // Positive so it fits in an int column, and not 0.
+   hash &= 0x7fffffffu;
+   return hash ? static_cast<int>(hash) : 1;
+}
+
+double BrewCalc::equivSucrose_kg( Fermentable const& ferm )
+{
+   double ret = ferm.amount_kg * ferm.yield_pct * (1.0-ferm.moisture_pct/100.0) / 100.0;
+
+   // If this is a steeped grain...
+   if( ferm.type == Fermentable::Grain && !ferm.isMashed )
+      return 0.60 * ret; // Reduce the yield by 60%.
+   else
+      return ret;
+}
+
+bool BrewCalc::isFermentableSugarOrExtract( Fermentable const& ferm )
+{
+   return ferm.type == Fermentable::Sugar
+       || ferm.type == Fermentable::Extract
+       || ferm.type == Fermentable::Dry_Extract;
+}
+
+double BrewCalc::batchSizeNoLosses_l( Recipe const& rec )
+{
+   double ret = rec.batchSize_l;
+
+   if( rec.hasEquipment )
+      ret += rec.equipment.trubChillerLoss_l;
+
+   return ret;
+}
+
+double BrewCalc::wortEndOfBoil_l( Equipment const& equip, double kettleWort_l )
+{
+   return kettleWort_l - (equip.boilTime_min/60.0)*equip.evapRate_lHr;
+}
+
+double BrewCalc::grainsInMash_kg( Recipe const& rec )
+{
+   double ret = 0.0;
+   std::vector<Fermentable>::const_iterator i;
+
+   for( i = rec.fermentables.begin(); i != rec.fermentables.end(); ++i )
+   {
+      if( i->type == Fermentable::Grain && i->isMashed )
+         ret += i->amount_kg;
+   }
+
+   return ret;
+}
+
+double BrewCalc::grains_kg( Recipe const& rec )
+{
+   double ret = 0.0;
+   std::vector<Fermentable>::const_iterator i;
+
+   for( i = rec.fermentables.begin(); i != rec.fermentables.end(); ++i )
+      ret += i->amount_kg;
+
+   return ret;
+}
+
+BrewCalc::Volumes BrewCalc::volumes( Recipe const& rec, double grainsInMash_kg )
+{
+   Volumes ret;
+   double absorption_lKg;
+   double tmp;
+   std::vector<Fermentable>::const_iterator i;
+
+   // wortFromMash_l ==========================
+   if( rec.hasMash )
+   {
+      if( rec.hasEquipment )
+         absorption_lKg = rec.equipment.grainAbsorption_LKg;
+      else
+         absorption_lKg = PhysicalConstants::grainAbsorption_Lkg;
+
+      ret.wortFromMash_l = rec.mash.totalMashWater_l - absorption_lKg * grainsInMash_kg;
+   }
+
+   // boilVolume_l ==============================
+   if( rec.hasEquipment )
+      tmp = ret.wortFromMash_l - rec.equipment.lauterDeadspace_l + rec.equipment.topUpKettle_l;
+   else
+      tmp = ret.wortFromMash_l;
+
+   // Need to account for extract/sugar volume also.
+   for( i = rec.fermentables.begin(); i != rec.fermentables.end(); ++i )
+   {
+      if( i->type == Fermentable::Extract )
+         tmp += i->amount_kg / PhysicalConstants::liquidExtractDensity_kgL;
+      else if( i->type == Fermentable::Sugar )
+         tmp += i->amount_kg / PhysicalConstants::sucroseDensity_kgL;
+      else if( i->type == Fermentable::Dry_Extract )
+         tmp += i->amount_kg / PhysicalConstants::dryExtractDensity_kgL;
+   }
+
+   if( tmp <= 0.0 )
+      tmp = rec.boilSize_l; // Give up.
+
+   ret.boilVolume_l = tmp;
+
+   // finalVolume_l ==============================
+
+   // NOTE: the following figure is not based on the other volume estimates
+   // since we want to show og,fg,ibus,etc. as if the collected wort is correct.
+   ret.finalVolumeNoLosses_l = batchSizeNoLosses_l(rec);
+   // Can't do much without an equipment, so finalVolume_l stays 0.
+   if( rec.hasEquipment )
+      ret.finalVolume_l = wortEndOfBoil_l(rec.equipment, ret.boilVolume_l) + rec.equipment.topUpWater_l - rec.equipment.trubChillerLoss_l;
+
+   // postBoilVolume_l ===========================
+   if( rec.hasEquipment )
+      ret.postBoilVolume_l = wortEndOfBoil_l(rec.equipment, ret.boilVolume_l);
+   else
+      ret.postBoilVolume_l = rec.batchSize_l; // Give up.
+
+   return ret;
+}
+
+double BrewCalc::color_srm( Recipe const& rec, double finalVolumeNoLosses_l, ColorFormula formula )
+{
+   double mcu = 0.0;
+   std::vector<Fermentable>::const_iterator i;
+
+   for( i = rec.fermentables.begin(); i != rec.fermentables.end(); ++i )
+      mcu += maltColorUnits(*i, finalVolumeNoLosses_l);
+
+   return mcuToSrm(formula, mcu);
+}
+
+double BrewCalc::maltColorUnits( Fermentable const& ferm, double finalVolumeNoLosses_l )
+{
+   return ferm.color_srm * lbGalToKgL * ferm.amount_kg / finalVolumeNoLosses_l;
+}
+
+BrewCalc::Sugars BrewCalc::totalPoints( Recipe const& rec )
+{
+   Sugars ret;
+   double sucrose_kg;
+   std::vector<Fermentable>::const_iterator i;
+
+   for( i = rec.fermentables.begin(); i != rec.fermentables.end(); ++i )
+   {
+      sucrose_kg = equivSucrose_kg(*i);
+
+      // If we have some sort of non-grain, we have to ignore efficiency.
+      if( isFermentableSugarOrExtract(*i) )
+      {
+         ret.sugar_kg_ignoreEfficiency += sucrose_kg;
+
+         if( i->addAfterBoil )
+            ret.lateAddition_kg_ignoreEff += sucrose_kg;
+
+         if( !i->isFermentable )
+            ret.nonFermentableSugars_kg += sucrose_kg;
+      }
+      else
+      {
+         ret.sugar_kg += sucrose_kg;
+
+         if( i->addAfterBoil )
+            ret.lateAddition_kg += sucrose_kg;
+      }
+   }
+
+   return ret;
+}
+
+double BrewCalc::kettleSugarRatio( Recipe const& rec, double wortFromMash_l )
+{
+   double kettleWort_l, postBoilWort_l, ratio;
+
+   if( !rec.hasEquipment )
+      return 1.0;
+
+   // We might lose some sugar in the form of Trub/Chiller loss and lauter deadspace.
+   kettleWort_l = (wortFromMash_l - rec.equipment.lauterDeadspace_l) + rec.equipment.topUpKettle_l;
+   postBoilWort_l = wortEndOfBoil_l(rec.equipment, kettleWort_l);
+   ratio = (postBoilWort_l - rec.equipment.trubChillerLoss_l) / postBoilWort_l;
+   if( ratio > 1.0 ) // Usually happens when we don't have a mash yet.
+      ratio = 1.0;
+   else if( ratio < 0.0 )
+      ratio = 0.0;
+   else if( ratio != ratio ) // NaN
+      ratio = 1.0;
+
+   return ratio;
+}
+
+BrewCalc::Gravities BrewCalc::ogFg( Recipe const& rec, double wortFromMash_l, double finalVolumeNoLosses_l )
+{
+   Gravities ret;
+   Sugars sugars = totalPoints(rec);
+   double sugar_kg = sugars.sugar_kg;
+   double sugar_kg_ignoreEfficiency = sugars.sugar_kg_ignoreEfficiency;
+   double nonFermentableSugars_kg = sugars.nonFermentableSugars_kg;
+   double ratio;
+   double attenuation_pct = 0.0;
+   double tmp_pnts, tmp_ferm_pnts;
+   std::vector<Yeast>::const_iterator y;
+
+   if( rec.hasEquipment )
+   {
+      ratio = kettleSugarRatio(rec, wortFromMash_l);
+      // Grain sugar losses should be included in efficiency already.
+      sugar_kg_ignoreEfficiency *= ratio;
+      if( nonFermentableSugars_kg != 0.0 )
+         nonFermentableSugars_kg *= ratio;
+   }
+
+   sugar_kg = sugar_kg * rec.efficiency_pct/100.0 + sugar_kg_ignoreEfficiency;
+
+   ret.og = platoToSg( plato(sugar_kg, finalVolumeNoLosses_l) );
+   tmp_pnts = (ret.og-1)*1000.0;
+   if( nonFermentableSugars_kg != 0.0 )
+   {
+      ret.og_fermentable = platoToSg( plato(sugar_kg - nonFermentableSugars_kg, finalVolumeNoLosses_l) );
+      tmp_ferm_pnts = (platoToSg( plato(nonFermentableSugars_kg, finalVolumeNoLosses_l) )-1)*1000.0;
+   }
+   else
+   {
+      ret.og_fermentable = ret.og;
+      tmp_ferm_pnts = 0;
+   }
+
+   // Get the yeast with the greatest attenuation.
+   for( y = rec.yeasts.begin(); y != rec.yeasts.end(); ++y )
+   {
+      if( y->attenuation_pct > attenuation_pct )
+         attenuation_pct = y->attenuation_pct;
+   }
+   if( rec.yeasts.size() > 0 && attenuation_pct <= 0.0 ) // This means we have yeast, but they neglected to provide attenuation percentages.
+      attenuation_pct = 75.0; // 75% is an average attenuation.
+
+   if( nonFermentableSugars_kg != 0.0 )
+   {
+      tmp_ferm_pnts = (tmp_pnts-tmp_ferm_pnts) * (1.0 - attenuation_pct/100.0);
+      tmp_pnts *= (1.0 - attenuation_pct/100.0);
+      ret.fg = 1 + tmp_pnts/1000.0;
+      ret.fg_fermentable = 1 + tmp_ferm_pnts/1000.0;
+   }
+   else
+   {
+      tmp_pnts *= (1.0 - attenuation_pct/100.0);
+      ret.fg = 1 + tmp_pnts/1000.0;
+      ret.fg_fermentable = ret.fg;
+   }
+
+   return ret;
+}
+
+double BrewCalc::ABV_pct( double og_fermentable, double fg_fermentable )
+{
+   // The complex formula, and variations comes from Ritchie Products Ltd, (Zymurgy, Summer 1995, vol. 18, no. 2)
+   // Michael L. Hall's article Brew by the Numbers: Add Up What's in Your Beer, and Designing Great Beers by Daniels.
+   return (76.08 * (og_fermentable - fg_fermentable) / (1.775 - og_fermentable)) * (fg_fermentable / 0.794);
+}
+
+double BrewCalc::boilGrav( Recipe const& rec )
+{
+   Sugars sugars = totalPoints(rec);
+   double sugar_kg;
+
+   // Since the efficiency refers to how much sugar we get into the fermenter,
+   // we need to adjust for that here.
+   sugar_kg = rec.efficiency_pct/100.0 * (sugars.sugar_kg - sugars.lateAddition_kg)
+            + sugars.sugar_kg_ignoreEfficiency - sugars.lateAddition_kg_ignoreEff;
+
+   return platoToSg( plato(sugar_kg, rec.boilSize_l) );
+}
+
+void BrewCalc::addToSchedule( HopSchedule& schedule, Hop const& hop, Recipe const& rec, Options const& opts )
+{
+   double minutes = hop.time_min;
+   // Assume 100% utilization until further notice
+   double hopUtilization = 1.0;
+   // Assume 60 min boil until further notice
+   int boilTime = 60;
+
+   // NOTE: we used to carefully calculate the average boil gravity and use it in the
+   // IBU calculations. However, due to John Palmer
+   // (http://homebrew.stackexchange.com/questions/7343/does-wort-gravity-affect-hop-utilization),
+   // it seems more appropriate to just use the OG directly, since it is the total
+   // amount of break material that truly affects the IBUs.
+
+   if( rec.hasEquipment )
+   {
+      hopUtilization = rec.equipment.hopUtilization_pct / 100.0;
+      boilTime = static_cast<int>(rec.equipment.boilTime_min);
+   }
+
+   if( hop.use == Hop::First_Wort )
+   {
+      hopUtilization *= opts.firstWortHopAdjustment;
+      minutes = boilTime;
+   }
+   else if( hop.use == Hop::Mash && opts.mashHopAdjustment > 0.0 )
+   {
+      hopUtilization *= opts.mashHopAdjustment;
+      minutes = boilTime;
+   }
+   else if( hop.use != Hop::Boil )
+      hopUtilization = 0.0;
+
+   // Adjust for hop form. Tinseth's table was created from whole cone data,
+   // and it seems other formulae are optimized that way as well. So, the
+   // utilization is considered unadjusted for whole cones, and adjusted
+   // up for plugs and pellets.
+   //
+   // - http://www.realbeer.com/hops/FAQ.html
+   // - https://groups.google.com/forum/#!topic/brewtarget-help/mv2qvWBC4sU
+   switch( hop.form )
+   {
+      case Hop::Plug:
+         hopUtilization *= 1.02;
+         break;
+      case Hop::Pellet:
+         hopUtilization *= 1.10;
+         break;
+      default:
+         break;
+   }
+
+   schedule.AArating.push_back(hop.alpha_pct/100.0);
+   schedule.grams.push_back(hop.amount_kg*1000.0);
+   schedule.minutes.push_back(minutes);
+   schedule.scale.push_back(hopUtilization);
+}
+
+double BrewCalc::ibuFromHop( Hop const& hop, Recipe const& rec, double og, double finalVolumeNoLosses_l, Options const& opts )
+{
+   HopSchedule schedule;
+   double ret;
+
+   addToSchedule(schedule, hop, rec, opts);
+   return ibus(opts.ibuFormula, schedule, finalVolumeNoLosses_l, og, &ret);
+}
+
+double BrewCalc::IBU( Recipe const& rec, double og, double finalVolumeNoLosses_l, Options const& opts, std::vector<double>* hopIbus )
+{
+   double ret;
+   HopSchedule schedule;
+   std::vector<double> tmp;
+   std::vector<double>& out = hopIbus ? *hopIbus : tmp;
+   std::vector<Hop>::const_iterator h;
+   std::vector<Fermentable>::const_iterator f;
+
+   // Bitterness due to hops...
+   for( h = rec.hops.begin(); h != rec.hops.end(); ++h )
+      addToSchedule(schedule, *h, rec, opts);
+   out.resize(schedule.size());
+   ret = ibus(opts.ibuFormula, schedule, finalVolumeNoLosses_l, og, out.empty() ? 0 : &out[0]);
+
+   // Bitterness due to hopped extracts...
+   for( f = rec.fermentables.begin(); f != rec.fermentables.end(); ++f )
+      ret += f->ibuGalPerLb * (f->amount_kg / rec.batchSize_l) / lbGalToKgL;
+
+   return ret;
+}
+
+// the formula in here are taken from http://hbd.org/ensmingr/
+double BrewCalc::calories12oz( double og, double fg )
+{
+   double startPlato, finishPlato, RE, abw, ret;
+
+   // Need to translate OG and FG into plato
+   startPlato  = -463.37 + ( 668.72 * og ) - (205.35 * og * og);
+   finishPlato = -463.37 + ( 668.72 * fg ) - (205.35 * fg * fg);
+
+   // RE (real extract)
+   RE = (0.1808 * startPlato) + (0.8192 * finishPlato);
+
+   // Alcohol by weight?
+   abw = (startPlato-RE)/(2.0665 - (0.010665 * startPlato));
+
+   // The final results of this formular are calories per 100 ml.
+   // The 3.55 puts it in terms of 12 oz.
+   ret = ((6.9*abw) + 4.0 * (RE-0.1)) * fg * 3.55;
+
+   // If there are no fermentables in the recipe, if there is no mash, etc.,
+   // then the calories/12 oz ends up negative. Since negative doesn't make
+   // sense, set it to 0
+   if( ret < 0 )
+      ret = 0;
+
+   return ret;
+}
+
+//=============================Bitterness/color=================================
+
+double BrewCalc::ibus( IbuFormula formula, double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes )
+{
+   switch( formula )
+   {
+      case Rager:
+         return rager(AArating, hops_grams, finalVolume_liters, wort_grav, minutes);
+      case Noonan:
+         return noonan(AArating, hops_grams, finalVolume_liters, wort_grav, minutes);
+      case Tinseth:
+      default:
+         return tinseth(AArating, hops_grams, finalVolume_liters, wort_grav, minutes);
+   }
+}
+
+double BrewCalc::ibus( IbuFormula formula, HopSchedule const& schedule, double finalVolume_liters, double wort_grav, double* hopIbus )
+{
+   switch( formula )
+   {
+      case Rager:
+         return ibuKernel<RagerKernel>(schedule, finalVolume_liters, wort_grav, hopIbus);
+      case Noonan:
+         return ibuKernel<NoonanKernel>(schedule, finalVolume_liters, wort_grav, hopIbus);
+      case Tinseth:
+      default:
+         return ibuKernel<TinsethKernel>(schedule, finalVolume_liters, wort_grav, hopIbus);
+   }
+}
+
+// These are collected from http://www.realbeer.com/hops/FAQ.html
+
+double BrewCalc::tinseth( double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes )
+{
+   return AArating * hops_grams * TinsethKernel::hopFactor(minutes) * TinsethKernel::wortFactor(finalVolume_liters, wort_grav);
+}
+
+double BrewCalc::rager( double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes )
+{
+   return AArating * hops_grams * RagerKernel::hopFactor(minutes) * RagerKernel::wortFactor(finalVolume_liters, wort_grav);
+}
+
+double BrewCalc::noonan( double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes )
+{
+   return AArating * hops_grams * NoonanKernel::hopFactor(minutes) * NoonanKernel::wortFactor(finalVolume_liters, wort_grav);
+}
+
+double BrewCalc::mcuToSrm( ColorFormula formula, double mcu )
+{
+   switch( formula )
+   {
+      // From Palmer's "How to Brew"
+      case Daniel:
+         return 0.2 * mcu + 8.4;
+      // From Palmer's "How to Brew"
+      case Mosher:
+         return 0.3 * mcu + 4.7;
+      // I don't know where this is from.
+      case Morey:
+      default:
+         return 1.4922 * std::pow( mcu, 0.6859 );
+   }
+}
+
+double BrewCalc::srmToMcu( ColorFormula formula, double srm )
+{
+   double ret;
+
+   switch( formula )
+   {
+      case Daniel:
+         ret = (srm - 8.4) / 0.2;
+         break;
+      case Mosher:
+         ret = (srm - 4.7) / 0.3;
+         break;
+      case Morey:
+      default:
+         ret = (srm > 0.0) ? std::pow( srm / 1.4922, 1.0/0.6859 ) : 0.0;
+         break;
+   }
+
+   return (ret > 0.0) ? ret : 0.0;
+}
+
+//===============================Brew notes=====================================
+
+double BrewCalc::effIntoBK_pct( double projPoints, double projVolIntoBK_l, double sg, double volumeIntoBK_l )
+{
+   // Points have already been translated from SG into pure glucose points.
+   double maxPoints = projPoints * projVolIntoBK_l;
+   double actualPoints = (sg - 1) * 1000 * volumeIntoBK_l;
+
+   if( maxPoints <= 0.0 )
+      return 0.0;
+
+   return actualPoints/maxPoints * 100;
+}
+
+double BrewCalc::projOg( double sg, double projVolIntoBK_l, double boilOff_l, double volumeIntoBK_l )
+{
+   double points = (sg-1) * 1000;
+   double expectedVol = projVolIntoBK_l - boilOff_l;
+
+   if( expectedVol <= 0.0 )
+      return 0.0;
+
+   return 1 + ((points * volumeIntoBK_l / expectedVol) / 1000);
+}
+
+double BrewCalc::brewhouseEff_pct( double projFermPoints, double projVolIntoFerm_l, double og, double volumeIntoFerm_l )
+{
+   double expectedPoints = projFermPoints * projVolIntoFerm_l;
+   double actualPoints = (og-1.0) * 1000.0 * volumeIntoFerm_l;
+
+   return actualPoints/expectedPoints * 100.0;
+}
+
+double BrewCalc::projABV_pct( double og, double atten_pct )
+{
+   // 1 + [(og-1) * 1000 * (1.0 - %/100)] / 1000  =
+   // 1 + [(og - 1) * (1.0 - %/100)]
+   double estFg = 1 + ((og-1.0)*(1.0 - atten_pct/100.0));
+
+   return (og-estFg)*130;
+}
+
+double BrewCalc::actualABV_pct( double og, double fg )
+{
+   return (og - fg) * 130;
+}
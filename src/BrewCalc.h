@@ -0,0 +1,590 @@
+/*
+ * BrewCalc.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BREWCALC_H
+#define _BREWCALC_H
+
+class BrewCalc;
+
+#include <vector>
+#include <map>
+
+/*!
+ * \class BrewCalc
+ * \author agent
+ *
+ * \brief The brewing math, on plain values.
+ *
+ * Nothing in here knows about QObject, the database or the user's options:
+ * the inputs are plain structs filled in by the caller, and every function
+ * is stateless. That makes it safe to call from any thread. Recipe, BrewNote
+ * and Equipment fill in the structs from their properties and call these.
+ *
+ * This is built as its own static library (btcalc) that only needs the
+ * standard library.
+ */
+class BrewCalc
+{
+public:
+   enum IbuFormula { Tinseth, Rager, Noonan };
+   enum ColorFormula { Morey, Daniel, Mosher };
+
+   //! \brief What we need to know about a fermentable.
+   struct Fermentable
+   {
+      //! \brief Same order as \c ::Fermentable::Type.
+      enum Type { Grain, Sugar, Extract, Dry_Extract, Adjunct };
+
+      Fermentable();
+
+      Type type;
+      double amount_kg;
+      double yield_pct;
+      double moisture_pct;
+      double color_srm;
+      double ibuGalPerLb;
+      bool isMashed;
+      bool addAfterBoil;
+      //! \brief False for sugars the yeast will not eat, like lactose.
+      bool isFermentable;
+   };
+
+   //! \brief What we need to know about a hop.
+   struct Hop
+   {
+      //! \brief Same order as \c ::Hop::Use.
+      enum Use { Mash, First_Wort, Boil, UseAroma, Dry_Hop };
+      //! \brief Same order as \c ::Hop::Form.
+      enum Form { Leaf, Pellet, Plug };
+
+      Hop();
+
+      double alpha_pct;
+      double amount_kg;
+      double time_min;
+      Use use;
+      Form form;
+   };
+
+   //! \brief What we need to know about a yeast.
+   struct Yeast
+   {
+      Yeast();
+
+      double attenuation_pct;
+   };
+
+   //! \brief What we need to know about an equipment.
+   struct Equipment
+   {
+      Equipment();
+
+      double boilTime_min;
+      double evapRate_lHr;
+      double lauterDeadspace_l;
+      double topUpKettle_l;
+      double topUpWater_l;
+      double trubChillerLoss_l;
+      double grainAbsorption_LKg;
+      double hopUtilization_pct;
+   };
+
+   //! \brief What we need to know about a mash.
+   struct Mash
+   {
+      Mash();
+
+      double totalMashWater_l;
+   };
+
+   //! \brief A recipe and everything in it.
+   struct Recipe
+   {
+      Recipe();
+
+      double batchSize_l;
+      double boilSize_l;
+      double efficiency_pct;
+
+      bool hasEquipment;
+      Equipment equipment;
+      bool hasMash;
+      Mash mash;
+
+      std::vector<Fermentable> fermentables;
+      std::vector<Hop> hops;
+      std::vector<Yeast> yeasts;
+   };
+
+   //! \brief Settings that change the results.
+   struct Options
+   {
+      Options();
+
+      IbuFormula ibuFormula;
+      ColorFormula colorFormula;
+      //! \brief Multiplies the IBUs of first wort hops.
+      double firstWortHopAdjustment;
+      //! \brief Multiplies the IBUs of mash hops. 0 means they add none.
+      double mashHopAdjustment;
+   };
+
+   /*!
+    * \brief Hops as parallel arrays, so that a formula can run down all of
+    * them in one loop. Fill it with \b addToSchedule().
+    */
+   struct HopSchedule
+   {
+      //! \brief Alpha acids in [0,1].
+      std::vector<double> AArating;
+      std::vector<double> grams;
+      //! \brief Minutes in the boil. The boil time for first wort and mash hops.
+      std::vector<double> minutes;
+      //! \brief Utilization, form and use adjustments together. 0 adds no IBUs.
+      std::vector<double> scale;
+
+      unsigned int size() const;
+      void clear();
+   };
+
+   //! \brief Sugar in a recipe, as kg of sucrose.
+   struct Sugars
+   {
+      Sugars();
+
+      //! \brief From grains. Efficiency still has to be applied.
+      double sugar_kg;
+      //! \brief From sugars and extracts, which ignore efficiency.
+      double sugar_kg_ignoreEfficiency;
+      double nonFermentableSugars_kg;
+      double lateAddition_kg;
+      double lateAddition_kg_ignoreEff;
+   };
+
+   //! \brief Volume estimates of a recipe.
+   struct Volumes
+   {
+      Volumes();
+
+      double wortFromMash_l;
+      double boilVolume_l;
+      double postBoilVolume_l;
+      double finalVolume_l;
+      //! \brief Final volume before any losses out of the kettle, used for sg/ibu/etc.
+      double finalVolumeNoLosses_l;
+   };
+
+   //! \brief Estimated gravities of a recipe.
+   struct Gravities
+   {
+      Gravities();
+
+      double og;
+      double fg;
+      //! \brief The og/fg of only the fermentable sugars, used for the ABV.
+      double og_fermentable;
+      double fg_fermentable;
+   };
+
+   //! \brief What \b grainBill() aims for.
+   struct GrainBillTargets
+   {
+      GrainBillTargets();
+
+      //! \brief 0 keeps the og the recipe has now.
+      double og;
+      //! \brief 0 for no color target.
+      double color_srm;
+      //! \brief Percent of the bill's weight, one per \c Recipe::fermentables. Negative for no target.
+      std::vector<double> grist_pct;
+   };
+
+   //! \brief What \b startHopSearch() aims for.
+   struct HopTargets
+   {
+      HopTargets();
+
+      //! \brief Total IBUs, counting hopped extracts and hops that are not searched.
+      double ibu;
+      //! \brief Percent of \c ibu from each of \c Recipe::hops. Negative keeps the share it has now.
+      std::vector<double> split_pct;
+      //! \brief How far a bittering addition may move either way, in minutes. 0 keeps the times.
+      double timeWindow_min;
+      //! \brief Hops that may stand in for any bittering addition, like the ones in the inventory.
+      std::vector<Hop> substitutes;
+      //! \brief How much there is of each of \c substitutes. Using more costs as much as buying it.
+      std::vector<double> substituteStock_kg;
+   };
+
+   /*!
+    * \brief A branch-and-bound search over hop schedules, run a piece at a
+    * time by \b searchHops().
+    *
+    * Each hop that gives IBUs is an addition. Bittering additions have a few
+    * choices of time and variety, the others only their own. The grams and
+    * cost of every choice are worked out up front and each addition's
+    * choices sorted cheapest first, so the first schedule tried is nearly
+    * always the best and the rest are soon ruled out.
+    */
+   struct HopSearch
+   {
+      HopSearch();
+
+      //! \brief Which of \c Recipe::hops each addition is.
+      std::vector<unsigned int> hopIndex;
+      //! \brief The IBUs each addition has to give.
+      std::vector<double> ibuWanted;
+      //! \brief Where each addition's choices start below, with one more at the end.
+      std::vector<unsigned int> firstChoice;
+      //! \brief The least the additions from each one on can cost, with 0 at the end.
+      std::vector<double> restCost;
+      //! \brief How many schedules the additions from each one on make, with 1 at the end.
+      std::vector<double> restTotal;
+
+      //! \name One per choice
+      //! @{
+      std::vector<double> minutes;
+      //! \brief -1 for the addition's own hop, or which of \c HopTargets::substitutes.
+      std::vector<int> substitute;
+      //! \brief Which of \c stock_g the grams come out of.
+      std::vector<unsigned int> variety;
+      //! \brief HUGE_VAL if the choice can not give the IBUs.
+      std::vector<double> grams;
+      //! \brief Cost of moving or swapping the hop, in grams.
+      std::vector<double> penalty;
+      //! \brief Cost of the choice as if no other addition used its variety.
+      std::vector<double> cost;
+      //! @}
+
+      //! \brief One per variety: the additions' own hops, then the substitutes.
+      std::vector<double> stock_g;
+
+      //! \brief How many schedules there are, and how many have been looked at or ruled out.
+      double total;
+      double done;
+
+      //! \name Where the search is
+      //! @{
+      //! \brief How many additions have a choice in \c next.
+      unsigned int depth;
+      //! \brief One per addition: the choice made, or the next one to try at \c depth.
+      std::vector<unsigned int> next;
+      //! \brief One per addition and one more: the cost of the choices before it.
+      std::vector<double> pathCost;
+      //! \brief One per variety: grams the choices made use.
+      std::vector<double> used_g;
+      //! @}
+
+      //! \brief The cheapest schedule so far, and its cost. HUGE_VAL if none works.
+      std::vector<unsigned int> best;
+      double bestCost;
+   };
+
+   //! \brief The statistics a style limits, as indices into \c StyleRanges and \c StyleStats.
+   enum StyleStat { StyleOg, StyleFg, StyleIbu, StyleColor, StyleAbv, StyleCarb, NumStyleStats };
+
+   //! \brief The ranges of a style. A max below its min, or both 0, is no limit.
+   struct StyleRanges
+   {
+      StyleRanges();
+
+      double min[NumStyleStats];
+      double max[NumStyleStats];
+   };
+
+   //! \brief A recipe's statistics to match to styles. Negative for unknown.
+   struct StyleStats
+   {
+      StyleStats();
+
+      double value[NumStyleStats];
+   };
+
+   /*!
+    * \brief Interval index over the ranges of many styles. Make it with
+    * \b indexStyles().
+    *
+    * Each statistic's range ends cut its axis into slots: one for each end,
+    * and one between each pair. Every slot has a bitset of the styles that
+    * cover it, so the styles a recipe fits are a binary search per
+    * statistic and an AND of the bitsets.
+    */
+   struct StyleIndex
+   {
+      StyleIndex();
+
+      std::vector<StyleRanges> styles;
+      //! \brief 32 bit words in each bitset.
+      unsigned int words;
+      //! \brief The distinct range ends of each statistic, in order.
+      std::vector<double> ends[NumStyleStats];
+      //! \brief \c words per slot, 2 * ends + 1 slots per statistic.
+      std::vector<unsigned int> cover[NumStyleStats];
+   };
+
+   //! \brief How well a recipe fits one of \c StyleIndex::styles.
+   struct StyleMatch
+   {
+      StyleMatch();
+
+      unsigned int style;
+      /*!
+       * \brief Lower is better. At most 1 if the recipe fits, by how far it
+       * is from the middles, and over 1 if not, by how far it is outside.
+       * Each is relative to the width of the range.
+       */
+      double score;
+      //! \brief Bit \c StyleStat set for each statistic out of range.
+      unsigned int outOfRange;
+   };
+
+   /*!
+    * \brief Where each part of a recipe is in the vectors from
+    * \b recipeFeatures(). Each part is scaled so that a unit is about as far
+    * apart as two recipes of the same style get.
+    */
+   enum RecipeFeature
+   {
+      FeatureOg, FeatureFg, FeatureIbu, FeatureColor, FeatureAbv,
+      //! \brief Share of the fermentables' weight of each \c Fermentable::Type.
+      FeatureGrist,
+      //! \brief Share of the hops' weight that bitters, flavors, goes in late, and dry hops.
+      FeatureHopTiming = FeatureGrist + 5,
+      //! \brief Share of the hops' weight of each variety, hashed into bins.
+      FeatureHopVariety = FeatureHopTiming + 4,
+      //! \brief Share of the yeasts of each strain, hashed into bins.
+      FeatureYeast = FeatureHopVariety + 16,
+      NumRecipeFeatures = FeatureYeast + 8
+   };
+
+   /*!
+    * \brief Points to find the nearest of, each with an id. \b setNeighbor()
+    * adds or moves one and \b removeNeighbor() takes one out, so the index
+    * follows its points a change at a time.
+    *
+    * The points are one flat array, so a search reads memory in order.
+    */
+   struct NeighborIndex
+   {
+      NeighborIndex();
+
+      //! \brief Length of every point, taken from the first one added.
+      unsigned int dims;
+      //! \brief \c dims per point, one after another.
+      std::vector<double> points;
+      //! \brief The id of each point.
+      std::vector<int> ids;
+      //! \brief Which point each id is.
+      std::map<int,unsigned int> rows;
+   };
+
+   //! \brief One of the points \b nearestNeighbors() found.
+   struct Neighbor
+   {
+      Neighbor();
+
+      int id;
+      double distance;
+   };
+
+   //! \brief Everything \b calculate() works out for a recipe.
+   struct Results
+   {
+      Results();
+
+      double grainsInMash_kg;
+      double grains_kg;
+      Volumes volumes;
+      double color_srm;
+      Gravities gravities;
+      double ABV_pct;
+      double boilGrav;
+      double IBU;
+      //! \brief The IBUs of each hop, in the same order as \c Recipe::hops.
+      std::vector<double> hopIbus;
+      double calories12oz;
+   };
+
+   //=========================Gravity conversions==============================
+
+   //! \returns plato of \c sg.
+   static double sgToPlato( double sg );
+   //! \returns sg of \c plato. Does not iterate between -10 and 60 plato.
+   static double platoToSg( double plato );
+   //! \brief \c plato[i] = sgToPlato(\c sg[i]) for the first \c n.
+   static void sgToPlato( double const* sg, double* plato, unsigned int n );
+   //! \brief \c sg[i] = platoToSg(\c plato[i]) for the first \c n.
+   static void platoToSg( double const* plato, double* sg, unsigned int n );
+   //! \returns the current plato that, starting from \c og, gives \c fg.
+   static double ogFgToPlato( double og, double fg );
+   //! \returns plato of \c sugar_kg of sucrose in \c wort_l of wort.
+   static double plato( double sugar_kg, double wort_l );
+
+   //================================Recipes===================================
+
+   //! \returns all the calculated properties of \c rec, in dependency order.
+   static Results calculate( Recipe const& rec, Options const& opts );
+   /*!
+    * \returns a number that changes whenever \b calculate() could give
+    * different results for the same recipe, either because \c opts changed
+    * or because the math did. Never 0, so 0 can mean "never calculated".
+    */
+   static int calcStamp( Options const& opts );
+
+   //! \returns how much sucrose \c ferm is worth.
+   static double equivSucrose_kg( Fermentable const& ferm );
+   //! \returns true if \c ferm goes straight into the kettle, so the mash efficiency does not apply.
+   static bool isFermentableSugarOrExtract( Fermentable const& ferm );
+   //! \returns the batch size plus what is lost to trub and the chiller.
+   static double batchSizeNoLosses_l( Recipe const& rec );
+   //! \returns the wort left in the kettle after boiling \c kettleWort_l.
+   static double wortEndOfBoil_l( Equipment const& equip, double kettleWort_l );
+   //! \returns the mass of the mashed grains.
+   static double grainsInMash_kg( Recipe const& rec );
+   //! \returns the mass of all the fermentables.
+   static double grains_kg( Recipe const& rec );
+   //! \returns the volume estimates of \c rec.
+   static Volumes volumes( Recipe const& rec, double grainsInMash_kg );
+   //! \returns the color in SRM when diluted in \c finalVolumeNoLosses_l.
+   static double color_srm( Recipe const& rec, double finalVolumeNoLosses_l, ColorFormula formula );
+   //! \returns the malt color units \c ferm gives \c finalVolumeNoLosses_l of wort.
+   static double maltColorUnits( Fermentable const& ferm, double finalVolumeNoLosses_l );
+   //! \returns the sugars of \c rec.
+   static Sugars totalPoints( Recipe const& rec );
+   //! \returns the part of the sugar into the kettle that makes it out, after deadspace and trub losses.
+   static double kettleSugarRatio( Recipe const& rec, double wortFromMash_l );
+   //! \returns og and fg of \c rec.
+   static Gravities ogFg( Recipe const& rec, double wortFromMash_l, double finalVolumeNoLosses_l );
+   //! \returns ABV from the fermentable og/fg.
+   static double ABV_pct( double og_fermentable, double fg_fermentable );
+   //! \returns the gravity in the kettle before the boil.
+   static double boilGrav( Recipe const& rec );
+   //! \brief Appends \c hop, as it is used in \c rec, to \c schedule.
+   static void addToSchedule( HopSchedule& schedule, Hop const& hop, Recipe const& rec, Options const& opts );
+   //! \returns the IBUs that \c hop adds to \c rec.
+   static double ibuFromHop( Hop const& hop, Recipe const& rec, double og, double finalVolumeNoLosses_l, Options const& opts );
+   /*!
+    * \returns the IBUs of \c rec from hops and hopped extracts.
+    * \param hopIbus if not null, gets the IBUs of each hop.
+    */
+   static double IBU( Recipe const& rec, double og, double finalVolumeNoLosses_l, Options const& opts, std::vector<double>* hopIbus = 0 );
+   //! \returns calories per 12 oz. Never negative.
+   static double calories12oz( double og, double fg );
+   /*!
+    * \returns the kg of each of \c rec's fermentables that come closest to
+    * \c targets, none negative. The og counts the most, then the color, then
+    * the grist. The equipment, efficiency and volumes stay as they are.
+    */
+   static std::vector<double> grainBill( Recipe const& rec, GrainBillTargets const& targets, Options const& opts );
+   /*!
+    * \brief Sets up a search for the hop schedule of \c rec that hits
+    * \c targets with the fewest grams to buy, then the fewest grams.
+    *
+    * Every hop that gives IBUs gets the grams for its share, but only the
+    * bittering ones, boil hops in for at least 30 minutes, may move or be
+    * swapped for a substitute. Late and aroma hops keep their time and
+    * variety. The og and volumes do not depend on the hops, so they are
+    * worked out once here.
+    */
+   static HopSearch startHopSearch( Recipe const& rec, HopTargets const& targets, Options const& opts );
+   //! \brief Try up to \c count more choices. \returns false once every schedule is looked at or ruled out.
+   static bool searchHops( HopSearch& search, unsigned int count );
+   /*!
+    * \returns \c rec's hops as the best schedule in \c search has them.
+    * \param substitute if not null, gets one value per hop: -1 to keep it,
+    *        or which of \c targets.substitutes it becomes.
+    */
+   static std::vector<Hop> bestHops( HopSearch const& search, Recipe const& rec, HopTargets const& targets, std::vector<int>* substitute );
+
+   //=============================Bitterness/color============================
+
+   /*!
+    * \returns ibus according to \c formula.
+    * \param AArating in [0,1] (0.04 means 4% AA for example)
+    * \param hops_grams - mass of hops in grams
+    * \param finalVolume_liters - self explanatory
+    * \param wort_grav in specific gravity at around 60F I guess.
+    * \param minutes - minutes that the hops are in the boil
+    */
+   static double ibus( IbuFormula formula, double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes );
+   /*!
+    * \brief The IBUs of every hop in \c schedule, picking the formula once.
+    * \param hopIbus gets one value per hop, and may be null if \c schedule is empty.
+    * \returns the total.
+    */
+   static double ibus( IbuFormula formula, HopSchedule const& schedule, double finalVolume_liters, double wort_grav, double* hopIbus );
+   static double tinseth( double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes );
+   static double rager( double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes );
+   //! \brief Greg Noonan's formula, by Daniel Pettersson.
+   static double noonan( double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes );
+
+   //! \returns SRM of \c mcu malt color units according to \c formula.
+   static double mcuToSrm( ColorFormula formula, double mcu );
+   //! \returns the mcu that \b mcuToSrm() turns into \c srm, or 0 if there is none.
+   static double srmToMcu( ColorFormula formula, double srm );
+
+   //=================================Styles===================================
+
+   //! \returns the index over \c styles.
+   static StyleIndex indexStyles( std::vector<StyleRanges> const& styles );
+   /*!
+    * \returns up to \c count styles, best first. The styles \c stats fit
+    * come from the index. Only if there are fewer than \c count of them
+    * are the rest scored to fill in with the closest misses.
+    */
+   static std::vector<StyleMatch> matchStyles( StyleIndex const& index, StyleStats const& stats, unsigned int count );
+   //! \returns how well \c stats fit \c style, with the same score as \b matchStyles().
+   static StyleMatch matchStyle( StyleRanges const& style, StyleStats const& stats );
+
+   //=============================Similar recipes==============================
+
+   /*!
+    * \returns the \c NumRecipeFeatures features of \c rec.
+    * \param stats what was worked out for \c rec. Carbonation is not used.
+    * \param hopVarieties one per \c rec.hops, the same for the same variety, like a hash of its name
+    * \param yeastStrains one per \c rec.yeasts, the same for the same strain
+    */
+   static std::vector<double> recipeFeatures( Recipe const& rec, StyleStats const& stats, std::vector<unsigned int> const& hopVarieties, std::vector<unsigned int> const& yeastStrains );
+   //! \brief Add the point of \c id, or move it if it is already there.
+   static void setNeighbor( NeighborIndex& index, int id, std::vector<double> const& point );
+   //! \brief Take out the point of \c id, if it is there.
+   static void removeNeighbor( NeighborIndex& index, int id );
+   /*!
+    * \returns up to \c count points nearest to \c point, nearest first,
+    * leaving out the one of \c excludeId. Every point is looked at, so it is
+    * exact, but each is dropped as soon as it is further than all \c count
+    * found so far.
+    */
+   static std::vector<Neighbor> nearestNeighbors( NeighborIndex const& index, std::vector<double> const& point, unsigned int count, int excludeId );
+
+   //===============================Brew notes=================================
+
+   //! \returns the efficiency into the kettle, or 0 if nothing was expected.
+   static double effIntoBK_pct( double projPoints, double projVolIntoBK_l, double sg, double volumeIntoBK_l );
+   //! \returns the og expected from the preboil gravity, or 0 if the expected volume is bad.
+   static double projOg( double sg, double projVolIntoBK_l, double boilOff_l, double volumeIntoBK_l );
+   //! \returns the brewhouse efficiency.
+   static double brewhouseEff_pct( double projFermPoints, double projVolIntoFerm_l, double og, double volumeIntoFerm_l );
+   //! \returns the ABV expected from \c og at \c atten_pct attenuation.
+   static double projABV_pct( double og, double atten_pct );
+   //! \returns the ABV from measured \c og and \c fg.
+   static double actualABV_pct( double og, double fg );
+};
+
+#endif /*_BREWCALC_H*/
@@ -0,0 +1,142 @@
+/*
+ * BrewCalcGrainBill.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrewCalc.h"
+#include "PhysicalConstants.h"
+#include "matrix.h"
+#include <cmath>
+
+namespace
+{
+   // How much grainBill() cares about each target, relative to the og.
+   const double grainBillOgWeight = 10.0;
+   const double grainBillColorWeight = 1.0;
+   const double grainBillGristWeight = 1.0;
+   const double grainBillSmallWeight = 1e-4;
+   const unsigned int grainBillPasses = 3;
+}
+
+BrewCalc::GrainBillTargets::GrainBillTargets()
+   : og(0.0),
+     color_srm(0.0)
+{
+}
+
+//===============================Grain bill=====================================
+
+std::vector<double> BrewCalc::grainBill( Recipe const& rec, GrainBillTargets const& targets, Options const& opts )
+{
+   unsigned int const n = rec.fermentables.size();
+   std::vector<double> ret(n);
+   std::vector<unsigned int> gristTargets;
+   Recipe work(rec);
+   double og = targets.og;
+   double targetMcu = 0.0;
+   unsigned int i, j, r, pass;
+
+   for( j = 0; j < n; ++j )
+      ret[j] = rec.fermentables[j].amount_kg;
+   if( n == 0 )
+      return ret;
+
+   if( og <= 0.0 )
+      og = calculate(rec, opts).gravities.og;
+   if( targets.color_srm > 0.0 )
+      targetMcu = srmToMcu(opts.colorFormula, targets.color_srm);
+   for( j = 0; j < n && j < targets.grist_pct.size(); ++j )
+      if( targets.grist_pct[j] >= 0.0 )
+         gristTargets.push_back(j);
+
+   // One row for the og, maybe one for the color, one per grist target, and
+   // a light one per fermentable to pick the smallest bill when several fit.
+   unsigned int const m = 1 + (targetMcu > 0.0 ? 1 : 0) + gristTargets.size() + n;
+
+   // How much sugar stays in the kettle depends a little on how much wort
+   // the grain soaks up. So solve, redo the volumes with the new amounts,
+   // and solve again.
+   for( pass = 0; pass < grainBillPasses; ++pass )
+   {
+      Matrix A(m, n);
+      Matrix b(m, 1);
+      Matrix lower(n, 1);
+      Matrix upper(n, 1);
+      Volumes vols;
+      double ratio, plato_frac, sugar_kg, sugarPerKg_sum = 0.0, total_kg;
+      std::vector<double> sugarPerKg(n);
+
+      for( j = 0; j < n; ++j )
+         work.fermentables[j].amount_kg = ret[j];
+      vols = volumes(work, grainsInMash_kg(work));
+      ratio = kettleSugarRatio(work, vols.wortFromMash_l);
+
+      // plato() turned around: the sugar that gives og in the final volume.
+      plato_frac = sgToPlato(og) / 100.0;
+      sugar_kg = plato_frac * vols.finalVolumeNoLosses_l / (1.0 - plato_frac*(1.0 - 1.0/PhysicalConstants::sucroseDensity_kgL));
+      if( !(sugar_kg > 0.0) )
+         return std::vector<double>(n, 0.0);
+
+      for( j = 0; j < n; ++j )
+      {
+         Fermentable unit = rec.fermentables[j];
+         unit.amount_kg = 1.0;
+         sugarPerKg[j] = equivSucrose_kg(unit) * (isFermentableSugarOrExtract(unit) ? ratio : rec.efficiency_pct/100.0);
+         sugarPerKg_sum += sugarPerKg[j];
+      }
+      // About how much the bill will weigh, to put the grist rows on the
+      // same scale as the others.
+      total_kg = (sugarPerKg_sum > 0.0) ? sugar_kg * n / sugarPerKg_sum : 1.0;
+
+      // Every row is relative to its target, and then weighted.
+      r = 0;
+      for( j = 0; j < n; ++j )
+         A.setVal(r, j, grainBillOgWeight * sugarPerKg[j] / sugar_kg);
+      b.setVal(r++, 0, grainBillOgWeight);
+
+      if( targetMcu > 0.0 )
+      {
+         for( j = 0; j < n; ++j )
+         {
+            Fermentable unit = rec.fermentables[j];
+            unit.amount_kg = 1.0;
+            A.setVal(r, j, grainBillColorWeight * maltColorUnits(unit, vols.finalVolumeNoLosses_l) / targetMcu);
+         }
+         b.setVal(r++, 0, grainBillColorWeight);
+      }
+
+      // amount_k - pct_k/100 * total = 0
+      for( i = 0; i < gristTargets.size(); ++i, ++r )
+      {
+         unsigned int k = gristTargets[i];
+         for( j = 0; j < n; ++j )
+            A.setVal(r, j, grainBillGristWeight * ((j == k ? 1.0 : 0.0) - targets.grist_pct[k]/100.0) / total_kg);
+      }
+
+      for( j = 0; j < n; ++j, ++r )
+         A.setVal(r, j, grainBillSmallWeight / total_kg);
+
+      for( j = 0; j < n; ++j )
+         upper.setVal(j, 0, HUGE_VAL);
+
+      Matrix x = Matrix::boundedLeastSquares(A, b, lower, upper);
+      for( j = 0; j < n; ++j )
+         ret[j] = x.getVal(j, 0);
+   }
+
+   return ret;
+}
@@ -0,0 +1,305 @@
+/*
+ * BrewCalcHopSearch.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrewCalc.h"
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+   // What searchHops() adds to the grams to buy, all in grams.
+   const double hopSearchGramWeight = 0.1;
+   const double hopSearchMinuteWeight = 0.02;
+   const double hopSearchSubstituteWeight = 1.0;
+   // Bittering additions move in steps of this many minutes.
+   const double hopSearchStep_min = 5.0;
+   // Boil hops in for this long are bittering, and stay at least this long.
+   const double hopSearchBittering_min = 30.0;
+}
+
+BrewCalc::HopTargets::HopTargets()
+   : ibu(0.0),
+     timeWindow_min(0.0)
+{
+}
+
+BrewCalc::HopSearch::HopSearch()
+   : total(0.0),
+     done(0.0),
+     depth(0),
+     bestCost(HUGE_VAL)
+{
+}
+
+//===============================Hop search=====================================
+
+BrewCalc::HopSearch BrewCalc::startHopSearch( Recipe const& rec, HopTargets const& targets, Options const& opts )
+{
+   unsigned int const nSubs = targets.substitutes.size();
+   HopSearch ret, sorted;
+   Results res = calculate(rec, opts);
+   HopSchedule schedule;
+   std::vector<double> ibuPerGram;
+   std::vector< std::pair<double,unsigned int> > order;
+   double const boilTime = rec.hasEquipment ? rec.equipment.boilTime_min : 60.0;
+   double fixedIbu = res.IBU;
+   double given = 0.0;
+   double shared = 0.0;
+   unsigned int nShared = 0;
+   unsigned int i, a, s, c, n;
+
+   // The additions are the hops that give IBUs at all.
+   for( i = 0; i < rec.hops.size(); ++i )
+   {
+      HopSchedule one;
+      addToSchedule(one, rec.hops[i], rec, opts);
+      if( one.scale[0] <= 0.0 )
+         continue;
+
+      ret.hopIndex.push_back(i);
+      fixedIbu -= res.hopIbus[i];
+   }
+   n = ret.hopIndex.size();
+
+   // Split what the additions have to give between them.
+   ret.ibuWanted.resize(n, -1.0);
+   for( a = 0; a < n; ++a )
+   {
+      i = ret.hopIndex[a];
+      if( i < targets.split_pct.size() && targets.split_pct[i] >= 0.0 )
+      {
+         ret.ibuWanted[a] = targets.split_pct[i] / 100.0 * targets.ibu;
+         given += ret.ibuWanted[a];
+      }
+      else
+      {
+         shared += res.hopIbus[i];
+         ++nShared;
+      }
+   }
+   for( a = 0; a < n; ++a )
+   {
+      if( ret.ibuWanted[a] >= 0.0 )
+         continue;
+      i = ret.hopIndex[a];
+      ret.ibuWanted[a] = std::max(0.0, targets.ibu - fixedIbu - given)
+                       * (shared > 0.0 ? res.hopIbus[i] / shared : 1.0 / nShared);
+   }
+
+   // Every choice of time and variety, each as one gram. Only bittering
+   // additions have more than their own.
+   for( a = 0; a < n; ++a )
+   {
+      Hop const& own = rec.hops[ret.hopIndex[a]];
+      bool const bittering = own.use == Hop::Boil && own.time_min >= hopSearchBittering_min;
+      std::vector<double> times(1, own.time_min);
+      double step;
+
+      ret.firstChoice.push_back(ret.minutes.size());
+
+      if( bittering )
+      {
+         for( step = hopSearchStep_min; step <= targets.timeWindow_min; step += hopSearchStep_min )
+         {
+            if( own.time_min - step >= hopSearchBittering_min )
+               times.push_back(own.time_min - step);
+            if( own.time_min + step <= boilTime )
+               times.push_back(own.time_min + step);
+         }
+      }
+
+      for( s = 0; s <= (bittering ? nSubs : 0); ++s )
+      {
+         Hop hop = (s == 0) ? own : targets.substitutes[s-1];
+         hop.use = own.use;
+         hop.amount_kg = 0.001;
+
+         for( i = 0; i < times.size(); ++i )
+         {
+            hop.time_min = times[i];
+            addToSchedule(schedule, hop, rec, opts);
+
+            ret.minutes.push_back(times[i]);
+            ret.substitute.push_back(static_cast<int>(s) - 1);
+            ret.variety.push_back(s == 0 ? a : n + s - 1);
+            ret.penalty.push_back( hopSearchMinuteWeight * std::fabs(times[i] - own.time_min)
+                                 + (s == 0 ? 0.0 : hopSearchSubstituteWeight) );
+         }
+      }
+   }
+   ret.firstChoice.push_back(ret.minutes.size());
+
+   // The recipe's own hops are there to be bought, the substitutes are stock.
+   ret.stock_g.resize(n, 0.0);
+   for( s = 0; s < nSubs; ++s )
+      ret.stock_g.push_back( s < targets.substituteStock_kg.size() ? targets.substituteStock_kg[s] * 1000.0 : 0.0 );
+
+   ibuPerGram.resize(schedule.size());
+   ibus(opts.ibuFormula, schedule, res.volumes.finalVolumeNoLosses_l, res.gravities.og, ibuPerGram.empty() ? 0 : &ibuPerGram[0]);
+
+   // What each choice costs by itself. Sharing a variety with other
+   // additions can only cost more, so these bound what is left to choose.
+   for( a = 0; a < n; ++a )
+   {
+      for( c = ret.firstChoice[a]; c < ret.firstChoice[a+1]; ++c )
+      {
+         double g = 0.0;
+         if( ret.ibuWanted[a] > 0.0 )
+            g = (ibuPerGram[c] > 0.0) ? ret.ibuWanted[a] / ibuPerGram[c] : HUGE_VAL;
+
+         ret.grams.push_back(g);
+         ret.cost.push_back( ret.penalty[c] + hopSearchGramWeight * g + std::max(0.0, g - ret.stock_g[ret.variety[c]]) );
+      }
+   }
+
+   // Cheapest first, so the first schedule tried is a good one to beat.
+   order.reserve(ret.cost.size());
+   for( a = 0; a < n; ++a )
+   {
+      for( c = ret.firstChoice[a]; c < ret.firstChoice[a+1]; ++c )
+         order.push_back( std::make_pair(ret.cost[c], c) );
+      std::sort( order.begin() + ret.firstChoice[a], order.end() );
+   }
+   sorted = ret;
+   for( c = 0; c < order.size(); ++c )
+   {
+      i = order[c].second;
+      sorted.minutes[c] = ret.minutes[i];
+      sorted.substitute[c] = ret.substitute[i];
+      sorted.variety[c] = ret.variety[i];
+      sorted.grams[c] = ret.grams[i];
+      sorted.penalty[c] = ret.penalty[i];
+      sorted.cost[c] = ret.cost[i];
+   }
+   ret = sorted;
+
+   ret.restCost.resize(n+1, 0.0);
+   ret.restTotal.resize(n+1, 1.0);
+   for( a = n; a-- > 0; )
+   {
+      ret.restCost[a] = ret.restCost[a+1] + ret.cost[ret.firstChoice[a]];
+      ret.restTotal[a] = ret.restTotal[a+1] * (ret.firstChoice[a+1] - ret.firstChoice[a]);
+   }
+
+   ret.next.resize(n, 0);
+   ret.pathCost.resize(n+1, 0.0);
+   ret.used_g.resize(ret.stock_g.size(), 0.0);
+   if( n > 0 )
+      ret.total = ret.restTotal[0];
+
+   return ret;
+}
+
+bool BrewCalc::searchHops( HopSearch& search, unsigned int count )
+{
+   unsigned int const n = search.hopIndex.size();
+   unsigned int k, d, c, v, choices;
+   double g, over, cost;
+
+   for( k = 0; k < count && search.done < search.total; ++k )
+   {
+      d = search.depth;
+
+      if( d == n )
+      {
+         // A whole schedule, and the cheapest so far or it would have been cut.
+         search.bestCost = search.pathCost[n];
+         search.best = search.next;
+         search.done += 1.0;
+      }
+      else
+      {
+         choices = search.firstChoice[d+1] - search.firstChoice[d];
+         if( search.next[d] < choices )
+         {
+            c = search.firstChoice[d] + search.next[d];
+
+            // Sorted cheapest first, so if this choice can not beat the best, none after it can.
+            if( search.pathCost[d] + search.cost[c] + search.restCost[d+1] >= search.bestCost )
+            {
+               search.done += (choices - search.next[d]) * search.restTotal[d+1];
+               search.next[d] = choices;
+               continue;
+            }
+
+            v = search.variety[c];
+            g = search.grams[c];
+            over = std::max(0.0, search.used_g[v] + g - search.stock_g[v])
+                 - std::max(0.0, search.used_g[v] - search.stock_g[v]);
+            cost = search.pathCost[d] + search.penalty[c] + hopSearchGramWeight * g + over;
+
+            if( cost + search.restCost[d+1] >= search.bestCost )
+            {
+               search.done += search.restTotal[d+1];
+               ++search.next[d];
+               continue;
+            }
+
+            search.used_g[v] += g;
+            search.pathCost[d+1] = cost;
+            if( ++search.depth < n )
+               search.next[d+1] = 0;
+            continue;
+         }
+      }
+
+      // Every schedule under this choice is done, so back up to the one before.
+      if( d == 0 )
+      {
+         search.done = search.total;
+         break;
+      }
+      search.depth = --d;
+      c = search.firstChoice[d] + search.next[d];
+      search.used_g[search.variety[c]] -= search.grams[c];
+      ++search.next[d];
+   }
+
+   return search.done < search.total;
+}
+
+std::vector<BrewCalc::Hop> BrewCalc::bestHops( HopSearch const& search, Recipe const& rec, HopTargets const& targets, std::vector<int>* substitute )
+{
+   std::vector<Hop> ret(rec.hops);
+   unsigned int a, c, i;
+
+   if( substitute )
+      substitute->assign(rec.hops.size(), -1);
+   if( search.best.empty() )
+      return ret;
+
+   for( a = 0; a < search.best.size(); ++a )
+   {
+      c = search.firstChoice[a] + search.best[a];
+      i = search.hopIndex[a];
+
+      if( search.substitute[c] >= 0 )
+      {
+         ret[i].alpha_pct = targets.substitutes[search.substitute[c]].alpha_pct;
+         ret[i].form = targets.substitutes[search.substitute[c]].form;
+         if( substitute )
+            (*substitute)[i] = search.substitute[c];
+      }
+      ret[i].time_min = search.minutes[c];
+      ret[i].amount_kg = search.grams[c] / 1000.0;
+   }
+
+   return ret;
+}
@@ -0,0 +1,208 @@
+/*
+ * BrewCalcNeighbors.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrewCalc.h"
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+   // How far apart each statistic gets between recipes of the same style.
+   // That is one unit of distance in BrewCalc::recipeFeatures().
+   const double ogSpread_points = 8.0;
+   const double fgSpread_points = 3.0;
+   const double ibuSpread = 10.0;
+   const double colorSpread_srm = 4.0;
+   const double abvSpread_pct = 1.0;
+   // Two recipes with nothing in common in one of these are sqrt(2) times
+   // its weight apart.
+   const double gristWeight = 3.0;
+   const double hopTimingWeight = 2.0;
+   const double hopVarietyWeight = 2.0;
+   const double yeastWeight = 2.0;
+}
+
+BrewCalc::NeighborIndex::NeighborIndex()
+   : dims(0)
+{
+}
+
+BrewCalc::Neighbor::Neighbor()
+   : id(0),
+     distance(0.0)
+{
+}
+
+//=============================Similar recipes==================================
+
+std::vector<double> BrewCalc::recipeFeatures( Recipe const& rec, StyleStats const& stats, std::vector<unsigned int> const& hopVarieties, std::vector<unsigned int> const& yeastStrains )
+{
+   std::vector<double> ret(NumRecipeFeatures, 0.0);
+   unsigned int const numVarietyBins = FeatureYeast - FeatureHopVariety;
+   unsigned int const numStrainBins = NumRecipeFeatures - FeatureYeast;
+   double total;
+   unsigned int i;
+   int timing;
+
+   // Unknown statistics stay at 0.
+   if( stats.value[StyleOg] > 0.0 )
+      ret[FeatureOg] = (stats.value[StyleOg] - 1.0) * 1000.0 / ogSpread_points;
+   if( stats.value[StyleFg] > 0.0 )
+      ret[FeatureFg] = (stats.value[StyleFg] - 1.0) * 1000.0 / fgSpread_points;
+   if( stats.value[StyleIbu] > 0.0 )
+      ret[FeatureIbu] = stats.value[StyleIbu] / ibuSpread;
+   if( stats.value[StyleColor] > 0.0 )
+      ret[FeatureColor] = stats.value[StyleColor] / colorSpread_srm;
+   if( stats.value[StyleAbv] > 0.0 )
+      ret[FeatureAbv] = stats.value[StyleAbv] / abvSpread_pct;
+
+   total = 0.0;
+   for( i = 0; i < rec.fermentables.size(); ++i )
+      total += rec.fermentables[i].amount_kg;
+   for( i = 0; total > 0.0 && i < rec.fermentables.size(); ++i )
+      ret[FeatureGrist + rec.fermentables[i].type] += gristWeight * rec.fermentables[i].amount_kg / total;
+
+   total = 0.0;
+   for( i = 0; i < rec.hops.size(); ++i )
+      total += rec.hops[i].amount_kg;
+   for( i = 0; total > 0.0 && i < rec.hops.size(); ++i )
+   {
+      Hop const& hop = rec.hops[i];
+
+      // Bittering, flavor, late and dry hops.
+      if( hop.use == Hop::Dry_Hop )
+         timing = 3;
+      else if( hop.use == Hop::UseAroma || (hop.use == Hop::Boil && hop.time_min <= 5.0) )
+         timing = 2;
+      else if( hop.use == Hop::Boil && hop.time_min < 30.0 )
+         timing = 1;
+      else
+         timing = 0;
+
+      ret[FeatureHopTiming + timing] += hopTimingWeight * hop.amount_kg / total;
+      if( i < hopVarieties.size() )
+         ret[FeatureHopVariety + hopVarieties[i] % numVarietyBins] += hopVarietyWeight * hop.amount_kg / total;
+   }
+
+   for( i = 0; i < rec.yeasts.size() && i < yeastStrains.size(); ++i )
+      ret[FeatureYeast + yeastStrains[i] % numStrainBins] += yeastWeight / rec.yeasts.size();
+
+   return ret;
+}
+
+void BrewCalc::setNeighbor( NeighborIndex& index, int id, std::vector<double> const& point )
+{
+   std::map<int,unsigned int>::const_iterator it = index.rows.find(id);
+
+   if( index.ids.empty() )
+      index.dims = point.size();
+   if( point.size() != index.dims )
+      return;
+
+   if( it != index.rows.end() )
+   {
+      std::copy( point.begin(), point.end(), index.points.begin() + it->second * index.dims );
+      return;
+   }
+
+   index.rows[id] = index.ids.size();
+   index.ids.push_back(id);
+   index.points.insert( index.points.end(), point.begin(), point.end() );
+}
+
+void BrewCalc::removeNeighbor( NeighborIndex& index, int id )
+{
+   std::map<int,unsigned int>::iterator it = index.rows.find(id);
+   unsigned int row, last;
+
+   if( it == index.rows.end() )
+      return;
+
+   // Move the last point into the hole.
+   row = it->second;
+   last = index.ids.size() - 1;
+   if( row != last )
+   {
+      std::copy( index.points.begin() + last * index.dims,
+                 index.points.begin() + (last+1) * index.dims,
+                 index.points.begin() + row * index.dims );
+      index.ids[row] = index.ids[last];
+      index.rows[index.ids[row]] = row;
+   }
+
+   index.rows.erase(it);
+   index.ids.pop_back();
+   index.points.resize( last * index.dims );
+}
+
+std::vector<BrewCalc::Neighbor> BrewCalc::nearestNeighbors( NeighborIndex const& index, std::vector<double> const& point, unsigned int count, int excludeId )
+{
+   std::vector<Neighbor> ret;
+   // The nearest so far as (squared distance, row), furthest on top.
+   std::vector< std::pair<double,unsigned int> > heap;
+   unsigned int const n = index.ids.size();
+   unsigned int const dims = index.dims;
+   double bound = HUGE_VAL;
+   double d, diff;
+   unsigned int r, k;
+
+   if( count == 0 || n == 0 || dims == 0 || point.size() != dims )
+      return ret;
+
+   double const* p = &point[0];
+   for( r = 0; r < n; ++r )
+   {
+      if( index.ids[r] == excludeId )
+         continue;
+
+      // The statistics come first and differ the most, so most points are
+      // dropped after a few of them.
+      double const* q = &index.points[r * dims];
+      d = 0.0;
+      for( k = 0; k < dims && d < bound; ++k )
+      {
+         diff = p[k] - q[k];
+         d += diff*diff;
+      }
+      if( d >= bound )
+         continue;
+
+      heap.push_back( std::make_pair(d, r) );
+      std::push_heap( heap.begin(), heap.end() );
+      if( heap.size() > count )
+      {
+         std::pop_heap( heap.begin(), heap.end() );
+         heap.pop_back();
+      }
+      if( heap.size() == count )
+         bound = heap.front().first;
+   }
+
+   std::sort_heap( heap.begin(), heap.end() );
+   for( r = 0; r < heap.size(); ++r )
+   {
+      Neighbor nb;
+      nb.id = index.ids[heap[r].second];
+      nb.distance = std::sqrt(heap[r].first);
+      ret.push_back(nb);
+   }
+
+   return ret;
+}
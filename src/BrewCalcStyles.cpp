@@ -0,0 +1,213 @@
+/*
+ * BrewCalcStyles.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrewCalc.h"
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+   bool hasLimit( BrewCalc::StyleRanges const& style, int stat )
+   {
+      return style.max[stat] >= style.min[stat] && !(style.min[stat] == 0.0 && style.max[stat] == 0.0);
+   }
+
+   bool betterStyleMatch( BrewCalc::StyleMatch const& lhs, BrewCalc::StyleMatch const& rhs )
+   {
+      return lhs.score < rhs.score;
+   }
+}
+
+BrewCalc::StyleRanges::StyleRanges()
+{
+   int i;
+   for( i = 0; i < NumStyleStats; ++i )
+   {
+      min[i] = 0.0;
+      max[i] = 0.0;
+   }
+}
+
+BrewCalc::StyleStats::StyleStats()
+{
+   int i;
+   for( i = 0; i < NumStyleStats; ++i )
+      value[i] = -1.0;
+}
+
+BrewCalc::StyleIndex::StyleIndex()
+   : words(0)
+{
+}
+
+BrewCalc::StyleMatch::StyleMatch()
+   : style(0),
+     score(0.0),
+     outOfRange(0)
+{
+}
+
+//=================================Styles=======================================
+
+BrewCalc::StyleIndex BrewCalc::indexStyles( std::vector<StyleRanges> const& styles )
+{
+   StyleIndex ret;
+   unsigned int s, slot, first, last;
+   int k;
+
+   ret.styles = styles;
+   ret.words = (styles.size() + 31) / 32;
+
+   for( k = 0; k < NumStyleStats; ++k )
+   {
+      std::vector<double>& ends = ret.ends[k];
+      std::vector<unsigned int>& cover = ret.cover[k];
+
+      for( s = 0; s < styles.size(); ++s )
+      {
+         if( !hasLimit(styles[s], k) )
+            continue;
+         ends.push_back(styles[s].min[k]);
+         ends.push_back(styles[s].max[k]);
+      }
+      std::sort( ends.begin(), ends.end() );
+      ends.erase( std::unique(ends.begin(), ends.end()), ends.end() );
+
+      // Slot 2i+1 is exactly at ends[i], and slot 2i is just below it.
+      cover.assign( (2*ends.size() + 1) * ret.words, 0u );
+      for( s = 0; s < styles.size(); ++s )
+      {
+         if( hasLimit(styles[s], k) )
+         {
+            first = 2 * (std::lower_bound(ends.begin(), ends.end(), styles[s].min[k]) - ends.begin()) + 1;
+            last = 2 * (std::lower_bound(ends.begin(), ends.end(), styles[s].max[k]) - ends.begin()) + 1;
+         }
+         else
+         {
+            first = 0;
+            last = 2 * ends.size();
+         }
+
+         for( slot = first; slot <= last; ++slot )
+            cover[slot * ret.words + s/32] |= 1u << (s % 32);
+      }
+   }
+
+   return ret;
+}
+
+std::vector<BrewCalc::StyleMatch> BrewCalc::matchStyles( StyleIndex const& index, StyleStats const& stats, unsigned int count )
+{
+   std::vector<StyleMatch> ret;
+   std::vector<unsigned int> fits(index.words, ~0u);
+   unsigned int i, s, pos, slot;
+   int k;
+
+   if( index.styles.empty() )
+      return ret;
+
+   for( k = 0; k < NumStyleStats; ++k )
+   {
+      std::vector<double> const& ends = index.ends[k];
+      double x = stats.value[k];
+
+      // Unknown, or no style limits it.
+      if( x < 0.0 || ends.empty() )
+         continue;
+
+      pos = std::lower_bound(ends.begin(), ends.end(), x) - ends.begin();
+      slot = (pos < ends.size() && ends[pos] == x) ? 2*pos + 1 : 2*pos;
+
+      unsigned int const* cover = &index.cover[k][slot * index.words];
+      for( i = 0; i < index.words; ++i )
+         fits[i] &= cover[i];
+   }
+   if( index.styles.size() % 32 )
+      fits[index.words-1] &= (1u << (index.styles.size() % 32)) - 1u;
+
+   for( s = 0; s < index.styles.size(); ++s )
+   {
+      if( !(fits[s/32] & (1u << (s % 32))) )
+         continue;
+      ret.push_back( matchStyle(index.styles[s], stats) );
+      ret.back().style = s;
+   }
+
+   // Not enough fit, so rank the misses too.
+   if( ret.size() < count )
+   {
+      for( s = 0; s < index.styles.size(); ++s )
+      {
+         if( fits[s/32] & (1u << (s % 32)) )
+            continue;
+         ret.push_back( matchStyle(index.styles[s], stats) );
+         ret.back().style = s;
+      }
+   }
+
+   if( count > ret.size() )
+      count = ret.size();
+   std::partial_sort( ret.begin(), ret.begin() + count, ret.end(), betterStyleMatch );
+   ret.resize(count);
+   return ret;
+}
+
+BrewCalc::StyleMatch BrewCalc::matchStyle( StyleRanges const& style, StyleStats const& stats )
+{
+   StyleMatch ret;
+   double inside = 0.0;
+   double outside = 0.0;
+   double x, lo, hi, width, d;
+   unsigned int n = 0;
+   int k;
+
+   for( k = 0; k < NumStyleStats; ++k )
+   {
+      x = stats.value[k];
+      if( x < 0.0 || !hasLimit(style, k) )
+         continue;
+
+      lo = style.min[k];
+      hi = style.max[k];
+      width = hi - lo;
+      // So that a range of one value still has a scale.
+      if( width <= 0.0 )
+         width = 1e-3 * (std::fabs(hi) + 1.0);
+
+      if( x < lo || x > hi )
+      {
+         d = (x < lo ? lo - x : x - hi) / width;
+         outside += d*d;
+         ret.outOfRange |= 1u << k;
+      }
+      else
+      {
+         d = (x - 0.5*(lo + hi)) / (0.5*width);
+         inside += d*d;
+         ++n;
+      }
+   }
+
+   if( ret.outOfRange )
+      ret.score = 1.0 + outside;
+   else
+      ret.score = (n > 0) ? inside / n : 0.0;
+
+   return ret;
+}
@@ -28,18 +28,76 @@
 #include <QDate>
 #include <QVector>
 #include <QDir>
+#include <QRunnable>
+#include <QMetaObject>
 #include "InstructionWidget.h"
 #include "TimerWidget.h"
 #include "style.h"
 #include "equipment.h"
 #include "mash.h"
+#include "mashstep.h"
+
+namespace {
+   
+   //! Joins the header and the per-instruction cells into the steps table.
+   QString assembleInstructionTable(QString const& header, QList<QString> const& fragments)
+   {
+      QString middle = header;
+      int i, size;
+      
+      size = fragments.size();
+      for( i = 0; i < size; ++i )
+      {
+         QString altTag = i % 2 ? "alt" : "norm";
+         middle += QString("<tr class=\"%1\">%2</tr>").arg(altTag).arg(fragments.at(i));
+      }
+      middle += "</table>";
+      
+      return middle;
+   }
+   
+   /*!
+    * Assembles the instruction table in the background and hands it back to
+    * \c receiver's acceptInstructionTable(). Only touches the strings it is
+    * given, never the database.
+    */
+   class InstructionTableJob : public QRunnable
+   {
+   public:
+      InstructionTableJob(QObject* receiver, QString const& header, QList<QString> const& fragments, int generation)
+         : _receiver(receiver), _header(header), _fragments(fragments), _generation(generation)
+      {
+      }
+      
+      void run()
+      {
+         QString table = assembleInstructionTable(_header, _fragments);
+         QMetaObject::invokeMethod( _receiver, "acceptInstructionTable", Qt::QueuedConnection,
+                                    Q_ARG(QString, table), Q_ARG(int, _generation) );
+      }
+      
+   private:
+      QObject* _receiver;
+      QString _header;
+      QList<QString> _fragments;
+      int _generation;
+   };
+}
 
 BrewDayScrollWidget::BrewDayScrollWidget(QWidget* parent)
-   : QWidget(parent), doc(new QWebView())
+   : QWidget(parent), doc(new QWebView()), fragmentsOptionsVersion(Brewtarget::optionsVersion()), renderGeneration(0), tableGeneration(-1)
 {
    setupUi(this);
    setObjectName("BrewDayScrollWidget");
    recObs = 0;
+   mashObs = 0;
+
+   // Many changes tend to arrive at once, so render after they have all come in.
+   renderTimer.setSingleShot(true);
+   renderTimer.setInterval(0);
+   connect( &renderTimer, SIGNAL(timeout()), this, SLOT(renderInstructionTable()) );
+   // One thread keeps the jobs in order.
+   renderPool.setMaxThreadCount(1);
 
    connect( listWidget, SIGNAL(currentRowChanged(int)), this, SLOT(showInstruction(int)) );
    // connect( plainTextEdit, SIGNAL(textChanged()), this, SLOT(saveInstruction()) );
@@ -51,6 +109,12 @@ BrewDayScrollWidget::BrewDayScrollWidget(QWidget* parent)
    connect( pushButton_generateInstructions, SIGNAL(clicked()), this, SLOT(generateInstructions()) );
 }
 
+BrewDayScrollWidget::~BrewDayScrollWidget()
+{
+   // Jobs hold a pointer to us.
+   renderPool.waitForDone();
+}
+
 void BrewDayScrollWidget::saveInstruction()
 {
    recObs->instructions()[ listWidget->currentRow() ]->setDirections( btTextEdit->toPlainText() );
@@ -158,7 +222,10 @@ void BrewDayScrollWidget::print(QPrinter *mainPrinter, QPrintDialog* dialog,
    // Start building the document to be printed.  The HTML doesn't work with
    // the image since it is a compiled resource
    pDoc = buildTitleTable( action != HTML );
-   pDoc += buildInstructionTable();
+   if( tableGeneration == renderGeneration && !renderTimer.isActive() )
+      pDoc += instructionTable;
+   else
+      pDoc += buildInstructionTable();
    pDoc += buildFooterTable();
 
    pDoc += tr("<h2>Notes</h2>");
@@ -183,9 +250,15 @@ void BrewDayScrollWidget::setRecipe(Recipe* rec)
    // Disconnect old notifier.
    if( recObs )
       disconnect( recObs, SIGNAL(changed(QMetaProperty,QVariant)), this, SLOT(acceptChanges(QMetaProperty,QVariant)) );
+   foreach( Instruction* ins, recIns )
+      disconnect( ins, 0, this, 0 );
+   
+   insFragments.clear();
+   recipeDependentFragments.clear();
    
    recObs = rec;
    connect( recObs, SIGNAL(changed(QMetaProperty,QVariant)), this, SLOT(acceptChanges(QMetaProperty,QVariant)) );
+   watchMash();
    
    recIns = recObs->instructions();
    foreach( Instruction* ins, recIns )
@@ -198,6 +271,7 @@ void BrewDayScrollWidget::setRecipe(Recipe* rec)
       btTextEdit->setEnabled(true);
 
    showChanges();
+   scheduleRender();
 }
 
 void BrewDayScrollWidget::insertInstruction()
@@ -229,7 +303,13 @@ void BrewDayScrollWidget::insertInstruction()
 
 void BrewDayScrollWidget::acceptChanges(QMetaProperty prop, QVariant /*value*/)
 {
-   if( recObs && QString(prop.name()) == "instructions" )
+   if( recObs == 0 )
+      return;
+   
+   if( QString(prop.name()) == "mash" )
+      watchMash();
+   
+   if( QString(prop.name()) == "instructions" )
    {
       // An instruction has been added or deleted, so update internal list.
       foreach( Instruction* ins, recIns )
@@ -237,27 +317,133 @@ void BrewDayScrollWidget::acceptChanges(QMetaProperty prop, QVariant /*value*/)
       recIns = recObs->instructions(); // Already sorted by instruction numbers.
       foreach( Instruction* ins, recIns )
          connect( ins, SIGNAL(changed(QMetaProperty,QVariant)), this, SLOT(acceptInsChanges(QMetaProperty,QVariant)) );
+      pruneFragments();
       showChanges();
    }
+   else if( !dropRecipeDependentFragments() )
+      return;
+   
+   scheduleRender();
+}
+
+void BrewDayScrollWidget::acceptMashChanges()
+{
+   // "Heat water" shows the step and infusion temperatures.
+   if( dropRecipeDependentFragments() )
+      scheduleRender();
+}
+
+void BrewDayScrollWidget::acceptMashStepsChanged()
+{
+   watchMash();
+   acceptMashChanges();
+}
+
+bool BrewDayScrollWidget::dropRecipeDependentFragments()
+{
+   if( recipeDependentFragments.isEmpty() )
+      return false;
+   
+   // Only the steps that list the recipe's ingredients are affected.
+   foreach( Instruction* ins, recipeDependentFragments )
+      insFragments.remove(ins);
+   recipeDependentFragments.clear();
+   return true;
+}
+
+void BrewDayScrollWidget::watchMash()
+{
+   if( mashObs )
+      disconnect( mashObs, 0, this, 0 );
+   foreach( MashStep* step, mashStepsObs )
+      disconnect( step, 0, this, 0 );
+   
+   mashObs = recObs ? recObs->mash() : 0;
+   mashStepsObs.clear();
+   if( mashObs == 0 )
+      return;
+   
+   connect( mashObs, SIGNAL(changed(QMetaProperty,QVariant)), this, SLOT(acceptMashChanges()) );
+   connect( mashObs, SIGNAL(mashStepsChanged()), this, SLOT(acceptMashStepsChanged()) );
+   mashStepsObs = mashObs->mashSteps();
+   foreach( MashStep* step, mashStepsObs )
+      connect( step, SIGNAL(changed(QMetaProperty,QVariant)), this, SLOT(acceptMashChanges()) );
 }
 
 void BrewDayScrollWidget::acceptInsChanges(QMetaProperty prop, QVariant /*value*/)
 {
    QString propName = prop.name();
+   Instruction* ins = qobject_cast<Instruction*>(sender());
    
    if( propName == "instructionNumber" )
    {
-      // The order changed, so resort our internal list.
+      // The order changed, so resort our internal list. The fragments
+      // themselves are still good.
       qSort( recIns.begin(), recIns.end(), insPtrLtByNumber );
       showChanges();
    }
-   else if( propName == "directions" )
+   else
+   {
+      if( propName == "directions" )
+      {
+         // This will make the displayed text directions update.
+         listWidget->setCurrentRow( listWidget->currentRow() );
+      }
+      else if( propName == "name" && ins )
+      {
+         int row = recIns.indexOf(ins);
+         if( row >= 0 && row < listWidget->count() )
+            listWidget->item(row)->setText( tr("Step %1: %2").arg(ins->instructionNumber()).arg(ins->name()) );
+      }
+      
+      // Only this one instruction needs to be rendered again.
+      insFragments.remove(ins);
+   }
+   
+   scheduleRender();
+}
+
+void BrewDayScrollWidget::pruneFragments()
+{
+   QSet<Instruction*> current = recIns.toSet();
+   
+   foreach( Instruction* ins, insFragments.keys() )
    {
-      // This will make the displayed text directions update.
-      listWidget->setCurrentRow( listWidget->currentRow() );
+      if( !current.contains(ins) )
+      {
+         insFragments.remove(ins);
+         recipeDependentFragments.remove(ins);
+      }
    }
 }
 
+void BrewDayScrollWidget::scheduleRender()
+{
+   // Anything already assembled is now out of date.
+   ++renderGeneration;
+   renderTimer.start();
+}
+
+void BrewDayScrollWidget::renderInstructionTable()
+{
+   if( recObs == 0 )
+      return;
+   
+   // The fragments need the database, so render them here. Joining them up
+   // can happen elsewhere.
+   renderPool.start( new InstructionTableJob(this, instructionTableHeader(), instructionFragments(), renderGeneration) );
+}
+
+void BrewDayScrollWidget::acceptInstructionTable(QString table, int generation)
+{
+   // Drop results that were overtaken by newer changes.
+   if( generation != renderGeneration )
+      return;
+   
+   instructionTable = table;
+   tableGeneration = generation;
+}
+
 void BrewDayScrollWidget::clear()
 {
    listWidget->clear();
@@ -378,74 +564,98 @@ QString BrewDayScrollWidget::buildTitleTable(bool includeImage)
 
 }
 
-QString BrewDayScrollWidget::buildInstructionTable()
+QString BrewDayScrollWidget::instructionTableHeader()
 {
-   QString middle;
-   int i, j, size;
+   QString header;
 
-   middle += QString("<h2>%1</h2>").arg(tr("Instructions"));
-   middle += QString("<table id=\"steps\">");
-   middle += QString("<tr><th class=\"check\">%1</th><th class=\"time\">%2</th><th class=\"step\">%3</th></tr>")
+   header += QString("<h2>%1</h2>").arg(tr("Instructions"));
+   header += QString("<table id=\"steps\">");
+   header += QString("<tr><th class=\"check\">%1</th><th class=\"time\">%2</th><th class=\"step\">%3</th></tr>")
          .arg(tr("Completed"))
          .arg(tr("Time"))
          .arg(tr("Step"));
 
-   QList<Instruction*> instructions = recObs->instructions();
-   QList<MashStep*> mashSteps = recObs->mash()->mashSteps();
-   size = instructions.size();
-   for( i = 0; i < size; ++i )
-   {
-      QString stepTime, tmp;
-      QList<QString> reagents;
-      
-      Instruction* ins = instructions[i];
+   return header;
+}
 
-      if (ins->interval())
-         stepTime = Brewtarget::displayAmount(ins->interval(), Units::minutes, 0);
-      else
-         stepTime = "--";
+QString BrewDayScrollWidget::buildInstructionFragment(Instruction* ins)
+{
+   QString stepTime, tmp;
+   QList<QString> reagents;
+   int j;
 
-      tmp = "";
+   if (ins->interval())
+      stepTime = Brewtarget::displayAmount(ins->interval(), Units::minutes, 0);
+   else
+      stepTime = "--";
 
-      // TODO: comparing ins->name() with these untranslated strings means this
-      // doesn't work in other languages. Find a better way.
-      if ( ins->name() == tr("Add grains") )
-         reagents = recObs->getReagents( recObs->fermentables() );
-      else if ( ins->name() == tr("Heat water") )
-         reagents = recObs->getReagents( recObs->mash()->mashSteps() );
-      else 
-         reagents = ins->reagents();
+   tmp = "";
 
-      if ( reagents.size() > 1 )
-      {
-         tmp = QString("<ul>");
-         for ( j = 0; j < reagents.size(); j++ )
-         {
-            tmp += QString("<li>%1</li>")
-                   .arg(reagents.at(j));
-         }
-         tmp += QString("</ul>");
-      }
-      else if ( reagents.size() == 1 )
-      {
-         tmp = reagents.at(0);
-      }
-      else
+   // TODO: comparing ins->name() with these untranslated strings means this
+   // doesn't work in other languages. Find a better way.
+   if ( ins->name() == tr("Add grains") )
+   {
+      reagents = recObs->getReagents( recObs->fermentables() );
+      recipeDependentFragments.insert(ins);
+   }
+   else if ( ins->name() == tr("Heat water") )
+   {
+      reagents = recObs->getReagents( recObs->mash()->mashSteps() );
+      recipeDependentFragments.insert(ins);
+   }
+   else 
+      reagents = ins->reagents();
+
+   if ( reagents.size() > 1 )
+   {
+      tmp = QString("<ul>");
+      for ( j = 0; j < reagents.size(); j++ )
       {
-         tmp = ins->directions();
+         tmp += QString("<li>%1</li>")
+                .arg(reagents.at(j));
       }
+      tmp += QString("</ul>");
+   }
+   else if ( reagents.size() == 1 )
+   {
+      tmp = reagents.at(0);
+   }
+   else
+   {
+      tmp = ins->directions();
+   }
+
+   return QString("<td class=\"check\"></td><td class=\"time\">%1</td><td align=\"step\">%2 : %3</td>")
+            .arg(stepTime)
+            .arg(ins->name())
+            .arg(tmp);
+}
 
-      QString altTag = i % 2 ? "alt" : "norm";
+QList<QString> BrewDayScrollWidget::instructionFragments()
+{
+   QList<QString> ret;
 
-      middle += QString("<tr class=\"%1\"><td class=\"check\"></td><td class=\"time\">%2</td><td align=\"step\">%3 : %4</td></tr>")
-               .arg(altTag)
-               .arg(stepTime)
-               .arg(ins->name())
-               .arg(tmp);
+   // Every fragment shows at least its time in the user's units.
+   if( fragmentsOptionsVersion != Brewtarget::optionsVersion() )
+   {
+      insFragments.clear();
+      recipeDependentFragments.clear();
+      fragmentsOptionsVersion = Brewtarget::optionsVersion();
    }
-   middle += "</table>";
 
-   return middle;
+   foreach( Instruction* ins, recIns )
+   {
+      if( !insFragments.contains(ins) )
+         insFragments.insert(ins, buildInstructionFragment(ins));
+      ret.append(insFragments.value(ins));
+   }
+
+   return ret;
+}
+
+QString BrewDayScrollWidget::buildInstructionTable()
+{
+   return assembleInstructionTable( instructionTableHeader(), instructionFragments() );
 }
 
 QString BrewDayScrollWidget::buildFooterTable()
@@ -31,6 +31,10 @@ class BrewDayScrollWidget;
 #include <QPrinter>
 #include <QPrintDialog>
 #include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QThreadPool>
 #include "recipe.h"
 
 /*!
@@ -46,7 +50,7 @@ public:
    enum { PRINT, PREVIEW, HTML, NUMACTIONS };
 
    BrewDayScrollWidget(QWidget* parent=0);
-   virtual ~BrewDayScrollWidget() {}
+   virtual ~BrewDayScrollWidget();
    //! \brief Sets the observed recipe.
    void setRecipe(Recipe* rec);
 
@@ -75,6 +79,10 @@ private slots:
    void acceptChanges( QMetaProperty prop, QVariant value );
    //! \brief Receive changes from instructions.
    void acceptInsChanges( QMetaProperty prop, QVariant value );
+   //! \brief Receive changes from the recipe's mash and its steps.
+   void acceptMashChanges();
+   //! \brief The mash got or lost steps, so watch the new list.
+   void acceptMashStepsChanged();
    
 private:
    //! Update the view.
@@ -88,7 +96,28 @@ private:
    QString buildFooterTable();
    QString getCSS();
    
+   /*!
+    * \brief Render the table cells for one instruction. Reads the database,
+    * so only call from the GUI thread.
+    */
+   QString buildInstructionFragment(Instruction* ins);
+   //! \brief Render any stale fragments. \returns them all, in step order.
+   QList<QString> instructionFragments();
+   //! \brief Header row of the instruction table.
+   QString instructionTableHeader();
+   //! \brief Forget the fragments of instructions we no longer display.
+   void pruneFragments();
+   //! \brief Forget the fragments that list the recipe's ingredients. \returns false if there were none.
+   bool dropRecipeDependentFragments();
+   //! \brief Watch the recipe's current mash and its steps, and stop watching the old ones.
+   void watchMash();
+   //! \brief Coalesce changes and re-render the instruction table soon.
+   void scheduleRender();
+   
    Recipe* recObs;
+   //! The mash of recObs, and its steps, as last connected by watchMash().
+   Mash* mashObs;
+   QList<MashStep*> mashStepsObs;
    QPrinter* printer;
    QWebView* doc;
    //! Internal list of recipe instructions, always sorted by instruction number.
@@ -96,10 +125,28 @@ private:
 
    QString cssName;
 
+   //! Cached table cells for each instruction. Missing entries are stale.
+   QHash<Instruction*,QString> insFragments;
+   //! Fragments that also depend on the recipe's ingredients (e.g. "Add grains").
+   QSet<Instruction*> recipeDependentFragments;
+   //! Brewtarget::optionsVersion() when insFragments were rendered, since they show units.
+   unsigned int fragmentsOptionsVersion;
+   //! Last assembled instruction table, valid when tableGeneration == renderGeneration.
+   QString instructionTable;
+   int renderGeneration;
+   int tableGeneration;
+   QTimer renderTimer;
+   //! Single thread that assembles the instruction table.
+   QThreadPool renderPool;
+
 private slots:
    bool loadComplete(bool ok);
    void showInstruction(int insNdx);
    void saveInstruction();
+   //! \brief Refresh stale fragments and assemble the table in the background.
+   void renderInstructionTable();
+   //! \brief Receive an assembled table from renderPool.
+   void acceptInstructionTable(QString table, int generation);
 };
 
 #endif  /* _BREWDAYSCROLLWIDGET_H */
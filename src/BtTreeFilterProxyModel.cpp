@@ -18,11 +18,39 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <QDebug>
+#include <QRegExp>
+#include <QStringList>
+#include <cmath>
 
 #include "brewtarget.h"
 #include "BtTreeFilterProxyModel.h"
 #include "BtTreeModel.h"
 #include "BtTreeItem.h"
+#include "unit.h"
+#include "UnitSystem.h"
+
+namespace
+{
+   //! \returns the stored statistic of \c rec shown in \c column.
+   double storedStat( Recipe* rec, int column )
+   {
+      Recipe::StoredStats const& stats = rec->storedStats();
+      switch( column )
+      {
+         case BtTreeItem::RECIPEOGCOL:
+            return stats.og;
+         case BtTreeItem::RECIPEFGCOL:
+            return stats.fg;
+         case BtTreeItem::RECIPEIBUCOL:
+            return stats.IBU;
+         case BtTreeItem::RECIPECOLORCOL:
+            return stats.color_srm;
+         case BtTreeItem::RECIPEABVCOL:
+            return stats.ABV_pct;
+      }
+      return 0.0;
+   }
+}
 
 BtTreeFilterProxyModel::BtTreeFilterProxyModel(QObject *parent,BtTreeModel::TypeMasks mask ) 
 : QSortFilterProxyModel(parent),
@@ -102,6 +130,12 @@ bool BtTreeFilterProxyModel::lessThanRecipe(BtTreeModel* model, const QModelInde
             return false;
          else
             return leftRecipe->style()->name() < rightRecipe->style()->name();
+      case BtTreeItem::RECIPEOGCOL:
+      case BtTreeItem::RECIPEFGCOL:
+      case BtTreeItem::RECIPEIBUCOL:
+      case BtTreeItem::RECIPECOLORCOL:
+      case BtTreeItem::RECIPEABVCOL:
+         return storedStat(leftRecipe, left.column()) < storedStat(rightRecipe, left.column());
    }
    // Default will be to just do a name sort. This doesn't likely make sense,
    // but it will prevent a lot of warnings.
@@ -366,7 +400,90 @@ bool BtTreeFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex
       return true;
 
    BeerXMLElement* thing = model->thing(child);
+   if ( ! thing->display() )
+      return false;
+
+   Recipe* rec = qobject_cast<Recipe*>(thing);
+   if ( rec && ! statConditions.isEmpty() )
+   {
+      // Recipes that were never calculated have nothing to compare.
+      if ( rec->storedStats().calcStamp == 0 )
+         return false;
+
+      foreach( StatCondition const& cond, statConditions )
+      {
+         double val = storedStat(rec, cond.column);
+         if ( val < cond.min || val > cond.max ||
+              (cond.strictMin && val == cond.min) || (cond.strictMax && val == cond.max) )
+            return false;
+      }
+   }
+
+   return true;
 
-   return thing->display();
+}
+
+bool BtTreeFilterProxyModel::setStatFilter(QString const& text)
+{
+   QRegExp termExp("(og|fg|ibu|color|srm|ebc|abv)(<=|>=|<|>|=)([0-9]*\\.?[0-9]+)", Qt::CaseInsensitive);
+   QList<StatCondition> conds;
+   // The tree shows gravity and color in the user's units, so read them that way too.
+   Unit* densityUnit = Brewtarget::findUnitSystem(Units::sp_grav, Unit::noUnit)->unit();
+   Unit* colorUnit = Brewtarget::findUnitSystem(Units::srm, Unit::noUnit)->unit();
+
+   foreach( QString const& term, text.split(QRegExp("\\s+"), QString::SkipEmptyParts) )
+   {
+      StatCondition cond;
+      QString stat, op;
+      double val;
+
+      if ( ! termExp.exactMatch(term) )
+         return false;
+
+      stat = termExp.cap(1).toLower();
+      op = termExp.cap(2);
+      val = termExp.cap(3).toDouble();
+
+      if ( stat == "og" || stat == "fg" )
+      {
+         cond.column = stat == "og" ? BtTreeItem::RECIPEOGCOL : BtTreeItem::RECIPEFGCOL;
+         val = densityUnit->toSI(val);
+      }
+      else if ( stat == "ibu" )
+         cond.column = BtTreeItem::RECIPEIBUCOL;
+      else if ( stat == "abv" )
+         cond.column = BtTreeItem::RECIPEABVCOL;
+      else
+      {
+         cond.column = BtTreeItem::RECIPECOLORCOL;
+         if ( stat == "srm" )
+            val = Units::srm->toSI(val);
+         else if ( stat == "ebc" )
+            val = Units::ebc->toSI(val);
+         else
+            val = colorUnit->toSI(val);
+      }
+
+      cond.min = -HUGE_VAL;
+      cond.max = HUGE_VAL;
+      cond.strictMin = cond.strictMax = false;
+      if ( op.startsWith('<') )
+      {
+         cond.max = val;
+         cond.strictMax = (op == "<");
+      }
+      else if ( op.startsWith('>') )
+      {
+         cond.min = val;
+         cond.strictMin = (op == ">");
+      }
+      else
+         cond.min = cond.max = val;
+
+      conds.append(cond);
+   }
 
+   statConditions = conds;
+   invalidateFilter();
+   return true;
 }
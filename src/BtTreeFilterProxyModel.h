@@ -24,6 +24,8 @@
 class BtTreeFilterProxyModel;
 
 #include <QSortFilterProxyModel>
+#include <QList>
+#include <QString>
 
 #include "BtFolder.h"
 #include "BtTreeModel.h"
@@ -51,12 +53,33 @@ class BtTreeFilterProxyModel : public QSortFilterProxyModel
 public:
    BtTreeFilterProxyModel(QObject *parent, BtTreeModel::TypeMasks mask);
 
+   /*!
+    * \brief Only show the recipes whose stored statistics match every term
+    * of \c text, like "abv>=5 ibu<40 color<10". The stats are og, fg, ibu,
+    * color and abv. Gravity and color are read in the user's units, like the
+    * tree shows them; srm or ebc in place of color name the scale outright.
+    * An empty \c text shows every recipe again.
+    * \returns false, and leaves the filter alone, if \c text does not parse.
+    */
+   bool setStatFilter(QString const& text);
+
 protected:
    bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
    bool filterAcceptsRow( int source_row, const QModelIndex &source_parent) const;
 
 private:
+   //! \brief One term of \b setStatFilter(), as a range of one column.
+   struct StatCondition
+   {
+      int column;
+      double min;
+      double max;
+      bool strictMin;
+      bool strictMax;
+   };
+
    BtTreeModel::TypeMasks treeMask;
+   QList<StatCondition> statConditions;
 
    bool lessThanRecipe(BtTreeModel* model,const QModelIndex &left, const QModelIndex &right) const;
    bool lessThanEquip(BtTreeModel* model,const QModelIndex &left, const QModelIndex &right) const;
@@ -38,6 +38,7 @@
 #include "yeast.h"
 #include "style.h"
 #include "BtFolder.h"
+#include "unit.h"
 
 bool operator==(BtTreeItem& lhs, BtTreeItem& rhs)
 {
@@ -209,6 +210,28 @@ QVariant BtTreeItem::dataRecipe( int column )
          if ( recipe && recipe->style() )
             return QVariant(recipe->style()->name());
          break;
+        // The statistics are the stored ones, so showing them does not
+        // recalculate the recipe. Blank until it has been calculated once.
+        case RECIPEOGCOL:
+         if ( recipe && recipe->storedStats().calcStamp )
+            return QVariant(Brewtarget::displayAmount(recipe->storedStats().og, Units::sp_grav, 3));
+         break;
+        case RECIPEFGCOL:
+         if ( recipe && recipe->storedStats().calcStamp )
+            return QVariant(Brewtarget::displayAmount(recipe->storedStats().fg, Units::sp_grav, 3));
+         break;
+        case RECIPEIBUCOL:
+         if ( recipe && recipe->storedStats().calcStamp )
+            return QVariant(Brewtarget::displayAmount(recipe->storedStats().IBU, 0, 1));
+         break;
+        case RECIPECOLORCOL:
+         if ( recipe && recipe->storedStats().calcStamp )
+            return QVariant(Brewtarget::displayAmount(recipe->storedStats().color_srm, Units::srm, 1));
+         break;
+        case RECIPEABVCOL:
+         if ( recipe && recipe->storedStats().calcStamp )
+            return QVariant(Brewtarget::displayAmount(recipe->storedStats().ABV_pct, 0, 1));
+         break;
       default :
          Brewtarget::logW( QString("BtTreeItem::dataRecipe Bad column: %1").arg(column));
    }
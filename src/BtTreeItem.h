@@ -71,6 +71,16 @@ public:
       RECIPEBREWDATECOL, 
       //! Recipe style
       RECIPESTYLECOL, 
+      //! Recipe OG, as stored
+      RECIPEOGCOL,
+      //! Recipe FG, as stored
+      RECIPEFGCOL,
+      //! Recipe IBU, as stored
+      RECIPEIBUCOL,
+      //! Recipe color, as stored
+      RECIPECOLORCOL,
+      //! Recipe ABV, as stored
+      RECIPEABVCOL,
       //! the number of columns available for recipes
       RECIPENUMCOLS 
    };
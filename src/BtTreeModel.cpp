@@ -25,6 +25,7 @@
 #include <QObject>
 #include <QStringBuilder>
 #include <QMimeData>
+#include <QMap>
 
 #include "brewtarget.h"
 #include "BtTreeItem.h"
@@ -57,52 +58,44 @@ BtTreeModel::BtTreeModel(BtTreeView *parent, TypeMasks type)
       case RECIPEMASK:
          rootItem->insertChildren(items,1,BtTreeItem::RECIPE);
          connect( &(Database::instance()), SIGNAL(newRecipeSignal(Recipe*)),this, SLOT(elementAdded(Recipe*)));
-         connect( &(Database::instance()), SIGNAL(deletedRecipeSignal(Recipe*)),this, SLOT(elementRemoved(Recipe*)));
          // Brewnotes need love too!
          connect( &(Database::instance()), SIGNAL(newBrewNoteSignal(BrewNote*)),this, SLOT(elementAdded(BrewNote*)));
-         connect( &(Database::instance()), SIGNAL(deletedBrewNoteSignal(BrewNote*)),this, SLOT(elementRemoved(BrewNote*)));
          _type = BtTreeItem::RECIPE;
          _mimeType = "application/x-brewtarget-recipe";
          break;
       case EQUIPMASK:
          rootItem->insertChildren(items,1,BtTreeItem::EQUIPMENT);
          connect( &(Database::instance()), SIGNAL(newEquipmentSignal(Equipment*)),this, SLOT(elementAdded(Equipment*)));
-         connect( &(Database::instance()), SIGNAL(deletedEquipmentSignal(Equipment*)),this, SLOT(elementRemoved(Equipment*)));
          _type = BtTreeItem::EQUIPMENT;
          _mimeType = "application/x-brewtarget-recipe";
          break;
       case FERMENTMASK:
          rootItem->insertChildren(items,1,BtTreeItem::FERMENTABLE);
          connect( &(Database::instance()), SIGNAL(newFermentableSignal(Fermentable*)),this, SLOT(elementAdded(Fermentable*)));
-         connect( &(Database::instance()), SIGNAL(deletedFermentableSignal(Fermentable*)),this, SLOT(elementRemoved(Fermentable*)));
          _type = BtTreeItem::FERMENTABLE;
          _mimeType = "application/x-brewtarget-ingredient";
          break;
       case HOPMASK:
          rootItem->insertChildren(items,1,BtTreeItem::HOP);
          connect( &(Database::instance()), SIGNAL(newHopSignal(Hop*)),this, SLOT(elementAdded(Hop*)));
-         connect( &(Database::instance()), SIGNAL(deletedHopSignal(Hop*)),this, SLOT(elementRemoved(Hop*)));
          _type = BtTreeItem::HOP;
          _mimeType = "application/x-brewtarget-ingredient";
          break;
       case MISCMASK:
          rootItem->insertChildren(items,1,BtTreeItem::MISC);
          connect( &(Database::instance()), SIGNAL(newMiscSignal(Misc*)),this, SLOT(elementAdded(Misc*)));
-         connect( &(Database::instance()), SIGNAL(deletedMiscSignal(Misc*)),this, SLOT(elementRemoved(Misc*)));
          _type = BtTreeItem::MISC;
          _mimeType = "application/x-brewtarget-ingredient";
          break;
       case STYLEMASK:
          rootItem->insertChildren(items,1,BtTreeItem::STYLE);
          connect( &(Database::instance()), SIGNAL(newStyleSignal(Style*)),this, SLOT(elementAdded(Style*)));
-         connect( &(Database::instance()), SIGNAL(deletedStyleSignal(Style*)),this, SLOT(elementRemoved(Style*)));
          _type = BtTreeItem::STYLE;
          _mimeType = "application/x-brewtarget-recipe";
          break;
       case YEASTMASK:
          rootItem->insertChildren(items,1,BtTreeItem::YEAST);
          connect( &(Database::instance()), SIGNAL(newYeastSignal(Yeast*)),this, SLOT(elementAdded(Yeast*)));
-         connect( &(Database::instance()), SIGNAL(deletedYeastSignal(Yeast*)),this, SLOT(elementRemoved(Yeast*)));
          _type = BtTreeItem::YEAST;
          _mimeType = "application/x-brewtarget-ingredient";
          break;
@@ -110,8 +103,13 @@ BtTreeModel::BtTreeModel(BtTreeView *parent, TypeMasks type)
          Brewtarget::logW(QString("Invalid treemask: %1").arg(type));
    }
 
+   // Deletes and moves come in batches, whatever the type.
+   connect( &(Database::instance()), SIGNAL(deletedElementsSignal(QList<BeerXMLElement*>)), this, SLOT(elementsRemoved(QList<BeerXMLElement*>)));
+   connect( &(Database::instance()), SIGNAL(movedElementsSignal(QList<BeerXMLElement*>,QString)), this, SLOT(elementsMoved(QList<BeerXMLElement*>,QString)));
+
    treeMask = type;
    parentTree = parent;
+   toolTipFormatter = new RecipeFormatter(this);
    loadTreeModel();
 }
 
@@ -286,7 +284,7 @@ QVariant BtTreeModel::data(const QModelIndex &index, int role) const
 
 QVariant BtTreeModel::toolTipData(const QModelIndex &index) const
 {
-   RecipeFormatter* whiskey = new RecipeFormatter();
+   RecipeFormatter* whiskey = toolTipFormatter;
 
    switch(treeMask)
    {
@@ -350,6 +348,16 @@ QVariant BtTreeModel::recipeHeader(int section) const
       return QVariant(tr("Brew Date"));
    case BtTreeItem::RECIPESTYLECOL:
       return QVariant(tr("Style"));
+   case BtTreeItem::RECIPEOGCOL:
+      return QVariant(tr("OG"));
+   case BtTreeItem::RECIPEFGCOL:
+      return QVariant(tr("FG"));
+   case BtTreeItem::RECIPEIBUCOL:
+      return QVariant(tr("IBU"));
+   case BtTreeItem::RECIPECOLORCOL:
+      return QVariant(tr("Color"));
+   case BtTreeItem::RECIPEABVCOL:
+      return QVariant(tr("ABV"));
    }
 
    Brewtarget::logW( QString("BtTreeModel::getRecipeHeader Bad column: %1").arg(section));
@@ -920,6 +928,7 @@ void BtTreeModel::copySelected(QList< QPair<QModelIndex, QString> > toBeCopied)
 void BtTreeModel::deleteSelected(QModelIndexList victims)
 {
    QModelIndexList toBeDeleted = victims; // trust me
+   QList<BeerXMLElement*> elements;
 
    while ( ! toBeDeleted.isEmpty() ) 
    {
@@ -927,25 +936,13 @@ void BtTreeModel::deleteSelected(QModelIndexList victims)
       switch ( type(ndx) ) 
       {
          case BtTreeItem::RECIPE:
-            Database::instance().remove( recipe(ndx) );
-            break;
          case BtTreeItem::EQUIPMENT:
-            Database::instance().remove( equipment(ndx) );
-            break;
          case BtTreeItem::FERMENTABLE:
-            Database::instance().remove( fermentable(ndx) );
-            break;
          case BtTreeItem::HOP:
-            Database::instance().remove( hop(ndx) );
-            break;
          case BtTreeItem::MISC:
-            Database::instance().remove( misc(ndx) );
-            break;
          case BtTreeItem::YEAST:
-            Database::instance().remove( yeast(ndx) );
-            break;
          case BtTreeItem::BREWNOTE:
-            Database::instance().remove( brewNote(ndx) );
+            elements.append( thing(ndx) );
             break;
          case BtTreeItem::FOLDER:
             // This one is weird.
@@ -956,6 +953,9 @@ void BtTreeModel::deleteSelected(QModelIndexList victims)
             Brewtarget::logW(QString("deleteSelected:: unknown type %1").arg(type(ndx)));
       }
    }
+
+   // All at once, so a big folder is one trip to the database and the tree.
+   Database::instance().deleteElements(elements);
 }
 
 // =========================================================================
@@ -1087,6 +1087,8 @@ bool BtTreeModel::renameFolder(BtFolder* victim, QString newName)
    QPair<QString,BtTreeItem*> f;
    QList<QPair<QString, BtTreeItem*> > folders;
    // This space is important       ^
+   QMap< QString, QList<BeerXMLElement*> > moves;
+   QMap< QString, QList<BeerXMLElement*> >::const_iterator m;
    int i;
 
    if ( ! ndx.isValid() )
@@ -1122,9 +1124,13 @@ bool BtTreeModel::renameFolder(BtFolder* victim, QString newName)
             folders.append(newTarget);
          }
          else // Leafnode
-            next->thing()->setFolder(targetPath);
+            moves[targetPath].append(next->thing());
       }
    }
+
+   for( m = moves.constBegin(); m != moves.constEnd(); ++m )
+      Database::instance().moveToFolder(m.value(), m.key());
+
    // Last thing is to remove the victim. 
    i = start->childNumber();
    return removeRows(i, 1, pInd); 
@@ -1333,34 +1339,100 @@ void BtTreeModel::elementAdded(BeerXMLElement* victim)
    observeElement(victim);
 }
 
-void BtTreeModel::elementRemoved(Recipe* victim)      { elementRemoved(qobject_cast<BeerXMLElement*>(victim)); }
-void BtTreeModel::elementRemoved(Equipment* victim)   { elementRemoved(qobject_cast<BeerXMLElement*>(victim)); }
-void BtTreeModel::elementRemoved(Fermentable* victim) { elementRemoved(qobject_cast<BeerXMLElement*>(victim)); }
-void BtTreeModel::elementRemoved(Hop* victim)         { elementRemoved(qobject_cast<BeerXMLElement*>(victim)); }
-void BtTreeModel::elementRemoved(Misc* victim)        { elementRemoved(qobject_cast<BeerXMLElement*>(victim)); }
-void BtTreeModel::elementRemoved(Style* victim)       { elementRemoved(qobject_cast<BeerXMLElement*>(victim)); }
-void BtTreeModel::elementRemoved(Yeast* victim)       { elementRemoved(qobject_cast<BeerXMLElement*>(victim)); }
-void BtTreeModel::elementRemoved(BrewNote* victim)    { elementRemoved(qobject_cast<BeerXMLElement*>(victim)); }
+void BtTreeModel::elementsRemoved(QList<BeerXMLElement*> victims)
+{
+   QList<BtTreeItem*> found = findElements(victims.toSet());
+   int i;
+
+   // Parents are found before their children and rows in order, so going
+   // backwards never moves a row we have yet to remove.
+   for( i = found.size() - 1; i >= 0; --i )
+   {
+      BtTreeItem* victim = found[i];
+      BtTreeItem* pItem = victim->parent();
 
-void BtTreeModel::elementRemoved(BeerXMLElement* victim)
+      disconnect( victim->thing(), 0, this, 0 );
+      removeRows(victim->childNumber(), 1, createIndex(pItem->childNumber(), 0, pItem));
+   }
+}
+
+void BtTreeModel::elementsMoved(QList<BeerXMLElement*> victims, QString folder)
 {
-   QModelIndex index,pIndex;
+   QList<BtTreeItem*> found = findElements(victims.toSet());
+   QList<BeerXMLElement*> moved;
+   bool expand = true;
+   int i;
 
-   if ( ! victim )
+   if ( found.isEmpty() )
       return;
 
-   index = findElement(victim);
-   if ( ! index.isValid() )
-      return;
+   // Take them all out, the same way elementsRemoved() does...
+   for( i = found.size() - 1; i >= 0; --i )
+   {
+      BtTreeItem* victim = found[i];
+      BtTreeItem* pItem = victim->parent();
 
-   pIndex = parent(index);
-   if ( ! pIndex.isValid() )
-      return;
+      moved.prepend(victim->thing());
+      removeRows(victim->childNumber(), 1, createIndex(pItem->childNumber(), 0, pItem));
+   }
 
-   if ( removeRows(index.row(),1,pIndex) )
-      return;
+   // ...then put them in the one folder.
+   QModelIndex newNdx = findFolder(folder, rootItem->child(0), true);
+   if ( ! newNdx.isValid() )
+   {
+      newNdx = createIndex(0,0,rootItem->child(0));
+      expand = false;
+   }
 
-   disconnect( victim, 0, this, 0 );
+   BtTreeItem* local = item(newNdx);
+   foreach( BeerXMLElement* elem, moved )
+   {
+      int j = local->childCount();
+
+      if ( ! insertRow(j,newNdx,elem,_type) )
+      {
+         Brewtarget::logW("elementsMoved:: could not insert row");
+         continue;
+      }
+      if ( treeMask & RECIPEMASK )
+         addBrewNoteSubTree(qobject_cast<Recipe*>(elem),j,local);
+   }
+
+   if ( expand )
+      emit expandFolder(treeMask,newNdx);
+}
+
+QList<BtTreeItem*> BtTreeModel::findElements(QSet<BeerXMLElement*> const& things)
+{
+   QList<BtTreeItem*> found;
+   QList<BtTreeItem*> folders;
+   int i;
+
+   if ( things.isEmpty() )
+      return found;
+
+   folders.append(rootItem->child(0));
+   while ( ! folders.isEmpty() )
+   {
+      BtTreeItem* target = folders.takeFirst();
+      for (i=0; i < target->childCount(); ++i)
+      {
+         BtTreeItem* next = target->child(i);
+
+         // Recipes hold their brewnotes.
+         if ( next->type() == BtTreeItem::FOLDER )
+         {
+            folders.append(next);
+            continue;
+         }
+         if ( next->type() == BtTreeItem::RECIPE )
+            folders.append(next);
+
+         if ( things.contains(next->thing()) )
+            found.append(next);
+      }
+   }
+   return found;
 }
 
 void BtTreeModel::observeElement(BeerXMLElement* d)
@@ -1374,6 +1446,8 @@ void BtTreeModel::observeElement(BeerXMLElement* d)
    {
       connect( d, SIGNAL(changedName(QString)), this, SLOT(elementChanged()) );
       connect( d, SIGNAL(changedFolder(QString)), this, SLOT(folderChanged(QString)));
+      if ( qobject_cast<Recipe*>(d) )
+         connect( d, SIGNAL(changedStoredStats()), this, SLOT(elementChanged()) );
    }
 }
 
@@ -1398,6 +1472,7 @@ bool BtTreeModel::dropMimeData(const QMimeData* data, Qt::DropAction action,
    QDataStream stream( &encodedData, QIODevice::ReadOnly);
    int oType, id;
    QList<int> droppedIds;
+   QList<BeerXMLElement*> dropped;
    QString target = ""; 
    QString name = "";
 
@@ -1455,7 +1530,7 @@ bool BtTreeModel::dropMimeData(const QMimeData* data, Qt::DropAction action,
       }
 
       if ( oType != BtTreeItem::FOLDER ) 
-         elem->setFolder(target);
+         dropped.append(elem);
       else 
       {
          // I need the actual folder object that got dropped.
@@ -1466,6 +1541,7 @@ bool BtTreeModel::dropMimeData(const QMimeData* data, Qt::DropAction action,
       }
    }
 
+   Database::instance().moveToFolder(dropped, target);
    return true;
 }
 
@@ -25,6 +25,7 @@ class BtTreeModel;
 #include <QModelIndex>
 #include <QVariant>
 #include <QList>
+#include <QSet>
 #include <QAbstractItemModel>
 #include <QMetaProperty>
 #include <QVariant>
@@ -44,6 +45,7 @@ class Hop;
 class Misc;
 class Yeast;
 class Style;
+class RecipeFormatter;
 
 /*!
  * \class BtTreeModel
@@ -204,14 +206,10 @@ private slots:
    
    void elementChanged();
 
-   void elementRemoved(Recipe* victim);
-   void elementRemoved(Equipment* victim);
-   void elementRemoved(Fermentable* victim);
-   void elementRemoved(Hop* victim);
-   void elementRemoved(Misc* victim);
-   void elementRemoved(Style* victim);
-   void elementRemoved(Yeast* victim);
-   void elementRemoved(BrewNote* victim);
+   //! \brief Removes every one of \c victims that is in this tree, in one walk.
+   void elementsRemoved(QList<BeerXMLElement*> victims);
+   //! \brief Moves every one of \c victims that is in this tree to \c folder.
+   void elementsMoved(QList<BeerXMLElement*> victims, QString folder);
 
 signals:
    void expandFolder(BtTreeModel::TypeMasks kindofThing, QModelIndex fIdx);
@@ -220,10 +218,13 @@ private:
    //! \brief Loads the tree. 
    void loadTreeModel();
   
-   //! \brief add and remove an element from the, respectively. All of the
-   //slots actually call these two methods 
+   //! \brief add an element to the tree. All of the elementAdded() slots
+   //actually call this method
    void elementAdded(BeerXMLElement* victim);
-   void elementRemoved(BeerXMLElement* victim);
+
+   //! \brief Finds the items holding any of \c things, parents before
+   //! children and in row order.
+   QList<BtTreeItem*> findElements(QSet<BeerXMLElement*> const& things);
 
    //! \brief connects the changedName() signal and changedFolder() signals to
    //! the proper methods for most things, and the same for changedBrewDate
@@ -262,6 +263,8 @@ private:
 
    BtTreeItem* rootItem;
    BtTreeView *parentTree;
+   //! Builds (and caches) our tooltips.
+   RecipeFormatter* toolTipFormatter;
    TypeMasks treeMask;
    int _type;
    QString _mimeType;
@@ -26,6 +26,7 @@
 #include <QMessageBox>
 #include <QMimeData>
 #include <QInputDialog>
+#include <QLineEdit>
 
 #include "BtTreeView.h"
 #include "BtTreeModel.h"
@@ -349,6 +350,9 @@ void BtTreeView::setupContextMenu(QWidget* top, QWidget* editor)
          subMenu->addAction(tr("Recalculate eff"), top, SLOT(fixBrewNote()));
          subMenu->addAction(tr("Delete"), top, SLOT(deleteSelected()));
 
+         _contextMenu->addAction(tr("Filter..."), this, SLOT(filterByStats()));
+         _contextMenu->addSeparator();
+
          break;
       case BtTreeModel::EQUIPMASK:
          _newMenu->addAction(tr("Equipment"), editor, SLOT(newEquipment()));
@@ -377,6 +381,9 @@ void BtTreeView::setupContextMenu(QWidget* top, QWidget* editor)
    _contextMenu->addAction(tr("Copy"), top, SLOT(copySelected()));
    // Delete
    _contextMenu->addAction(tr("Delete"), top, SLOT(deleteSelected()));
+   // Similar recipes
+   if ( _type == BtTreeModel::RECIPEMASK )
+      _contextMenu->addAction(tr("Similar Recipes..."), top, SLOT(showSimilarRecipes()));
    // export and import
    _contextMenu->addSeparator();
    _contextMenu->addAction(tr("Export"), top, SLOT(exportSelected()));
@@ -563,6 +570,26 @@ void BtTreeView::expandFolder(BtTreeModel::TypeMasks kindaThing, QModelIndex fId
    if ( kindaThing & _type && fIdx.isValid() && ! isExpanded(filter->mapFromSource(fIdx) ))
       setExpanded(filter->mapFromSource(fIdx),true);
 }
+void BtTreeView::filterByStats()
+{
+   bool ok = false;
+   QString text = QInputDialog::getText( this,
+                                         tr("Filter Recipes"),
+                                         tr("Show recipes with, for example, \"abv>=5 ibu<40 color<10\".\nGravity is in %1 and color in %2, as in the tree.\nLeave it empty to show them all.")
+                                            .arg(Brewtarget::getDensityUnit() == Unit::displayPlato ? tr("Plato") : tr("SG"))
+                                            .arg(Brewtarget::colorUnitName(Unit::noUnit)),
+                                         QLineEdit::Normal,
+                                         statFilter,
+                                         &ok );
+   if ( ! ok )
+      return;
+
+   if ( filter->setStatFilter(text) )
+      statFilter = text.trimmed();
+   else
+      QMessageBox::warning( this, tr("Filter Recipes"), tr("Could not understand \"%1\".").arg(text) );
+}
+
 // Bad form likely
 
 RecipeTreeView::RecipeTreeView(QWidget *parent)
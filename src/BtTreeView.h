@@ -130,6 +130,8 @@ public:
 
 private slots:
    void expandFolder(BtTreeModel::TypeMasks kindaThing, QModelIndex fIdx);
+   //! \brief Ask for the stats to show recipes by, like "abv>5 ibu<40".
+   void filterByStats();
 
 private:
    BtTreeModel* _model;
@@ -137,6 +139,7 @@ private:
    BtTreeModel::TypeMasks _type;
    QMenu* _contextMenu, *subMenu;
    QPoint dragStart;
+   QString statFilter;
 
    bool doubleClick;
 
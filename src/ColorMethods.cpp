@@ -19,7 +19,6 @@
 
 #include "ColorMethods.h"
 #include "brewtarget.h"
-#include <cmath>
 #include <QString>
 #include <QObject>
 
@@ -32,35 +31,22 @@ ColorMethods::~ColorMethods()
 }
 
 double ColorMethods::mcuToSrm(double mcu)
+{
+   return BrewCalc::mcuToSrm(formula(), mcu);
+}
+
+BrewCalc::ColorFormula ColorMethods::formula()
 {
    switch( Brewtarget::colorFormula )
    {
       case Brewtarget::MOREY:
-         return morey(mcu);
+         return BrewCalc::Morey;
       case Brewtarget::DANIEL:
-         return daniel(mcu);
+         return BrewCalc::Daniel;
       case Brewtarget::MOSHER:
-         return mosher(mcu);
+         return BrewCalc::Mosher;
       default:
          Brewtarget::logE(QObject::tr("Invalid color formula type: %1").arg(Brewtarget::colorFormula) );
-         return morey(mcu);
+         return BrewCalc::Morey;
    }
 }
-
-// I don't know where this is from.
-double ColorMethods::morey(double mcu)
-{
-   return 1.4922 * pow( mcu, 0.6859 );
-}
-
-// From Palmer's "How to Brew"
-double ColorMethods::daniel(double mcu)
-{
-   return 0.2 * mcu + 8.4;
-}
-
-// From Palmer's "How to Brew"
-double ColorMethods::mosher(double mcu)
-{
-   return 0.3 * mcu + 4.7;
-}
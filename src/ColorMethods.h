@@ -22,6 +22,8 @@
 
 class ColorMethods;
 
+#include "BrewCalc.h"
+
 /*!
  * \class ColorMethods
  * \author Philip G. Lee
@@ -36,10 +38,8 @@ public:
 
    //! Depending on selected algorithm, convert malt color units to SRM.
    static double mcuToSrm(double mcu);
-private:
-   static double morey(double mcu);
-   static double daniel(double mcu);
-   static double mosher(double mcu);
+   //! The selected algorithm, for \c BrewCalc.
+   static BrewCalc::ColorFormula formula();
 };
 
 #endif
@@ -0,0 +1,589 @@
+/*
+ * DatabaseGenerator.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseGenerator.h"
+#include "database.h"
+#include "brewtarget.h"
+#include <QDate>
+#include <QSqlError>
+
+namespace
+{
+   char const* const connectionName = "generator";
+
+   // Made-up but plausible ingredients: name, type, yield, color.
+   struct FermSeed { char const* name; char const* type; double yield; double color; };
+   FermSeed const fermSeeds[] = {
+      { "Pale Malt", "Grain", 80.0, 3.0 },
+      { "Pilsner Malt", "Grain", 81.0, 1.6 },
+      { "Munich Malt", "Grain", 80.0, 9.0 },
+      { "Vienna Malt", "Grain", 78.0, 3.5 },
+      { "Wheat Malt", "Grain", 84.0, 2.0 },
+      { "Crystal 40", "Grain", 74.0, 40.0 },
+      { "Crystal 120", "Grain", 72.0, 120.0 },
+      { "Chocolate Malt", "Grain", 60.0, 350.0 },
+      { "Roasted Barley", "Grain", 55.0, 300.0 },
+      { "Flaked Oats", "Adjunct", 70.0, 1.0 },
+      { "Corn Sugar", "Sugar", 100.0, 0.0 },
+      { "Light DME", "Dry Extract", 95.0, 4.0 }
+   };
+   int const numFermSeeds = sizeof(fermSeeds)/sizeof(FermSeed);
+
+   char const* const hopSeeds[] = {
+      "Cascade", "Centennial", "Chinook", "Citra", "Fuggle", "Hallertau",
+      "Magnum", "Saaz", "Simcoe", "Tettnang", "Willamette", "Northern Brewer"
+   };
+   int const numHopSeeds = sizeof(hopSeeds)/sizeof(char const*);
+
+   char const* const hopUses[] = { "Boil", "Boil", "Boil", "Aroma", "First Wort", "Dry Hop" };
+   int const numHopUses = sizeof(hopUses)/sizeof(char const*);
+
+   char const* const yeastSeeds[] = {
+      "American Ale", "English Ale", "German Lager", "Belgian Ale", "Hefeweizen", "Kolsch"
+   };
+   int const numYeastSeeds = sizeof(yeastSeeds)/sizeof(char const*);
+
+   // name, type, use
+   struct MiscSeed { char const* name; char const* type; char const* use; };
+   MiscSeed const miscSeeds[] = {
+      { "Irish Moss", "Fining", "Boil" },
+      { "Whirlfloc", "Fining", "Boil" },
+      { "Gypsum", "Water Agent", "Mash" },
+      { "Calcium Chloride", "Water Agent", "Mash" },
+      { "Yeast Nutrient", "Other", "Boil" },
+      { "Coriander", "Spice", "Boil" }
+   };
+   int const numMiscSeeds = sizeof(miscSeeds)/sizeof(MiscSeed);
+
+   // Mash profiles: name, then up to three steps of temperature (C) and
+   // time (min). A zero time ends the profile.
+   struct MashSeed { char const* name; double temp[3]; double time[3]; };
+   MashSeed const mashSeeds[] = {
+      { "Single Infusion, Medium Body", { 67.0, 0.0, 0.0 }, { 60.0, 0.0, 0.0 } },
+      { "Single Infusion, Light Body", { 64.0, 0.0, 0.0 }, { 75.0, 0.0, 0.0 } },
+      { "Single Infusion, Full Body", { 69.0, 0.0, 0.0 }, { 45.0, 0.0, 0.0 } },
+      { "Infusion with Mash Out", { 67.0, 76.0, 0.0 }, { 60.0, 10.0, 0.0 } },
+      { "Protein Rest, Mash Out", { 52.0, 66.0, 76.0 }, { 15.0, 60.0, 10.0 } }
+   };
+   int const numMashSeeds = sizeof(mashSeeds)/sizeof(MashSeed);
+
+   char const* const stepNames[] = { "Saccharification", "Mash Out", "Final" };
+}
+
+DatabaseGenerator::DatabaseGenerator( int recipes, uint seed )
+   : _recipes(recipes),
+     _ingredients(0),
+     _mashes(numMashSeeds),
+     _brewNotes(-1),
+     _folders(10),
+     _inventory_pct(50.0),
+     _seed(seed)
+{
+}
+
+void DatabaseGenerator::setIngredients( int count )
+{
+   _ingredients = qMax(0, count);
+}
+
+void DatabaseGenerator::setMashes( int count )
+{
+   _mashes = qMax(0, count);
+}
+
+void DatabaseGenerator::setBrewNotes( int count )
+{
+   _brewNotes = count;
+}
+
+void DatabaseGenerator::setFolders( int count )
+{
+   _folders = qMax(0, count);
+}
+
+void DatabaseGenerator::setInventory_pct( double pct )
+{
+   _inventory_pct = qBound(0.0, pct, 100.0);
+}
+
+bool DatabaseGenerator::generate( QString const& fileName )
+{
+   bool ret = true;
+   int i, n;
+
+   if( !Database::createBlank(fileName) )
+      return false;
+
+   {
+      _db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+      _db.setDatabaseName(fileName);
+      if( !_db.open() )
+      {
+         Brewtarget::logW(QString("DatabaseGenerator: could not open '%1'").arg(fileName));
+         _db = QSqlDatabase();
+         QSqlDatabase::removeDatabase(connectionName);
+         return false;
+      }
+
+      // Nobody else has this file yet, so do not wait on the disk.
+      QSqlQuery("PRAGMA synchronous = off", _db);
+      _db.transaction();
+
+      // Unless told otherwise, roughly one new ingredient for every 20
+      // recipes, like a brewery that keeps adding to its shelves.
+      ret &= makeEquipment();
+      ret &= makeFermentables( _ingredients > 0 ? _ingredients : qMax(numFermSeeds, _recipes/20) );
+      ret &= makeHops( _ingredients > 0 ? _ingredients : qMax(numHopSeeds, _recipes/20) );
+      ret &= makeMiscs( _ingredients > 0 ? _ingredients : qMax(numMiscSeeds, _recipes/50) );
+      ret &= makeYeasts( _ingredients > 0 ? _ingredients : qMax(numYeastSeeds, _recipes/50) );
+      ret &= makeMashes( _mashes );
+
+      ret &= makeInventory( "fermentable", _fermentables );
+      ret &= makeInventory( "hop", _hops );
+      ret &= makeInventory( "misc", _miscs );
+      ret &= makeInventory( "yeast", _yeasts );
+
+      for( i = 0; ret && i < _recipes; ++i )
+         ret &= makeRecipe(i);
+
+      // Brew notes go to random recipes, so some get several and some none.
+      n = _brewNotes < 0 ? _recipes/2 : _brewNotes;
+      for( i = 0; ret && !_recipeKeys.isEmpty() && i < n; ++i )
+         ret &= makeBrewNote( _recipeKeys.at(randInt(0, _recipeKeys.size()-1)), i );
+
+      if( ret )
+         ret &= _db.commit();
+      else
+         _db.rollback();
+
+      _queries.clear();
+      _recipeKeys.clear();
+      _db.close();
+      _db = QSqlDatabase();
+   } // All queries are gone before removeDatabase().
+
+   QSqlDatabase::removeDatabase(connectionName);
+
+   if( !ret )
+      Brewtarget::logW(QString("DatabaseGenerator: could not fill '%1'").arg(fileName));
+
+   return ret;
+}
+
+int DatabaseGenerator::insert( QString const& table, QHash<QString,QVariant> const& values )
+{
+   QStringList cols = values.keys();
+   QString sql;
+   int i;
+
+   // Sort so the same columns always give the same statement.
+   cols.sort();
+   sql = QString("INSERT INTO `%1` (`%2`) VALUES (%3)")
+         .arg(table)
+         .arg(cols.join("`,`"))
+         .arg(QString("?,").repeated(cols.size()).left(2*cols.size()-1));
+
+   if( !_queries.contains(sql) )
+   {
+      QSqlQuery q(_db);
+      if( !q.prepare(sql) )
+      {
+         Brewtarget::logW(QString("DatabaseGenerator: %1").arg(q.lastError().text()));
+         return -1;
+      }
+      _queries.insert(sql, q);
+   }
+
+   QSqlQuery& q = _queries[sql];
+   for( i = 0; i < cols.size(); ++i )
+      q.bindValue(i, values.value(cols[i]));
+
+   if( !q.exec() )
+   {
+      Brewtarget::logW(QString("DatabaseGenerator: %1").arg(q.lastError().text()));
+      return -1;
+   }
+
+   return q.lastInsertId().toInt();
+}
+
+int DatabaseGenerator::insertChild( QString const& table, Parent const& parent, QHash<QString,QVariant> const& values )
+{
+   QHash<QString,QVariant> childValues = parent.values;
+   QHash<QString,QVariant>::const_iterator it;
+   QHash<QString,QVariant> rel;
+   int key;
+
+   for( it = values.constBegin(); it != values.constEnd(); ++it )
+      childValues.insert(it.key(), it.value());
+   childValues.insert("display", 0);
+
+   key = insert(table, childValues);
+   if( key < 0 )
+      return -1;
+
+   rel.insert("parent_id", parent.key);
+   rel.insert("child_id", key);
+   if( insert(QString("%1_children").arg(table), rel) < 0 )
+      return -1;
+
+   return key;
+}
+
+bool DatabaseGenerator::link( QString const& table, int key, int recKey )
+{
+   QHash<QString,QVariant> rel;
+
+   rel.insert(QString("%1_id").arg(table), key);
+   rel.insert("recipe_id", recKey);
+
+   return insert(QString("%1_in_recipe").arg(table), rel) >= 0;
+}
+
+int DatabaseGenerator::randInt( int lo, int hi )
+{
+   // Our own generator, so the same seed gives the same database everywhere.
+   _seed = _seed * 1103515245u + 12345u;
+   return lo + static_cast<int>((_seed >> 16) % static_cast<uint>(hi - lo + 1));
+}
+
+double DatabaseGenerator::randDouble( double lo, double hi )
+{
+   return lo + (hi - lo) * randInt(0, 10000) / 10000.0;
+}
+
+DatabaseGenerator::Parent const& DatabaseGenerator::pick( QList<Parent> const& list )
+{
+   return list.at( randInt(0, list.size()-1) );
+}
+
+bool DatabaseGenerator::makeEquipment()
+{
+   Parent p;
+
+   p.values.insert("name", QString("Generated 20 L system"));
+   p.values.insert("boil_size", 24.0);
+   p.values.insert("batch_size", 20.0);
+   p.values.insert("tun_volume", 40.0);
+   p.values.insert("evap_rate", 15.0);
+   p.values.insert("real_evap_rate", 4.0);
+   p.values.insert("boil_time", 60.0);
+   p.values.insert("lauter_deadspace", 0.5);
+   p.values.insert("trub_chiller_loss", 1.0);
+   p.values.insert("hop_utilization", 100.0);
+   p.values.insert("absorption", 1.085);
+   p.values.insert("boiling_point", 100.0);
+
+   p.key = insert("equipment", p.values);
+   if( p.key < 0 )
+      return false;
+
+   _equipment.append(p);
+   return true;
+}
+
+bool DatabaseGenerator::makeFermentables( int count )
+{
+   int i;
+
+   for( i = 0; i < count; ++i )
+   {
+      FermSeed const& s = fermSeeds[i % numFermSeeds];
+      Parent p;
+
+      p.values.insert("name", i < numFermSeeds ? QString(s.name) : QString("%1 #%2").arg(s.name).arg(i / numFermSeeds + 1));
+      p.values.insert("ftype", QString(s.type));
+      p.values.insert("yield", s.yield);
+      p.values.insert("color", s.color);
+      p.values.insert("moisture", 4.0);
+      p.values.insert("is_mashed", QString(s.type) == "Grain" ? 1 : 0);
+      p.values.insert("amount", 1.0);
+
+      p.key = insert("fermentable", p.values);
+      if( p.key < 0 )
+         return false;
+      _fermentables.append(p);
+   }
+
+   return true;
+}
+
+bool DatabaseGenerator::makeHops( int count )
+{
+   int i;
+
+   for( i = 0; i < count; ++i )
+   {
+      Parent p;
+
+      p.values.insert("name", i < numHopSeeds ? QString(hopSeeds[i]) : QString("%1 #%2").arg(hopSeeds[i % numHopSeeds]).arg(i / numHopSeeds + 1));
+      p.values.insert("alpha", randDouble(3.0, 14.0));
+      p.values.insert("form", QString(randInt(0,1) ? "Pellet" : "Leaf"));
+      p.values.insert("use", QString("Boil"));
+      p.values.insert("time", 60.0);
+      p.values.insert("amount", 0.028);
+
+      p.key = insert("hop", p.values);
+      if( p.key < 0 )
+         return false;
+      _hops.append(p);
+   }
+
+   return true;
+}
+
+bool DatabaseGenerator::makeMiscs( int count )
+{
+   int i;
+
+   for( i = 0; i < count; ++i )
+   {
+      MiscSeed const& s = miscSeeds[i % numMiscSeeds];
+      Parent p;
+
+      p.values.insert("name", i < numMiscSeeds ? QString(s.name) : QString("%1 #%2").arg(s.name).arg(i / numMiscSeeds + 1));
+      p.values.insert("mtype", QString(s.type));
+      p.values.insert("use", QString(s.use));
+      p.values.insert("time", QString(s.use) == "Boil" ? 15.0 : 60.0);
+      p.values.insert("amount", 0.005);
+      p.values.insert("amount_is_weight", 1);
+
+      p.key = insert("misc", p.values);
+      if( p.key < 0 )
+         return false;
+      _miscs.append(p);
+   }
+
+   return true;
+}
+
+bool DatabaseGenerator::makeYeasts( int count )
+{
+   int i;
+
+   for( i = 0; i < count; ++i )
+   {
+      Parent p;
+
+      p.values.insert("name", i < numYeastSeeds ? QString(yeastSeeds[i]) : QString("%1 #%2").arg(yeastSeeds[i % numYeastSeeds]).arg(i / numYeastSeeds + 1));
+      p.values.insert("ytype", QString(i % numYeastSeeds == 2 ? "Lager" : "Ale"));
+      p.values.insert("form", QString("Liquid"));
+      p.values.insert("attenuation", randDouble(68.0, 82.0));
+      p.values.insert("amount", 0.125);
+
+      p.key = insert("yeast", p.values);
+      if( p.key < 0 )
+         return false;
+      _yeasts.append(p);
+   }
+
+   return true;
+}
+
+bool DatabaseGenerator::makeMashes( int count )
+{
+   int i, j;
+
+   for( i = 0; i < count; ++i )
+   {
+      MashSeed const& s = mashSeeds[i % numMashSeeds];
+      QList< QHash<QString,QVariant> > steps;
+      Parent p;
+
+      p.values.insert("name", i < numMashSeeds ? QString(s.name) : QString("%1 #%2").arg(s.name).arg(i / numMashSeeds + 1));
+      p.values.insert("grain_temp", 20.0);
+      p.values.insert("tun_temp", 20.0);
+      p.values.insert("sparge_temp", 76.0);
+      p.values.insert("ph", 5.4);
+
+      p.key = insert("mash", p.values);
+      if( p.key < 0 )
+         return false;
+
+      for( j = 0; j < 3 && s.time[j] > 0.0; ++j )
+      {
+         QHash<QString,QVariant> step;
+
+         step.insert("name", QString(j == 0 && s.temp[0] < 60.0 ? "Protein Rest" : stepNames[j]));
+         step.insert("mstype", QString(j == 0 ? "Infusion" : "Temperature"));
+         step.insert("infuse_amount", j == 0 ? 15.0 : 0.0);
+         step.insert("step_temp", s.temp[j]);
+         step.insert("end_temp", s.temp[j]);
+         step.insert("step_time", s.time[j]);
+         step.insert("step_number", j);
+         steps.append(step);
+
+         step.insert("mash_id", p.key);
+         if( insert("mashstep", step) < 0 )
+            return false;
+      }
+
+      _mashProfiles.append(p);
+      _mashSteps.append(steps);
+   }
+
+   return true;
+}
+
+bool DatabaseGenerator::makeInventory( QString const& table, QList<Parent> const& parents )
+{
+   QHash<QString,QVariant> values;
+   bool isYeast = (table == "yeast");
+
+   foreach( Parent const& p, parents )
+   {
+      if( randDouble(0.0, 100.0) >= _inventory_pct )
+         continue;
+
+      // Inventory hangs off the parent, so every copy in a recipe sees it.
+      values.clear();
+      values.insert(QString("%1_id").arg(table), p.key);
+      if( isYeast )
+         values.insert("quanta", randInt(1, 4));
+      else
+         values.insert("amount", p.values.value("amount").toDouble() * randDouble(0.5, 20.0));
+
+      if( insert(QString("%1_in_inventory").arg(table), values) < 0 )
+         return false;
+   }
+
+   return true;
+}
+
+bool DatabaseGenerator::makeRecipe( int i )
+{
+   QHash<QString,QVariant> values;
+   QList<int> used;
+   int recKey, key, n, j;
+
+   values.insert("name", QString("Generated Recipe %1").arg(i+1));
+   values.insert("type", QString("All Grain"));
+   values.insert("brewer", QString("Generator"));
+   values.insert("batch_size", 20.0);
+   values.insert("boil_size", 24.0);
+   values.insert("boil_time", 60.0);
+   values.insert("efficiency", randDouble(65.0, 80.0));
+   values.insert("date", QDate(2015,1,1).addDays(i % 365).toString("d/M/yyyy"));
+   if( _folders > 0 )
+      values.insert("folder", QString("/Generated/Folder %1").arg(randInt(1, _folders)));
+
+   // The mash is a copy of a profile, steps and all.
+   if( !_mashProfiles.isEmpty() )
+   {
+      j = randInt(0, _mashProfiles.size()-1);
+      Parent const& profile = _mashProfiles.at(j);
+      QHash<QString,QVariant> mashValues = profile.values;
+
+      mashValues.insert("display", 0);
+      key = insert("mash", mashValues);
+      if( key < 0 )
+         return false;
+
+      foreach( QHash<QString,QVariant> step, _mashSteps.at(j) )
+      {
+         step.insert("mash_id", key);
+         if( insert("mashstep", step) < 0 )
+            return false;
+      }
+      values.insert("mash_id", key);
+   }
+
+   // The equipment is copied into the recipe like any ingredient.
+   values.insert("equipment_id", insertChild("equipment", _equipment.first(), QHash<QString,QVariant>()));
+   recKey = insert("recipe", values);
+   if( recKey < 0 )
+      return false;
+   _recipeKeys.append(recKey);
+
+   // A base malt and a few specialty ones. Never the same parent twice.
+   n = randInt(3, 6);
+   for( j = 0; j < n; ++j )
+   {
+      Parent const& p = pick(_fermentables);
+      if( used.contains(p.key) )
+         continue;
+      used.append(p.key);
+
+      values.clear();
+      values.insert("amount", j == 0 ? randDouble(3.0, 6.0) : randDouble(0.1, 0.8));
+      key = insertChild("fermentable", p, values);
+      if( key < 0 || !link("fermentable", key, recKey) )
+         return false;
+   }
+
+   used.clear();
+   n = randInt(2, 5);
+   for( j = 0; j < n; ++j )
+   {
+      Parent const& p = pick(_hops);
+      if( used.contains(p.key) )
+         continue;
+      used.append(p.key);
+
+      values.clear();
+      values.insert("amount", randDouble(0.01, 0.06));
+      values.insert("use", QString(hopUses[randInt(0, numHopUses-1)]));
+      values.insert("time", static_cast<double>(randInt(0, 6) * 10));
+      key = insertChild("hop", p, values);
+      if( key < 0 || !link("hop", key, recKey) )
+         return false;
+   }
+
+   // Most recipes get a fining or a water agent, some get both.
+   used.clear();
+   n = _miscs.isEmpty() ? 0 : randInt(0, 2);
+   for( j = 0; j < n; ++j )
+   {
+      Parent const& p = pick(_miscs);
+      if( used.contains(p.key) )
+         continue;
+      used.append(p.key);
+
+      key = insertChild("misc", p, QHash<QString,QVariant>());
+      if( key < 0 || !link("misc", key, recKey) )
+         return false;
+   }
+
+   key = insertChild("yeast", pick(_yeasts), QHash<QString,QVariant>());
+   if( key < 0 || !link("yeast", key, recKey) )
+      return false;
+
+   return true;
+}
+
+bool DatabaseGenerator::makeBrewNote( int recKey, int i )
+{
+   QHash<QString,QVariant> values;
+   QDate brewDate = QDate(2015,1,1).addDays(i % 730);
+   double og = randDouble(1.040, 1.075);
+   double fg = 1.0 + (og - 1.0) * randDouble(0.18, 0.30);
+
+   values.insert("recipe_id", recKey);
+   values.insert("brewDate", brewDate.toString(Qt::ISODate));
+   values.insert("fermentDate", brewDate.addDays(1).toString(Qt::ISODate));
+   values.insert("sg", og - randDouble(0.004, 0.010));
+   values.insert("og", og);
+   values.insert("fg", fg);
+   values.insert("abv", (og - fg) * 131.25);
+   values.insert("volume_into_bk", randDouble(23.0, 26.0));
+   values.insert("volume_into_fermenter", randDouble(19.0, 21.0));
+   values.insert("eff_into_bk", randDouble(65.0, 80.0));
+
+   return insert("brewnote", values) >= 0;
+}
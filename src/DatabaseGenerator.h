@@ -0,0 +1,124 @@
+/*
+ * DatabaseGenerator.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DATABASEGENERATOR_H
+#define _DATABASEGENERATOR_H
+
+class DatabaseGenerator;
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QVariant>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+/*!
+ * \class DatabaseGenerator
+ * \author agent
+ *
+ * \brief Fills a new database with made-up recipes, for scaling tests.
+ *
+ * The rows look like what the program writes itself: every ingredient in a
+ * recipe is a hidden copy of a visible parent ingredient, linked through the
+ * *_children tables, and every recipe mash is a copy of a mash profile with
+ * its own steps. Recipes draw their ingredients from small pools, so the
+ * same parents show up in many recipes like they would in a real brewery.
+ * The same counts and seed always give the same database.
+ */
+class DatabaseGenerator
+{
+public:
+   //! \param recipes is how many recipes to make.
+   DatabaseGenerator( int recipes = 1000, uint seed = 1 );
+
+   //! \brief Visible fermentables, hops, miscs and yeasts of each kind. 0 scales with the recipes.
+   void setIngredients( int count );
+   //! \brief Mash profiles that recipe mashes are copied from. 0 means recipes have no mash.
+   void setMashes( int count );
+   //! \brief Brew notes, spread over the recipes. Less than 0 means one for every other recipe.
+   void setBrewNotes( int count );
+   //! \brief Recipe folders. 0 leaves every recipe at the top.
+   void setFolders( int count );
+   //! \brief Percent of the visible ingredients that have something in inventory.
+   void setInventory_pct( double pct );
+
+   /*!
+    * \brief Create \c fileName with the current schema and fill it.
+    * \returns false if the file could not be created or written.
+    */
+   bool generate( QString const& fileName );
+
+private:
+   //! \brief A visible ingredient that recipes get copies of.
+   struct Parent
+   {
+      int key;
+      QHash<QString,QVariant> values;
+   };
+
+   //! \brief Insert a row and \returns its key, or -1 on error.
+   int insert( QString const& table, QHash<QString,QVariant> const& values );
+   //! \brief Insert a hidden copy of \c parent with \c values changed, and link the two.
+   int insertChild( QString const& table, Parent const& parent, QHash<QString,QVariant> const& values );
+   //! \brief Put the ingredient \c key into the recipe \c recKey.
+   bool link( QString const& table, int key, int recKey );
+
+   //! \returns a random integer in [lo, hi].
+   int randInt( int lo, int hi );
+   //! \returns a random double in [lo, hi].
+   double randDouble( double lo, double hi );
+   //! \returns a random element of \c list.
+   Parent const& pick( QList<Parent> const& list );
+
+   bool makeEquipment();
+   bool makeFermentables( int count );
+   bool makeHops( int count );
+   bool makeMiscs( int count );
+   bool makeYeasts( int count );
+   bool makeMashes( int count );
+   bool makeInventory( QString const& table, QList<Parent> const& parents );
+   bool makeRecipe( int i );
+   bool makeBrewNote( int recKey, int i );
+
+   int _recipes;
+   int _ingredients;
+   int _mashes;
+   int _brewNotes;
+   int _folders;
+   double _inventory_pct;
+   // Also the state of our random number generator.
+   uint _seed;
+   QSqlDatabase _db;
+   // Prepared inserts, by statement.
+   QHash<QString,QSqlQuery> _queries;
+
+   QList<Parent> _equipment;
+   QList<Parent> _fermentables;
+   QList<Parent> _hops;
+   QList<Parent> _miscs;
+   QList<Parent> _yeasts;
+   QList<int> _recipeKeys;
+   // Mash profiles, with the steps of each.
+   QList<Parent> _mashProfiles;
+   QList< QList< QHash<QString,QVariant> > > _mashSteps;
+};
+
+#endif /*_DATABASEGENERATOR_H*/
@@ -27,7 +27,7 @@
 #include <QDebug>
 #include <QSqlError>
 
-const int DatabaseSchemaHelper::dbVersion = 4;
+const int DatabaseSchemaHelper::dbVersion = 6;
 
 // Commands and keywords
 QString DatabaseSchemaHelper::CREATETABLE("CREATE TABLE");
@@ -270,6 +270,10 @@ QString DatabaseSchemaHelper::colRecKegPrimFact("keg_priming_factor");
 QString DatabaseSchemaHelper::colRecNotes("notes");
 QString DatabaseSchemaHelper::colRecTasteNotes("taste_notes");
 QString DatabaseSchemaHelper::colRecTasteRating("taste_rating");
+QString DatabaseSchemaHelper::colRecCalcIbu("calc_ibu");
+QString DatabaseSchemaHelper::colRecCalcColor("calc_color_srm");
+QString DatabaseSchemaHelper::colRecCalcAbv("calc_abv_pct");
+QString DatabaseSchemaHelper::colRecCalcStamp("calc_stamp");
 QString DatabaseSchemaHelper::colRecStyleId("style_id");
 QString DatabaseSchemaHelper::colRecMashId("mash_id");
 QString DatabaseSchemaHelper::colRecEquipId("equipment_id");
@@ -324,6 +328,8 @@ QString DatabaseSchemaHelper::tableMiscInventory("misc_in_inventory");
 
 QString DatabaseSchemaHelper::tableYeastInventory("yeast_in_inventory");
 
+QString DatabaseSchemaHelper::tableInventoryLedger("inventory_ledger");
+
 // Default namespace hides functions from everything outside this file.
 namespace {
    
@@ -332,6 +338,21 @@ namespace {
       return QString("FOREIGN KEY(%1) REFERENCES %2(id)").arg(column).arg(foreignTable);
    }
    
+   QString inventoryLedgerTable()
+   {
+      // Append-only. Each row records one change to the inventory of the
+      // (parent) ingredient ingredient_id in the table ingredient_table.
+      return QString() +
+         "id INTEGER PRIMARY KEY autoincrement," +
+         "ingredient_table TEXT," +
+         "ingredient_id INTEGER," +
+         "recipe_id INTEGER DEFAULT 0," +
+         "delta REAL DEFAULT 0.0," +
+         "balance REAL DEFAULT 0.0," +
+         "reason TEXT DEFAULT ''," +
+         "tstamp DATETIME DEFAULT CURRENT_TIMESTAMP";
+   }
+   
    QString childrenTable( QString const& foreignTable )
    {
       return QString() +
@@ -731,6 +752,11 @@ bool DatabaseSchemaHelper::create(QSqlDatabase db)
       colRecNotes        + SEP + TYPETEXT + SEP + DEFAULT + " ''" + "," +
       colRecTasteNotes   + SEP + TYPETEXT + SEP + DEFAULT + " ''" + "," +
       colRecTasteRating  + SEP + TYPEREAL + SEP + DEFAULT + " 0.0" + "," +
+      // Calculated, stored so the trees need not recalculate-----------------
+      colRecCalcIbu      + SEP + TYPEREAL + SEP + DEFAULT + " 0.0" + "," +
+      colRecCalcColor    + SEP + TYPEREAL + SEP + DEFAULT + " 0.0" + "," +
+      colRecCalcAbv      + SEP + TYPEREAL + SEP + DEFAULT + " 0.0" + "," +
+      colRecCalcStamp    + SEP + TYPEINTEGER + SEP + DEFAULT + " 0" + "," +
       // Relational data-------------------------------------------------------
       colRecStyleId + SEP + TYPEINTEGER + "," +
       colRecMashId  + SEP + TYPEINTEGER + "," +
@@ -981,6 +1007,12 @@ bool DatabaseSchemaHelper::create(QSqlDatabase db)
       ")"
    );
    
+   ret &= q.exec(
+      CREATETABLE + SEP + tableInventoryLedger + SEP + "(" +
+      inventoryLedgerTable() +
+      ")"
+   );
+   
    // Commit transaction
    if( hasTransaction )
       ret &= db.commit();
@@ -1273,6 +1305,43 @@ bool DatabaseSchemaHelper::migrateNext(int oldVersion, QSqlDatabase db)
          
          break;
          
+      case 4:
+         
+         // Add the inventory ledger
+         ret &= q.exec(
+            CREATETABLE + SEP + tableInventoryLedger + SEP + "(" +
+            inventoryLedgerTable() +
+            ")"
+         );
+         
+         break;
+         
+      case 5:
+         
+         // Add the stored recipe statistics. A stamp of 0 means they have
+         // never been calculated.
+         ret &= q.exec(
+            ALTERTABLE + SEP + tableRecipe + SEP +
+            ADDCOLUMN + SEP + colRecCalcIbu + SEP + TYPEREAL + SEP + DEFAULT + " 0.0"
+         );
+         
+         ret &= q.exec(
+            ALTERTABLE + SEP + tableRecipe + SEP +
+            ADDCOLUMN + SEP + colRecCalcColor + SEP + TYPEREAL + SEP + DEFAULT + " 0.0"
+         );
+         
+         ret &= q.exec(
+            ALTERTABLE + SEP + tableRecipe + SEP +
+            ADDCOLUMN + SEP + colRecCalcAbv + SEP + TYPEREAL + SEP + DEFAULT + " 0.0"
+         );
+         
+         ret &= q.exec(
+            ALTERTABLE + SEP + tableRecipe + SEP +
+            ADDCOLUMN + SEP + colRecCalcStamp + SEP + TYPEINTEGER + SEP + DEFAULT + " 0"
+         );
+         
+         break;
+         
       default:
          Brewtarget::logE(QString("Unknown version %1").arg(oldVersion));
          return false;
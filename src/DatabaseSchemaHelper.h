@@ -292,6 +292,10 @@ private:
    static QString colRecNotes;
    static QString colRecTasteNotes;
    static QString colRecTasteRating;
+   static QString colRecCalcIbu;
+   static QString colRecCalcColor;
+   static QString colRecCalcAbv;
+   static QString colRecCalcStamp;
    static QString colRecStyleId;
    static QString colRecMashId;
    static QString colRecEquipId;
@@ -325,6 +329,8 @@ private:
    static QString tableMiscInventory;
    static QString tableYeastInventory;
    
+   static QString tableInventoryLedger;
+   
    //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
    /*!
@@ -0,0 +1,106 @@
+/*
+ * DisplayCache.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DISPLAYCACHE_H
+#define _DISPLAYCACHE_H
+
+#include <Qt>
+#include <QHash>
+#include <QVector>
+#include <QVariant>
+#include "brewtarget.h"
+
+/*!
+ * \class DisplayCache
+ * \author agent
+ *
+ * \brief What a table model's \b data() returned for each row, so that
+ * painting does not go back to the database.
+ *
+ * Keeps the display, user and check state roles of every column, keyed by
+ * the row's element. The model must \b remove() a row when the element
+ * changes. Every row is dropped when the options change, since the units
+ * and scales live there.
+ *
+ * Inventory is shared by every copy of an ingredient, and the other copies
+ * do not say when it changes, so the models leave that column out. The
+ * database keeps the balances in memory, so it costs no query anyway.
+ */
+template<class T> class DisplayCache
+{
+public:
+   DisplayCache( int columns )
+      : _columns(columns),
+        _optionsVersion(Brewtarget::optionsVersion())
+   {
+   }
+
+   /*!
+    * \returns the cell for \c row, \c col and \c role, or 0 if that role is
+    * not cached. The cell is an invalid QVariant until it is filled in.
+    */
+   QVariant* cell( T const* row, int col, int role )
+   {
+      int slot;
+
+      if( col < 0 || col >= _columns )
+         return 0;
+
+      switch( role )
+      {
+         case Qt::DisplayRole:
+            slot = 0;
+            break;
+         case Qt::UserRole:
+            slot = 1;
+            break;
+         case Qt::CheckStateRole:
+            slot = 2;
+            break;
+         default:
+            return 0;
+      }
+
+      if( _optionsVersion != Brewtarget::optionsVersion() )
+      {
+         _rows.clear();
+         _optionsVersion = Brewtarget::optionsVersion();
+      }
+
+      QVector<QVariant>& cells = _rows[row];
+      if( cells.isEmpty() )
+         cells.resize(_columns * numRoles);
+
+      return &cells[col * numRoles + slot];
+   }
+
+   //! \brief Forget everything about \c row.
+   void remove( T const* row ) { _rows.remove(row); }
+   //! \brief Forget every row.
+   void clear() { _rows.clear(); }
+
+private:
+   static int const numRoles = 3;
+
+   int _columns;
+   unsigned int _optionsVersion;
+   QHash< T const*, QVector<QVariant> > _rows;
+};
+
+#endif /*_DISPLAYCACHE_H*/
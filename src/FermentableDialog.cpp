@@ -44,6 +44,8 @@ FermentableDialog::FermentableDialog(MainWindow* parent) :
 
    fermTableModel = new FermentableTableModel(tableWidget, false);
    fermTableModel->setInventoryEditable(true);
+   // Big catalogs are listed a page at a time, as the table scrolls.
+   fermTableModel->setPaged(true);
    fermTableProxy = new FermentableSortFilterProxyModel(tableWidget);
    fermTableProxy->setSourceModel(fermTableModel);
    tableWidget->setModel(fermTableProxy);
@@ -221,6 +223,8 @@ void FermentableDialog::newFermentable()
 
 void FermentableDialog::filterFermentables(QString searchExpression)
 {
+    // Rows not listed yet are invisible to the proxy, so ask the database too.
+    fermTableModel->setNameFilter(searchExpression);
     fermTableProxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
     fermTableProxy->setFilterFixedString(searchExpression);
 }
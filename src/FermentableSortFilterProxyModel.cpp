@@ -37,39 +37,25 @@ bool FermentableSortFilterProxyModel::lessThan(const QModelIndex &left,
 {
    QVariant leftFermentable = sourceModel()->data(left);
    QVariant rightFermentable = sourceModel()->data(right);
-   double leftDouble, rightDouble;
-
-   Unit* unit = Units::kilograms;
+   // The model hands numbers back in SI under Qt::UserRole.
+   double leftDouble = sourceModel()->data(left, Qt::UserRole).toDouble();
+   double rightDouble = sourceModel()->data(right, Qt::UserRole).toDouble();
 
    switch( left.column() )
    {
       case FERMINVENTORYCOL:
          // If the numbers are equal, compare the names and be done with it
-         if (Brewtarget::qStringToSI(leftFermentable.toString(), unit) == Brewtarget::qStringToSI(rightFermentable.toString(),unit))
+         if (leftDouble == rightDouble)
             return getName(right) < getName(left);
          // Show non-zero entries first.
-         else if (Brewtarget::qStringToSI(leftFermentable.toString(), unit) == 0.0 && this->sortOrder() == Qt::AscendingOrder)
+         else if (leftDouble == 0.0 && this->sortOrder() == Qt::AscendingOrder)
             return false;
          else
-            return Brewtarget::qStringToSI(leftFermentable.toString(),unit) < Brewtarget::qStringToSI(rightFermentable.toString(),unit);
+            return leftDouble < rightDouble;
       case FERMAMOUNTCOL:
-         // If the numbers are equal, compare the names and be done with it
-         if (Brewtarget::qStringToSI(leftFermentable.toString(), unit) == Brewtarget::qStringToSI(rightFermentable.toString(),unit))
-            return getName(right) < getName(left);
-         else
-            return Brewtarget::qStringToSI(leftFermentable.toString(),unit) < Brewtarget::qStringToSI(rightFermentable.toString(),unit);
       case FERMYIELDCOL:
-         leftDouble = toDouble(leftFermentable);
-         rightDouble = toDouble(rightFermentable);
-
-         if (leftDouble == rightDouble)
-            return getName(right) < getName(left);
-         else
-            return leftDouble < rightDouble;
       case FERMCOLORCOL:
-         leftDouble = toDouble(leftFermentable);
-         rightDouble = toDouble(rightFermentable);
-
+         // If the numbers are equal, compare the names and be done with it
          if (leftDouble == rightDouble)
             return getName(right) < getName(left);
          else
@@ -79,17 +65,6 @@ bool FermentableSortFilterProxyModel::lessThan(const QModelIndex &left,
    return leftFermentable.toString() < rightFermentable.toString();
 }
 
-double FermentableSortFilterProxyModel::toDouble(QVariant side) const
-{
-   double amt;
-   bool ok = false;
-
-   amt = Brewtarget::toDouble(side.toString(), &ok);
-   if ( ! ok )
-      Brewtarget::logW( QString("FermentableSortFilterProxyModel::lessThan could not convert %1 to double").arg(side.toString()));
-   return amt;
-}
-
 QString FermentableSortFilterProxyModel::getName( const QModelIndex &index ) const
 {
    QVariant info = sourceModel()->data(QAbstractItemModel::createIndex(index.row(),FERMNAMECOL));
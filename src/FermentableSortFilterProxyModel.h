@@ -47,7 +47,6 @@ private:
    bool filter;
 
    QString getName( const QModelIndex &index ) const;
-   double toDouble(QVariant side) const;
 };
 
 #endif
@@ -54,7 +54,9 @@ FermentableTableModel::FermentableTableModel(QTableView* parent, bool editable)
      _inventoryEditable(false),
      recObs(0),
      displayPercentages(false),
-     totalFermMass_kg(0)
+     totalFermMass_kg(0),
+     _paged(false),
+     _displayCache(FERMNUMCOLS)
 {
    fermObs.clear();
    // for units and scales
@@ -95,7 +97,13 @@ void FermentableTableModel::observeDatabase(bool val)
       removeAll();
       connect( &(Database::instance()), SIGNAL(newFermentableSignal(Fermentable*)), this, SLOT(addFermentable(Fermentable*)) );
       connect( &(Database::instance()), SIGNAL(deletedFermentableSignal(Fermentable*)), this, SLOT(removeFermentable(Fermentable*)) );
-      addFermentables( Database::instance().fermentables() );
+      if( _paged )
+      {
+         _unfetched = Database::instance().fermentablesByName(_nameFilter);
+         fetchMore();
+      }
+      else
+         addFermentables( Database::instance().fermentables() );
    }
    else
    {
@@ -109,6 +117,8 @@ void FermentableTableModel::addFermentable(Fermentable* ferm)
    //Check to see if it's already in the list
    if( fermObs.contains(ferm) )
       return;
+   // It may not have been listed yet.
+   _unfetched.removeOne(ferm);
    // If we are observing the database, ensure that the ferm is undeleted and
    // fit to display.
    if(
@@ -160,6 +170,8 @@ bool FermentableTableModel::removeFermentable(Fermentable* ferm)
 {
    int i;
 
+   _unfetched.removeOne(ferm);
+   _displayCache.remove(ferm);
    i = fermObs.indexOf(ferm);
    if( i >= 0 )
    {
@@ -179,6 +191,8 @@ bool FermentableTableModel::removeFermentable(Fermentable* ferm)
 
 void FermentableTableModel::removeAll()
 {
+   _unfetched.clear();
+   _displayCache.clear();
    if (fermObs.size())
    {
       beginRemoveRows( QModelIndex(), 0, fermObs.size()-1 );
@@ -192,6 +206,51 @@ void FermentableTableModel::removeAll()
    totalFermMass_kg = 0;
 }
 
+void FermentableTableModel::setPaged( bool var )
+{
+   _paged = var;
+}
+
+void FermentableTableModel::setNameFilter( QString const& text )
+{
+   if( text == _nameFilter )
+      return;
+
+   _nameFilter = text;
+   if( _paged && recObs == 0 )
+   {
+      removeAll();
+      _unfetched = Database::instance().fermentablesByName(_nameFilter);
+      fetchMore();
+   }
+}
+
+bool FermentableTableModel::canFetchMore( const QModelIndex& parent ) const
+{
+   return !parent.isValid() && !_unfetched.isEmpty();
+}
+
+void FermentableTableModel::fetchMore( const QModelIndex& parent )
+{
+   int i, size, n;
+
+   if( parent.isValid() || _unfetched.isEmpty() )
+      return;
+
+   // Nothing in _unfetched is listed yet, so no need to check for repeats.
+   size = fermObs.size();
+   n = qMin(pageSize, _unfetched.size());
+   beginInsertRows( QModelIndex(), size, size+n-1 );
+   for( i = 0; i < n; ++i )
+   {
+      Fermentable* item = _unfetched.takeFirst();
+      fermObs.append(item);
+      connect( item, SIGNAL(changed(QMetaProperty,QVariant)), this, SLOT(changed(QMetaProperty,QVariant)) );
+      totalFermMass_kg += item->amount_kg();
+   }
+   endInsertRows();
+}
+
 void FermentableTableModel::updateTotalGrains()
 {
    int i, size;
@@ -216,6 +275,8 @@ void FermentableTableModel::changed(QMetaProperty prop, QVariant /*val*/)
    Fermentable* fermSender = qobject_cast<Fermentable*>(sender());
    if( fermSender )
    {
+      _displayCache.remove(fermSender);
+
       i = fermObs.indexOf(fermSender);
       if( i < 0 )
          return;
@@ -252,9 +313,7 @@ int FermentableTableModel::columnCount(const QModelIndex& /*parent*/) const
 QVariant FermentableTableModel::data( const QModelIndex& index, int role ) const
 {
    Fermentable* row;
-   int col = index.column();
-   Unit::unitScale scale;
-   Unit::unitDisplay unit;
+   QVariant* cell;
 
    // Ensure the row is ok.
    if( index.row() >= (int)fermObs.size() )
@@ -265,6 +324,23 @@ QVariant FermentableTableModel::data( const QModelIndex& index, int role ) const
    else
       row = fermObs[index.row()];
 
+   // Inventory is left out. See DisplayCache.
+   if( index.column() == FERMINVENTORYCOL )
+      return uncachedData(row, index.column(), role);
+
+   cell = _displayCache.cell(row, index.column(), role);
+   if( cell == 0 )
+      return uncachedData(row, index.column(), role);
+   if( !cell->isValid() )
+      *cell = uncachedData(row, index.column(), role);
+   return *cell;
+}
+
+QVariant FermentableTableModel::uncachedData( Fermentable* row, int col, int role ) const
+{
+   Unit::unitScale scale;
+   Unit::unitDisplay unit;
+
    switch( col )
    {
       case FERMNAMECOL:
@@ -280,7 +356,9 @@ QVariant FermentableTableModel::data( const QModelIndex& index, int role ) const
          else
             return QVariant();
       case FERMINVENTORYCOL:
-         if( role != Qt::DisplayRole )
+         if( role == Qt::UserRole )
+            return QVariant(row->inventory());
+         else if( role != Qt::DisplayRole )
             return QVariant();
 
          // So just query the columns
@@ -289,7 +367,9 @@ QVariant FermentableTableModel::data( const QModelIndex& index, int role ) const
 
          return QVariant( Brewtarget::displayAmount(row->inventory(), Units::kilograms, 3, unit, scale) );
       case FERMAMOUNTCOL:
-         if( role != Qt::DisplayRole )
+         if( role == Qt::UserRole )
+            return QVariant(row->amount_kg());
+         else if( role != Qt::DisplayRole )
             return QVariant();
 
          // So just query the columns
@@ -314,10 +394,14 @@ QVariant FermentableTableModel::data( const QModelIndex& index, int role ) const
       case FERMYIELDCOL:
          if( role == Qt::DisplayRole )
             return QVariant( Brewtarget::displayAmount(row->yield_pct(), 0) );
+         else if( role == Qt::UserRole )
+            return QVariant(row->yield_pct());
          else
             return QVariant();
       case FERMCOLORCOL:
-         if( role != Qt::DisplayRole )
+         if( role == Qt::UserRole )
+            return QVariant(row->color_srm());
+         else if( role != Qt::DisplayRole )
             return QVariant();
 
          unit  = displayUnit(col);
@@ -36,6 +36,7 @@ class FermentableItemDelegate;
 #include <QAbstractItemDelegate>
 #include <QList>
 #include "unit.h"
+#include "DisplayCache.h"
 
 // Forward declarations.
 class Fermentable;
@@ -64,6 +65,17 @@ public:
    void addFermentables(QList<Fermentable*> ferms);
    //! \brief Clear the model.
    void removeAll();
+
+   /*!
+    * \brief If true, observeDatabase() lists the database a page at a time.
+    *
+    * Only the first page is listed at first, and \b fetchMore() adds the
+    * rest as the view scrolls down. Rows are not connected to until they are
+    * listed, and sorting only sorts what is listed so far.
+    */
+   void setPaged( bool var );
+   //! \brief When paged, only list fermentables whose names contain \c text.
+   void setNameFilter( QString const& text );
    //! \brief Return the \c i-th fermentable in the model.
    Fermentable* getFermentable(unsigned int i);
    //! \brief True if you want to display percent of each grain in the row header.
@@ -92,6 +104,10 @@ public:
    virtual Qt::ItemFlags flags(const QModelIndex& index ) const;
    //! \brief Reimplemented from QAbstractTableModel.
    virtual bool setData( const QModelIndex& index, const QVariant& value, int role = Qt::EditRole );
+   //! \brief Reimplemented from QAbstractTableModel.
+   virtual bool canFetchMore( const QModelIndex& parent = QModelIndex() ) const;
+   //! \brief Reimplemented from QAbstractTableModel.
+   virtual void fetchMore( const QModelIndex& parent = QModelIndex() );
    
    QTableView* parentTableWidget;
    
@@ -118,6 +134,17 @@ private:
    Recipe* recObs;
    bool displayPercentages;
    double totalFermMass_kg;
+
+   //! \brief Rows listed by each \b fetchMore().
+   static int const pageSize = 200;
+   bool _paged;
+   QString _nameFilter;
+   //! \brief What is left to list, when paged.
+   QList<Fermentable*> _unfetched;
+
+   //! \brief Work out what \b data() returns for \c row, without the cache.
+   QVariant uncachedData( Fermentable* row, int col, int role ) const;
+   mutable DisplayCache<Fermentable> _displayCache;
    
 };
 
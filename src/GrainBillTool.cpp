@@ -0,0 +1,212 @@
+/*
+ * GrainBillTool.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GrainBillTool.h"
+#include "brewtarget.h"
+#include "recipe.h"
+#include "fermentable.h"
+#include "unit.h"
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QSpacerItem>
+
+GrainBillTool::GrainBillTool(QWidget* parent)
+   : QDialog(parent),
+     recObs(0),
+     loading(false)
+{
+   doLayout();
+
+   connect( ogSlider, SIGNAL(valueChanged(int)), this, SLOT(solve()) );
+   connect( colorSlider, SIGNAL(valueChanged(int)), this, SLOT(solve()) );
+   connect( tableWidget, SIGNAL(itemChanged(QTableWidgetItem*)), this, SLOT(solve()) );
+   connect( pushButton_apply, SIGNAL(clicked()), this, SLOT(apply()) );
+   connect( pushButton_close, SIGNAL(clicked()), this, SLOT(reject()) );
+}
+
+void GrainBillTool::doLayout()
+{
+   resize(420, 360);
+   QVBoxLayout* vLayout = new QVBoxLayout(this);
+      QFormLayout* formLayout = new QFormLayout();
+         ogLabel = new QLabel(this);
+         QHBoxLayout* ogLayout = new QHBoxLayout();
+            ogSlider = new QSlider(Qt::Horizontal, this);
+               // Gravity points, 1.000 to 1.150.
+               ogSlider->setRange(1000, 1150);
+            ogValueLabel = new QLabel(this);
+               ogValueLabel->setMinimumSize(QSize(48, 0));
+            ogLayout->addWidget(ogSlider);
+            ogLayout->addWidget(ogValueLabel);
+         colorLabel = new QLabel(this);
+         QHBoxLayout* colorLayout = new QHBoxLayout();
+            colorSlider = new QSlider(Qt::Horizontal, this);
+               // SRM, where 0 is no target.
+               colorSlider->setRange(0, 80);
+            colorValueLabel = new QLabel(this);
+               colorValueLabel->setMinimumSize(QSize(48, 0));
+            colorLayout->addWidget(colorSlider);
+            colorLayout->addWidget(colorValueLabel);
+         formLayout->addRow(ogLabel, ogLayout);
+         formLayout->addRow(colorLabel, colorLayout);
+      tableWidget = new QTableWidget(0, NUMCOLS, this);
+         tableWidget->verticalHeader()->hide();
+         tableWidget->horizontalHeader()->setStretchLastSection(true);
+      resultLabel = new QLabel(this);
+      QHBoxLayout* buttonLayout = new QHBoxLayout();
+         QSpacerItem* horizontalSpacer = new QSpacerItem(40, 20, QSizePolicy::Expanding, QSizePolicy::Minimum);
+         pushButton_apply = new QPushButton(this);
+            pushButton_apply->setAutoDefault(false);
+         pushButton_close = new QPushButton(this);
+            pushButton_close->setAutoDefault(false);
+         buttonLayout->addItem(horizontalSpacer);
+         buttonLayout->addWidget(pushButton_apply);
+         buttonLayout->addWidget(pushButton_close);
+   vLayout->addLayout(formLayout);
+   vLayout->addWidget(tableWidget);
+   vLayout->addWidget(resultLabel);
+   vLayout->addLayout(buttonLayout);
+
+   retranslateUi();
+}
+
+void GrainBillTool::retranslateUi()
+{
+   setWindowTitle(tr("Hit Targets"));
+   ogLabel->setText(tr("Target OG"));
+   colorLabel->setText(tr("Target Color"));
+   tableWidget->setHorizontalHeaderLabels( QStringList() << tr("Fermentable") << tr("Target %") << tr("Amount") );
+   pushButton_apply->setText(tr("Apply"));
+   pushButton_close->setText(tr("Close"));
+#ifndef QT_NO_TOOLTIP
+   colorSlider->setToolTip(tr("All the way left for no color target"));
+   tableWidget->setToolTip(tr("Leave a percentage empty to let it take whatever is left"));
+#endif // QT_NO_TOOLTIP
+}
+
+void GrainBillTool::setRecipe(Recipe* rec)
+{
+   recObs = rec;
+   if( isVisible() )
+      reset();
+}
+
+void GrainBillTool::showEvent(QShowEvent* event)
+{
+   reset();
+   QDialog::showEvent(event);
+}
+
+void GrainBillTool::reset()
+{
+   int i;
+
+   loading = true;
+
+   ferms.clear();
+   amounts_kg.clear();
+   tableWidget->setRowCount(0);
+
+   if( recObs )
+   {
+      // Read the recipe and the options once, so solve() does not have to.
+      ferms = recObs->fermentables();
+      input = recObs->calcInput();
+      options = Recipe::calcOptions();
+
+      ogSlider->setValue( qRound(recObs->og() * 1000.0) );
+      colorSlider->setValue( qRound(recObs->color_srm()) );
+
+      tableWidget->setRowCount(ferms.size());
+      for( i = 0; i < ferms.size(); ++i )
+      {
+         QTableWidgetItem* name = new QTableWidgetItem(ferms[i]->name());
+         name->setFlags(Qt::ItemIsEnabled);
+         QTableWidgetItem* amount = new QTableWidgetItem();
+         amount->setFlags(Qt::ItemIsEnabled);
+
+         tableWidget->setItem(i, NAMECOL, name);
+         tableWidget->setItem(i, PERCENTCOL, new QTableWidgetItem());
+         tableWidget->setItem(i, AMOUNTCOL, amount);
+      }
+   }
+
+   loading = false;
+   solve();
+}
+
+void GrainBillTool::solve()
+{
+   BrewCalc::GrainBillTargets targets;
+   BrewCalc::Recipe out;
+   BrewCalc::Results results;
+   unsigned int i;
+
+   ogValueLabel->setText( Brewtarget::displayAmount(ogSlider->value() / 1000.0, Units::sp_grav, 3) );
+   if( colorSlider->value() > 0 )
+      colorValueLabel->setText( Brewtarget::displayAmount(colorSlider->value(), Units::srm, 0) );
+   else
+      colorValueLabel->setText( tr("None") );
+
+   if( loading || ! recObs || input.fermentables.empty() )
+   {
+      resultLabel->clear();
+      return;
+   }
+
+   targets.og = ogSlider->value() / 1000.0;
+   targets.color_srm = colorSlider->value();
+   for( i = 0; i < input.fermentables.size(); ++i )
+   {
+      bool ok = false;
+      double pct = Brewtarget::toDouble(tableWidget->item(i, PERCENTCOL)->text(), &ok);
+      targets.grist_pct.push_back( ok ? pct : -1.0 );
+   }
+
+   amounts_kg = BrewCalc::grainBill(input, targets, options);
+
+   // Show what the new amounts actually give, which may not be the targets
+   // if they can not all be met.
+   out = input;
+   loading = true;
+   for( i = 0; i < amounts_kg.size(); ++i )
+   {
+      out.fermentables[i].amount_kg = amounts_kg[i];
+      tableWidget->item(i, AMOUNTCOL)->setText( Brewtarget::displayAmount(amounts_kg[i], Units::kilograms) );
+   }
+   loading = false;
+
+   results = BrewCalc::calculate(out, options);
+   resultLabel->setText( tr("Gives OG %1, color %2")
+                         .arg(Brewtarget::displayAmount(results.gravities.og, Units::sp_grav, 3))
+                         .arg(Brewtarget::displayAmount(results.color_srm, Units::srm, 0)) );
+}
+
+void GrainBillTool::apply()
+{
+   int i;
+
+   if( ! recObs || static_cast<int>(amounts_kg.size()) != ferms.size() )
+      return;
+
+   for( i = 0; i < ferms.size(); ++i )
+      ferms[i]->setAmount_kg(amounts_kg[i]);
+}
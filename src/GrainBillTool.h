@@ -0,0 +1,111 @@
+/*
+ * GrainBillTool.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GRAINBILLTOOL_H
+#define _GRAINBILLTOOL_H
+
+class GrainBillTool;
+
+#include <QDialog>
+#include <QWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QSlider>
+#include <QTableWidget>
+#include <QList>
+#include <QEvent>
+#include <QShowEvent>
+#include <vector>
+#include "BrewCalc.h"
+
+// Forward declarations
+class Recipe;
+class Fermentable;
+
+/*!
+ * \class GrainBillTool
+ * \author agent
+ *
+ * \brief Dialog that works out the fermentable amounts to hit a target
+ * OG, color and grist.
+ *
+ * The recipe is read once when the dialog is shown. After that, moving a
+ * slider or changing a percentage only re-runs \b BrewCalc::grainBill(),
+ * so the amounts follow the sliders as they are dragged. Nothing changes
+ * in the recipe until "Apply".
+ */
+class GrainBillTool : public QDialog
+{
+   Q_OBJECT
+public:
+
+   GrainBillTool(QWidget* parent=0);
+   //! \brief Set the observed \c Recipe
+   void setRecipe(Recipe* rec);
+
+   //! \name Public UI Variables
+   //! @{
+   QLabel* ogLabel;
+   QSlider* ogSlider;
+   QLabel* ogValueLabel;
+   QLabel* colorLabel;
+   QSlider* colorSlider;
+   QLabel* colorValueLabel;
+   QTableWidget* tableWidget;
+   QLabel* resultLabel;
+   QPushButton* pushButton_apply;
+   QPushButton* pushButton_close;
+   //! @}
+
+public slots:
+   //! \brief Work out new amounts for the current targets.
+   void solve();
+   //! \brief Write the new amounts to the recipe's fermentables.
+   void apply();
+   //! \brief Start over from what the recipe has now.
+   void reset();
+
+protected:
+
+   virtual void changeEvent(QEvent* event)
+   {
+      if(event->type() == QEvent::LanguageChange)
+         retranslateUi();
+      QDialog::changeEvent(event);
+   }
+
+   virtual void showEvent(QShowEvent* event);
+
+private:
+
+   enum { NAMECOL, PERCENTCOL, AMOUNTCOL, NUMCOLS };
+
+   void doLayout();
+   void retranslateUi();
+
+   Recipe* recObs;
+   QList<Fermentable*> ferms;
+   BrewCalc::Recipe input;
+   BrewCalc::Options options;
+   std::vector<double> amounts_kg;
+   //! \brief True while the widgets are being filled in, so they do not each solve.
+   bool loading;
+};
+
+#endif /*_GRAINBILLTOOL_H*/
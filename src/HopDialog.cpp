@@ -44,6 +44,8 @@ HopDialog::HopDialog(MainWindow* parent) :
 
    hopTableModel = new HopTableModel(tableWidget, false);
    hopTableModel->setInventoryEditable(true);
+   // Big catalogs are listed a page at a time, as the table scrolls.
+   hopTableModel->setPaged(true);
    hopTableProxy = new HopSortFilterProxyModel(tableWidget);
    hopTableProxy->setSourceModel(hopTableModel);
    tableWidget->setModel(hopTableProxy);
@@ -219,6 +221,8 @@ void HopDialog::newHop()
 
 void HopDialog::filterHops(QString searchExpression)
 {
+    // Rows not listed yet are invisible to the proxy, so ask the database too.
+    hopTableModel->setNameFilter(searchExpression);
     hopTableProxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
     hopTableProxy->setFilterFixedString(searchExpression);
 }
@@ -0,0 +1,82 @@
+/*
+ * HopOptimizer.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HopOptimizer.h"
+#include <QElapsedTimer>
+
+HopOptimizer::HopOptimizer( QObject* parent )
+   : QThread(parent),
+     _run(0),
+     _cancelled(0)
+{
+}
+
+HopOptimizer::~HopOptimizer()
+{
+   cancel();
+   wait();
+}
+
+int HopOptimizer::search( BrewCalc::Recipe const& rec, BrewCalc::HopTargets const& targets, BrewCalc::Options const& opts )
+{
+   cancel();
+   wait();
+
+   ++_run;
+   _rec = rec;
+   _targets = targets;
+   _opts = opts;
+   _cancelled.storeRelease(0);
+   start(QThread::LowPriority);
+   return _run;
+}
+
+void HopOptimizer::cancel()
+{
+   _cancelled.storeRelease(1);
+}
+
+BrewCalc::HopSearch const& HopOptimizer::result() const
+{
+   return _search;
+}
+
+void HopOptimizer::run()
+{
+   QElapsedTimer timer;
+   qint64 lastEmit = 0;
+   bool more = true;
+
+   timer.start();
+   _search = BrewCalc::startHopSearch(_rec, _targets, _opts);
+
+   while( more && ! _cancelled.loadAcquire() )
+   {
+      more = BrewCalc::searchHops(_search, piece);
+
+      if( timer.elapsed() - lastEmit >= 100 )
+      {
+         lastEmit = timer.elapsed();
+         emit progress(_run, _search.done, _search.total, _search.done * 1000.0 / lastEmit);
+      }
+   }
+
+   emit progress(_run, _search.done, _search.total, _search.done * 1000.0 / qMax(timer.elapsed(), qint64(1)));
+   emit searched(_run);
+}
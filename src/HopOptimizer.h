@@ -0,0 +1,81 @@
+/*
+ * HopOptimizer.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOPOPTIMIZER_H
+#define _HOPOPTIMIZER_H
+
+class HopOptimizer;
+
+#include <QThread>
+#include <QAtomicInt>
+#include "BrewCalc.h"
+
+/*!
+ * \class HopOptimizer
+ * \author agent
+ *
+ * \brief Runs \b BrewCalc::searchHops() in its own thread.
+ *
+ * The search goes a piece at a time, checking for \b cancel() in between,
+ * so stopping early still leaves the best schedule found so far. Read
+ * \b result() once \b searched() has been emitted for the run that
+ * \b search() returned. Both signals are queued across threads, so they
+ * may arrive after a newer run has started: compare the run first.
+ */
+class HopOptimizer : public QThread
+{
+   Q_OBJECT
+
+public:
+   HopOptimizer( QObject* parent = 0 );
+   virtual ~HopOptimizer();
+
+   /*!
+    * \brief Start a new search. Cancels and waits for any search still running.
+    * \returns the number of the new run, never 0.
+    */
+   int search( BrewCalc::Recipe const& rec, BrewCalc::HopTargets const& targets, BrewCalc::Options const& opts );
+   //! \brief Stop as soon as the current piece is done. Never blocks.
+   void cancel();
+   //! \brief The search as it was left. Only while not running.
+   BrewCalc::HopSearch const& result() const;
+
+signals:
+   //! \brief Emitted from the search thread a few times a second, so connect it queued.
+   void progress( int run, double done, double total, double perSecond );
+   //! \brief Emitted from the search thread as run \c run ends, cancelled or not.
+   void searched( int run );
+
+protected:
+   virtual void run();
+
+private:
+   //! \brief Choices to try between checks for \b cancel().
+   static unsigned int const piece = 65536;
+
+   BrewCalc::Recipe _rec;
+   BrewCalc::HopTargets _targets;
+   BrewCalc::Options _opts;
+   BrewCalc::HopSearch _search;
+   //! \brief The number of the latest run. Only written while none is running.
+   int _run;
+   QAtomicInt _cancelled;
+};
+
+#endif /*_HOPOPTIMIZER_H*/
@@ -0,0 +1,356 @@
+/*
+ * HopScheduleTool.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HopScheduleTool.h"
+#include "HopOptimizer.h"
+#include "brewtarget.h"
+#include "database.h"
+#include "recipe.h"
+#include "hop.h"
+#include "unit.h"
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QSpacerItem>
+
+HopScheduleTool::HopScheduleTool(QWidget* parent)
+   : QDialog(parent),
+     recObs(0),
+     optimizer(new HopOptimizer(this)),
+     searchRun(0),
+     gravityUnits(0.0),
+     linking(false)
+{
+   doLayout();
+
+   connect( ibuSpinBox, SIGNAL(valueChanged(double)), this, SLOT(ibuChanged(double)) );
+   connect( buguSpinBox, SIGNAL(valueChanged(double)), this, SLOT(buguChanged(double)) );
+   connect( optimizer, SIGNAL(progress(int,double,double,double)), this, SLOT(searchProgress(int,double,double,double)) );
+   connect( optimizer, SIGNAL(searched(int)), this, SLOT(searchFinished(int)) );
+   connect( pushButton_search, SIGNAL(clicked()), this, SLOT(search()) );
+   connect( pushButton_apply, SIGNAL(clicked()), this, SLOT(apply()) );
+   connect( pushButton_close, SIGNAL(clicked()), this, SLOT(reject()) );
+}
+
+HopScheduleTool::~HopScheduleTool()
+{
+   // Before the optimizer goes, so its last signals have nowhere to go.
+   optimizer->disconnect(this);
+}
+
+void HopScheduleTool::doLayout()
+{
+   resize(520, 400);
+   QVBoxLayout* vLayout = new QVBoxLayout(this);
+      QFormLayout* formLayout = new QFormLayout();
+         ibuLabel = new QLabel(this);
+         ibuSpinBox = new QDoubleSpinBox(this);
+            ibuSpinBox->setRange(0.0, 200.0);
+            ibuSpinBox->setDecimals(1);
+         buguLabel = new QLabel(this);
+         buguSpinBox = new QDoubleSpinBox(this);
+            buguSpinBox->setRange(0.0, 4.0);
+            buguSpinBox->setDecimals(2);
+            buguSpinBox->setSingleStep(0.05);
+         windowLabel = new QLabel(this);
+         windowSpinBox = new QSpinBox(this);
+            windowSpinBox->setRange(0, 30);
+            windowSpinBox->setSingleStep(5);
+         substituteCheckBox = new QCheckBox(this);
+         formLayout->addRow(ibuLabel, ibuSpinBox);
+         formLayout->addRow(buguLabel, buguSpinBox);
+         formLayout->addRow(windowLabel, windowSpinBox);
+         formLayout->addRow(substituteCheckBox);
+      tableWidget = new QTableWidget(0, NUMCOLS, this);
+         tableWidget->verticalHeader()->hide();
+         tableWidget->horizontalHeader()->setStretchLastSection(true);
+      progressBar = new QProgressBar(this);
+         progressBar->setRange(0, 1000);
+         progressBar->setTextVisible(false);
+      resultLabel = new QLabel(this);
+      QHBoxLayout* buttonLayout = new QHBoxLayout();
+         QSpacerItem* horizontalSpacer = new QSpacerItem(40, 20, QSizePolicy::Expanding, QSizePolicy::Minimum);
+         pushButton_search = new QPushButton(this);
+            pushButton_search->setAutoDefault(false);
+         pushButton_apply = new QPushButton(this);
+            pushButton_apply->setAutoDefault(false);
+            pushButton_apply->setEnabled(false);
+         pushButton_close = new QPushButton(this);
+            pushButton_close->setAutoDefault(false);
+         buttonLayout->addItem(horizontalSpacer);
+         buttonLayout->addWidget(pushButton_search);
+         buttonLayout->addWidget(pushButton_apply);
+         buttonLayout->addWidget(pushButton_close);
+   vLayout->addLayout(formLayout);
+   vLayout->addWidget(tableWidget);
+   vLayout->addWidget(progressBar);
+   vLayout->addWidget(resultLabel);
+   vLayout->addLayout(buttonLayout);
+
+   retranslateUi();
+}
+
+void HopScheduleTool::retranslateUi()
+{
+   setWindowTitle(tr("Hop Schedule"));
+   ibuLabel->setText(tr("Target IBU"));
+   buguLabel->setText(tr("Target BU:GU"));
+   windowLabel->setText(tr("Move bittering additions by up to"));
+   windowSpinBox->setSuffix(tr(" min"));
+   substituteCheckBox->setText(tr("Substitute hops from the inventory"));
+   tableWidget->setHorizontalHeaderLabels( QStringList() << tr("Hop") << tr("Use") << tr("Target %") << tr("Amount") << tr("Time") << tr("Becomes") );
+   pushButton_search->setText( optimizer->isRunning() ? tr("Stop") : tr("Search") );
+   pushButton_apply->setText(tr("Apply"));
+   pushButton_close->setText(tr("Close"));
+#ifndef QT_NO_TOOLTIP
+   tableWidget->setToolTip(tr("Leave a percentage empty to keep the share of the IBUs the hop has now"));
+   substituteCheckBox->setToolTip(tr("Any hop with some in the inventory may take the place of a bittering addition, one boiled for at least 30 minutes"));
+#endif // QT_NO_TOOLTIP
+}
+
+void HopScheduleTool::setRecipe(Recipe* rec)
+{
+   recObs = rec;
+   if( isVisible() )
+      reset();
+}
+
+void HopScheduleTool::showEvent(QShowEvent* event)
+{
+   reset();
+   QDialog::showEvent(event);
+}
+
+void HopScheduleTool::reset()
+{
+   int i;
+
+   optimizer->cancel();
+   optimizer->wait();
+   // Its signals may still be queued, and are for a recipe we no longer have.
+   searchRun = 0;
+   pushButton_search->setText(tr("Search"));
+
+   hops.clear();
+   substitutes.clear();
+   result.clear();
+   resultSubstitute.clear();
+   tableWidget->setRowCount(0);
+   progressBar->setValue(0);
+   resultLabel->clear();
+   pushButton_apply->setEnabled(false);
+   gravityUnits = 0.0;
+
+   if( ! recObs )
+      return;
+
+   // Read the recipe and the options once, so the search does not have to.
+   hops = recObs->hops();
+   input = recObs->calcInput();
+   options = Recipe::calcOptions();
+   gravityUnits = (recObs->og() - 1.0) * 1000.0;
+
+   linking = true;
+   ibuSpinBox->setValue(recObs->IBU());
+   buguSpinBox->setValue( gravityUnits > 0.0 ? recObs->IBU() / gravityUnits : 0.0 );
+   linking = false;
+
+   tableWidget->setRowCount(hops.size());
+   for( i = 0; i < hops.size(); ++i )
+   {
+      QTableWidgetItem* name = new QTableWidgetItem(hops[i]->name());
+      name->setFlags(Qt::ItemIsEnabled);
+      QTableWidgetItem* use = new QTableWidgetItem(hops[i]->useStringTr());
+      use->setFlags(Qt::ItemIsEnabled);
+
+      tableWidget->setItem(i, NAMECOL, name);
+      tableWidget->setItem(i, USECOL, use);
+      tableWidget->setItem(i, PERCENTCOL, new QTableWidgetItem());
+      for( int col = AMOUNTCOL; col < NUMCOLS; ++col )
+      {
+         QTableWidgetItem* item = new QTableWidgetItem();
+         item->setFlags(Qt::ItemIsEnabled);
+         tableWidget->setItem(i, col, item);
+      }
+   }
+}
+
+void HopScheduleTool::ibuChanged(double ibu)
+{
+   if( linking )
+      return;
+   linking = true;
+   buguSpinBox->setValue( gravityUnits > 0.0 ? ibu / gravityUnits : 0.0 );
+   linking = false;
+}
+
+void HopScheduleTool::buguChanged(double bugu)
+{
+   if( linking )
+      return;
+   linking = true;
+   ibuSpinBox->setValue( bugu * gravityUnits );
+   linking = false;
+}
+
+void HopScheduleTool::search()
+{
+   int i;
+
+   if( optimizer->isRunning() )
+   {
+      optimizer->cancel();
+      return;
+   }
+
+   if( ! recObs || hops.isEmpty() )
+      return;
+
+   targets = BrewCalc::HopTargets();
+   targets.ibu = ibuSpinBox->value();
+   targets.timeWindow_min = windowSpinBox->value();
+   for( i = 0; i < hops.size(); ++i )
+   {
+      bool ok = false;
+      double pct = Brewtarget::toDouble(tableWidget->item(i, PERCENTCOL)->text(), &ok);
+      targets.split_pct.push_back( ok ? pct : -1.0 );
+   }
+
+   substitutes.clear();
+   if( substituteCheckBox->isChecked() )
+   {
+      foreach( Hop* hop, Database::instance().hops() )
+      {
+         if( ! hop->display() || hop->deleted() || hop->inventory() <= 0.0 )
+            continue;
+         substitutes.append(hop);
+         targets.substitutes.push_back(hop->calcInput());
+         targets.substituteStock_kg.push_back(hop->inventory());
+      }
+   }
+
+   result.clear();
+   resultSubstitute.clear();
+   pushButton_apply->setEnabled(false);
+   resultLabel->clear();
+   progressBar->setValue(0);
+
+   searchRun = optimizer->search(input, targets, options);
+   pushButton_search->setText(tr("Stop"));
+}
+
+void HopScheduleTool::searchProgress(int run, double done, double total, double perSecond)
+{
+   if( run != searchRun )
+      return;
+
+   progressBar->setValue( total > 0.0 ? qRound(1000.0 * done / total) : 1000 );
+   resultLabel->setText( tr("%L1 of %L2 schedules looked at or ruled out, %L3 a second")
+                         .arg(done, 0, 'f', 0)
+                         .arg(total, 0, 'f', 0)
+                         .arg(perSecond, 0, 'f', 0) );
+}
+
+void HopScheduleTool::searchFinished(int run)
+{
+   BrewCalc::Recipe out;
+   BrewCalc::Results results;
+   unsigned int i;
+
+   // A run from before the last reset() or search().
+   if( run != searchRun || static_cast<unsigned int>(hops.size()) != input.hops.size() )
+      return;
+   // searched() goes out just before the thread is done.
+   optimizer->wait();
+
+   pushButton_search->setText(tr("Search"));
+
+   if( optimizer->result().best.empty() )
+   {
+      resultLabel->setText(tr("No schedule gives those IBUs."));
+      return;
+   }
+
+   result = BrewCalc::bestHops(optimizer->result(), input, targets, &resultSubstitute);
+   for( i = 0; i < result.size(); ++i )
+   {
+      tableWidget->item(i, AMOUNTCOL)->setText( Brewtarget::displayAmount(result[i].amount_kg, Units::kilograms) );
+      tableWidget->item(i, TIMECOL)->setText( Brewtarget::displayAmount(result[i].time_min, Units::minutes, 0) );
+      tableWidget->item(i, HOPCOL)->setText( resultSubstitute[i] >= 0 ? substitutes[resultSubstitute[i]]->name() : hops[i]->name() );
+   }
+
+   out = input;
+   out.hops = result;
+   results = BrewCalc::calculate(out, options);
+   resultLabel->setText( tr("Gives %1 IBU, %2 BU:GU")
+                         .arg(results.IBU, 0, 'f', 1)
+                         .arg(gravityUnits > 0.0 ? results.IBU / gravityUnits : 0.0, 0, 'f', 2) );
+   pushButton_apply->setEnabled(true);
+}
+
+void HopScheduleTool::apply()
+{
+   unsigned int i;
+
+   if( ! recObs || result.size() != static_cast<unsigned int>(hops.size()) )
+      return;
+
+   // The recipe recalculates once, in finishBatch(), not after every swap.
+   Database::instance().startBatch();
+   for( i = 0; i < result.size(); ++i )
+   {
+      Hop* hop = hops[i];
+
+      // A substitute goes in as a new child of the inventory hop, and the
+      // hop it stands in for comes out, so both keep their parents.
+      if( resultSubstitute[i] >= 0 )
+      {
+         QList<Hop*> before = recObs->hops();
+         Hop* added = 0;
+
+         Database::instance().addToRecipe(recObs, substitutes[resultSubstitute[i]]);
+         foreach( Hop* h, recObs->hops() )
+         {
+            if( ! before.contains(h) )
+            {
+               added = h;
+               break;
+            }
+         }
+         if( ! added )
+            continue;
+
+         added->setUse(hop->use());
+         added->setAmount_kg(result[i].amount_kg);
+         added->setTime_min(result[i].time_min);
+         Database::instance().removeFromRecipe(recObs, hop);
+         continue;
+      }
+
+      if( result[i].amount_kg != input.hops[i].amount_kg )
+         hop->setAmount_kg(result[i].amount_kg);
+      if( result[i].time_min != input.hops[i].time_min )
+         hop->setTime_min(result[i].time_min);
+   }
+   Database::instance().finishBatch();
+
+   // The recipe has moved on, so the schedule is no longer an edit of it.
+   reset();
+}
@@ -0,0 +1,133 @@
+/*
+ * HopScheduleTool.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOPSCHEDULETOOL_H
+#define _HOPSCHEDULETOOL_H
+
+class HopScheduleTool;
+
+#include <QDialog>
+#include <QWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QProgressBar>
+#include <QTableWidget>
+#include <QList>
+#include <QEvent>
+#include <QShowEvent>
+#include <vector>
+#include "BrewCalc.h"
+
+// Forward declarations
+class Recipe;
+class Hop;
+class HopOptimizer;
+
+/*!
+ * \class HopScheduleTool
+ * \author agent
+ *
+ * \brief Dialog that searches for hop amounts and times that hit a target
+ * IBU or BU:GU, and a split between the additions.
+ *
+ * The search runs in a \b HopOptimizer, so the dialog stays live and
+ * "Stop" keeps the best schedule found so far. "Apply" writes every
+ * change to the recipe's hops in one batch.
+ */
+class HopScheduleTool : public QDialog
+{
+   Q_OBJECT
+public:
+
+   HopScheduleTool(QWidget* parent=0);
+   virtual ~HopScheduleTool();
+   //! \brief Set the observed \c Recipe
+   void setRecipe(Recipe* rec);
+
+   //! \name Public UI Variables
+   //! @{
+   QLabel* ibuLabel;
+   QDoubleSpinBox* ibuSpinBox;
+   QLabel* buguLabel;
+   QDoubleSpinBox* buguSpinBox;
+   QLabel* windowLabel;
+   QSpinBox* windowSpinBox;
+   QCheckBox* substituteCheckBox;
+   QTableWidget* tableWidget;
+   QProgressBar* progressBar;
+   QLabel* resultLabel;
+   QPushButton* pushButton_search;
+   QPushButton* pushButton_apply;
+   QPushButton* pushButton_close;
+   //! @}
+
+public slots:
+   //! \brief Start a search, or stop the one running.
+   void search();
+   //! \brief Write the schedule found to the recipe's hops.
+   void apply();
+   //! \brief Start over from what the recipe has now.
+   void reset();
+
+private slots:
+   void ibuChanged(double ibu);
+   void buguChanged(double bugu);
+   void searchProgress(int run, double done, double total, double perSecond);
+   void searchFinished(int run);
+
+protected:
+
+   virtual void changeEvent(QEvent* event)
+   {
+      if(event->type() == QEvent::LanguageChange)
+         retranslateUi();
+      QDialog::changeEvent(event);
+   }
+
+   virtual void showEvent(QShowEvent* event);
+
+private:
+
+   enum { NAMECOL, USECOL, PERCENTCOL, AMOUNTCOL, TIMECOL, HOPCOL, NUMCOLS };
+
+   void doLayout();
+   void retranslateUi();
+
+   Recipe* recObs;
+   QList<Hop*> hops;
+   //! \brief The inventory hops in \c targets.substitutes, in the same order.
+   QList<Hop*> substitutes;
+   HopOptimizer* optimizer;
+   //! \brief The optimizer's run for the recipe as it is now, or 0 for none.
+   int searchRun;
+   BrewCalc::Recipe input;
+   BrewCalc::Options options;
+   BrewCalc::HopTargets targets;
+   std::vector<BrewCalc::Hop> result;
+   std::vector<int> resultSubstitute;
+   //! \brief Gravity units of the recipe, to turn IBUs into BU:GU.
+   double gravityUnits;
+   //! \brief True while one spin box sets the other.
+   bool linking;
+};
+
+#endif /*_HOPSCHEDULETOOL_H*/
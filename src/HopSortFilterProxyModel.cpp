@@ -37,32 +37,24 @@ bool HopSortFilterProxyModel::lessThan(const QModelIndex &left,
     QVariant leftHop = sourceModel()->data(left);
     QVariant rightHop = sourceModel()->data(right);
     QStringList uses = QStringList() << "Dry Hop" << "Aroma" << "Boil" << "First Wort" << "Mash";
+    // The model hands numbers back in SI under Qt::UserRole.
+    double lValue = sourceModel()->data(left, Qt::UserRole).toDouble();
+    double rValue = sourceModel()->data(right, Qt::UserRole).toDouble();
     QModelIndex lSibling, rSibling;
     int lUse, rUse;
-    double lAlpha, rAlpha;
-    bool ok = false;
-    Unit* unit = Units::kilograms;
 
    switch( left.column() )
    {
       case HOPALPHACOL:
-         lAlpha = Brewtarget::toDouble(leftHop.toString(), &ok );
-         if ( ! ok )
-            Brewtarget::logW( QString("HopSortFilterProxyModel::lessThan() could not convert %1 to double").arg(leftHop.toString()));
-
-         rAlpha = Brewtarget::toDouble(rightHop.toString(), &ok );
-         if ( ! ok )
-            Brewtarget::logW( QString("HopSortFilterProxyModel::lessThan() could not convert %1 to double").arg(rightHop.toString()));
-
-         return lAlpha < rAlpha;
+         return lValue < rValue;
 
       case HOPINVENTORYCOL:
-         if (Brewtarget::qStringToSI(leftHop.toString(), unit) == 0.0 && this->sortOrder() == Qt::AscendingOrder)
+         if (lValue == 0.0 && this->sortOrder() == Qt::AscendingOrder)
             return false;
          else
-            return Brewtarget::qStringToSI(leftHop.toString(),unit) < Brewtarget::qStringToSI(rightHop.toString(),unit);
+            return lValue < rValue;
       case HOPAMOUNTCOL:
-         return Brewtarget::qStringToSI(leftHop.toString(),unit) < Brewtarget::qStringToSI(rightHop.toString(),unit);
+         return lValue < rValue;
       case HOPTIMECOL:
         // Get the indexes of the Use column
         lSibling = left.sibling(left.row(), HOPUSECOL);
@@ -74,7 +66,7 @@ bool HopSortFilterProxyModel::lessThan(const QModelIndex &left,
         rUse = uses.indexOf( (sourceModel()->data(rSibling)).toString() );
 
         if ( lUse == rUse )
-            return Brewtarget::qStringToSI(leftHop.toString(),unit) < Brewtarget::qStringToSI(rightHop.toString(),unit);
+            return lValue < rValue;
 
         return lUse < rUse;
     }
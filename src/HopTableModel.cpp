@@ -47,7 +47,9 @@ HopTableModel::HopTableModel(QTableView* parent, bool editable)
      _inventoryEditable(false),
      recObs(0),
      parentTableWidget(parent),
-     showIBUs(false)
+     showIBUs(false),
+     _paged(false),
+     _displayCache(HOPNUMCOLS)
 {
    hopObs.clear();
    setObjectName("hopTable");
@@ -102,7 +104,13 @@ void HopTableModel::observeDatabase(bool val)
       removeAll();
       connect( &(Database::instance()), SIGNAL(newHopSignal(Hop*)), this, SLOT(addHop(Hop*)) );
       connect( &(Database::instance()), SIGNAL(deletedHopSignal(Hop*)), this, SLOT(removeHop(Hop*)) );
-      addHops( Database::instance().hops() );
+      if( _paged )
+      {
+         _unfetched = Database::instance().hopsByName(_nameFilter);
+         fetchMore();
+      }
+      else
+         addHops( Database::instance().hops() );
    }
    else
    {
@@ -115,6 +123,8 @@ void HopTableModel::addHop(Hop* hop)
 {
    if( hop == 0 || hopObs.contains(hop) )
       return;
+   // It may not have been listed yet.
+   _unfetched.removeOne(hop);
 
    // If we are observing the database, ensure that the item is undeleted and
    // fit to display.
@@ -162,6 +172,8 @@ void HopTableModel::addHops(QList<Hop*> hops)
 bool HopTableModel::removeHop(Hop* hop)
 {
    int i;
+   _unfetched.removeOne(hop);
+   _displayCache.remove(hop);
    i = hopObs.indexOf(hop);
    if( i >= 0 )
    {
@@ -184,6 +196,8 @@ void HopTableModel::setShowIBUs( bool var )
 
 void HopTableModel::removeAll()
 {
+   _unfetched.clear();
+   _displayCache.clear();
    if (hopObs.size())
    {
       beginRemoveRows( QModelIndex(), 0, hopObs.size()-1 );
@@ -195,6 +209,50 @@ void HopTableModel::removeAll()
    }
 }
 
+void HopTableModel::setPaged( bool var )
+{
+   _paged = var;
+}
+
+void HopTableModel::setNameFilter( QString const& text )
+{
+   if( text == _nameFilter )
+      return;
+
+   _nameFilter = text;
+   if( _paged && recObs == 0 )
+   {
+      removeAll();
+      _unfetched = Database::instance().hopsByName(_nameFilter);
+      fetchMore();
+   }
+}
+
+bool HopTableModel::canFetchMore( const QModelIndex& parent ) const
+{
+   return !parent.isValid() && !_unfetched.isEmpty();
+}
+
+void HopTableModel::fetchMore( const QModelIndex& parent )
+{
+   int i, size, n;
+
+   if( parent.isValid() || _unfetched.isEmpty() )
+      return;
+
+   // Nothing in _unfetched is listed yet, so no need to check for repeats.
+   size = hopObs.size();
+   n = qMin(pageSize, _unfetched.size());
+   beginInsertRows( QModelIndex(), size, size+n-1 );
+   for( i = 0; i < n; ++i )
+   {
+      Hop* item = _unfetched.takeFirst();
+      hopObs.append(item);
+      connect( item, SIGNAL(changed(QMetaProperty,QVariant)), this, SLOT(changed(QMetaProperty,QVariant)) );
+   }
+   endInsertRows();
+}
+
 void HopTableModel::changed(QMetaProperty prop, QVariant /*val*/)
 {
    int i;
@@ -203,6 +261,8 @@ void HopTableModel::changed(QMetaProperty prop, QVariant /*val*/)
    Hop* hopSender = qobject_cast<Hop*>(sender());
    if( hopSender )
    {
+      _displayCache.remove(hopSender);
+
       i = hopObs.indexOf(hopSender);
       if( i < 0 )
          return;
@@ -241,9 +301,7 @@ int HopTableModel::columnCount(const QModelIndex& /*parent*/) const
 QVariant HopTableModel::data( const QModelIndex& index, int role ) const
 {
    Hop* row;
-   int col = index.column();
-   Unit::unitScale scale;
-   Unit::unitDisplay unit;
+   QVariant* cell;
 
    // Ensure the row is ok.
    if( index.row() >= (int)hopObs.size() )
@@ -254,7 +312,24 @@ QVariant HopTableModel::data( const QModelIndex& index, int role ) const
    else
       row = hopObs[index.row()];
 
-   switch( index.column() )
+   // Inventory is left out. See DisplayCache.
+   if( index.column() == HOPINVENTORYCOL )
+      return uncachedData(row, index.column(), role);
+
+   cell = _displayCache.cell(row, index.column(), role);
+   if( cell == 0 )
+      return uncachedData(row, index.column(), role);
+   if( !cell->isValid() )
+      *cell = uncachedData(row, index.column(), role);
+   return *cell;
+}
+
+QVariant HopTableModel::uncachedData( Hop* row, int col, int role ) const
+{
+   Unit::unitScale scale;
+   Unit::unitDisplay unit;
+
+   switch( col )
    {
       case HOPNAMECOL:
          if( role == Qt::DisplayRole )
@@ -264,10 +339,14 @@ QVariant HopTableModel::data( const QModelIndex& index, int role ) const
       case HOPALPHACOL:
          if( role == Qt::DisplayRole )
             return QVariant( Brewtarget::displayAmount(row->alpha_pct(), 0) );
+         else if( role == Qt::UserRole )
+            return QVariant(row->alpha_pct());
          else
             return QVariant();
       case HOPINVENTORYCOL:
-         if( role != Qt::DisplayRole )
+         if( role == Qt::UserRole )
+            return QVariant(row->inventory());
+         else if( role != Qt::DisplayRole )
             return QVariant();
          unit = displayUnit(col);
          scale = displayScale(col);
@@ -275,7 +354,9 @@ QVariant HopTableModel::data( const QModelIndex& index, int role ) const
          return QVariant(Brewtarget::displayAmount(row->inventory(), Units::kilograms, 3, unit, scale));
 
       case HOPAMOUNTCOL:
-         if( role != Qt::DisplayRole )
+         if( role == Qt::UserRole )
+            return QVariant(row->amount_kg());
+         else if( role != Qt::DisplayRole )
             return QVariant();
          unit = displayUnit(col);
          scale = displayScale(col);
@@ -290,7 +371,9 @@ QVariant HopTableModel::data( const QModelIndex& index, int role ) const
          else
             return QVariant();
       case HOPTIMECOL:
-         if( role != Qt::DisplayRole )
+         if( role == Qt::UserRole )
+            return QVariant(row->time_min());
+         else if( role != Qt::DisplayRole )
             return QVariant();
 
          scale = displayScale(col);
@@ -304,7 +387,7 @@ QVariant HopTableModel::data( const QModelIndex& index, int role ) const
         else
            return QVariant();
       default :
-         Brewtarget::logW(QString("HopTableModel::data Bad column: %1").arg(index.column()));
+         Brewtarget::logW(QString("HopTableModel::data Bad column: %1").arg(col));
          return QVariant();
    }
 }
@@ -36,6 +36,7 @@ class HopItemDelegate;
 #include <QVector>
 #include "hop.h"
 #include "recipe.h"
+#include "DisplayCache.h"
 
 enum{HOPNAMECOL, HOPALPHACOL, HOPAMOUNTCOL, HOPINVENTORYCOL, HOPFORMCOL, HOPUSECOL, HOPTIMECOL, HOPNUMCOLS /*This one MUST be last*/};
 
@@ -65,6 +66,17 @@ public:
    Hop* getHop(int i);
    //! \brief Clear the model.
    void removeAll();
+
+   /*!
+    * \brief If true, observeDatabase() lists the database a page at a time.
+    *
+    * Only the first page is listed at first, and \b fetchMore() adds the
+    * rest as the view scrolls down. Rows are not connected to until they are
+    * listed, and sorting only sorts what is listed so far.
+    */
+   void setPaged( bool var );
+   //! \brief When paged, only list hops whose names contain \c text.
+   void setNameFilter( QString const& text );
    
    /*!
     * \brief True if the inventory column should be editable, false otherwise.
@@ -85,6 +97,10 @@ public:
    virtual Qt::ItemFlags flags(const QModelIndex& index ) const;
    //! \brief Reimplemented from QAbstractTableModel.
    virtual bool setData( const QModelIndex& index, const QVariant& value, int role = Qt::EditRole );
+   //! \brief Reimplemented from QAbstractTableModel.
+   virtual bool canFetchMore( const QModelIndex& parent = QModelIndex() ) const;
+   //! \brief Reimplemented from QAbstractTableModel.
+   virtual void fetchMore( const QModelIndex& parent = QModelIndex() );
    
    // Stuff for setting display units and scales -- per cell first, then by
    // column
@@ -112,6 +128,17 @@ private:
    Recipe* recObs;
    QTableView* parentTableWidget;
    bool showIBUs; // True if you want to show the IBU contributions in the table rows.
+
+   //! \brief Rows listed by each \b fetchMore().
+   static int const pageSize = 200;
+   bool _paged;
+   QString _nameFilter;
+   //! \brief What is left to list, when paged.
+   QList<Hop*> _unfetched;
+
+   //! \brief Work out what \b data() returns for \c row, without the cache.
+   QVariant uncachedData( Hop* row, int col, int role ) const;
+   mutable DisplayCache<Hop> _displayCache;
 };
 
 /*!
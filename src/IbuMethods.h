@@ -20,6 +20,8 @@
 #ifndef _IBUMETHODS_H
 #define _IBUMETHODS_H
 
+#include "BrewCalc.h"
+
 /*!
  * \class IbuMethods
  * \author Philip G. Lee
@@ -41,16 +43,9 @@ public:
     * \param minutes - minutes that the hops are in the boil
     */
    static double getIbus(double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes);
-private:
-   static double tinseth(double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes);
-   static double rager(double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes);
 
-   /*!
-    * \author Daniel Pettersson (pettson81@gmail.com)
-    *
-    * \brief Calculates the IBU by Greg Noonans formula
-    */
-   static double noonan(double AARating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes);
+   //! \return the selected algorithm, for \c BrewCalc.
+   static BrewCalc::IbuFormula formula();
 };
 
 #endif
@@ -0,0 +1,143 @@
+/*
+ * LibraryRecalculator.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LibraryRecalculator.h"
+#include "recipe.h"
+#include "database.h"
+#include "RecipeFormatter.h"
+#include <QRunnable>
+
+//! Calculates one recipe.
+class LibraryRecalculator::Job : public QRunnable
+{
+public:
+   Job( LibraryRecalculator* owner, int i )
+      : _owner(owner), _i(i)
+   {
+   }
+
+   void run()
+   {
+      _owner->calculate(_i);
+   }
+
+private:
+   LibraryRecalculator* _owner;
+   int _i;
+};
+
+LibraryRecalculator::LibraryRecalculator( QObject* parent )
+   : QThread(parent),
+     _done(0),
+     _cancelled(0),
+     _run(0)
+{
+}
+
+LibraryRecalculator::~LibraryRecalculator()
+{
+   cancel();
+   wait();
+}
+
+int LibraryRecalculator::recalculate( QList<Recipe*> const& recs, int threads )
+{
+   cancel();
+   wait();
+
+   _recs = recs;
+   // Read here, since the recipes and the options live in the main thread.
+   _inputs.clear();
+   _inputs.reserve(recs.size());
+   _versions.clear();
+   _versions.reserve(recs.size());
+   foreach( Recipe* rec, recs )
+   {
+      _inputs.push_back(rec->calcInput());
+      _versions.push_back(RecipeFormatter::elementVersion(rec, true));
+   }
+   _opts = Recipe::calcOptions();
+   _pool.setMaxThreadCount( threads > 0 ? threads : QThread::idealThreadCount() );
+   _results.assign(recs.size(), BrewCalc::Results());
+   _calculated.assign(recs.size(), 0);
+   _done.storeRelease(0);
+   _cancelled.storeRelease(0);
+   ++_run;
+   start(QThread::LowPriority);
+   return _run;
+}
+
+void LibraryRecalculator::cancel()
+{
+   _cancelled.storeRelease(1);
+}
+
+void LibraryRecalculator::calculate( int i )
+{
+   if( !_cancelled.loadAcquire() )
+   {
+      _results[i] = BrewCalc::calculate(_inputs[i], _opts);
+      _calculated[i] = 1;
+   }
+   _done.ref();
+}
+
+void LibraryRecalculator::run()
+{
+   int i;
+   // recalculate() waits for us before it changes _run again.
+   int run = _run;
+
+   for( i = 0; i < _recs.size(); ++i )
+      _pool.start( new Job(this, i) );
+
+   while( !_pool.waitForDone(100) )
+      emit progress(_done.loadAcquire(), _recs.size());
+   emit progress(_recs.size(), _recs.size());
+   emit recalculated(run);
+}
+
+int LibraryRecalculator::apply( int run )
+{
+   int i;
+   int ret = 0;
+   int stamp;
+
+   // A run that was superseded, or a signal queued before it was.
+   if( run != _run )
+      return 0;
+
+   // The pool is done once recalculated() is out, even if the thread is not.
+   stamp = BrewCalc::calcStamp(_opts);
+
+   Database::instance().startBatch();
+   for( i = 0; i < _recs.size(); ++i )
+   {
+      // Edited since it was read, so it already has newer statistics.
+      if( !_calculated[i] || RecipeFormatter::elementVersion(_recs[i], true) != _versions[i] )
+         continue;
+      _recs[i]->setCalcResults(_results[i], stamp);
+      ++ret;
+   }
+   Database::instance().finishBatch();
+
+   // Only once.
+   _calculated.assign(_calculated.size(), 0);
+   return ret;
+}
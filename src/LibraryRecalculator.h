@@ -0,0 +1,105 @@
+/*
+ * LibraryRecalculator.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LIBRARYRECALCULATOR_H
+#define _LIBRARYRECALCULATOR_H
+
+class LibraryRecalculator;
+
+#include <QThread>
+#include <QThreadPool>
+#include <QList>
+#include <QAtomicInt>
+#include <vector>
+#include "BrewCalc.h"
+
+class Recipe;
+
+/*!
+ * \class LibraryRecalculator
+ * \author agent
+ *
+ * \brief Recalculates the statistics of many recipes at once, for when
+ * the calculation options change.
+ *
+ * Each recipe is read into a \b BrewCalc::Recipe on the main thread, and
+ * only \b BrewCalc::calculate() runs on the pool, so the workers touch
+ * neither the recipes nor the database. \b apply() hands the results to
+ * the recipes from the main thread and writes their og/fg in one
+ * transaction. Recipes edited during the run already recalculated
+ * themselves, so they are left alone.
+ */
+class LibraryRecalculator : public QThread
+{
+   Q_OBJECT
+
+public:
+   LibraryRecalculator( QObject* parent = 0 );
+   virtual ~LibraryRecalculator();
+
+   /*!
+    * \brief Start on \c recs with the options as they are now. Cancels and
+    * waits for any run that has not finished. Only from the main thread.
+    * \param threads is the most threads to use. 0 picks one per core.
+    * \returns the number of this run, as \b recalculated() will give it.
+    */
+   int recalculate( QList<Recipe*> const& recs, int threads = 0 );
+   //! \brief Skip the recipes not started yet. Never blocks.
+   void cancel();
+   /*!
+    * \brief Give each recipe its new statistics. Only from the main thread,
+    * once \b recalculated() has been emitted for \c run. Never blocks.
+    * \returns how many recipes were recalculated, or 0 if \c run is not
+    * the latest one.
+    */
+   int apply( int run );
+
+signals:
+   //! \brief Emitted from the worker thread a few times a second, so connect it queued.
+   void progress( int done, int total );
+   //! \brief Emitted from the worker thread once every recipe of \c run is done.
+   void recalculated( int run );
+
+protected:
+   virtual void run();
+
+private:
+   class Job;
+
+   //! \brief Calculate recipe \c i. Called from the pool.
+   void calculate( int i );
+
+   QList<Recipe*> _recs;
+   //! \brief One per recipe, read before the run starts.
+   std::vector<BrewCalc::Recipe> _inputs;
+   //! \brief Change version of each recipe and its parts when it was read.
+   std::vector<unsigned int> _versions;
+   BrewCalc::Options _opts;
+   //! \brief Kept from run to run, so its threads are too.
+   QThreadPool _pool;
+   //! \brief One per recipe, each written by only one worker.
+   std::vector<BrewCalc::Results> _results;
+   std::vector<char> _calculated;
+   QAtomicInt _done;
+   QAtomicInt _cancelled;
+   //! \brief Number of the latest run. Only changed while no run is going.
+   int _run;
+};
+
+#endif /*_LIBRARYRECALCULATOR_H*/
@@ -0,0 +1,278 @@
+/*
+ * Logger.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Logger.h"
+#include <QMutexLocker>
+#include <iostream>
+
+Logger::Logger( QObject* parent )
+   : QThread(parent),
+     _head(0),
+     _tail(0),
+     _dropped(0),
+     _stopping(0),
+     _stopped(0),
+     _stream(0),
+     _repeats(0),
+     _windowCount(0),
+     _suppressed(0)
+{
+   int i;
+   for( i = 0; i < ringSize; ++i )
+      _slots[i].seq.store(i);
+}
+
+Logger::~Logger()
+{
+   stop();
+}
+
+bool Logger::post( QString const& line )
+{
+   Slot* slot;
+   int pos;
+
+   // Once stopped, nobody is left to write it for us.
+   if( _stopped.loadAcquire() )
+   {
+      QMutexLocker locker(&_writeMutex);
+      write(line);
+      writeNotes();
+      std::cerr.flush();
+      return true;
+   }
+
+   // Claim a free slot by moving the tail past it. Other threads may be
+   // claiming too, so retry until our compare-and-swap wins.
+   pos = _tail.load();
+   for(;;)
+   {
+      slot = &_slots[pos & (ringSize-1)];
+      int diff = slot->seq.loadAcquire() - pos;
+      if( diff == 0 )
+      {
+         if( _tail.testAndSetRelaxed(pos, pos+1) )
+            break;
+         pos = _tail.load();
+      }
+      else if( diff < 0 )
+      {
+         // The writer has not caught up with this lap yet.
+         _dropped.fetchAndAddRelaxed(1);
+         return false;
+      }
+      else
+         pos = _tail.load();
+   }
+
+   slot->line = line;
+   // Ordered, so that either stop() sees the line or we see _stopped.
+   slot->seq.fetchAndStoreOrdered(pos+1);
+
+   // stop() may have had its last look before we published.
+   if( _stopped.loadAcquire() )
+   {
+      QMutexLocker locker(&_writeMutex);
+      QString last;
+      drain(&last);
+      writeNotes();
+      std::cerr.flush();
+      return true;
+   }
+
+   _ready.release();
+   return true;
+}
+
+bool Logger::take( QString* line )
+{
+   int pos = _head.load();
+   Slot& slot = _slots[pos & (ringSize-1)];
+
+   if( slot.seq.loadAcquire() != pos+1 )
+      return false;
+
+   *line = slot.line;
+   slot.line = QString();
+   // Free for the next lap.
+   slot.seq.storeRelease(pos + ringSize);
+   _head.storeRelease(pos+1);
+   return true;
+}
+
+int Logger::drain( QString* last )
+{
+   QString line;
+   int n = 0;
+
+   while( take(&line) )
+   {
+      write(line);
+      *last = line;
+      ++n;
+   }
+
+   return n;
+}
+
+void Logger::run()
+{
+   QString last;
+   int n;
+   bool notesDue = false;
+
+   for(;;)
+   {
+      // Repeats are only noted once they stop coming, so while some are
+      // waiting, wake up after a while even if nothing is posted.
+      if( notesDue )
+         _ready.tryAcquire(1, 100);
+      else
+         _ready.acquire();
+      // Each permit's line is already in the ring, so one pass takes them all.
+      _ready.tryAcquire(_ready.available());
+
+      // Read this first, so that everything posted before stop() is drained.
+      bool stopping = _stopping.loadAcquire();
+
+      {
+         QMutexLocker locker(&_writeMutex);
+         n = drain(&last);
+         if( n == 0 || stopping )
+            writeNotes();
+         notesDue = _repeats > 0 || _suppressed > 0;
+         std::cerr.flush();
+         if( _stream )
+            _stream->flush();
+         _drained.wakeAll();
+      }
+
+      if( n > 0 )
+         emit statusMessage(last, 3000);
+
+      if( stopping )
+         break;
+   }
+}
+
+void Logger::flush()
+{
+   QMutexLocker locker(&_writeMutex);
+
+   // The writer takes lines only with the mutex, and wakes us after each
+   // batch. The timeout covers it stopping meanwhile.
+   while( isRunning() && _head.loadAcquire() != _tail.loadAcquire() )
+      _drained.wait(&_writeMutex, 100);
+
+   writeNotes();
+   std::cerr.flush();
+   if( _stream )
+      _stream->flush();
+}
+
+void Logger::stop()
+{
+   QString last;
+
+   if( isRunning() )
+   {
+      _stopping.storeRelease(1);
+      _ready.release();
+      wait();
+   }
+   // Ordered, so that either we see a line posted meanwhile or its post() sees this.
+   _stopped.fetchAndStoreOrdered(1);
+
+   // Anything that came in after the writer's last look.
+   QMutexLocker locker(&_writeMutex);
+   drain(&last);
+   writeNotes();
+   std::cerr.flush();
+   if( _stream )
+      _stream->flush();
+}
+
+void Logger::setStream( QTextStream* stream )
+{
+   QMutexLocker locker(&_writeMutex);
+
+   if( _stream )
+      _stream->flush();
+   _stream = stream;
+}
+
+void Logger::write( QString const& line )
+{
+   if( line == _lastLine )
+   {
+      ++_repeats;
+      return;
+   }
+   if( _repeats > 0 )
+   {
+      writeLine(QString("(last message repeated %1 more times)").arg(_repeats));
+      _repeats = 0;
+   }
+   _lastLine = line;
+
+   if( !_window.isValid() || _window.elapsed() >= 1000 )
+   {
+      if( _suppressed > 0 )
+         writeLine(QString("(%1 messages suppressed)").arg(_suppressed));
+      _window.start();
+      _windowCount = 0;
+      _suppressed = 0;
+   }
+
+   if( _windowCount >= maxPerSecond )
+   {
+      ++_suppressed;
+      return;
+   }
+   ++_windowCount;
+   writeLine(line);
+}
+
+void Logger::writeLine( QString const& line )
+{
+   // No std::endl, which would flush every line.
+   std::cerr << line.toUtf8().constData() << '\n';
+   if( _stream )
+      *_stream << line << "\n";
+}
+
+void Logger::writeNotes()
+{
+   int dropped = _dropped.fetchAndStoreRelaxed(0);
+
+   if( _repeats > 0 )
+   {
+      writeLine(QString("(last message repeated %1 more times)").arg(_repeats));
+      _repeats = 0;
+      // A later copy of the same line is news again.
+      _lastLine = QString();
+   }
+   if( _suppressed > 0 && _window.isValid() && _window.elapsed() >= 1000 )
+   {
+      writeLine(QString("(%1 messages suppressed)").arg(_suppressed));
+      _suppressed = 0;
+   }
+   if( dropped > 0 )
+      writeLine(QString("(%1 messages dropped, the log could not keep up)").arg(dropped));
+}
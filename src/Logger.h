@@ -0,0 +1,119 @@
+/*
+ * Logger.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LOGGER_H
+#define _LOGGER_H
+
+class Logger;
+
+#include <QThread>
+#include <QString>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QSemaphore>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+/*!
+ * \class Logger
+ * \author agent
+ *
+ * \brief Writes log lines to stderr and the log file from its own thread.
+ *
+ * \b post() puts a line in a fixed-size ring and returns without waiting
+ * for the writer, so any thread can log from a hot path. The writer thread
+ * sleeps until lines are posted, then empties the ring in batches, flushing
+ * once per batch. It folds runs of the same
+ * line into one "repeated" note, and writes at most \b maxPerSecond lines
+ * a second, counting the rest. If the ring is full, lines are dropped and
+ * counted too. The last line of each batch goes out through
+ * \b statusMessage(), which a queued connection carries to the status bar.
+ */
+class Logger : public QThread
+{
+   Q_OBJECT
+
+public:
+   Logger( QObject* parent = 0 );
+   virtual ~Logger();
+
+   //! \brief Queue \c line. Never blocks. \returns false if the ring was full.
+   bool post( QString const& line );
+   //! \brief Wait until everything posted so far is written.
+   void flush();
+   //! \brief Write what is left and stop the thread. Later lines are written at once.
+   void stop();
+   //! \brief Also write to \c stream, or only to stderr if 0.
+   void setStream( QTextStream* stream );
+
+   //! \brief Lines written each second before the rest are counted instead.
+   static int const maxPerSecond = 200;
+
+signals:
+   //! \brief Emitted from the writer thread, so connect it queued.
+   void statusMessage( QString const& message, int timeout );
+
+protected:
+   virtual void run();
+
+private:
+   //! \brief Must be a power of 2.
+   static int const ringSize = 4096;
+
+   struct Slot
+   {
+      // Equal to its position when free, one more when full.
+      QAtomicInt seq;
+      QString line;
+   };
+
+   //! \brief Take the oldest line. Only the writer may call this.
+   bool take( QString* line );
+   //! \brief Take and write everything in the ring. Needs \b _writeMutex.
+   int drain( QString* last );
+   //! \brief Write one line, subject to repeats and the rate limit. Needs \b _writeMutex.
+   void write( QString const& line );
+   //! \brief Write one line as is. Needs \b _writeMutex.
+   void writeLine( QString const& line );
+   //! \brief Write the notes about repeated, suppressed and dropped lines. Needs \b _writeMutex.
+   void writeNotes();
+
+   Slot _slots[ringSize];
+   QAtomicInt _head;
+   QAtomicInt _tail;
+   QAtomicInt _dropped;
+   QAtomicInt _stopping;
+   QAtomicInt _stopped;
+   //! \brief One permit per line posted, and one from \b stop(), to wake the writer.
+   QSemaphore _ready;
+
+   // Everything below belongs to whoever holds the mutex.
+   QMutex _writeMutex;
+   //! \brief Woken by the writer after each batch, for \b flush().
+   QWaitCondition _drained;
+   QTextStream* _stream;
+   QString _lastLine;
+   int _repeats;
+   QElapsedTimer _window;
+   int _windowCount;
+   int _suppressed;
+};
+
+#endif /*_LOGGER_H*/
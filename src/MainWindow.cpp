@@ -78,6 +78,12 @@
 #include "config.h"
 #include "unit.h"
 #include "ScaleRecipeTool.h"
+#include "GrainBillTool.h"
+#include "HopScheduleTool.h"
+#include "StyleAuditTool.h"
+#include "SimilarRecipesDialog.h"
+#include "SimilarRecipes.h"
+#include "LibraryRecalculator.h"
 #include "HopTableModel.h"
 #include "BtDigitWidget.h"
 #include "FermentableTableModel.h"
@@ -115,15 +121,28 @@
 #include "StyleSortFilterProxyModel.h"
 #include "NamedMashEditor.h"
 #include "BtDatePopup.h"
+#include "SqlProfiler.h"
+#include "StartupTrace.h"
+#include <QShortcut>
 #if defined(Q_OS_WIN)
    #include <windows.h>
 #endif
 
+//! \brief Make \c dialog the first time it is wanted.
+template<class T> static T* lazy( T*& dialog, MainWindow* parent )
+{
+   if( !dialog )
+      dialog = new T(parent);
+   return dialog;
+}
+
 MainWindow::MainWindow(QWidget* parent)
         : QMainWindow(parent)
 {
    // Need to call this to get all the widgets added (I think).
+   StartupTrace::Scope uiScope("MainWindow::setupUi");
    setupUi(this);
+   uiScope.end();
 
    /* PLEASE DO NOT REMOVE. 
     This code is left here, commented out, intentionally. The only way I can
@@ -137,7 +156,10 @@ MainWindow::MainWindow(QWidget* parent)
    QDesktopWidget *desktop = QApplication::desktop();
 
    // Ensure database initializes.
-   Database::instance();
+   {
+      StartupTrace::Scope dbScope("Database::instance");
+      Database::instance();
+   }
 
    // Set the window title.
    setWindowTitle( QString("Brewtarget - %1").arg(VERSIONSTRING) );
@@ -156,34 +178,50 @@ MainWindow::MainWindow(QWidget* parent)
    // Null out the recipe
    recipeObs = 0;
 
-   dialog_about = new AboutDialog(this);
-   equipEditor = new EquipmentEditor(this);
-   singleEquipEditor = new EquipmentEditor(this, true);
-   fermDialog = new FermentableDialog(this);
-   fermEditor = new FermentableEditor(this);
-   hopDialog = new HopDialog(this);
-   hopEditor = new HopEditor(this);
-   mashEditor = new MashEditor(this);
-   mashStepEditor = new MashStepEditor(this);
-   mashWizard = new MashWizard(this);
-   miscDialog = new MiscDialog(this);
-   miscEditor = new MiscEditor(this);
-   styleEditor = new StyleEditor(this);
-   singleStyleEditor = new StyleEditor(this,true);
-   yeastDialog = new YeastDialog(this);
-   yeastEditor = new YeastEditor(this);
-   optionDialog = new OptionDialog(this);
-   recipeScaler = new ScaleRecipeTool(this);
-   recipeFormatter = new RecipeFormatter(this);
-   ogAdjuster = new OgAdjuster(this);
-   converterTool = new ConverterTool(this);
-   timerListDialog = new TimerListDialog(this);
-   primingDialog = new PrimingDialog(this);
-   strikeWaterDialog = new StrikeWaterDialog(this);
-   refractoDialog = new RefractoDialog(this);
-   mashDesigner = new MashDesigner(this);
-   pitchDialog = new PitchDialog(this);
-   btDatePopup = new BtDatePopup(this);
+   recStyle = 0;
+   recEquip = 0;
+
+   // The dialogs and editors are made the first time they are shown. Most
+   // of them fill models from the whole database, and there is no reason to
+   // pay for that before the window is up.
+   dialog_about = 0;
+   equipEditor = 0;
+   singleEquipEditor = 0;
+   fermDialog = 0;
+   fermEditor = 0;
+   hopDialog = 0;
+   hopEditor = 0;
+   mashEditor = 0;
+   mashStepEditor = 0;
+   mashWizard = 0;
+   miscDialog = 0;
+   miscEditor = 0;
+   styleEditor = 0;
+   singleStyleEditor = 0;
+   yeastDialog = 0;
+   yeastEditor = 0;
+   optionDialog = 0;
+   recipeScaler = 0;
+   grainBillTool = 0;
+   hopScheduleTool = 0;
+   styleAuditTool = 0;
+   similarRecipesDialog = 0;
+   similarRecipes = 0;
+   libraryRecalculator = 0;
+   libraryRecalcRun = 0;
+   recipeFormatter = 0;
+   ogAdjuster = 0;
+   converterTool = 0;
+   timerListDialog = 0;
+   primingDialog = 0;
+   strikeWaterDialog = 0;
+   refractoDialog = 0;
+   mashDesigner = 0;
+   pitchDialog = 0;
+   btDatePopup = 0;
+   namedMashEditor = 0;
+   // I don't think this is used yet
+   singleNamedMashEditor = 0;
 
    styleRangeWidget_og->setRange(1.000, 1.120);
    styleRangeWidget_og->setPrecision(3);
@@ -232,6 +270,7 @@ MainWindow::MainWindow(QWidget* parent)
    }
 
    // Set equipment combo box model.
+   StartupTrace::Scope modelScope("MainWindow models");
    equipmentListModel = new EquipmentListModel(equipmentComboBox);
    equipmentComboBox->setModel(equipmentListModel);
 
@@ -246,11 +285,6 @@ MainWindow::MainWindow(QWidget* parent)
    mashListModel =  new MashListModel(mashComboBox);
    mashComboBox->setModel(mashListModel);
 
-   // Nothing to say.
-   namedMashEditor = new NamedMashEditor(this, mashStepEditor);
-   // I don't think this is used yet
-   singleNamedMashEditor = new NamedMashEditor(this,mashStepEditor,true);
-
    // Set table models.
    // Fermentables
    fermTableModel = new FermentableTableModel(fermentableTable);
@@ -302,6 +336,7 @@ MainWindow::MainWindow(QWidget* parent)
    yeastTable->horizontalHeader()->setSortIndicator( YEASTNAMECOL, Qt::DescendingOrder );
    yeastTable->setSortingEnabled(true);
    yeastTableProxy->setDynamicSortFilter(true);
+   modelScope.end();
 
    // Create the keyboard shortcuts
    setupShortCuts();
@@ -328,7 +363,9 @@ MainWindow::MainWindow(QWidget* parent)
    splitter_2->setStretchFactor(1,1);
 
    // Once more with the context menus too
+   StartupTrace::Scope menuScope("MainWindow::setupContextMenu");
    setupContextMenu();
+   menuScope.end();
 
    // If we saved a size the last time we ran, use it
    if ( Brewtarget::hasOption("geometry"))
@@ -346,6 +383,7 @@ MainWindow::MainWindow(QWidget* parent)
    }
 
    // If we saved the selected recipe name the last time we ran, select it and show it.
+   StartupTrace::Scope recipeScope("MainWindow::setRecipe");
    if (Brewtarget::hasOption("recipeKey"))
    {
       int key = Brewtarget::option("recipeKey").toInt();
@@ -361,36 +399,48 @@ MainWindow::MainWindow(QWidget* parent)
       if( recs.size() > 0 )
          setRecipe( recs[0] );
    }
+   recipeScope.end();
+
+   // Bring the statistics the recipe tree shows up to date, in case the
+   // options or the math changed since they were stored.
+   recalculateLibrary();
+
+   // Index the library for finding similar recipes, whenever there is nothing else to do.
+   similarRecipes = new SimilarRecipes(this);
+   similarRecipes->build();
 
    // Connect signals.
    // actions
    connect( actionExit, SIGNAL( triggered() ), this, SLOT( close() ) );
-   connect( actionAbout_BrewTarget, SIGNAL( triggered() ), dialog_about, SLOT( show() ) );
+   connect( actionAbout_BrewTarget, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
    connect( actionNewRecipe, SIGNAL( triggered() ), this, SLOT( newRecipe() ) );
    connect( actionImport_Recipes, SIGNAL( triggered() ), this, SLOT( importFiles() ) );
    connect( actionExportRecipe, SIGNAL( triggered() ), this, SLOT( exportRecipe() ) );
-   connect( actionEquipments, SIGNAL( triggered() ), equipEditor, SLOT( show() ) );
-   connect( actionMashs, SIGNAL( triggered() ), namedMashEditor, SLOT( show() ) );
-   connect( actionStyles, SIGNAL( triggered() ), styleEditor, SLOT( show() ) );
-   connect( actionFermentables, SIGNAL( triggered() ), fermDialog, SLOT( show() ) );
-   connect( actionHops, SIGNAL( triggered() ), hopDialog, SLOT( show() ) );
-   connect( actionMiscs, SIGNAL( triggered() ), miscDialog, SLOT( show() ) );
-   connect( actionYeasts, SIGNAL( triggered() ), yeastDialog, SLOT( show() ) );
-   connect( actionOptions, SIGNAL( triggered() ), optionDialog, SLOT( show() ) );
+   connect( actionEquipments, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionMashs, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionStyles, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionFermentables, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionHops, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionMiscs, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionYeasts, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionOptions, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
    connect( actionManual, SIGNAL( triggered() ), this, SLOT( openManual() ) );
-   connect( actionScale_Recipe, SIGNAL( triggered() ), recipeScaler, SLOT( show() ) );
-   connect( action_recipeToTextClipboard, SIGNAL( triggered() ), recipeFormatter, SLOT( toTextClipboard() ) );
-   connect( actionConvert_Units, SIGNAL( triggered() ), converterTool, SLOT( show() ) );
-   connect( actionOG_Correction_Help, SIGNAL( triggered() ), ogAdjuster, SLOT( show() ) );
+   connect( actionScale_Recipe, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionGrain_Bill, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionHop_Schedule, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionStyle_Audit, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( action_recipeToTextClipboard, SIGNAL( triggered() ), this, SLOT( recipeToTextClipboard() ) );
+   connect( actionConvert_Units, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionOG_Correction_Help, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
    connect( actionBackup_Database, SIGNAL( triggered() ), this, SLOT( backup() ) );
    connect( actionRestore_Database, SIGNAL( triggered() ), this, SLOT( restoreFromBackup() ) );
    connect( actionCopy_Recipe, SIGNAL( triggered() ), this, SLOT( copyRecipe() ) );
-   connect( actionPriming_Calculator, SIGNAL( triggered() ), primingDialog, SLOT( show() ) );
-   connect( actionStrikeWater_Calculator, SIGNAL( triggered() ), strikeWaterDialog, SLOT( show() ) );
-   connect( actionRefractometer_Tools, SIGNAL( triggered() ), refractoDialog, SLOT( show() ) );
+   connect( actionPriming_Calculator, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionStrikeWater_Calculator, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
+   connect( actionRefractometer_Tools, SIGNAL( triggered() ), this, SLOT( showDialog() ) );
    connect( actionPitch_Rate_Calculator, SIGNAL(triggered()), this, SLOT(showPitchDialog()));
    connect( actionMergeDatabases, SIGNAL(triggered()), this, SLOT(updateDatabase()) );
-   connect( actionTimers, SIGNAL(triggered()), timerListDialog, SLOT(show()) );
+   connect( actionTimers, SIGNAL(triggered()), this, SLOT(showDialog()) );
    connect( actionDeleteSelected, SIGNAL(triggered()), this, SLOT(deleteSelected()) );
    connect( actionSave, SIGNAL(triggered()), this, SLOT(save()) );
 
@@ -419,17 +469,17 @@ MainWindow::MainWindow(QWidget* parent)
    connect( styleButton, SIGNAL( clicked() ), this, SLOT(showStyleEditor()) );
 
    connect( mashComboBox, SIGNAL( activated(int) ), this, SLOT(updateRecipeMash()) );
-   connect( mashButton, SIGNAL( clicked() ), mashEditor, SLOT( showEditor() ) );
+   connect( mashButton, SIGNAL( clicked() ), this, SLOT( showMashEditor() ) );
 
    connect( lineEdit_name, SIGNAL( editingFinished() ), this, SLOT( updateRecipeName() ) );
    connect( lineEdit_batchSize, SIGNAL( textModified() ), this, SLOT( updateRecipeBatchSize() ) );
    connect( lineEdit_boilSize, SIGNAL( textModified() ), this, SLOT( updateRecipeBoilSize() ) );
    connect( lineEdit_boilTime, SIGNAL( textModified() ), this, SLOT( updateRecipeBoilTime() ) );
    connect( lineEdit_efficiency, SIGNAL( textModified() ), this, SLOT( updateRecipeEfficiency() ) );
-   connect( pushButton_addFerm, SIGNAL( clicked() ), fermDialog, SLOT( show() ) );
-   connect( pushButton_addHop, SIGNAL( clicked() ), hopDialog, SLOT( show() ) );
-   connect( pushButton_addMisc, SIGNAL( clicked() ), miscDialog, SLOT( show() ) );
-   connect( pushButton_addYeast, SIGNAL( clicked() ), yeastDialog, SLOT( show() ) );
+   connect( pushButton_addFerm, SIGNAL( clicked() ), this, SLOT( showDialog() ) );
+   connect( pushButton_addHop, SIGNAL( clicked() ), this, SLOT( showDialog() ) );
+   connect( pushButton_addMisc, SIGNAL( clicked() ), this, SLOT( showDialog() ) );
+   connect( pushButton_addYeast, SIGNAL( clicked() ), this, SLOT( showDialog() ) );
    connect( pushButton_removeFerm, SIGNAL( clicked() ), this, SLOT( removeSelectedFermentable() ) );
    connect( pushButton_removeHop, SIGNAL( clicked() ), this, SLOT( removeSelectedHop() ) );
    connect( pushButton_removeMisc, SIGNAL( clicked() ), this, SLOT( removeSelectedMisc() ) );
@@ -438,13 +488,13 @@ MainWindow::MainWindow(QWidget* parent)
    connect( pushButton_editMisc, SIGNAL( clicked() ), this, SLOT( editSelectedMisc() ) );
    connect( pushButton_editHop, SIGNAL( clicked() ), this, SLOT( editSelectedHop() ) );
    connect( pushButton_editYeast, SIGNAL( clicked() ), this, SLOT( editSelectedYeast() ) );
-   connect( pushButton_editMash, SIGNAL( clicked() ), mashEditor, SLOT( showEditor() ) );
+   connect( pushButton_editMash, SIGNAL( clicked() ), this, SLOT( showMashEditor() ) );
    connect( pushButton_addMashStep, SIGNAL( clicked() ), this, SLOT(addMashStep()) );
    connect( pushButton_removeMashStep, SIGNAL( clicked() ), this, SLOT(removeSelectedMashStep()) );
    connect( pushButton_editMashStep, SIGNAL( clicked() ), this, SLOT(editSelectedMashStep()) );
-   connect( pushButton_mashWizard, SIGNAL( clicked() ), mashWizard, SLOT( show() ) );
+   connect( pushButton_mashWizard, SIGNAL( clicked() ), this, SLOT( showDialog() ) );
    connect( pushButton_saveMash, SIGNAL( clicked() ), this, SLOT( saveMash() ) );
-   connect( pushButton_mashDes, SIGNAL( clicked() ), mashDesigner, SLOT( show() ) );
+   connect( pushButton_mashDes, SIGNAL( clicked() ), this, SLOT( showDialog() ) );
    connect( pushButton_mashUp, SIGNAL( clicked() ), this, SLOT( moveSelectedMashStepUp() ) );
    connect( pushButton_mashDown, SIGNAL( clicked() ), this, SLOT( moveSelectedMashStepDown() ) );
    connect( pushButton_mashRemove, SIGNAL( clicked() ), this, SLOT( removeMash() ) );
@@ -469,6 +519,278 @@ void MainWindow::setupShortCuts()
    actionCopy_Recipe->setShortcut(QKeySequence::Copy);
    actionSave->setShortcut(QKeySequence::Save);
    actionDeleteSelected->setShortcut(QKeySequence::Delete);
+
+   // Only with --sql-profile, to see what one action costs.
+   if( SqlProfiler::enabled() )
+   {
+      QShortcut* profile = new QShortcut(QKeySequence("Ctrl+Shift+F12"), this);
+      connect( profile, SIGNAL(activated()), this, SLOT(logSqlProfile()) );
+   }
+}
+
+void MainWindow::logSqlProfile()
+{
+   SqlProfiler::logReport();
+   SqlProfiler::reset();
+}
+
+void MainWindow::recalculateLibrary()
+{
+   QList<Recipe*> stale;
+   int stamp = Recipe::currentCalcStamp();
+
+   // Recipes stored with the current options are already right.
+   foreach( Recipe* rec, Database::instance().recipes() )
+   {
+      if( rec->storedStats().calcStamp != stamp )
+         stale.append(rec);
+   }
+   if( stale.isEmpty() )
+      return;
+
+   if( !libraryRecalculator )
+   {
+      libraryRecalculator = new LibraryRecalculator(this);
+      connect( libraryRecalculator, SIGNAL(progress(int,int)), this, SLOT(libraryRecalcProgress(int,int)) );
+      connect( libraryRecalculator, SIGNAL(recalculated(int)), this, SLOT(libraryRecalcFinished(int)) );
+   }
+
+   libraryRecalcRun = libraryRecalculator->recalculate( stale );
+}
+
+void MainWindow::libraryRecalcProgress(int done, int total)
+{
+   statusBar()->showMessage( tr("Recalculating recipes: %1 of %2").arg(done).arg(total) );
+}
+
+void MainWindow::libraryRecalcFinished(int run)
+{
+   int n;
+
+   // A newer run is going, and will report itself.
+   if( run != libraryRecalcRun )
+      return;
+
+   n = libraryRecalculator->apply(run);
+   statusBar()->showMessage( tr("Recalculated %1 recipes").arg(n), 3000 );
+}
+
+EquipmentEditor* MainWindow::getSingleEquipEditor()
+{
+   if( !singleEquipEditor )
+   {
+      singleEquipEditor = new EquipmentEditor(this, true);
+      singleEquipEditor->setEquipment(recEquip);
+   }
+   return singleEquipEditor;
+}
+
+StyleEditor* MainWindow::getSingleStyleEditor()
+{
+   if( !singleStyleEditor )
+   {
+      singleStyleEditor = new StyleEditor(this, true);
+      singleStyleEditor->setStyle(recStyle);
+   }
+   return singleStyleEditor;
+}
+
+MashStepEditor* MainWindow::getMashStepEditor()
+{
+   return lazy(mashStepEditor, this);
+}
+
+NamedMashEditor* MainWindow::getNamedMashEditor()
+{
+   if( !namedMashEditor )
+      namedMashEditor = new NamedMashEditor(this, getMashStepEditor());
+   return namedMashEditor;
+}
+
+MashEditor* MainWindow::getMashEditor()
+{
+   if( !mashEditor )
+   {
+      mashEditor = new MashEditor(this);
+      if( recipeObs )
+         mashEditor->setMash(recipeObs->mash());
+      mashEditor->setEquipment(recEquip);
+   }
+   return mashEditor;
+}
+
+MashWizard* MainWindow::getMashWizard()
+{
+   if( !mashWizard )
+   {
+      mashWizard = new MashWizard(this);
+      mashWizard->setRecipe(recipeObs);
+   }
+   return mashWizard;
+}
+
+MashDesigner* MainWindow::getMashDesigner()
+{
+   if( !mashDesigner )
+   {
+      mashDesigner = new MashDesigner(this);
+      mashDesigner->setRecipe(recipeObs);
+   }
+   return mashDesigner;
+}
+
+RecipeFormatter* MainWindow::getRecipeFormatter()
+{
+   if( !recipeFormatter )
+   {
+      recipeFormatter = new RecipeFormatter(this);
+      recipeFormatter->setRecipe(recipeObs);
+   }
+   return recipeFormatter;
+}
+
+OgAdjuster* MainWindow::getOgAdjuster()
+{
+   if( !ogAdjuster )
+   {
+      ogAdjuster = new OgAdjuster(this);
+      ogAdjuster->setRecipe(recipeObs);
+   }
+   return ogAdjuster;
+}
+
+ScaleRecipeTool* MainWindow::getRecipeScaler()
+{
+   if( !recipeScaler )
+   {
+      recipeScaler = new ScaleRecipeTool(this);
+      recipeScaler->setRecipe(recipeObs);
+   }
+   return recipeScaler;
+}
+
+GrainBillTool* MainWindow::getGrainBillTool()
+{
+   if( !grainBillTool )
+   {
+      grainBillTool = new GrainBillTool(this);
+      grainBillTool->setRecipe(recipeObs);
+   }
+   return grainBillTool;
+}
+
+HopScheduleTool* MainWindow::getHopScheduleTool()
+{
+   if( !hopScheduleTool )
+   {
+      hopScheduleTool = new HopScheduleTool(this);
+      hopScheduleTool->setRecipe(recipeObs);
+   }
+   return hopScheduleTool;
+}
+
+SimilarRecipesDialog* MainWindow::getSimilarRecipesDialog()
+{
+   if( !similarRecipesDialog )
+   {
+      similarRecipesDialog = new SimilarRecipesDialog(similarRecipes, this);
+      connect( similarRecipesDialog, SIGNAL(recipeChosen(Recipe*)), this, SLOT(setRecipe(Recipe*)) );
+   }
+   return similarRecipesDialog;
+}
+
+void MainWindow::showDialog()
+{
+   QObject* selection = sender();
+   QWidget* dialog = 0;
+
+   if( selection == actionAbout_BrewTarget )
+      dialog = lazy(dialog_about, this);
+   else if( selection == actionEquipments )
+      dialog = lazy(equipEditor, this);
+   else if( selection == actionMashs )
+      dialog = getNamedMashEditor();
+   else if( selection == actionStyles )
+      dialog = lazy(styleEditor, this);
+   else if( selection == actionFermentables || selection == pushButton_addFerm )
+      dialog = lazy(fermDialog, this);
+   else if( selection == actionHops || selection == pushButton_addHop )
+      dialog = lazy(hopDialog, this);
+   else if( selection == actionMiscs || selection == pushButton_addMisc )
+      dialog = lazy(miscDialog, this);
+   else if( selection == actionYeasts || selection == pushButton_addYeast )
+      dialog = lazy(yeastDialog, this);
+   else if( selection == actionOptions )
+      dialog = lazy(optionDialog, this);
+   else if( selection == actionScale_Recipe )
+      dialog = getRecipeScaler();
+   else if( selection == actionGrain_Bill )
+      dialog = getGrainBillTool();
+   else if( selection == actionHop_Schedule )
+      dialog = getHopScheduleTool();
+   else if( selection == actionStyle_Audit )
+      dialog = lazy(styleAuditTool, this);
+   else if( selection == actionConvert_Units )
+      dialog = lazy(converterTool, this);
+   else if( selection == actionOG_Correction_Help )
+      dialog = getOgAdjuster();
+   else if( selection == actionPriming_Calculator )
+      dialog = lazy(primingDialog, this);
+   else if( selection == actionStrikeWater_Calculator )
+      dialog = lazy(strikeWaterDialog, this);
+   else if( selection == actionRefractometer_Tools )
+      dialog = lazy(refractoDialog, this);
+   else if( selection == actionTimers )
+      dialog = lazy(timerListDialog, this);
+   else if( selection == pushButton_mashWizard )
+      dialog = getMashWizard();
+   else if( selection == pushButton_mashDes )
+      dialog = getMashDesigner();
+
+   // Some dialogs hide QWidget::show() with a slot of their own, so call
+   // it the way the signal would have.
+   if( dialog )
+      QMetaObject::invokeMethod(dialog, "show");
+}
+
+void MainWindow::showMashEditor()
+{
+   getMashEditor()->showEditor();
+}
+
+void MainWindow::recipeToTextClipboard()
+{
+   getRecipeFormatter()->toTextClipboard();
+}
+
+void MainWindow::newEquipment()
+{
+   lazy(equipEditor, this)->newEquipment();
+}
+
+void MainWindow::newFermentable()
+{
+   lazy(fermDialog, this)->newFermentable();
+}
+
+void MainWindow::newHop()
+{
+   lazy(hopDialog, this)->newHop();
+}
+
+void MainWindow::newMisc()
+{
+   lazy(miscDialog, this)->newMisc();
+}
+
+void MainWindow::newStyle()
+{
+   getSingleStyleEditor()->newStyle();
+}
+
+void MainWindow::newYeast()
+{
+   lazy(yeastDialog, this)->newYeast();
 }
 
 void MainWindow::deleteSelected()
@@ -524,7 +846,7 @@ void MainWindow::treeActivated(const QModelIndex &index)
          kit = active->equipment(index);
          if ( kit )
          {
-            singleEquipEditor->setEquipment(kit);
+            getSingleEquipEditor()->setEquipment(kit);
             singleEquipEditor->show();
          }
          break;
@@ -532,7 +854,7 @@ void MainWindow::treeActivated(const QModelIndex &index)
          ferm = active->fermentable(index);
          if ( ferm )
          {
-            fermEditor->setFermentable(ferm);
+            lazy(fermEditor, this)->setFermentable(ferm);
             fermEditor->show();
          }
          break;
@@ -540,7 +862,7 @@ void MainWindow::treeActivated(const QModelIndex &index)
          h = active->hop(index);
          if (h)
          {
-            hopEditor->setHop(h);
+            lazy(hopEditor, this)->setHop(h);
             hopEditor->show();
          }
          break;
@@ -548,7 +870,7 @@ void MainWindow::treeActivated(const QModelIndex &index)
          m = active->misc(index);
          if (m)
          {
-            miscEditor->setMisc(m);
+            lazy(miscEditor, this)->setMisc(m);
             miscEditor->show();
          }
          break;
@@ -556,7 +878,7 @@ void MainWindow::treeActivated(const QModelIndex &index)
          s = active->style(index);
          if ( s )
          {
-            singleStyleEditor->setStyle(s);
+            getSingleStyleEditor()->setStyle(s);
             singleStyleEditor->show();
          }
          break;
@@ -564,7 +886,7 @@ void MainWindow::treeActivated(const QModelIndex &index)
          y = active->yeast(index);
          if (y)
          {
-            yeastEditor->setYeast(y);
+            lazy(yeastEditor, this)->setYeast(y);
             yeastEditor->show();
          }
          break;
@@ -704,23 +1026,38 @@ void MainWindow::setRecipe(Recipe* recipe)
    }
 
    // Tell some of our other widgets to observe the new recipe.
-   mashWizard->setRecipe(recipe);
+   // Dialogs not made yet will pick the recipe up when they are.
+   if( mashWizard )
+      mashWizard->setRecipe(recipe);
    brewDayScrollWidget->setRecipe(recipe);
    equipmentListModel->observeRecipe(recipe);
-   recipeFormatter->setRecipe(recipe);
-   ogAdjuster->setRecipe(recipe);
+   if( recipeFormatter )
+      recipeFormatter->setRecipe(recipe);
+   if( ogAdjuster )
+      ogAdjuster->setRecipe(recipe);
    recipeExtrasWidget->setRecipe(recipe);
-   mashDesigner->setRecipe(recipe);
+   if( mashDesigner )
+      mashDesigner->setRecipe(recipe);
    equipmentButton->setRecipe(recipe);
-   singleEquipEditor->setEquipment(recEquip);
+   if( singleEquipEditor )
+      singleEquipEditor->setEquipment(recEquip);
    styleButton->setRecipe(recipe);
-   singleStyleEditor->setStyle(recStyle);
+   if( singleStyleEditor )
+      singleStyleEditor->setStyle(recStyle);
 
-   mashEditor->setMash(recipeObs->mash());
-   mashEditor->setEquipment(recEquip);
+   if( mashEditor )
+   {
+      mashEditor->setMash(recipeObs->mash());
+      mashEditor->setEquipment(recEquip);
+   }
 
    mashButton->setMash(recipeObs->mash());
-   recipeScaler->setRecipe(recipeObs);
+   if( recipeScaler )
+      recipeScaler->setRecipe(recipeObs);
+   if( grainBillTool )
+      grainBillTool->setRecipe(recipeObs);
+   if( hopScheduleTool )
+      hopScheduleTool->setRecipe(recipeObs);
 
    // If you don't connect this late, every previous set of an attribute
    // causes this signal to be slotted, which then causes showChanges() to be
@@ -738,13 +1075,15 @@ void MainWindow::changed(QMetaProperty prop, QVariant value)
       Equipment* newRecEquip = qobject_cast<Equipment*>(BeerXMLElement::extractPtr(value));
       recEquip = newRecEquip;
 
-      singleEquipEditor->setEquipment(recEquip);
+      if( singleEquipEditor )
+         singleEquipEditor->setEquipment(recEquip);
    }
    else if( propName == "style" )
    {
       //recStyle = recipeObs->style();
       recStyle = qobject_cast<Style*>(BeerXMLElement::extractPtr(value));
-      singleStyleEditor->setStyle(recStyle);
+      if( singleStyleEditor )
+         singleStyleEditor->setStyle(recStyle);
 
    }
 
@@ -896,7 +1235,8 @@ void MainWindow::updateRecipeMash()
    if( selected )
    {
       Database::instance().addToRecipe( recipeObs, selected );
-      mashEditor->setMash(recipeObs->mash());
+      if( mashEditor )
+         mashEditor->setMash(recipeObs->mash());
       mashButton->setMash(recipeObs->mash());
    }
 }
@@ -938,7 +1278,8 @@ void MainWindow::droppedRecipeEquipment(Equipment *kit)
       recipeObs->setBatchSize_l( kit->batchSize_l() );
       recipeObs->setBoilSize_l( kit->boilSize_l() );
       recipeObs->setBoilTime_min( kit->boilTime_min() );
-      mashEditor->setEquipment(kit);
+      if( mashEditor )
+         mashEditor->setEquipment(kit);
    }
 }
 
@@ -1237,7 +1578,7 @@ void MainWindow::editSelectedFermentable()
    if( f == 0 )
       return;
 
-   fermEditor->setFermentable(f);
+   lazy(fermEditor, this)->setFermentable(f);
    fermEditor->show();
 }
 
@@ -1247,7 +1588,7 @@ void MainWindow::editSelectedMisc()
    if( m == 0 )
       return;
 
-   miscEditor->setMisc(m);
+   lazy(miscEditor, this)->setMisc(m);
    miscEditor->show();
 }
 
@@ -1257,7 +1598,7 @@ void MainWindow::editSelectedHop()
    if( h == 0 )
       return;
 
-   hopEditor->setHop(h);
+   lazy(hopEditor, this)->setHop(h);
    hopEditor->show();
 }
 
@@ -1267,7 +1608,7 @@ void MainWindow::editSelectedYeast()
    if( y == 0 )
       return;
 
-   yeastEditor->setYeast(y);
+   lazy(yeastEditor, this)->setYeast(y);
    yeastEditor->show();
 }
 
@@ -1535,68 +1876,30 @@ void MainWindow::setTreeSelection(QModelIndex item)
 void MainWindow::reduceInventory(){
 
    QModelIndexList indexes = treeView_recipe->selectionModel()->selectedRows();
-      QModelIndex bIndex;
+   QList<Recipe*> recs;
 
-      foreach(QModelIndex selected, indexes)
-      {
-         Recipe*   rec   = treeView_recipe->recipe(selected);
+   foreach(QModelIndex selected, indexes)
+   {
+      Recipe*   rec   = treeView_recipe->recipe(selected);
+      if( rec == 0 ){
+         //try the parent recipe
+         rec = treeView_recipe->recipe(treeView_recipe->parent(selected));
          if( rec == 0 ){
-            //try the parent recipe
-            rec = treeView_recipe->recipe(treeView_recipe->parent(selected));
-            if( rec == 0 ){
-               continue;
-            }
-         }
-
-         // Make sure everything is properly set and selected
-         if( rec != recipeObs )
-            setRecipe(rec);
-
-      int i = 0;
-      //reduce fermentables
-      QList<Fermentable*> flist = rec->fermentables();
-      if(flist.size() > 0){
-         for( i = 0; static_cast<int>(i) < flist.size(); ++i )
-         {
-            double newVal=flist[i]->inventory() - flist[i]->amount_kg();
-            newVal = (newVal < 0) ? 0 : newVal;
-            flist[i]->setInventoryAmount(newVal);
-         }
-      }
-
-      //reduce misc
-      QList<Misc*> mlist = rec->miscs();
-      if(mlist.size() > 0){
-         for( i = 0; static_cast<int>(i) < mlist.size(); ++i )
-         {
-            double newVal=mlist[i]->inventory() - mlist[i]->amount();
-            newVal = (newVal < 0) ? 0 : newVal;
-            mlist[i]->setInventoryAmount(newVal);
-         }
-      }
-      //reduce hops
-      QList<Hop*> hlist = rec->hops();
-      if(hlist.size() > 0){
-         for( i = 0; static_cast<int>(i) < hlist.size(); ++i )
-         {
-            double newVal = hlist[i]->inventory() - hlist[i]->amount_kg();
-            newVal = (newVal < 0) ? 0 : newVal;
-            hlist[i]->setInventoryAmount(newVal);
-         }
-      }
-      //reduce yeast
-      QList<Yeast*> ylist = rec->yeasts();
-      if(ylist.size() > 0){
-         for( i = 0; static_cast<int>(i) < ylist.size(); ++i )
-         {
-            //Yeast inventory is done by quanta not amount
-            int newVal = ylist[i]->inventory() - 1;
-            newVal = (newVal < 0) ? 0 : newVal;
-            ylist[i]->setInventoryQuanta(newVal);
+            continue;
          }
       }
+      recs.append(rec);
    }
 
+   if( recs.isEmpty() )
+      return;
+
+   // Make sure everything is properly set and selected
+   if( recs.last() != recipeObs )
+      setRecipe(recs.last());
+
+   // Reduce everything in one go instead of a write per ingredient.
+   Database::instance().reduceInventory(recs);
 }
 
 // Need to make sure the recipe tree is active, I think
@@ -1658,6 +1961,25 @@ void MainWindow::brewItHelper()
    reduceInventory();
 }
 
+void MainWindow::showSimilarRecipes()
+{
+   QModelIndexList indexes = treeView_recipe->selectionModel()->selectedRows();
+   Recipe* rec = 0;
+
+   foreach(QModelIndex selected, indexes)
+   {
+      rec = treeView_recipe->recipe(selected);
+      if( rec )
+         break;
+   }
+
+   if( rec == 0 )
+      return;
+
+   getSimilarRecipesDialog()->setRecipe(rec);
+   getSimilarRecipesDialog()->show();
+}
+
 void MainWindow::brewAgainHelper()
 {
    reBrewNote();
@@ -1733,7 +2055,7 @@ void MainWindow::addMashStep()
    }
 
    MashStep* step = Database::instance().newMashStep(mash);
-   mashStepEditor->setMashStep(step);
+   getMashStepEditor()->setMashStep(step);
    mashStepEditor->setVisible(true);
 }
 
@@ -1835,7 +2157,7 @@ void MainWindow::editSelectedMashStep()
    }
 
    MashStep* step = mashStepTableModel->getMashStep(row);
-   mashStepEditor->setMashStep(step);
+   getMashStepEditor()->setMashStep(step);
    mashStepEditor->setVisible(true);
 }
 
@@ -1956,12 +2278,12 @@ void MainWindow::print()
    if ( selection == actionRecipePrint || selection == actionBrewdayPrint )
    {
       QPrintDialog printerDialog(printer, this);
-      selection == actionRecipePrint ?  recipeFormatter->print( printer, &printerDialog, RecipeFormatter::PRINT) :
+      selection == actionRecipePrint ?  getRecipeFormatter()->print( printer, &printerDialog, RecipeFormatter::PRINT) :
                                         brewDayScrollWidget->print( printer, &printerDialog, BrewDayScrollWidget::PRINT);
    }
    else if ( selection == actionRecipePreview )
    {
-      recipeFormatter->print(printer, 0, RecipeFormatter::PREVIEW);
+      getRecipeFormatter()->print(printer, 0, RecipeFormatter::PREVIEW);
    }
    else if ( selection == actionBrewdayPreview )
    {
@@ -1973,13 +2295,13 @@ void MainWindow::print()
 
       if (! outfile )
          return;
-      selection == actionRecipeHTML ? recipeFormatter->print(printer, 0, RecipeFormatter::HTML, outfile) :
+      selection == actionRecipeHTML ? getRecipeFormatter()->print(printer, 0, RecipeFormatter::HTML, outfile) :
                                       brewDayScrollWidget->print(printer, 0, BrewDayScrollWidget::HTML, outfile);
       delete outfile;
    }
    else if ( selection == actionRecipeBBCode )
    {
-      QApplication::clipboard()->setText(recipeFormatter->getBBCodeFormat());
+      QApplication::clipboard()->setText(getRecipeFormatter()->getBBCodeFormat());
    }
 }
 
@@ -2016,13 +2338,14 @@ void MainWindow::setupContextMenu()
 {
 
    treeView_recipe->setupContextMenu(this,this);
-   treeView_equip->setupContextMenu(this,equipEditor);
+   // The "New" actions come back here, so the dialogs need not exist yet.
+   treeView_equip->setupContextMenu(this,this);
 
-   treeView_ferm->setupContextMenu(this,fermDialog);
-   treeView_hops->setupContextMenu(this,hopDialog);
-   treeView_misc->setupContextMenu(this,miscDialog);
-   treeView_style->setupContextMenu(this,singleStyleEditor);
-   treeView_yeast->setupContextMenu(this,yeastDialog);
+   treeView_ferm->setupContextMenu(this,this);
+   treeView_hops->setupContextMenu(this,this);
+   treeView_misc->setupContextMenu(this,this);
+   treeView_style->setupContextMenu(this,this);
+   treeView_yeast->setupContextMenu(this,this);
 
    // TreeView for clicks, both double and right
    connect( treeView_recipe, SIGNAL(doubleClicked(const QModelIndex &)), this, SLOT(treeActivated(const QModelIndex &)));
@@ -2246,6 +2569,8 @@ void MainWindow::redisplayLabel(Unit::unitDisplay oldUnit, Unit::unitScale oldSc
 
 void MainWindow::showPitchDialog()
 {
+   lazy(pitchDialog, this);
+
    // First, copy the current recipe og and volume.
    if( recipeObs )
    {
@@ -2265,7 +2590,7 @@ void MainWindow::showEquipmentEditor()
    }
    else
    {
-      singleEquipEditor->show();
+      getSingleEquipEditor()->show();
    }
 }
 
@@ -2277,7 +2602,7 @@ void MainWindow::showStyleEditor()
    }
    else
    {
-      singleStyleEditor->show();
+      getSingleStyleEditor()->show();
    }
 }
 
@@ -2314,7 +2639,7 @@ void MainWindow::changeBrewDate()
          continue;
 
       // Pop the calendar, get the date.
-      if ( btDatePopup->exec() == QDialog::Accepted )
+      if ( lazy(btDatePopup, this)->exec() == QDialog::Accepted )
       {
          newDate = btDatePopup->selectedDate();
          target->setBrewDate(newDate);
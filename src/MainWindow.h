@@ -61,6 +61,12 @@ class MashWizard;
 class BrewDayScrollWidget;
 class HtmlViewer;
 class ScaleRecipeTool;
+class GrainBillTool;
+class HopScheduleTool;
+class StyleAuditTool;
+class SimilarRecipesDialog;
+class SimilarRecipes;
+class LibraryRecalculator;
 class RecipeFormatter;
 class OgAdjuster;
 class ConverterTool;
@@ -227,6 +233,8 @@ public slots:
    //! \brief copies an existing brewnote to a new brewday
    void reBrewNote();
    void brewItHelper();
+   //! \brief Shows the recipes most like the one selected in the tree.
+   void showSimilarRecipes();
    void brewAgainHelper();
    void reduceInventory();
    void changeBrewDate();
@@ -254,6 +262,9 @@ public slots:
    void droppedRecipeMisc(QList<Misc*>miscs);
    void droppedRecipeYeast(QList<Yeast*>yeasts);
 
+   //! \brief Recalculate, in the background, every recipe whose stored statistics are out of date.
+   void recalculateLibrary();
+
 protected:
    virtual void closeEvent(QCloseEvent* event);
 
@@ -268,6 +279,29 @@ private slots:
     */
    void showChanges(QMetaProperty* prop = 0);
 
+   //! \brief Log the query profile so far, and start over.
+   void logSqlProfile();
+
+   //! \brief Show how far \b recalculateLibrary() has got.
+   void libraryRecalcProgress(int done, int total);
+   //! \brief Hand the recipes their new statistics, unless \c run was superseded.
+   void libraryRecalcFinished(int run);
+
+   //! \brief Shows the right dialog, depending on the signal sender.
+   void showDialog();
+   //! \brief Show the mash editor for the current recipe's mash.
+   void showMashEditor();
+   //! \brief Copy the current recipe to the clipboard as text.
+   void recipeToTextClipboard();
+
+   //! \brief New ingredients from the tree context menus, via the dialogs.
+   void newEquipment();
+   void newFermentable();
+   void newHop();
+   void newMisc();
+   void newStyle();
+   void newYeast();
+
 private:
    Recipe* recipeObs;
    Style* recStyle;
@@ -297,6 +331,15 @@ private:
    OptionDialog* optionDialog;
    QDialog* brewDayDialog;
    ScaleRecipeTool* recipeScaler;
+   GrainBillTool* grainBillTool;
+   HopScheduleTool* hopScheduleTool;
+   StyleAuditTool* styleAuditTool;
+   SimilarRecipesDialog* similarRecipesDialog;
+   //! \brief Built at startup, so finding similar recipes never waits on the library.
+   SimilarRecipes* similarRecipes;
+   LibraryRecalculator* libraryRecalculator;
+   //! \brief The run of \b libraryRecalculator whose results we want.
+   int libraryRecalcRun;
    RecipeFormatter* recipeFormatter;
    OgAdjuster* ogAdjuster;
    ConverterTool* converterTool;
@@ -343,6 +386,24 @@ private:
    //! \brief Scroll to the given \c item in the currently visible item tree.
    void setTreeSelection(QModelIndex item);
 
+   /*!
+    * \brief Dialogs and editors are only made the first time they are
+    * needed. These make them, and catch them up with the current recipe.
+    */
+   EquipmentEditor* getSingleEquipEditor();
+   StyleEditor* getSingleStyleEditor();
+   MashStepEditor* getMashStepEditor();
+   NamedMashEditor* getNamedMashEditor();
+   MashEditor* getMashEditor();
+   MashWizard* getMashWizard();
+   MashDesigner* getMashDesigner();
+   RecipeFormatter* getRecipeFormatter();
+   OgAdjuster* getOgAdjuster();
+   ScaleRecipeTool* getRecipeScaler();
+   GrainBillTool* getGrainBillTool();
+   HopScheduleTool* getHopScheduleTool();
+   SimilarRecipesDialog* getSimilarRecipesDialog();
+
    //! \brief Set the keyboard shortcuts.
    void setupShortCuts();
    //! \brief Set the context menus.
@@ -42,6 +42,8 @@ MiscDialog::MiscDialog(MainWindow* parent) :
 
    miscTableModel = new MiscTableModel(tableWidget, false);
    miscTableModel->setInventoryEditable(true);
+   // Big catalogs are listed a page at a time, as the table scrolls.
+   miscTableModel->setPaged(true);
    miscTableProxy = new MiscSortFilterProxyModel(tableWidget);
    miscTableProxy->setSourceModel(miscTableModel);
    tableWidget->setModel(miscTableProxy);
@@ -215,6 +217,8 @@ void MiscDialog::newMisc()
 
 void MiscDialog::filterMisc(QString searchExpression)
 {
+    // Rows not listed yet are invisible to the proxy, so ask the database too.
+    miscTableModel->setNameFilter(searchExpression);
     miscTableProxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
     miscTableProxy->setFilterFixedString(searchExpression);
 }
@@ -36,23 +36,26 @@ bool MiscSortFilterProxyModel::lessThan(const QModelIndex &left,
 {
    QAbstractItemModel* source = sourceModel();
    QVariant leftMisc, rightMisc;
+   double lValue = 0.0, rValue = 0.0;
    if( source )
    {
       leftMisc = source->data(left);
       rightMisc = source->data(right);
+      // Numbers come back in SI under Qt::UserRole.
+      lValue = source->data(left, Qt::UserRole).toDouble();
+      rValue = source->data(right, Qt::UserRole).toDouble();
    }
 
    switch( left.column() )
    {
    case MISCINVENTORYCOL:
-         if (Brewtarget::qStringToSI(leftMisc.toString(), Units::kilograms) == 0.0 && this->sortOrder() == Qt::AscendingOrder)
+         if (lValue == 0.0 && this->sortOrder() == Qt::AscendingOrder)
             return false;
          else
-            return Brewtarget::qStringToSI(leftMisc.toString(), Units::kilograms) < Brewtarget::qStringToSI(rightMisc.toString(), Units::kilograms);
+            return lValue < rValue;
    case MISCAMOUNTCOL:
-         return Brewtarget::qStringToSI(leftMisc.toString(), Units::kilograms) < Brewtarget::qStringToSI(rightMisc.toString(), Units::kilograms);
    case MISCTIMECOL:
-      return Brewtarget::qStringToSI(leftMisc.toString(), Units::minutes) < Brewtarget::qStringToSI(rightMisc.toString(), Units::minutes);
+      return lValue < rValue;
     default:
       return leftMisc.toString() < rightMisc.toString();
    }
@@ -36,7 +36,9 @@ MiscTableModel::MiscTableModel(QTableView* parent, bool editable)
      editable(editable),
      _inventoryEditable(false),
      recObs(0),
-     parentTableWidget(parent)
+     parentTableWidget(parent),
+     _paged(false),
+     _displayCache(MISCNUMCOLS)
 {
    miscObs.clear();
    setObjectName("miscTableModel");
@@ -74,7 +76,13 @@ void MiscTableModel::observeDatabase(bool val)
       removeAll();
       connect( &(Database::instance()), SIGNAL(newMiscSignal(Misc*)), this, SLOT(addMisc(Misc*)) );
       connect( &(Database::instance()), SIGNAL(deletedMiscSignal(Misc*)), this, SLOT(removeMisc(Misc*)) );
-      addMiscs( Database::instance().miscs() );
+      if( _paged )
+      {
+         _unfetched = Database::instance().miscsByName(_nameFilter);
+         fetchMore();
+      }
+      else
+         addMiscs( Database::instance().miscs() );
    }
    else
    {
@@ -87,6 +95,8 @@ void MiscTableModel::addMisc(Misc* misc)
 {
    if( miscObs.contains(misc) )
       return;
+   // It may not have been listed yet.
+   _unfetched.removeOne(misc);
    // If we are observing the database, ensure that the item is undeleted and
    // fit to display.
    if(
@@ -135,6 +145,8 @@ bool MiscTableModel::removeMisc(Misc* misc)
 {
    int i;
 
+   _unfetched.removeOne(misc);
+   _displayCache.remove(misc);
    i = miscObs.indexOf(misc);
    if( i >= 0 )
    {
@@ -152,6 +164,8 @@ bool MiscTableModel::removeMisc(Misc* misc)
 
 void MiscTableModel::removeAll()
 {
+   _unfetched.clear();
+   _displayCache.clear();
    if (miscObs.size())
    {
       beginRemoveRows( QModelIndex(), 0, miscObs.size()-1 );
@@ -163,6 +177,50 @@ void MiscTableModel::removeAll()
    }
 }
 
+void MiscTableModel::setPaged( bool var )
+{
+   _paged = var;
+}
+
+void MiscTableModel::setNameFilter( QString const& text )
+{
+   if( text == _nameFilter )
+      return;
+
+   _nameFilter = text;
+   if( _paged && recObs == 0 )
+   {
+      removeAll();
+      _unfetched = Database::instance().miscsByName(_nameFilter);
+      fetchMore();
+   }
+}
+
+bool MiscTableModel::canFetchMore( const QModelIndex& parent ) const
+{
+   return !parent.isValid() && !_unfetched.isEmpty();
+}
+
+void MiscTableModel::fetchMore( const QModelIndex& parent )
+{
+   int i, size, n;
+
+   if( parent.isValid() || _unfetched.isEmpty() )
+      return;
+
+   // Nothing in _unfetched is listed yet, so no need to check for repeats.
+   size = miscObs.size();
+   n = qMin(pageSize, _unfetched.size());
+   beginInsertRows( QModelIndex(), size, size+n-1 );
+   for( i = 0; i < n; ++i )
+   {
+      Misc* item = _unfetched.takeFirst();
+      miscObs.append(item);
+      connect( item, SIGNAL(changed(QMetaProperty,QVariant)), this, SLOT(changed(QMetaProperty,QVariant)) );
+   }
+   endInsertRows();
+}
+
 int MiscTableModel::rowCount(const QModelIndex& /*parent*/) const
 {
    return miscObs.size();
@@ -176,8 +234,7 @@ int MiscTableModel::columnCount(const QModelIndex& /*parent*/) const
 QVariant MiscTableModel::data( const QModelIndex& index, int role ) const
 {
    Misc* row;
-   Unit::unitDisplay unit;
-   Unit::unitScale scale;
+   QVariant* cell;
 
    // Ensure the row is ok.
    if( index.row() >= (int)miscObs.size() )
@@ -188,8 +245,25 @@ QVariant MiscTableModel::data( const QModelIndex& index, int role ) const
    else
       row = miscObs[index.row()];
 
+   // Inventory is left out. See DisplayCache.
+   if( index.column() == MISCINVENTORYCOL )
+      return uncachedData(row, index.column(), role);
+
+   cell = _displayCache.cell(row, index.column(), role);
+   if( cell == 0 )
+      return uncachedData(row, index.column(), role);
+   if( !cell->isValid() )
+      *cell = uncachedData(row, index.column(), role);
+   return *cell;
+}
+
+QVariant MiscTableModel::uncachedData( Misc* row, int col, int role ) const
+{
+   Unit::unitDisplay unit;
+   Unit::unitScale scale;
+
    // Deal with the column and return the right data.
-   switch( index.column() )
+   switch( col )
    {
       case MISCNAMECOL:
          if( role == Qt::DisplayRole )
@@ -211,23 +285,29 @@ QVariant MiscTableModel::data( const QModelIndex& index, int role ) const
          else
             return QVariant();
       case MISCTIMECOL:
-         if( role != Qt::DisplayRole )
+         if( role == Qt::UserRole )
+            return QVariant(row->time());
+         else if( role != Qt::DisplayRole )
             return QVariant();
 
          scale = displayScale(MISCTIMECOL);
 
          return QVariant( Brewtarget::displayAmount(row->time(), Units::minutes, 0, Unit::noUnit, scale) );
       case MISCINVENTORYCOL:
-         if( role != Qt::DisplayRole )
+         if( role == Qt::UserRole )
+            return QVariant(row->inventory());
+         else if( role != Qt::DisplayRole )
             return QVariant();
 
-         unit = displayUnit(index.column());
+         unit = displayUnit(col);
          return QVariant( Brewtarget::displayAmount(row->inventory(), row->amountIsWeight()? (Unit*)Units::kilograms : (Unit*)Units::liters, 3, unit, Unit::noScale ) );
       case MISCAMOUNTCOL:
-         if( role != Qt::DisplayRole )
+         if( role == Qt::UserRole )
+            return QVariant(row->amount());
+         else if( role != Qt::DisplayRole )
             return QVariant();
 
-         unit = displayUnit(index.column());
+         unit = displayUnit(col);
          return QVariant( Brewtarget::displayAmount(row->amount(), row->amountIsWeight()? (Unit*)Units::kilograms : (Unit*)Units::liters, 3, unit, Unit::noScale ) );
 
       case MISCISWEIGHT:
@@ -238,7 +318,7 @@ QVariant MiscTableModel::data( const QModelIndex& index, int role ) const
          else
             return QVariant();
       default:
-         Brewtarget::logW(QString("Bad model index. column = %1").arg(index.column()));
+         Brewtarget::logW(QString("Bad model index. column = %1").arg(col));
    }
    return QVariant();
 }
@@ -367,6 +447,8 @@ void MiscTableModel::changed(QMetaProperty prop, QVariant /*val*/)
    Misc* miscSender = qobject_cast<Misc*>(sender());
    if( miscSender )
    {
+      _displayCache.remove(miscSender);
+
       i = miscObs.indexOf(miscSender);
       if( i < 0 )
          return;
@@ -38,6 +38,7 @@ class MiscItemDelegate;
 #include <QTableView>
 
 #include "unit.h"
+#include "DisplayCache.h"
 
 // Forward declarations.
 class Misc;
@@ -69,6 +70,17 @@ public:
    Misc* getMisc(unsigned int i);
    //! \brief Clear the model.
    void removeAll();
+
+   /*!
+    * \brief If true, observeDatabase() lists the database a page at a time.
+    *
+    * Only the first page is listed at first, and \b fetchMore() adds the
+    * rest as the view scrolls down. Rows are not connected to until they are
+    * listed, and sorting only sorts what is listed so far.
+    */
+   void setPaged( bool var );
+   //! \brief When paged, only list miscs whose names contain \c text.
+   void setNameFilter( QString const& text );
    
    /*!
     * \brief True if the inventory column should be editable, false otherwise.
@@ -89,6 +101,10 @@ public:
    virtual Qt::ItemFlags flags(const QModelIndex& index ) const;
    //! \brief Reimplemented from QAbstractTableModel
    virtual bool setData( const QModelIndex& index, const QVariant& value, int role = Qt::EditRole );
+   //! \brief Reimplemented from QAbstractTableModel.
+   virtual bool canFetchMore( const QModelIndex& parent = QModelIndex() ) const;
+   //! \brief Reimplemented from QAbstractTableModel.
+   virtual void fetchMore( const QModelIndex& parent = QModelIndex() );
 
    Unit::unitDisplay displayUnit(int column) const;
    Unit::unitScale displayScale(int column) const;
@@ -114,6 +130,17 @@ private:
    QList<Misc*> miscObs;
    Recipe* recObs;
    QTableView* parentTableWidget;
+
+   //! \brief Rows listed by each \b fetchMore().
+   static int const pageSize = 200;
+   bool _paged;
+   QString _nameFilter;
+   //! \brief What is left to list, when paged.
+   QList<Misc*> _unfetched;
+
+   //! \brief Work out what \b data() returns for \c row, without the cache.
+   QVariant uncachedData( Misc* row, int col, int role ) const;
+   mutable DisplayCache<Misc> _displayCache;
 };
 
 /*!
@@ -205,6 +205,8 @@ void OptionDialog::saveAndClose()
    Brewtarget::IbuType iformula;
    Brewtarget::ColorUnitType colorUnit;
    QString newUserDataDir;
+   bool recalculate;
+   double mashHop, firstWort;
 
    button = colorGroup->checkedButton();
    if( button == radioButton_mosher )
@@ -305,6 +307,14 @@ void OptionDialog::saveAndClose()
    else
       Brewtarget::dateFormat = Unit::displaySI;
 
+   // Every recipe's statistics depend on these.
+   mashHop = lineEdit_mashHop->toSI() / 100;
+   firstWort = lineEdit_firstWort->toSI() / 100;
+   recalculate = iformula != Brewtarget::ibuFormula
+              || cformula != Brewtarget::colorFormula
+              || mashHop != Brewtarget::option("mashHopAdjustment", 0).toDouble()
+              || firstWort != Brewtarget::option("firstWortHopAdjustment", 1.1).toDouble();
+
    Brewtarget::ibuFormula = iformula;
    Brewtarget::colorFormula = cformula;
    Brewtarget::weightUnitSystem = weightUnitSystem;
@@ -348,11 +358,15 @@ void OptionDialog::saveAndClose()
       );
    }
 
-   Brewtarget::setOption("mashHopAdjustment", lineEdit_mashHop->toSI() / 100);
-   Brewtarget::setOption("firstWortHopAdjustment", lineEdit_firstWort->toSI() / 100);
+   Brewtarget::setOption("mashHopAdjustment", mashHop);
+   Brewtarget::setOption("firstWortHopAdjustment", firstWort);
    // Make sure the main window updates.
    if( Brewtarget::mainWindow() )
+   {
       Brewtarget::mainWindow()->showChanges();
+      if( recalculate )
+         Brewtarget::mainWindow()->recalculateLibrary();
+   }
 
    setVisible(false);
 }
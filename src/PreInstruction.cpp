@@ -51,3 +51,13 @@ double PreInstruction::getTime()
 {
    return time;
 }
+
+QList<QString> PreInstruction::getReagents()
+{
+   return reagents;
+}
+
+void PreInstruction::addReagent(const QString& reagent)
+{
+   reagents.append(reagent);
+}
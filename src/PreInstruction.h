@@ -23,6 +23,7 @@
 class PreInstruction;
 
 #include <QString>
+#include <QList>
 
 /*!
  * \class PreInstruction
@@ -41,10 +42,14 @@ public:
    QString getText();
    QString getTitle();
    double getTime();
+   //! Reagents are carried over to the in-memory Instruction::reagents().
+   QList<QString> getReagents();
+   void addReagent(const QString& reagent);
 private:
    QString text;
    QString title;
    double time;
+   QList<QString> reagents;
 };
 
 #endif   /* _PREINSTRUCTION_H */
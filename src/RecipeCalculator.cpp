@@ -0,0 +1,102 @@
+/*
+ * RecipeCalculator.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RecipeCalculator.h"
+#include "recipe.h"
+#include "database.h"
+#include <QJsonDocument>
+#include <QList>
+
+RecipeCalculator::RecipeCalculator( QTextStream* out )
+   : _out(out)
+{
+}
+
+int RecipeCalculator::calcFile( QString const& fileName )
+{
+   QList<Recipe*> recs;
+   QJsonObject obj;
+
+   Database::instance().importFromXML(fileName, &recs);
+   if( recs.isEmpty() )
+   {
+      obj["source"] = fileName;
+      obj["error"] = QString("no recipes could be read");
+      writeLine(obj);
+      return 1;
+   }
+
+   foreach( Recipe* rec, recs )
+   {
+      obj = stats(rec);
+      obj["source"] = fileName;
+      writeLine(obj);
+   }
+
+   return 0;
+}
+
+int RecipeCalculator::calcKey( int key )
+{
+   Recipe* rec = Database::instance().recipe(key);
+   QJsonObject obj;
+
+   if( rec == 0 )
+   {
+      obj["source"] = QString("database");
+      obj["id"] = key;
+      obj["error"] = QString("no such recipe");
+      writeLine(obj);
+      return 1;
+   }
+
+   obj = stats(rec);
+   obj["source"] = QString("database");
+   obj["id"] = key;
+   writeLine(obj);
+
+   return 0;
+}
+
+QJsonObject RecipeCalculator::stats( Recipe* rec )
+{
+   QJsonObject ret;
+
+   ret["name"] = rec->name();
+   ret["valid"] = rec->isValid();
+   ret["batch_size_l"] = rec->batchSize_l();
+   ret["efficiency_pct"] = rec->efficiency_pct();
+   ret["og"] = rec->og();
+   ret["fg"] = rec->fg();
+   ret["abv_pct"] = rec->ABV_pct();
+   ret["ibu"] = rec->IBU();
+   ret["color_srm"] = rec->color_srm();
+   ret["calories_12oz"] = rec->calories12oz();
+   ret["boil_grav"] = rec->boilGrav();
+   ret["boil_volume_l"] = rec->boilVolume_l();
+   ret["final_volume_l"] = rec->finalVolume_l();
+   ret["grains_kg"] = rec->grains_kg();
+
+   return ret;
+}
+
+void RecipeCalculator::writeLine( QJsonObject const& obj )
+{
+   *_out << QJsonDocument(obj).toJson(QJsonDocument::Compact) << "\n";
+}
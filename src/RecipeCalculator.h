@@ -0,0 +1,68 @@
+/*
+ * RecipeCalculator.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RECIPECALCULATOR_H
+#define _RECIPECALCULATOR_H
+
+class RecipeCalculator;
+
+#include <QString>
+#include <QJsonObject>
+#include <QTextStream>
+
+class Recipe;
+
+/*!
+ * \class RecipeCalculator
+ * \author agent
+ *
+ * \brief Writes the calculated statistics of recipes as JSON lines.
+ *
+ * Each recipe gets one line holding a single JSON object. Inputs that
+ * cannot be read get a line with an "error" member instead, so every input
+ * shows up in the output.
+ */
+class RecipeCalculator
+{
+public:
+   //! \param out is where the lines go. We do not own it.
+   RecipeCalculator( QTextStream* out );
+
+   /*!
+    * \brief Import the BeerXML \c fileName into the open database and write
+    * a line for each recipe in it.
+    * \returns 1 if the file could not be read, 0 otherwise.
+    */
+   int calcFile( QString const& fileName );
+   /*!
+    * \brief Write a line for the recipe with database key \c key.
+    * \returns 1 if there is no such recipe, 0 otherwise.
+    */
+   int calcKey( int key );
+
+   //! \returns the calculated statistics of \c rec.
+   static QJsonObject stats( Recipe* rec );
+
+private:
+   void writeLine( QJsonObject const& obj );
+
+   QTextStream* _out;
+};
+
+#endif /*_RECIPECALCULATOR_H*/
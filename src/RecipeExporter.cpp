@@ -0,0 +1,172 @@
+/*
+ * RecipeExporter.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RecipeExporter.h"
+#include "RecipeFormatter.h"
+#include "recipe.h"
+#include "database.h"
+#include "brewtarget.h"
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QRegExp>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QAtomicInt>
+
+namespace
+{
+   //! Writes one formatted recipe out.
+   class WriteJob : public QRunnable
+   {
+   public:
+      WriteJob( QString const& out, QString const& fileName, QAtomicInt* failures )
+         : _out(out), _fileName(fileName), _failures(failures)
+      {
+      }
+
+      void run()
+      {
+         QFile file(_fileName);
+
+         if( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) )
+         {
+            Brewtarget::logW(QString("RecipeExporter: could not open %1 for writing").arg(_fileName));
+            _failures->ref();
+            return;
+         }
+
+         QTextStream stream(&file);
+         stream.setCodec("UTF-8");
+         stream << _out;
+      }
+
+   private:
+      QString _out;
+      QString _fileName;
+      QAtomicInt* _failures;
+   };
+}
+
+RecipeExporter::RecipeExporter( QString const& outDir, Format format )
+   : _outDir(outDir),
+     _format(format)
+{
+}
+
+bool RecipeExporter::formatFromName( QString const& name, Format* format )
+{
+   QString n = name.toLower();
+
+   if( n == "html" )
+      *format = HTML;
+   else if( n == "text" || n == "txt" )
+      *format = TEXT;
+   else if( n == "bbcode" )
+      *format = BBCODE;
+   else
+      return false;
+
+   return true;
+}
+
+QList<Recipe*> RecipeExporter::selectRecipes( QStringList const& names )
+{
+   QList<Recipe*> all = Database::instance().recipes();
+   QList<Recipe*> ret;
+
+   if( names.isEmpty() )
+      return all;
+
+   foreach( Recipe* rec, all )
+   {
+      if( names.contains(rec->name()) )
+         ret.append(rec);
+   }
+
+   return ret;
+}
+
+QString RecipeExporter::fileName( Recipe* rec ) const
+{
+   QString base = rec->name();
+   QString ext;
+
+   switch( _format )
+   {
+      case TEXT:
+         ext = "txt";
+         break;
+      case BBCODE:
+         ext = "bbcode";
+         break;
+      case HTML:
+      default:
+         ext = "html";
+         break;
+   }
+
+   // Keep the name readable but safe on every filesystem. The key keeps
+   // recipes with the same name apart.
+   base.replace(QRegExp("[^\\w\\- ]"), "_");
+   return QDir(_outDir).filePath(QString("%1-%2.%3").arg(base.simplified()).arg(rec->key()).arg(ext));
+}
+
+int RecipeExporter::exportRecipes( QList<Recipe*> const& recs, int threads )
+{
+   QThreadPool pool;
+   QAtomicInt failures(0);
+   RecipeFormatter formatter;
+
+   if( !QDir().mkpath(_outDir) )
+   {
+      Brewtarget::logE(QString("RecipeExporter: could not create %1").arg(_outDir));
+      return recs.size();
+   }
+
+   pool.setMaxThreadCount( threads > 0 ? threads : QThread::idealThreadCount() );
+   foreach( Recipe* rec, recs )
+   {
+      QString out;
+
+      // The recipes may recalculate and write the database as they are
+      // read, so they are only formatted here, and the next one is
+      // formatted while the last is written.
+      formatter.setRecipe(rec);
+      switch( _format )
+      {
+         case TEXT:
+            out = formatter.getTextFormat();
+            break;
+         case BBCODE:
+            out = formatter.getBBCodeFormat();
+            break;
+         case HTML:
+         default:
+            out = formatter.getHTMLFormat();
+            break;
+      }
+
+      pool.start( new WriteJob(out, fileName(rec), &failures) );
+   }
+   pool.waitForDone();
+
+   return failures.load();
+}
@@ -0,0 +1,69 @@
+/*
+ * RecipeExporter.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RECIPEEXPORTER_H
+#define _RECIPEEXPORTER_H
+
+class RecipeExporter;
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+class Recipe;
+
+/*!
+ * \class RecipeExporter
+ * \author agent
+ *
+ * \brief Writes recipes to files through \b RecipeFormatter, without a GUI.
+ *
+ * Each recipe goes to its own file in the output directory. The recipes
+ * are formatted on the calling thread, since reading one may recalculate
+ * it, and only the files are written on a thread pool.
+ */
+class RecipeExporter
+{
+public:
+   enum Format { HTML, TEXT, BBCODE };
+
+   RecipeExporter( QString const& outDir, Format format );
+
+   //! \brief Parse "html", "text" or "bbcode" into \c format. \returns false if \c name is none of them.
+   static bool formatFromName( QString const& name, Format* format );
+   //! \returns the recipes named in \c names, or all recipes if \c names is empty.
+   static QList<Recipe*> selectRecipes( QStringList const& names );
+
+   /*!
+    * \brief Write every recipe in \c recs, blocking until all are done.
+    *
+    * \param threads is the most threads writing files. 0 picks one per core.
+    * \returns the number of recipes that could not be written.
+    */
+   int exportRecipes( QList<Recipe*> const& recs, int threads = 0 );
+
+   //! \returns the file that \c rec gets written to.
+   QString fileName( Recipe* rec ) const;
+
+private:
+   QString _outDir;
+   Format _format;
+};
+
+#endif /*_RECIPEEXPORTER_H*/
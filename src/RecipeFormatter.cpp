@@ -31,6 +31,7 @@
 #include "mashstep.h"
 #include "unit.h"
 #include "brewtarget.h"
+#include "database.h"
 #include "MainWindow.h"
 #include <QClipboard>
 #include <QObject>
@@ -40,12 +41,25 @@
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
+#include <QMutexLocker>
+
+QCache<RecipeFormatter::CacheKey,RecipeFormatter::CacheEntry> RecipeFormatter::_cache(1000);
+QMutex RecipeFormatter::_cacheMutex;
 
 RecipeFormatter::RecipeFormatter(QObject* parent)
    : QObject(parent)
 {
    textSeparator = 0;
    rec = 0;
+   printer = 0;
+   doc = 0;
+   docDialog = 0;
+}
+
+void RecipeFormatter::setupPreviewDialog()
+{
+   if( docDialog != 0 )
+      return;
 
    //===Construct a print-preview dialog.===
    docDialog = new QDialog(Brewtarget::mainWindow());
@@ -75,7 +89,139 @@ void RecipeFormatter::setRecipe(Recipe* recipe)
    rec = recipe;
 }
 
+void RecipeFormatter::clearCache()
+{
+   QMutexLocker locker(&_cacheMutex);
+   _cache.clear();
+}
+
+bool RecipeFormatter::cached( BeerXMLElement const* element, CachedFormat format, unsigned int version, QString* out )
+{
+   QMutexLocker locker(&_cacheMutex);
+   CacheEntry* entry = _cache.object( CacheKey(element, format) );
+   
+   if( entry == 0 || entry->version != version || entry->optionsVersion != Brewtarget::optionsVersion() )
+      return false;
+   
+   *out = entry->str;
+   return true;
+}
+
+void RecipeFormatter::cache( BeerXMLElement const* element, CachedFormat format, unsigned int version, QString const& str )
+{
+   CacheEntry* entry = new CacheEntry;
+   entry->version = version;
+   entry->optionsVersion = Brewtarget::optionsVersion();
+   entry->str = str;
+   
+   QMutexLocker locker(&_cacheMutex);
+   _cache.insert( CacheKey(element, format), entry );
+}
+
+unsigned int RecipeFormatter::elementVersion( BeerXMLElement* element )
+{
+   return element->changeVersion();
+}
+
+unsigned int RecipeFormatter::elementVersion( Recipe* rec, bool deep )
+{
+   // Versions are unique and only increase, so the newest part tells us if
+   // anything changed. Adding or removing a part changes the recipe itself.
+   unsigned int ret = rec->changeVersion();
+   Style* style = rec->style();
+   
+   if( style )
+      ret = qMax(ret, style->changeVersion());
+   
+   if( !deep )
+      return ret;
+   
+   Equipment* equip = rec->equipment();
+   Mash* mash = rec->mash();
+   if( equip )
+      ret = qMax(ret, equip->changeVersion());
+   if( mash )
+   {
+      ret = qMax(ret, mash->changeVersion());
+      foreach( MashStep* step, mash->mashSteps() )
+         ret = qMax(ret, step->changeVersion());
+   }
+   foreach( Fermentable* ferm, rec->fermentables() )
+      ret = qMax(ret, ferm->changeVersion());
+   foreach( Hop* hop, rec->hops() )
+      ret = qMax(ret, hop->changeVersion());
+   foreach( Misc* misc, rec->miscs() )
+      ret = qMax(ret, misc->changeVersion());
+   foreach( Yeast* yeast, rec->yeasts() )
+      ret = qMax(ret, yeast->changeVersion());
+   foreach( Instruction* ins, rec->instructions() )
+      ret = qMax(ret, ins->changeVersion());
+   foreach( BrewNote* note, rec->brewNotes() )
+      ret = qMax(ret, note->changeVersion());
+   
+   return ret;
+}
+
 QString RecipeFormatter::getTextFormat()
+{
+   QString ret;
+   unsigned int version;
+   
+   if( rec == 0 )
+      return "";
+   
+   version = elementVersion(rec, true);
+   if( !cached(rec, TEXTFORMAT, version, &ret) )
+   {
+      ret = buildTextFormat();
+      cache(rec, TEXTFORMAT, version, ret);
+   }
+   return ret;
+}
+
+QString RecipeFormatter::getHTMLFormat()
+{
+   QString ret;
+   unsigned int version;
+   
+   if( rec == 0 )
+      return buildHTMLFormat();
+   
+   version = elementVersion(rec, true);
+   if( !cached(rec, HTMLFORMAT, version, &ret) )
+   {
+      ret = buildHTMLFormat();
+      cache(rec, HTMLFORMAT, version, ret);
+   }
+   return ret;
+}
+
+QString RecipeFormatter::getBBCodeFormat()
+{
+   QString ret;
+   unsigned int version;
+   
+   if( rec == 0 )
+      return "";
+   
+   version = elementVersion(rec, true);
+   if( !cached(rec, BBCODEFORMAT, version, &ret) )
+   {
+      ret = buildBBCodeFormat();
+      cache(rec, BBCODEFORMAT, version, ret);
+   }
+   return ret;
+}
+
+QString RecipeFormatter::getToolTip(Recipe* rec)       { return cachedToolTip(rec); }
+QString RecipeFormatter::getToolTip(Style* style)      { return cachedToolTip(style); }
+QString RecipeFormatter::getToolTip(Equipment* kit)    { return cachedToolTip(kit); }
+QString RecipeFormatter::getToolTip(Fermentable* ferm) { return cachedToolTip(ferm); }
+QString RecipeFormatter::getToolTip(Hop* hop)          { return cachedToolTip(hop); }
+QString RecipeFormatter::getToolTip(Misc* misc)        { return cachedToolTip(misc); }
+QString RecipeFormatter::getToolTip(Yeast* yeast)      { return cachedToolTip(yeast); }
+
+QString RecipeFormatter::buildTextFormat()
 {
    QString ret = "";
    QString tmp = "";
@@ -150,7 +296,7 @@ QString RecipeFormatter::getTextSeparator()
    return *textSeparator;
 }
 
-QString RecipeFormatter::getHTMLFormat()
+QString RecipeFormatter::buildHTMLFormat()
 {
    QString pDoc;
 
@@ -169,7 +315,7 @@ QString RecipeFormatter::getHTMLFormat()
    return pDoc;
 }
 
-QString RecipeFormatter::getBBCodeFormat()
+QString RecipeFormatter::buildBBCodeFormat()
 {
    QString ret = "";
    QString tmp = "";
@@ -231,7 +377,7 @@ QString RecipeFormatter::getBBCodeFormat()
    return ret;
 }
 
-QString RecipeFormatter::getToolTip(Recipe* rec)
+QString RecipeFormatter::buildToolTip(Recipe* rec)
 {
    QString header;
    QString body;
@@ -282,7 +428,7 @@ QString RecipeFormatter::getToolTip(Recipe* rec)
 
 }
 
-QString RecipeFormatter::getToolTip(Style* style)
+QString RecipeFormatter::buildToolTip(Style* style)
 {
    QString header;
    QString body;
@@ -327,7 +473,7 @@ QString RecipeFormatter::getToolTip(Style* style)
 
 }
 
-QString RecipeFormatter::getToolTip(Equipment* kit)
+QString RecipeFormatter::buildToolTip(Equipment* kit)
 {
    QString header;
    QString body;
@@ -363,8 +509,20 @@ QString RecipeFormatter::getToolTip(Equipment* kit)
 
 }
 
-// Once we do inventory, this needs to be fixed to show amount on hand
-QString RecipeFormatter::getToolTip(Fermentable* ferm)
+QString RecipeFormatter::inventoryToolTipRow(BeerXMLElement* ing, QString const& inStock)
+{
+   QList<Database::InventoryChange> brews = Database::instance().inventoryHistory(ing, "brew", 1);
+   QString lastBrewed = brews.isEmpty() ? tr("Never") : Brewtarget::displayDate(brews.first().when.date());
+
+   return QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>"
+                  "<td class=\"left\">%3</td><td class=\"value\">%4</td></tr>")
+          .arg(tr("In stock"))
+          .arg(inStock)
+          .arg(tr("Last brewed"))
+          .arg(lastBrewed);
+}
+
+QString RecipeFormatter::buildToolTip(Fermentable* ferm)
 {
    QString header;
    QString body;
@@ -400,6 +558,8 @@ QString RecipeFormatter::getToolTip(Fermentable* ferm)
    body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
            .arg(tr("Yield"))
            .arg(Brewtarget::displayAmount(ferm->yield_pct(), 0));
+   // Third row -- inventory
+   body += inventoryToolTipRow(ferm, Brewtarget::displayAmount(ferm->inventory(), Units::kilograms));
 
    body += "</table></body></html>";
 
@@ -407,7 +567,7 @@ QString RecipeFormatter::getToolTip(Fermentable* ferm)
 
 }
 
-QString RecipeFormatter::getToolTip(Hop* hop)
+QString RecipeFormatter::buildToolTip(Hop* hop)
 {
    QString header;
    QString body;
@@ -444,6 +604,8 @@ QString RecipeFormatter::getToolTip(Hop* hop)
    body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
            .arg(tr("Use"))
            .arg( hop->useStringTr() );
+   // Third row -- inventory
+   body += inventoryToolTipRow(hop, Brewtarget::displayAmount(hop->inventory(), Units::kilograms));
 
    body += "</table></body></html>";
 
@@ -451,7 +613,7 @@ QString RecipeFormatter::getToolTip(Hop* hop)
 
 }
 
-QString RecipeFormatter::getToolTip(Misc* misc)
+QString RecipeFormatter::buildToolTip(Misc* misc)
 {
    QString header;
    QString body;
@@ -480,6 +642,8 @@ QString RecipeFormatter::getToolTip(Misc* misc)
    body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
            .arg(tr("Use"))
            .arg(misc->useStringTr());
+   // Second row -- inventory
+   body += inventoryToolTipRow(misc, Brewtarget::displayAmount(misc->inventory(), misc->amountIsWeight() ? static_cast<Unit*>(Units::kilograms) : static_cast<Unit*>(Units::liters)));
 
    body += "</table></body></html>";
 
@@ -487,7 +651,7 @@ QString RecipeFormatter::getToolTip(Misc* misc)
 
 }
 
-QString RecipeFormatter::getToolTip(Yeast* yeast)
+QString RecipeFormatter::buildToolTip(Yeast* yeast)
 {
    QString header;
    QString body;
@@ -531,6 +695,8 @@ QString RecipeFormatter::getToolTip(Yeast* yeast)
    body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
            .arg(tr("Flocculation"))
            .arg( yeast->flocculationStringTr());
+   // Fourth row -- inventory
+   body += inventoryToolTipRow(yeast, QString::number(yeast->inventory()));
 
 
    body += "</table></body></html>";
@@ -1424,6 +1590,8 @@ void RecipeFormatter::print(QPrinter* mainPrinter, QPrintDialog *dialog,
       outFile->close();
       return;
    }
+   setupPreviewDialog();
+
    // We are printing hard copy
    if ( action == PRINT )
    {
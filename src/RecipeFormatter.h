@@ -31,6 +31,9 @@ class RecipeFormatter;
 #include <QWebView>
 #include <QDialog>
 #include <QFile>
+#include <QCache>
+#include <QPair>
+#include <QMutex>
 #include "recipe.h"
 
 /*!
@@ -38,6 +41,11 @@ class RecipeFormatter;
  * \author Philip G. Lee
  *
  * \brief View class that creates various text versions of a recipe.
+ *
+ * All formatters share a cache of their output, keyed on the element, the
+ * format, and the element's \c BeerXMLElement::changeVersion(). Output is
+ * rebuilt only after the element (or, for recipes, one of its parts) or a
+ * display option changes. The cache may be used from several threads.
  */
 class RecipeFormatter : public QObject
 {
@@ -56,6 +64,8 @@ public:
    QString getHTMLFormat();
    //! Get a BBCode view. Why is this here?
    QString getBBCodeFormat();
+   //! \brief Forget all cached output.
+   static void clearCache();
    //! Generate a tooltip for a recipe
    QString getToolTip(Recipe* rec);
    QString getToolTip(Style* style);
@@ -81,6 +91,60 @@ public slots:
    void toTextClipboard();
    
 private:
+   //! Kinds of output held in the cache.
+   enum CachedFormat { TEXTFORMAT, HTMLFORMAT, BBCODEFORMAT, TOOLTIPFORMAT };
+   
+   typedef QPair<BeerXMLElement const*,int> CacheKey;
+   struct CacheEntry
+   {
+      unsigned int version;
+      unsigned int optionsVersion;
+      QString str;
+   };
+   
+   //! \returns true and sets \c out if the cache has \c format of \c element at \c version.
+   static bool cached( BeerXMLElement const* element, CachedFormat format, unsigned int version, QString* out );
+   //! \brief Put \c str in the cache.
+   static void cache( BeerXMLElement const* element, CachedFormat format, unsigned int version, QString const& str );
+   
+   //! \returns the newest change version of \c rec, its style and, if \c deep, all its other parts.
+   static unsigned int elementVersion( Recipe* rec, bool deep = false );
+   static unsigned int elementVersion( BeerXMLElement* element );
+   
+   //! \brief Look up the tooltip of \c element in the cache, building it if needed.
+   template<class T> QString cachedToolTip( T* element )
+   {
+      QString ret;
+      unsigned int version;
+      
+      if( element == 0 )
+         return buildToolTip(element);
+      
+      version = elementVersion(element);
+      if( !cached(element, TOOLTIPFORMAT, version, &ret) )
+      {
+         ret = buildToolTip(element);
+         cache(element, TOOLTIPFORMAT, version, ret);
+      }
+      return ret;
+   }
+   
+   QString buildTextFormat();
+   QString buildHTMLFormat();
+   QString buildBBCodeFormat();
+   QString buildToolTip(Recipe* rec);
+   QString buildToolTip(Style* style);
+   QString buildToolTip(Equipment* kit);
+   QString buildToolTip(Fermentable* ferm);
+   QString buildToolTip(Hop* hop);
+   QString buildToolTip(Misc* misc);
+   QString buildToolTip(Yeast* yeast);
+   //! \brief Tooltip row with \c inStock and when \c ing was last brewed, from the inventory ledger.
+   QString inventoryToolTipRow(BeerXMLElement* ing, QString const& inStock);
+   
+   //! \brief Make the print preview dialog the first time we need it.
+   void setupPreviewDialog();
+   
    QString getTextSeparator();
 
    QString buildStatTableHtml();
@@ -112,6 +176,9 @@ private:
    QWebView* doc;
    QDialog* docDialog;
    QString cssName;
+   
+   static QCache<CacheKey,CacheEntry> _cache;
+   static QMutex _cacheMutex;
 
 private slots:
    bool loadComplete(bool ok);
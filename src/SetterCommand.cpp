@@ -27,6 +27,7 @@
 #include <QThread>
 #include "SetterCommand.h"
 #include "database.h"
+#include "SqlProfiler.h"
 
 SetterCommand::SetterCommand( Brewtarget::DBTable table, int key, const char* col_name, QVariant value, QMetaProperty prop, BeerXMLElement* object, bool notify)
    : QUndoCommand(QString("Change %1 to %2").arg(col_name).arg(value.toString()))
@@ -34,6 +35,11 @@ SetterCommand::SetterCommand( Brewtarget::DBTable table, int key, const char* co
    appendCommand( table, key, QString(col_name), value, prop, object, notify );
 }
 
+SetterCommand::SetterCommand()
+   : QUndoCommand(QString("Change several values"))
+{
+}
+
 SetterCommand::~SetterCommand()
 {
 }
@@ -159,7 +165,9 @@ void SetterCommand::oldValueTransaction()
                 .arg(*keyIt);
       q.prepare(str);
       queries.append(q);
+      SqlProfiler::Timer timer("SetterCommand::oldValueTransaction");
       q.exec();
+      timer.stop(q);
       ++tableIt;
       ++colNameIt;
       ++keyIt;
@@ -235,7 +243,10 @@ void SetterCommand::redo()
 
    foreach( QSqlQuery q, queries )
    {
-      if( ! q.exec() )
+      SqlProfiler::Timer timer("SetterCommand::redo");
+      bool ok = q.exec();
+      timer.stop(q);
+      if( ! ok )
          Brewtarget::logE( QString("SetterCommand::redo: %1.\n   \"%2\"").arg(q.lastError().text()).arg(q.lastQuery()) );
    }
    QSqlQuery transEnd("COMMIT", Database::sqlDatabase());
@@ -261,7 +272,10 @@ void SetterCommand::undo()
 
    foreach( QSqlQuery q, queries )
    {
-      if( ! q.exec() )
+      SqlProfiler::Timer timer("SetterCommand::undo");
+      bool ok = q.exec();
+      timer.stop(q);
+      if( ! ok )
          Brewtarget::logE( QString("SetterCommand::undo: %1.\n   \"%2\"").arg(q.lastError().text()).arg(q.lastQuery()) );
    }
    QSqlQuery transEnd("COMMIT", Database::sqlDatabase());
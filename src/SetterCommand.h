@@ -46,6 +46,8 @@ public:
                   QMetaProperty prop,
                   BeerXMLElement* object,
                   bool notify=true);
+   //! An empty command, for others to be merged into.
+   SetterCommand();
    virtual ~SetterCommand();
    
    //! Reimplemented from QUndoCommand.
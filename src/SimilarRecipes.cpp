@@ -0,0 +1,194 @@
+/*
+ * SimilarRecipes.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "SimilarRecipes.h"
+#include "StyleMatcher.h"
+#include "database.h"
+#include "recipe.h"
+#include "hop.h"
+#include "yeast.h"
+#include <QElapsedTimer>
+
+SimilarRecipes::SimilarRecipes(QObject* parent)
+   : QObject(parent)
+{
+   // 0 runs it whenever there are no events waiting.
+   _timer.setInterval(0);
+   connect( &_timer, SIGNAL(timeout()), this, SLOT(indexSome()) );
+   connect( &(Database::instance()), SIGNAL(newRecipeSignal(Recipe*)), this, SLOT(addRecipe(Recipe*)) );
+   connect( &(Database::instance()), SIGNAL(deletedRecipeSignal(Recipe*)), this, SLOT(removeRecipe(Recipe*)) );
+}
+
+void SimilarRecipes::build()
+{
+   foreach( Recipe* rec, Database::instance().recipes() )
+      addRecipe(rec);
+}
+
+bool SimilarRecipes::isIndexed() const
+{
+   return _changed.isEmpty();
+}
+
+QList<SimilarRecipes::Match> SimilarRecipes::find( Recipe* rec, int count )
+{
+   QList<Match> ret;
+   std::vector<double> point;
+   std::vector<BrewCalc::Neighbor> neighbors;
+   std::map<int,unsigned int>::const_iterator row;
+
+   if( !rec || count <= 0 )
+      return ret;
+
+   // The point of rec as indexed, unless it is out of date. Then it is just
+   // the one recipe to read.
+   row = _index.rows.find(rec->key());
+   if( row != _index.rows.end() && !_changed.contains(rec) )
+      point.assign( _index.points.begin() + row->second * _index.dims,
+                    _index.points.begin() + (row->second + 1) * _index.dims );
+   else
+      point = features(rec);
+
+   neighbors = BrewCalc::nearestNeighbors( _index, point, count, rec->key() );
+   for( std::vector<BrewCalc::Neighbor>::const_iterator i = neighbors.begin(); i != neighbors.end(); ++i )
+   {
+      Match m;
+      m.recipe = _recipes.value(i->id);
+      m.distance = i->distance;
+      ret.append(m);
+   }
+
+   return ret;
+}
+
+std::vector<double> SimilarRecipes::features( Recipe* rec )
+{
+   std::vector<unsigned int> varieties;
+   std::vector<unsigned int> strains;
+
+   // Same name, same variety, whatever the alpha or the supplier says.
+   foreach( Hop* h, rec->hops() )
+      varieties.push_back( qHash(h->name().trimmed().toLower()) );
+   foreach( Yeast* y, rec->yeasts() )
+      strains.push_back( qHash(y->name().trimmed().toLower()) );
+
+   return BrewCalc::recipeFeatures( rec->calcInput(), StyleMatcher::stats(rec), varieties, strains );
+}
+
+void SimilarRecipes::addRecipe( Recipe* rec )
+{
+   if( !rec || _recipes.contains(rec->key()) )
+      return;
+
+   _recipes.insert( rec->key(), rec );
+   queue(rec);
+   // Stats catch the changes to amounts and times, and changed() catches
+   // ingredients that come and go.
+   connect( rec, SIGNAL(changedStoredStats()), this, SLOT(recipeChanged()) );
+   connect( rec, SIGNAL(changed(QMetaProperty,QVariant)), this, SLOT(recipeChanged()) );
+}
+
+void SimilarRecipes::removeRecipe( Recipe* rec )
+{
+   if( !rec || !_recipes.contains(rec->key()) )
+      return;
+
+   disconnect( rec, 0, this, 0 );
+   for( QHash<QObject*,Recipe*>::iterator i = _owners.begin(); i != _owners.end(); )
+   {
+      if( i.value() == rec )
+      {
+         disconnect( i.key(), 0, this, 0 );
+         i = _owners.erase(i);
+      }
+      else
+         ++i;
+   }
+   _changed.remove(rec);
+   _recipes.remove(rec->key());
+   BrewCalc::removeNeighbor( _index, rec->key() );
+}
+
+void SimilarRecipes::recipeChanged()
+{
+   Recipe* rec = qobject_cast<Recipe*>(sender());
+
+   if( rec )
+      queue(rec);
+}
+
+void SimilarRecipes::ingredientRenamed()
+{
+   Recipe* rec = _owners.value(sender());
+
+   if( rec )
+      queue(rec);
+}
+
+void SimilarRecipes::watchIngredients( Recipe* rec )
+{
+   // Ingredients are copied into each recipe, so each has one owner.
+   foreach( Hop* h, rec->hops() )
+   {
+      if( _owners.contains(h) )
+         continue;
+      _owners.insert(h, rec);
+      connect( h, SIGNAL(changedName(QString)), this, SLOT(ingredientRenamed()) );
+   }
+   foreach( Yeast* y, rec->yeasts() )
+   {
+      if( _owners.contains(y) )
+         continue;
+      _owners.insert(y, rec);
+      connect( y, SIGNAL(changedName(QString)), this, SLOT(ingredientRenamed()) );
+   }
+}
+
+void SimilarRecipes::queue( Recipe* rec )
+{
+   _changed.insert(rec);
+   if( !_timer.isActive() )
+      _timer.start();
+}
+
+void SimilarRecipes::indexSome()
+{
+   QElapsedTimer elapsed;
+
+   elapsed.start();
+   while( !_changed.isEmpty() && elapsed.elapsed() < slice_ms )
+   {
+      Recipe* rec = *_changed.begin();
+      std::vector<double> point = features(rec);
+
+      // Reading the features may calculate the recipe and queue it again,
+      // but the point already has what that changed.
+      _changed.remove(rec);
+      BrewCalc::setNeighbor( _index, rec->key(), point );
+      // Any hop or yeast added since was in the point, so watch it from here.
+      watchIngredients(rec);
+   }
+
+   if( _changed.isEmpty() )
+   {
+      _timer.stop();
+      emit indexed();
+   }
+}
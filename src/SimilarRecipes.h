@@ -0,0 +1,113 @@
+/*
+ * SimilarRecipes.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _SIMILARRECIPES_H
+#define _SIMILARRECIPES_H
+
+class SimilarRecipes;
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <vector>
+#include "BrewCalc.h"
+
+// Forward declarations
+class Recipe;
+
+/*!
+ * \class SimilarRecipes
+ * \author agent
+ *
+ * \brief Finds the recipes in the library most like a given one.
+ *
+ * Each recipe is a point of \b BrewCalc::recipeFeatures() in a
+ * \b BrewCalc::NeighborIndex. Reading a recipe's features takes the
+ * database, so it happens on the main thread, but a few milliseconds at a
+ * time whenever the event loop is free: \b build() queues the whole
+ * library at startup, and recipes that are added or change, or whose hops
+ * or yeasts are renamed, go back in the queue. \b find() only scans the
+ * index.
+ */
+class SimilarRecipes : public QObject
+{
+   Q_OBJECT
+public:
+   //! \brief One of the recipes \b find() found.
+   struct Match
+   {
+      Recipe* recipe;
+      //! \brief Same as \c BrewCalc::Neighbor::distance.
+      double distance;
+   };
+
+   SimilarRecipes(QObject* parent=0);
+
+   //! \brief Queue every recipe in the library to be indexed.
+   void build();
+   //! \returns true if no recipe is waiting to be indexed.
+   bool isIndexed() const;
+
+   /*!
+    * \returns up to \c count recipes most like \c rec, nearest first,
+    * leaving out \c rec. Recipes still in the queue are found where they
+    * were last indexed, or not at all.
+    */
+   QList<Match> find( Recipe* rec, int count );
+
+   //! \returns the features of \c rec, from its stored statistics.
+   static std::vector<double> features( Recipe* rec );
+
+signals:
+   //! \brief The queue has just been emptied.
+   void indexed();
+
+private slots:
+   void addRecipe( Recipe* rec );
+   void removeRecipe( Recipe* rec );
+   //! \brief Queue the sending recipe to be indexed again.
+   void recipeChanged();
+   //! \brief Queue the recipe of the sending hop or yeast to be indexed again.
+   void ingredientRenamed();
+   //! \brief Index queued recipes for up to \c slice_ms.
+   void indexSome();
+
+private:
+   void queue( Recipe* rec );
+   //! \brief Watch the names of the hops and yeasts in \c rec, which its features hash.
+   void watchIngredients( Recipe* rec );
+
+   //! \brief How long \b indexSome() may keep the event loop waiting.
+   static int const slice_ms = 10;
+
+   BrewCalc::NeighborIndex _index;
+   //! \brief Every recipe known, by key.
+   QHash<int,Recipe*> _recipes;
+   //! \brief Recipes to index.
+   QSet<Recipe*> _changed;
+   //! \brief The recipe each watched hop and yeast is in.
+   QHash<QObject*,Recipe*> _owners;
+   //! \brief Runs \b indexSome() while \c _changed is not empty.
+   QTimer _timer;
+};
+
+#endif /*_SIMILARRECIPES_H*/
@@ -0,0 +1,151 @@
+/*
+ * SimilarRecipesDialog.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "SimilarRecipesDialog.h"
+#include "brewtarget.h"
+#include "recipe.h"
+#include "style.h"
+#include "unit.h"
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QSpacerItem>
+#include <QStringList>
+
+SimilarRecipesDialog::SimilarRecipesDialog(SimilarRecipes* similarRecipes, QWidget* parent)
+   : QDialog(parent),
+     recObs(0),
+     similar(similarRecipes)
+{
+   doLayout();
+
+   connect( similar, SIGNAL(indexed()), this, SLOT(recipesIndexed()) );
+   connect( spinBox_count, SIGNAL(valueChanged(int)), this, SLOT(find()) );
+   connect( tableWidget, SIGNAL(cellDoubleClicked(int,int)), this, SLOT(open()) );
+   connect( pushButton_open, SIGNAL(clicked()), this, SLOT(open()) );
+   connect( pushButton_close, SIGNAL(clicked()), this, SLOT(reject()) );
+}
+
+void SimilarRecipesDialog::doLayout()
+{
+   resize(640, 360);
+   QVBoxLayout* vLayout = new QVBoxLayout(this);
+      QHBoxLayout* topLayout = new QHBoxLayout();
+         recipeLabel = new QLabel(this);
+         QSpacerItem* topSpacer = new QSpacerItem(40, 20, QSizePolicy::Expanding, QSizePolicy::Minimum);
+         countLabel = new QLabel(this);
+         spinBox_count = new QSpinBox(this);
+            spinBox_count->setRange(1, 100);
+            spinBox_count->setValue(10);
+         countLabel->setBuddy(spinBox_count);
+         topLayout->addWidget(recipeLabel);
+         topLayout->addItem(topSpacer);
+         topLayout->addWidget(countLabel);
+         topLayout->addWidget(spinBox_count);
+      tableWidget = new QTableWidget(0, NUMCOLS, this);
+         tableWidget->verticalHeader()->hide();
+         tableWidget->horizontalHeader()->setStretchLastSection(true);
+         tableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+         tableWidget->setSelectionBehavior(QAbstractItemView::SelectRows);
+         tableWidget->setSelectionMode(QAbstractItemView::SingleSelection);
+      QHBoxLayout* buttonLayout = new QHBoxLayout();
+         QSpacerItem* horizontalSpacer = new QSpacerItem(40, 20, QSizePolicy::Expanding, QSizePolicy::Minimum);
+         pushButton_open = new QPushButton(this);
+            pushButton_open->setAutoDefault(false);
+         pushButton_close = new QPushButton(this);
+            pushButton_close->setAutoDefault(false);
+         buttonLayout->addItem(horizontalSpacer);
+         buttonLayout->addWidget(pushButton_open);
+         buttonLayout->addWidget(pushButton_close);
+   vLayout->addLayout(topLayout);
+   vLayout->addWidget(tableWidget);
+   vLayout->addLayout(buttonLayout);
+
+   retranslateUi();
+}
+
+void SimilarRecipesDialog::retranslateUi()
+{
+   setWindowTitle(tr("Similar Recipes"));
+   recipeLabel->setText( recObs ? tr("Recipes most like %1").arg(recObs->name()) : QString() );
+   countLabel->setText(tr("Show"));
+   tableWidget->setHorizontalHeaderLabels( QStringList() << tr("Recipe") << tr("Style") << tr("OG") << tr("IBU")
+                                                         << tr("Color") << tr("ABV") << tr("Distance") );
+   pushButton_open->setText(tr("Open"));
+   pushButton_close->setText(tr("Close"));
+#ifndef QT_NO_TOOLTIP
+   tableWidget->setToolTip(tr("By the numbers, grist, hops and yeast. Double click a recipe to open it"));
+#endif // QT_NO_TOOLTIP
+}
+
+void SimilarRecipesDialog::setRecipe(Recipe* rec)
+{
+   recObs = rec;
+   recipeLabel->setText( recObs ? tr("Recipes most like %1").arg(recObs->name()) : QString() );
+   if( isVisible() )
+      find();
+}
+
+void SimilarRecipesDialog::showEvent(QShowEvent* event)
+{
+   find();
+   QDialog::showEvent(event);
+}
+
+void SimilarRecipesDialog::find()
+{
+   int row = 0;
+
+   found.clear();
+   tableWidget->setRowCount(0);
+   if( ! recObs )
+      return;
+
+   foreach( SimilarRecipes::Match const& m, similar->find(recObs, spinBox_count->value()) )
+   {
+      Recipe::StoredStats const& stats = m.recipe->storedStats();
+      Style* style = m.recipe->style();
+
+      tableWidget->insertRow(row);
+      tableWidget->setItem(row, NAMECOL, new QTableWidgetItem(m.recipe->name()));
+      tableWidget->setItem(row, STYLECOL, new QTableWidgetItem(style ? style->name() : QString()));
+      tableWidget->setItem(row, OGCOL, new QTableWidgetItem(Brewtarget::displayAmount(stats.og, Units::sp_grav, 3)));
+      tableWidget->setItem(row, IBUCOL, new QTableWidgetItem(Brewtarget::displayAmount(stats.IBU, 0, 1)));
+      tableWidget->setItem(row, COLORCOL, new QTableWidgetItem(Brewtarget::displayAmount(stats.color_srm, Units::srm, 0)));
+      tableWidget->setItem(row, ABVCOL, new QTableWidgetItem(Brewtarget::displayAmount(stats.ABV_pct, 0, 1)));
+      tableWidget->setItem(row, DISTANCECOL, new QTableWidgetItem(Brewtarget::displayAmount(m.distance, 0, 2)));
+      found.append(m.recipe);
+      ++row;
+   }
+}
+
+void SimilarRecipesDialog::open()
+{
+   int row = tableWidget->currentRow();
+
+   if( row >= 0 && row < found.size() )
+      emit recipeChosen(found[row]);
+}
+
+void SimilarRecipesDialog::recipesIndexed()
+{
+   if( isVisible() )
+      find();
+}
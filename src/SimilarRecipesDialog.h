@@ -0,0 +1,107 @@
+/*
+ * SimilarRecipesDialog.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _SIMILARRECIPESDIALOG_H
+#define _SIMILARRECIPESDIALOG_H
+
+class SimilarRecipesDialog;
+
+#include <QDialog>
+#include <QWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QList>
+#include <QEvent>
+#include <QShowEvent>
+#include "SimilarRecipes.h"
+
+// Forward declarations
+class Recipe;
+
+/*!
+ * \class SimilarRecipesDialog
+ * \author agent
+ *
+ * \brief Dialog that lists the recipes in the library most like one recipe.
+ *
+ * The index is built by the main window at startup and kept up to date
+ * from then on, so a search only scans it.
+ */
+class SimilarRecipesDialog : public QDialog
+{
+   Q_OBJECT
+public:
+
+   //! \param similarRecipes is the index to search. We do not own it.
+   SimilarRecipesDialog(SimilarRecipes* similarRecipes, QWidget* parent=0);
+   //! \brief Set the recipe to find others like.
+   void setRecipe(Recipe* rec);
+
+   //! \name Public UI Variables
+   //! @{
+   QLabel* recipeLabel;
+   QLabel* countLabel;
+   QSpinBox* spinBox_count;
+   QTableWidget* tableWidget;
+   QPushButton* pushButton_open;
+   QPushButton* pushButton_close;
+   //! @}
+
+public slots:
+   //! \brief Search again for the current recipe.
+   void find();
+   //! \brief Emit \b recipeChosen() for the selected row.
+   void open();
+
+private slots:
+   //! \brief Search again if shown, now that the index is up to date.
+   void recipesIndexed();
+
+signals:
+   //! \brief The user wants to look at \c rec.
+   void recipeChosen(Recipe* rec);
+
+protected:
+
+   virtual void changeEvent(QEvent* event)
+   {
+      if(event->type() == QEvent::LanguageChange)
+         retranslateUi();
+      QDialog::changeEvent(event);
+   }
+
+   virtual void showEvent(QShowEvent* event);
+
+private:
+
+   enum { NAMECOL, STYLECOL, OGCOL, IBUCOL, COLORCOL, ABVCOL, DISTANCECOL, NUMCOLS };
+
+   void doLayout();
+   void retranslateUi();
+
+   Recipe* recObs;
+   SimilarRecipes* similar;
+   //! \brief The recipe on each row.
+   QList<Recipe*> found;
+};
+
+#endif /*_SIMILARRECIPESDIALOG_H*/
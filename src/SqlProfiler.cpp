@@ -0,0 +1,180 @@
+/*
+ * SqlProfiler.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SqlProfiler.h"
+#include "brewtarget.h"
+#include <QMutexLocker>
+#include <QStringList>
+#include <QMap>
+
+bool SqlProfiler::_enabled = false;
+qint64 SqlProfiler::_slow_ns = 100 * 1000000LL;
+QMutex SqlProfiler::_mutex;
+QHash<QString,SqlProfiler::Stats> SqlProfiler::_stats;
+
+SqlProfiler::Timer::Timer( char const* site )
+   : _site(site)
+{
+   if( SqlProfiler::enabled() )
+      _timer.start();
+}
+
+SqlProfiler::Timer::~Timer()
+{
+   stop();
+}
+
+void SqlProfiler::Timer::stop( QSqlQuery const& q )
+{
+   if( !_timer.isValid() )
+      return;
+
+   SqlProfiler::record(_site, _timer.nsecsElapsed(), q.lastQuery());
+   _timer.invalidate();
+}
+
+void SqlProfiler::Timer::stop()
+{
+   if( !_timer.isValid() )
+      return;
+
+   SqlProfiler::record(_site, _timer.nsecsElapsed());
+   _timer.invalidate();
+}
+
+SqlProfiler::Stats::Stats()
+   : count(0),
+     total_ns(0),
+     max_ns(0)
+{
+   int i;
+   for( i = 0; i < numBuckets; ++i )
+      buckets[i] = 0;
+}
+
+void SqlProfiler::setEnabled( bool enabled )
+{
+   _enabled = enabled;
+}
+
+bool SqlProfiler::enabled()
+{
+   return _enabled;
+}
+
+void SqlProfiler::setSlowQuery_ms( int ms )
+{
+   _slow_ns = ms < 0 ? -1 : ms * 1000000LL;
+}
+
+void SqlProfiler::record( char const* site, qint64 nsecs, QString const& sql )
+{
+   qint64 us = nsecs / 1000;
+   int b = 0;
+
+   while( us > 1 && b < numBuckets-1 )
+   {
+      us >>= 1;
+      ++b;
+   }
+
+   {
+      QMutexLocker locker(&_mutex);
+      Stats& s = _stats[QString::fromLatin1(site)];
+      s.count += 1;
+      s.total_ns += nsecs;
+      s.max_ns = qMax(s.max_ns, nsecs);
+      s.buckets[b] += 1;
+   }
+
+   // Outside the lock, since logging takes its own.
+   if( _slow_ns >= 0 && nsecs > _slow_ns )
+   {
+      Brewtarget::logW( QString("Slow query, %1 ms in %2: %3")
+                        .arg(nsecs / 1e6, 0, 'f', 1)
+                        .arg(site)
+                        .arg(sql.isEmpty() ? QString("(no SQL)") : sql) );
+   }
+}
+
+qint64 SqlProfiler::percentile_us( Stats const& s, double pct )
+{
+   qint64 seen = 0;
+   qint64 want = static_cast<qint64>(s.count * pct / 100.0 + 0.5);
+   int b;
+
+   for( b = 0; b < numBuckets; ++b )
+   {
+      seen += s.buckets[b];
+      if( seen >= want )
+         break;
+   }
+
+   return 2LL << qMin(b, numBuckets-1);
+}
+
+QString SqlProfiler::report()
+{
+   QMutexLocker locker(&_mutex);
+   QMultiMap<qint64,QString> byTotal;
+   QHash<QString,Stats>::const_iterator it;
+   QStringList lines;
+
+   for( it = _stats.constBegin(); it != _stats.constEnd(); ++it )
+      byTotal.insert(it.value().total_ns, it.key());
+
+   lines << QString("%1 %2 %3 %4 %5 %6 %7")
+            .arg("Call site", -40)
+            .arg("Count", 9)
+            .arg("Total ms", 10)
+            .arg("Mean us", 9)
+            .arg("p50 us", 9)
+            .arg("p99 us", 9)
+            .arg("Max us", 9);
+
+   // The map is in increasing order, and we want the slowest first.
+   QMapIterator<qint64,QString> i(byTotal);
+   i.toBack();
+   while( i.hasPrevious() )
+   {
+      i.previous();
+      Stats const& s = _stats[i.value()];
+      lines << QString("%1 %2 %3 %4 %5 %6 %7")
+               .arg(i.value(), -40)
+               .arg(s.count, 9)
+               .arg(s.total_ns / 1e6, 10, 'f', 1)
+               .arg(s.total_ns / 1000 / qMax(s.count, qint64(1)), 9)
+               .arg(percentile_us(s, 50.0), 9)
+               .arg(percentile_us(s, 99.0), 9)
+               .arg(s.max_ns / 1000, 9);
+   }
+
+   return lines.join("\n");
+}
+
+void SqlProfiler::logReport()
+{
+   Brewtarget::log( Brewtarget::LogType_INFO, QString("SQL profile:\n%1").arg(report()) );
+}
+
+void SqlProfiler::reset()
+{
+   QMutexLocker locker(&_mutex);
+   _stats.clear();
+}
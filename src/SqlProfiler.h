@@ -0,0 +1,100 @@
+/*
+ * SqlProfiler.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SQLPROFILER_H
+#define _SQLPROFILER_H
+
+class SqlProfiler;
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QSqlQuery>
+
+/*!
+ * \class SqlProfiler
+ * \author agent
+ *
+ * \brief Counts and times the queries Database runs, by call site.
+ *
+ * Each call site wraps its query in a \b SqlProfiler::Timer named after the
+ * caller, like "Database::get". When profiling is off the timers do
+ * nothing. When it is on, every site keeps its count, total and maximum
+ * time, and a histogram of latencies for the percentiles, and queries
+ * slower than the threshold go to the log with their SQL. \b report()
+ * gives a table of all sites, slowest total first.
+ */
+class SqlProfiler
+{
+public:
+   //! \brief Times one query, and records it when stopped or destroyed.
+   class Timer
+   {
+   public:
+      //! \param site names the caller. Must outlive the profiler, so use a literal.
+      Timer( char const* site );
+      ~Timer();
+      //! \brief Record the time since construction, with the SQL of \c q for the slow log.
+      void stop( QSqlQuery const& q );
+      //! \brief Record the time since construction.
+      void stop();
+
+   private:
+      char const* _site;
+      QElapsedTimer _timer;
+   };
+
+   static void setEnabled( bool enabled );
+   static bool enabled();
+   //! \brief Queries that take longer than this are logged. Less than 0 logs none.
+   static void setSlowQuery_ms( int ms );
+
+   //! \brief Add one query of \c nsecs at \c site.
+   static void record( char const* site, qint64 nsecs, QString const& sql = QString() );
+   //! \returns a table of every call site, slowest total first.
+   static QString report();
+   //! \brief Log the report.
+   static void logReport();
+   //! \brief Forget everything recorded so far.
+   static void reset();
+
+private:
+   //! \brief Histogram bucket \c b holds latencies in [2^b, 2^(b+1)) microseconds.
+   static int const numBuckets = 24;
+
+   struct Stats
+   {
+      Stats();
+      qint64 count;
+      qint64 total_ns;
+      qint64 max_ns;
+      qint64 buckets[numBuckets];
+   };
+
+   //! \returns the upper edge in microseconds of the bucket that holds the \c pct percentile.
+   static qint64 percentile_us( Stats const& s, double pct );
+
+   static bool _enabled;
+   static qint64 _slow_ns;
+   static QMutex _mutex;
+   static QHash<QString,Stats> _stats;
+};
+
+#endif /*_SQLPROFILER_H*/
@@ -0,0 +1,136 @@
+/*
+ * StartupTrace.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StartupTrace.h"
+#include "brewtarget.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+
+bool StartupTrace::_enabled = false;
+QString StartupTrace::_fileName;
+QElapsedTimer StartupTrace::_clock;
+QMutex StartupTrace::_mutex;
+QList<StartupTrace::Event> StartupTrace::_events;
+QHash<void*,int> StartupTrace::_threads;
+
+StartupTrace::Scope::Scope( char const* name )
+   : _name(name),
+     _start_us(StartupTrace::enabled() ? StartupTrace::now_us() : -1)
+{
+}
+
+StartupTrace::Scope::~Scope()
+{
+   end();
+}
+
+void StartupTrace::Scope::end()
+{
+   if( _start_us < 0 )
+      return;
+
+   // Tracing may have finished while we were open.
+   if( StartupTrace::enabled() )
+      StartupTrace::record(_name, _start_us, StartupTrace::now_us() - _start_us);
+   _start_us = -1;
+}
+
+void StartupTrace::start( QString const& fileName )
+{
+   QMutexLocker locker(&_mutex);
+
+   _fileName = fileName;
+   _events.clear();
+   _threads.clear();
+   _clock.start();
+   _enabled = true;
+}
+
+bool StartupTrace::enabled()
+{
+   return _enabled;
+}
+
+qint64 StartupTrace::now_us()
+{
+   return _clock.nsecsElapsed() / 1000;
+}
+
+void StartupTrace::record( char const* name, qint64 start_us, qint64 duration_us )
+{
+   QMutexLocker locker(&_mutex);
+   void* t = QThread::currentThreadId();
+   Event e;
+
+   if( !_threads.contains(t) )
+      _threads.insert(t, _threads.size() + 1);
+
+   e.name = name;
+   e.start_us = start_us;
+   e.duration_us = duration_us;
+   e.thread = _threads.value(t);
+   _events.append(e);
+}
+
+bool StartupTrace::finish()
+{
+   QMutexLocker locker(&_mutex);
+   QJsonArray events;
+   QJsonObject root;
+   QFile file;
+   qint64 pid = QCoreApplication::applicationPid();
+
+   if( !_enabled )
+      return true;
+   _enabled = false;
+
+   // "X" events are complete ones, with a start and a duration. Chrome
+   // nests them by time, so the order here does not matter.
+   foreach( Event const& e, _events )
+   {
+      QJsonObject obj;
+      obj.insert("name", QString::fromLatin1(e.name));
+      obj.insert("cat", QString("startup"));
+      obj.insert("ph", QString("X"));
+      obj.insert("ts", static_cast<double>(e.start_us));
+      obj.insert("dur", static_cast<double>(e.duration_us));
+      obj.insert("pid", static_cast<double>(pid));
+      obj.insert("tid", e.thread);
+      events.append(obj);
+   }
+   root.insert("traceEvents", events);
+   root.insert("displayTimeUnit", QString("ms"));
+   _events.clear();
+
+   file.setFileName(_fileName);
+   if( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) )
+   {
+      Brewtarget::logW(QString("StartupTrace: could not write '%1'").arg(_fileName));
+      return false;
+   }
+   file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+   file.close();
+
+   return true;
+}
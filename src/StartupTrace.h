@@ -0,0 +1,89 @@
+/*
+ * StartupTrace.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _STARTUPTRACE_H
+#define _STARTUPTRACE_H
+
+class StartupTrace;
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+
+/*!
+ * \class StartupTrace
+ * \author agent
+ *
+ * \brief Records how long each phase of startup takes, as a trace that
+ * chrome://tracing can open.
+ *
+ * Turned on by the BREWTARGET_TRACE environment variable or the
+ * --trace-startup option, either of which names the file to write. Each
+ * phase is a \b StartupTrace::Scope, and nested scopes show up nested in
+ * the trace. The file is written by \b finish() once the main window is up,
+ * or at exit for the headless modes. When tracing is off, scopes do nothing.
+ */
+class StartupTrace
+{
+public:
+   //! \brief One phase, from construction until \b end() or destruction.
+   class Scope
+   {
+   public:
+      //! \param name names the phase. Must outlive the trace, so use a literal.
+      Scope( char const* name );
+      ~Scope();
+      //! \brief End the phase now instead of at destruction.
+      void end();
+
+   private:
+      char const* _name;
+      qint64 _start_us;
+   };
+
+   //! \brief Start tracing, to be written to \c fileName.
+   static void start( QString const& fileName );
+   static bool enabled();
+   //! \brief Write the trace and stop tracing. Does nothing if not tracing.
+   static bool finish();
+
+private:
+   struct Event
+   {
+      char const* name;
+      qint64 start_us;
+      qint64 duration_us;
+      int thread;
+   };
+
+   static qint64 now_us();
+   static void record( char const* name, qint64 start_us, qint64 duration_us );
+
+   static bool _enabled;
+   static QString _fileName;
+   static QElapsedTimer _clock;
+   static QMutex _mutex;
+   static QList<Event> _events;
+   // Small numbers for the threads, in order of appearance.
+   static QHash<void*,int> _threads;
+};
+
+#endif /*_STARTUPTRACE_H*/
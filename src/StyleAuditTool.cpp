@@ -0,0 +1,130 @@
+/*
+ * StyleAuditTool.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "StyleAuditTool.h"
+#include "database.h"
+#include "recipe.h"
+#include "style.h"
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QSpacerItem>
+#include <QStringList>
+#include <QApplication>
+
+StyleAuditTool::StyleAuditTool(QWidget* parent)
+   : QDialog(parent)
+{
+   doLayout();
+
+   connect( checkBox_outOfStyle, SIGNAL(toggled(bool)), this, SLOT(showAudit()) );
+   connect( pushButton_refresh, SIGNAL(clicked()), this, SLOT(audit()) );
+   connect( pushButton_close, SIGNAL(clicked()), this, SLOT(reject()) );
+}
+
+void StyleAuditTool::doLayout()
+{
+   resize(640, 420);
+   QVBoxLayout* vLayout = new QVBoxLayout(this);
+      checkBox_outOfStyle = new QCheckBox(this);
+         checkBox_outOfStyle->setChecked(true);
+      tableWidget = new QTableWidget(0, NUMCOLS, this);
+         tableWidget->verticalHeader()->hide();
+         tableWidget->horizontalHeader()->setStretchLastSection(true);
+         tableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+      resultLabel = new QLabel(this);
+      QHBoxLayout* buttonLayout = new QHBoxLayout();
+         QSpacerItem* horizontalSpacer = new QSpacerItem(40, 20, QSizePolicy::Expanding, QSizePolicy::Minimum);
+         pushButton_refresh = new QPushButton(this);
+            pushButton_refresh->setAutoDefault(false);
+         pushButton_close = new QPushButton(this);
+            pushButton_close->setAutoDefault(false);
+         buttonLayout->addItem(horizontalSpacer);
+         buttonLayout->addWidget(pushButton_refresh);
+         buttonLayout->addWidget(pushButton_close);
+   vLayout->addWidget(checkBox_outOfStyle);
+   vLayout->addWidget(tableWidget);
+   vLayout->addWidget(resultLabel);
+   vLayout->addLayout(buttonLayout);
+
+   retranslateUi();
+}
+
+void StyleAuditTool::retranslateUi()
+{
+   setWindowTitle(tr("Style Audit"));
+   checkBox_outOfStyle->setText(tr("Only recipes out of style"));
+   tableWidget->setHorizontalHeaderLabels( QStringList() << tr("Recipe") << tr("Style") << tr("Out of Range") << tr("Best Matches") );
+   pushButton_refresh->setText(tr("Refresh"));
+   pushButton_close->setText(tr("Close"));
+#ifndef QT_NO_TOOLTIP
+   tableWidget->setToolTip(tr("Best matches marked with * are not fully in style either"));
+#endif // QT_NO_TOOLTIP
+}
+
+void StyleAuditTool::showEvent(QShowEvent* event)
+{
+   audit();
+   QDialog::showEvent(event);
+}
+
+void StyleAuditTool::audit()
+{
+   QApplication::setOverrideCursor(Qt::WaitCursor);
+   StyleMatcher matcher( Database::instance().styles() );
+   audits = matcher.audit( Database::instance().recipes(), numBest );
+   QApplication::restoreOverrideCursor();
+
+   showAudit();
+}
+
+void StyleAuditTool::showAudit()
+{
+   int row = 0;
+   int outOfStyle = 0;
+   bool onlyOut = checkBox_outOfStyle->isChecked();
+
+   tableWidget->setSortingEnabled(false);
+   tableWidget->setRowCount(0);
+
+   foreach( StyleMatcher::Audit const& a, audits )
+   {
+      QStringList best;
+      bool inStyle = a.style && !a.outOfRange;
+
+      if( !inStyle )
+         ++outOfStyle;
+      else if( onlyOut )
+         continue;
+
+      foreach( StyleMatcher::Match const& m, a.best )
+         best.append( m.outOfRange ? m.style->name() + "*" : m.style->name() );
+
+      tableWidget->insertRow(row);
+      tableWidget->setItem(row, RECIPECOL, new QTableWidgetItem(a.recipe->name()));
+      tableWidget->setItem(row, STYLECOL, new QTableWidgetItem(a.style ? a.style->name() : QString()));
+      tableWidget->setItem(row, OUTOFRANGECOL, new QTableWidgetItem(a.style ? StyleMatcher::statNames(a.outOfRange) : tr("No style")));
+      tableWidget->setItem(row, BESTCOL, new QTableWidgetItem(best.join(", ")));
+      ++row;
+   }
+
+   tableWidget->setSortingEnabled(true);
+   resultLabel->setText( tr("%1 of %2 recipes are out of style").arg(outOfStyle).arg(audits.size()) );
+}
@@ -0,0 +1,91 @@
+/*
+ * StyleAuditTool.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _STYLEAUDITTOOL_H
+#define _STYLEAUDITTOOL_H
+
+class StyleAuditTool;
+
+#include <QDialog>
+#include <QWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QCheckBox>
+#include <QTableWidget>
+#include <QList>
+#include <QEvent>
+#include <QShowEvent>
+#include "StyleMatcher.h"
+
+/*!
+ * \class StyleAuditTool
+ * \author agent
+ *
+ * \brief Dialog that checks every recipe in the library against its style.
+ *
+ * Each recipe is listed with the statistics that are out of its style's
+ * ranges, and the styles it fits best. The audit is redone each time the
+ * dialog is shown, or on "Refresh".
+ */
+class StyleAuditTool : public QDialog
+{
+   Q_OBJECT
+public:
+
+   StyleAuditTool(QWidget* parent=0);
+
+   //! \name Public UI Variables
+   //! @{
+   QCheckBox* checkBox_outOfStyle;
+   QTableWidget* tableWidget;
+   QLabel* resultLabel;
+   QPushButton* pushButton_refresh;
+   QPushButton* pushButton_close;
+   //! @}
+
+public slots:
+   //! \brief Audit the whole library again.
+   void audit();
+   //! \brief Fill the table from the last audit.
+   void showAudit();
+
+protected:
+
+   virtual void changeEvent(QEvent* event)
+   {
+      if(event->type() == QEvent::LanguageChange)
+         retranslateUi();
+      QDialog::changeEvent(event);
+   }
+
+   virtual void showEvent(QShowEvent* event);
+
+private:
+
+   enum { RECIPECOL, STYLECOL, OUTOFRANGECOL, BESTCOL, NUMCOLS };
+   //! \brief How many of the best styles to list for each recipe.
+   static int const numBest = 3;
+
+   void doLayout();
+   void retranslateUi();
+
+   QList<StyleMatcher::Audit> audits;
+};
+
+#endif /*_STYLEAUDITTOOL_H*/
@@ -0,0 +1,159 @@
+/*
+ * StyleMatcher.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StyleMatcher.h"
+#include "style.h"
+#include "recipe.h"
+#include <QStringList>
+#include <QObject>
+#include <vector>
+
+StyleMatcher::StyleMatcher( QList<Style*> const& styles )
+{
+   std::vector<BrewCalc::StyleRanges> ranges;
+
+   // Recipes keep hidden copies of their styles; only match the real ones.
+   foreach( Style* style, styles )
+   {
+      if( !style->display() )
+         continue;
+      _styles.append(style);
+      ranges.push_back( StyleMatcher::ranges(style) );
+   }
+
+   _index = BrewCalc::indexStyles(ranges);
+}
+
+QList<StyleMatcher::Match> StyleMatcher::match( Recipe* rec, int count ) const
+{
+   return match( stats(rec), count );
+}
+
+QList<StyleMatcher::Match> StyleMatcher::match( BrewCalc::StyleStats const& stats, int count ) const
+{
+   QList<Match> ret;
+   std::vector<BrewCalc::StyleMatch> matches = BrewCalc::matchStyles( _index, stats, count > 0 ? count : 0 );
+
+   for( std::vector<BrewCalc::StyleMatch>::const_iterator i = matches.begin(); i != matches.end(); ++i )
+   {
+      Match m;
+      m.style = _styles[i->style];
+      m.score = i->score;
+      m.outOfRange = i->outOfRange;
+      ret.append(m);
+   }
+
+   return ret;
+}
+
+QList<StyleMatcher::Audit> StyleMatcher::audit( QList<Recipe*> const& recs, int count ) const
+{
+   QList<Audit> ret;
+   BrewCalc::Options const opts = Recipe::calcOptions();
+
+   foreach( Recipe* rec, recs )
+   {
+      Audit a;
+      BrewCalc::StyleStats s = stats(rec, opts);
+
+      a.recipe = rec;
+      a.style = rec->style();
+      a.outOfRange = 0;
+      if( a.style )
+      {
+         if( !_ownRanges.contains(a.style) )
+            _ownRanges.insert( a.style, ranges(a.style) );
+         a.outOfRange = BrewCalc::matchStyle( _ownRanges.value(a.style), s ).outOfRange;
+      }
+      a.best = match( s, count );
+
+      ret.append(a);
+   }
+
+   return ret;
+}
+
+BrewCalc::StyleRanges StyleMatcher::ranges( Style* style )
+{
+   BrewCalc::StyleRanges ret;
+
+   ret.min[BrewCalc::StyleOg] = style->ogMin();
+   ret.max[BrewCalc::StyleOg] = style->ogMax();
+   ret.min[BrewCalc::StyleFg] = style->fgMin();
+   ret.max[BrewCalc::StyleFg] = style->fgMax();
+   ret.min[BrewCalc::StyleIbu] = style->ibuMin();
+   ret.max[BrewCalc::StyleIbu] = style->ibuMax();
+   ret.min[BrewCalc::StyleColor] = style->colorMin_srm();
+   ret.max[BrewCalc::StyleColor] = style->colorMax_srm();
+   ret.min[BrewCalc::StyleAbv] = style->abvMin_pct();
+   ret.max[BrewCalc::StyleAbv] = style->abvMax_pct();
+   ret.min[BrewCalc::StyleCarb] = style->carbMin_vol();
+   ret.max[BrewCalc::StyleCarb] = style->carbMax_vol();
+
+   return ret;
+}
+
+BrewCalc::StyleStats StyleMatcher::stats( Recipe* rec )
+{
+   return stats( rec, Recipe::calcOptions() );
+}
+
+BrewCalc::StyleStats StyleMatcher::stats( Recipe* rec, BrewCalc::Options const& opts )
+{
+   BrewCalc::StyleStats ret;
+   int const stamp = BrewCalc::calcStamp(opts);
+   double carb;
+
+   // Never calculated, or calculated with another formula than the one
+   // the user has now.
+   if( rec->storedStats().calcStamp != stamp )
+      rec->setCalcResults( BrewCalc::calculate(rec->calcInput(), opts), stamp );
+
+   Recipe::StoredStats const& stored = rec->storedStats();
+   ret.value[BrewCalc::StyleOg] = stored.og;
+   ret.value[BrewCalc::StyleFg] = stored.fg;
+   ret.value[BrewCalc::StyleIbu] = stored.IBU;
+   ret.value[BrewCalc::StyleColor] = stored.color_srm;
+   ret.value[BrewCalc::StyleAbv] = stored.ABV_pct;
+   // Most recipes never set the carbonation, so 0 is unknown.
+   carb = rec->carbonation_vols();
+   ret.value[BrewCalc::StyleCarb] = (carb > 0.0) ? carb : -1.0;
+
+   return ret;
+}
+
+QString StyleMatcher::statNames( unsigned int outOfRange )
+{
+   QStringList ret;
+
+   if( outOfRange & (1u << BrewCalc::StyleOg) )
+      ret.append( QObject::tr("OG") );
+   if( outOfRange & (1u << BrewCalc::StyleFg) )
+      ret.append( QObject::tr("FG") );
+   if( outOfRange & (1u << BrewCalc::StyleIbu) )
+      ret.append( QObject::tr("IBU") );
+   if( outOfRange & (1u << BrewCalc::StyleColor) )
+      ret.append( QObject::tr("Color") );
+   if( outOfRange & (1u << BrewCalc::StyleAbv) )
+      ret.append( QObject::tr("ABV") );
+   if( outOfRange & (1u << BrewCalc::StyleCarb) )
+      ret.append( QObject::tr("Carbonation") );
+
+   return ret.join(", ");
+}
@@ -0,0 +1,95 @@
+/*
+ * StyleMatcher.h is part of Brewtarget, and is Copyright the following
+ * authors 2026
+ * - agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _STYLEMATCHER_H
+#define _STYLEMATCHER_H
+
+class StyleMatcher;
+
+#include <QList>
+#include <QHash>
+#include <QString>
+#include "BrewCalc.h"
+
+// Forward declarations
+class Style;
+class Recipe;
+
+/*!
+ * \class StyleMatcher
+ * \author agent
+ *
+ * \brief Finds the styles a recipe fits, for one recipe or the whole library.
+ *
+ * The ranges of the styles are read once, into a \b BrewCalc::StyleIndex,
+ * so each match after that is a few microseconds. Recipes are matched by
+ * their stored statistics, which are calculated first if they never have
+ * been or were calculated with other options.
+ */
+class StyleMatcher
+{
+public:
+   //! \brief How well a recipe fits one style.
+   struct Match
+   {
+      Style* style;
+      //! \brief Same as \c BrewCalc::StyleMatch::score.
+      double score;
+      //! \brief Bit \c BrewCalc::StyleStat set for each statistic out of range.
+      unsigned int outOfRange;
+   };
+
+   //! \brief How a recipe fits the style it says it is, and which it fits best.
+   struct Audit
+   {
+      Recipe* recipe;
+      //! \brief The recipe's own style. Null if it has none.
+      Style* style;
+      //! \brief Of \c style. 0 if the recipe is in style or has none.
+      unsigned int outOfRange;
+      QList<Match> best;
+   };
+
+   //! \brief Index the \c styles that are displayed.
+   StyleMatcher( QList<Style*> const& styles );
+
+   //! \returns up to \c count styles for \c rec, best first.
+   QList<Match> match( Recipe* rec, int count ) const;
+   //! \returns an audit of each of \c recs, with \c count best matches each.
+   QList<Audit> audit( QList<Recipe*> const& recs, int count ) const;
+
+   //! \returns the ranges of \c style.
+   static BrewCalc::StyleRanges ranges( Style* style );
+   //! \returns the statistics of \c rec, as stored with the options as they are now.
+   static BrewCalc::StyleStats stats( Recipe* rec );
+   //! \brief Same as \b stats(Recipe*), with \b Recipe::calcOptions() read once by the caller.
+   static BrewCalc::StyleStats stats( Recipe* rec, BrewCalc::Options const& opts );
+   //! \returns the statistics set in \c outOfRange, like "OG, IBU".
+   static QString statNames( unsigned int outOfRange );
+
+private:
+   QList<Style*> _styles;
+   BrewCalc::StyleIndex _index;
+   //! \brief Ranges of the recipes' own styles, each read once.
+   mutable QHash<Style*,BrewCalc::StyleRanges> _ownRanges;
+
+   QList<Match> match( BrewCalc::StyleStats const& stats, int count ) const;
+};
+
+#endif /*_STYLEMATCHER_H*/
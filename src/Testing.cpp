@@ -19,6 +19,7 @@
 
 #include <Testing.h>
 #include <math.h>
+#include <QFile>
 #include "recipe.h"
 #include "equipment.h"
 #include "database.h"
@@ -26,6 +27,19 @@
 #include "fermentable.h"
 #include "mash.h"
 #include "mashstep.h"
+#include "instruction.h"
+#include "BrewCalc.h"
+#include "Algorithms.h"
+#include "LibraryRecalculator.h"
+#include "HopOptimizer.h"
+#include "HopScheduleTool.h"
+#include "RecipeExporter.h"
+#include "HopTableModel.h"
+#include "StyleMatcher.h"
+#include "BtTreeModel.h"
+#include "BtTreeFilterProxyModel.h"
+#include "BtTreeItem.h"
+#include "UnitSystems.h"
 
 QTEST_MAIN(Testing)
 
@@ -239,3 +253,737 @@ void Testing::cleanupTestCase()
    // It will clear all settings that are application specific, user-scoped, and in the brewtarget namespace.
    QSettings().clear();
 }
+
+void Testing::init()
+{
+   ibuFormula = Brewtarget::ibuFormula;
+}
+
+void Testing::cleanup()
+{
+   // Even when a check failed part way through.
+   Brewtarget::ibuFormula = ibuFormula;
+}
+
+Recipe* Testing::newAllGrainRecipe(QString const& name)
+{
+   Recipe* rec = Database::instance().newRecipe();
+
+   rec->setName(name);
+   rec->setBatchSize_l(equipFiveGalNoLoss->batchSize_l());
+   rec->setBoilSize_l(equipFiveGalNoLoss->boilSize_l());
+   rec->setEfficiency_pct(70.0);
+   Database::instance().addToRecipe(rec, equipFiveGalNoLoss);
+   twoRow->setAmount_kg(5.0);
+   Database::instance().addToRecipe(rec, twoRow);
+   cascade_4pct->setAmount_kg(0.085);
+   Database::instance().addToRecipe(rec, cascade_4pct);
+
+   return rec;
+}
+
+void Testing::inventoryReduceTest()
+{
+   Recipe* recA = Database::instance().newRecipe();
+   Recipe* recB = Database::instance().newRecipe();
+   Fermentable* pilsner = Database::instance().newFermentable();
+
+   pilsner->setName("Pilsner");
+   pilsner->setAmount_kg(3.0);
+   pilsner->setInventoryAmount(10.0);
+
+   // Both recipes get a copy, which shares the inventory of pilsner.
+   Database::instance().addToRecipe(recA, pilsner);
+   Database::instance().addToRecipe(recB, pilsner);
+   QVERIFY2( fuzzyComp(recA->fermentables().first()->inventory(), 10.0, 1e-6), "Copy does not share inventory" );
+
+   // Brew A twice and B once.
+   Database::instance().reduceInventory(QList<Recipe*>() << recA << recB << recA);
+   QVERIFY2( fuzzyComp(pilsner->inventory(), 1.0, 1e-6), "Wrong inventory after reduction" );
+   QVERIFY2( fuzzyComp(recB->fermentables().first()->inventory(), 1.0, 1e-6), "Copy does not share inventory" );
+
+   // Inventory never goes negative.
+   Database::instance().reduceInventory(QList<Recipe*>() << recB);
+   QVERIFY2( fuzzyComp(pilsner->inventory(), 0.0, 1e-6), "Inventory went negative" );
+
+   // The ledger has every change, newest first, wherever the copy was brewed.
+   QList<Database::InventoryChange> brews = Database::instance().inventoryHistory(recB->fermentables().first(), "brew");
+   QVERIFY2( brews.size() == 4, "Ledger is missing brews" );
+   QVERIFY2( brews.first().recipeKey == recB->key() && fuzzyComp(brews.first().delta, -1.0, 1e-6), "Wrong newest ledger entry" );
+   QVERIFY2( fuzzyComp(brews.last().balance, 7.0, 1e-6), "Wrong oldest ledger entry" );
+   QVERIFY2( Database::instance().inventoryHistory(pilsner, "set").size() == 1, "Ledger is missing the set" );
+}
+
+void Testing::exportTest()
+{
+   Recipe* rec = Database::instance().newRecipe();
+   QDir dir(QDir::tempPath() + "/brewtarget-export-test");
+   RecipeExporter exporter(dir.path(), RecipeExporter::TEXT);
+   QFile file;
+   QString out;
+
+   rec->setName("TestRecipe_export");
+   rec->setBatchSize_l(equipFiveGalNoLoss->batchSize_l());
+   rec->setBoilSize_l(equipFiveGalNoLoss->boilSize_l());
+   Database::instance().addToRecipe(rec, equipFiveGalNoLoss);
+   Database::instance().addToRecipe(rec, cascade_4pct);
+
+   // More threads than recipes, so a write job waits on nothing.
+   QVERIFY2( exporter.exportRecipes(QList<Recipe*>() << rec, 4) == 0, "Export failed" );
+
+   file.setFileName(exporter.fileName(rec));
+   QVERIFY2( file.open(QIODevice::ReadOnly), "Export wrote no file" );
+   out = QString::fromUtf8(file.readAll());
+   file.close();
+   QVERIFY2( out.contains("TestRecipe_export"), "Recipe name not exported" );
+   QVERIFY2( out.contains(cascade_4pct->name()), "Hops not exported" );
+
+   file.remove();
+   dir.rmdir(dir.path());
+}
+
+void Testing::brewCalcTest()
+{
+   double const grain_kg = 5.0;
+   BrewCalc::Recipe rec;
+   BrewCalc::Fermentable grain;
+   BrewCalc::Hop hop;
+   BrewCalc::Yeast yeast;
+   BrewCalc::Results res;
+
+   // Gravity conversions go both ways.
+   QVERIFY2( fuzzyComp(BrewCalc::platoToSg(BrewCalc::sgToPlato(1.050)), 1.050, 1e-6), "Wrong plato round trip" );
+
+   // Same as recipeCalcTest_allGrain(), but with plain values.
+   rec.batchSize_l = 18.93;
+   rec.boilSize_l = 18.93;
+   rec.efficiency_pct = 70.0;
+   rec.hasEquipment = true;
+   rec.hasMash = true;
+   rec.mash.totalMashWater_l = rec.boilSize_l + rec.equipment.grainAbsorption_LKg * grain_kg;
+
+   grain.amount_kg = grain_kg;
+   grain.yield_pct = 70.0;
+   grain.color_srm = 2.0;
+   rec.fermentables.push_back(grain);
+
+   hop.alpha_pct = 4.0;
+   hop.amount_kg = 0.085;
+   hop.time_min = 60.0;
+   rec.hops.push_back(hop);
+
+   yeast.attenuation_pct = 75.0;
+   rec.yeasts.push_back(yeast);
+
+   res = BrewCalc::calculate(rec, BrewCalc::Options());
+
+   // Ground-truth og, as in recipeCalcTest_allGrain().
+   double plato = grain_kg * 0.70 * 0.70 / (rec.batchSize_l * 1.050) * 100;
+   double og = 259.0/(259.0-plato);
+
+   QVERIFY2( fuzzyComp(res.volumes.boilVolume_l, rec.boilSize_l, 0.1), "Wrong boil volume calculation" );
+   QVERIFY2( fuzzyComp(res.gravities.og, og, 0.002), "Wrong OG calculation" );
+   QVERIFY2( fuzzyComp(res.gravities.fg, 1.0 + (res.gravities.og-1.0)*0.25, 1e-6), "Wrong FG calculation" );
+   QVERIFY2( res.hopIbus.size() == 1, "Wrong number of hop IBUs" );
+   QVERIFY2( fuzzyComp(res.IBU, res.hopIbus[0], 1e-6), "Wrong IBU total" );
+
+   // The batched kernels agree with the one-hop formulas.
+   BrewCalc::HopSchedule schedule;
+   double hopIbus[3];
+   hop.alpha_pct = 10.0;
+   hop.amount_kg = 0.02;
+   for( int i = 0; i < 3; ++i )
+   {
+      hop.time_min = 30.0*i;
+      BrewCalc::addToSchedule(schedule, hop, BrewCalc::Recipe(), BrewCalc::Options());
+   }
+   BrewCalc::ibus(BrewCalc::Rager, schedule, 20.0, 1.060, hopIbus);
+   for( int i = 0; i < 3; ++i )
+      QVERIFY2( fuzzyComp(hopIbus[i], BrewCalc::rager(0.10, 20.0, 20.0, 1.060, 30.0*i), 1e-9), "Batched IBUs differ" );
+}
+
+void Testing::browseByNameTest()
+{
+   Hop* quoted = Database::instance().newHop();
+   quoted->setName("O'Brien's 100% _Wild_");
+
+   QList<Hop*> hops = Database::instance().hopsByName("cascade 4");
+   QVERIFY2( hops.contains(cascade_4pct), "Name match should ignore case" );
+   QVERIFY2( !hops.contains(quoted), "Name match found the wrong hop" );
+
+   hops = Database::instance().hopsByName("Brien's 100% _W");
+   QVERIFY2( hops.size() == 1 && hops[0] == quoted, "Quotes and wildcards should match as themselves" );
+
+   hops = Database::instance().hopsByName("s_100");
+   QVERIFY2( !hops.contains(quoted), "An underscore should not match any character" );
+
+   Database::instance().deleteElements(QList<BeerXMLElement*>() << quoted);
+   QVERIFY2( Database::instance().hopsByName("O'Brien").isEmpty(), "Deleted hop is still listed" );
+}
+
+void Testing::browsePagingTest()
+{
+   // Unique to this run, in case an earlier one failed before cleaning up.
+   QString const prefix = QString("Paged %1 ").arg(QDateTime::currentMSecsSinceEpoch());
+   QList<BeerXMLElement*> paged;
+   HopTableModel model;
+   int i;
+
+   // One more than a page, named so they list in the order they were made.
+   for( i = 0; i < 201; ++i )
+   {
+      Hop* hop = Database::instance().newHop();
+      hop->setName(prefix + QString("%1").arg(i, 3, 10, QChar('0')));
+      paged.append(hop);
+   }
+
+   model.setPaged(true);
+   model.setNameFilter(prefix);
+   model.observeDatabase(true);
+   QVERIFY2( model.rowCount() == 200 && model.canFetchMore(), "First page is the wrong size" );
+   QVERIFY2( model.getHop(0) == paged.first() && model.getHop(199) == paged[199], "First page is out of order" );
+
+   model.fetchMore();
+   QVERIFY2( model.rowCount() == 201 && !model.canFetchMore(), "Fetching did not list the rest" );
+   QVERIFY2( model.getHop(200) == paged.last(), "Fetched the wrong hop" );
+
+   // Another filter starts again from its own first page.
+   model.setNameFilter(prefix + "19");
+   QVERIFY2( model.rowCount() == 10 && model.getHop(0) == paged[190], "Filter did not start over" );
+
+   Database::instance().deleteElements(paged);
+   QVERIFY2( model.rowCount() == 0, "Deleted hops are still listed" );
+   QVERIFY2( Database::instance().hopsByName(prefix).isEmpty(), "Deleted hops are still in the database list" );
+}
+
+void Testing::recipeRelationsTest()
+{
+   Recipe* rec = Database::instance().newRecipe();
+   Recipe* copy;
+   Hop* hop;
+
+   Database::instance().addToRecipe(rec, cascade_4pct);
+   Database::instance().addToRecipe(rec, equipFiveGalNoLoss);
+   QVERIFY2( rec->hops().size() == 1, "Added hop is missing" );
+   QVERIFY2( rec->equipment() && rec->equipment()->name() == equipFiveGalNoLoss->name(), "Added equipment is missing" );
+   QVERIFY2( rec->mash(), "New recipe has no mash" );
+
+   // A copy starts from what the tables say.
+   copy = Database::instance().newRecipe(rec);
+   QVERIFY2( copy->hops().size() == 1 && copy->hops().first() != rec->hops().first(), "Copy should have its own hop" );
+   QVERIFY2( copy->equipment() && copy->equipment() != rec->equipment(), "Copy should have its own equipment" );
+
+   hop = rec->hops().first();
+   Database::instance().removeFromRecipe(rec, hop);
+   QVERIFY2( rec->hops().isEmpty(), "Removed hop is still there" );
+   QVERIFY2( copy->hops().size() == 1, "Removing from one recipe changed the other" );
+}
+
+void Testing::gravityConversionTest()
+{
+   Polynomial sgToPlato( Polynomial() << -616.868 << 1111.14 << -630.272 << 135.997 );
+   double plato[71];
+   double sg[71];
+   int i;
+
+   // The fit against the root finder it replaces, over its whole range.
+   for( i = 0; i < 71; ++i )
+      plato[i] = i - 10.0;
+   BrewCalc::platoToSg(plato, sg, 71);
+   for( i = 0; i < 71; ++i )
+   {
+      Polynomial poly(sgToPlato);
+      poly[0] -= plato[i];
+      QVERIFY2( fuzzyComp(sg[i], poly.rootFind(1.000, 1.050), 1e-6), "Wrong sg from plato" );
+   }
+
+   // Outside of it, too.
+   QVERIFY2( fuzzyComp(BrewCalc::platoToSg(80.0), 1.4237, 1e-4), "Wrong sg from high plato" );
+
+   QVERIFY2( fuzzyComp(Algorithms::sgByStartingPlato(12.0, BrewCalc::ogFgToPlato(BrewCalc::platoToSg(12.0), 1.012)), 1.012, 1e-6), "Wrong plato from og and fg" );
+}
+
+void Testing::bulkDeleteTest()
+{
+   // Unique to this run, so the folder starts empty.
+   QString const path = QString("/bulk%1").arg(QDateTime::currentMSecsSinceEpoch());
+   QList<BeerXMLElement*> elements;
+   Recipe* first = Database::instance().newRecipe();
+   Recipe* second = Database::instance().newRecipe();
+   Hop* hop = Database::instance().newHop(cascade_4pct);
+   BtTreeModel recipeTree(0, BtTreeModel::RECIPEMASK);
+   BtTreeModel hopTree(0, BtTreeModel::HOPMASK);
+   QModelIndex recipeFolder, hopFolder;
+
+   elements << first << second << hop;
+
+   Database::instance().moveToFolder(elements, path);
+   QVERIFY2( first->folder() == path && second->folder() == path && hop->folder() == path, "Moved elements are not in the folder" );
+
+   // Each tree takes its own kind out of the batch and into the folder.
+   recipeFolder = recipeTree.findFolder(path);
+   hopFolder = hopTree.findFolder(path);
+   QVERIFY2( recipeFolder.isValid() && recipeTree.rowCount(recipeFolder) == 2, "Recipe tree did not make the folder" );
+   QVERIFY2( recipeTree.findElement(first).parent() == recipeFolder && recipeTree.findElement(second).parent() == recipeFolder,
+             "Recipe tree did not move the recipes" );
+   QVERIFY2( !recipeTree.findElement(hop).isValid(), "Recipe tree took the hop" );
+   QVERIFY2( hopFolder.isValid() && hopTree.findElement(hop).parent() == hopFolder, "Hop tree did not move the hop" );
+
+   Database::instance().deleteElements(elements);
+   QVERIFY2( first->deleted() && second->deleted() && hop->deleted(), "Deleted elements are not marked deleted" );
+   QVERIFY2( !recipeTree.findElement(first).isValid() && !recipeTree.findElement(second).isValid(), "Recipe tree kept deleted recipes" );
+   QVERIFY2( recipeTree.rowCount(recipeTree.findFolder(path)) == 0, "Recipe folder still has rows" );
+   QVERIFY2( !hopTree.findElement(hop).isValid(), "Hop tree kept the deleted hop" );
+}
+
+BrewCalc::Recipe Testing::emptyCalcRecipe()
+{
+   BrewCalc::Recipe rec;
+
+   rec.batchSize_l = 20.0;
+   rec.boilSize_l = 25.0;
+   rec.efficiency_pct = 72.0;
+   rec.hasMash = true;
+   rec.mash.totalMashWater_l = 30.0;
+
+   return rec;
+}
+
+void Testing::grainBillTest()
+{
+   double const color_srm[] = { 2.0, 40.0, 0.0 };
+   double const yield_pct[] = { 80.0, 77.0, 100.0 };
+   BrewCalc::Fermentable::Type const type[] = { BrewCalc::Fermentable::Grain, BrewCalc::Fermentable::Grain, BrewCalc::Fermentable::Sugar };
+   BrewCalc::Recipe rec = emptyCalcRecipe();
+   BrewCalc::Options opts;
+   BrewCalc::GrainBillTargets targets;
+   BrewCalc::Results res;
+   std::vector<double> amounts_kg;
+   double total_kg = 0.0;
+   unsigned int i;
+
+   for( i = 0; i < 3; ++i )
+   {
+      BrewCalc::Fermentable ferm;
+      ferm.type = type[i];
+      ferm.amount_kg = 1.0;
+      ferm.yield_pct = yield_pct[i];
+      ferm.color_srm = color_srm[i];
+      ferm.isMashed = (type[i] == BrewCalc::Fermentable::Grain);
+      rec.fermentables.push_back(ferm);
+   }
+
+   // A pale base, 10% crystal and whatever sugar it takes.
+   targets.og = 1.060;
+   targets.color_srm = 8.0;
+   targets.grist_pct.push_back(-1.0);
+   targets.grist_pct.push_back(10.0);
+   targets.grist_pct.push_back(-1.0);
+
+   amounts_kg = BrewCalc::grainBill(rec, targets, opts);
+   QVERIFY2( amounts_kg.size() == 3, "Wrong number of amounts" );
+   for( i = 0; i < amounts_kg.size(); ++i )
+   {
+      QVERIFY2( amounts_kg[i] >= 0.0, "Negative amount" );
+      rec.fermentables[i].amount_kg = amounts_kg[i];
+      total_kg += amounts_kg[i];
+   }
+
+   res = BrewCalc::calculate(rec, opts);
+   QVERIFY2( fuzzyComp(res.gravities.og, 1.060, 0.001), "Missed the target OG" );
+   QVERIFY2( fuzzyComp(res.color_srm, 8.0, 0.2), "Missed the target color" );
+   QVERIFY2( fuzzyComp(amounts_kg[1]/total_kg*100.0, 10.0, 0.2), "Missed the target grist" );
+}
+
+void Testing::hopSearchTest()
+{
+   double const time_min[] = { 60.0, 15.0, 0.0 };
+   BrewCalc::Hop::Use const use[] = { BrewCalc::Hop::Boil, BrewCalc::Hop::Boil, BrewCalc::Hop::Dry_Hop };
+   BrewCalc::Recipe rec = emptyCalcRecipe();
+   BrewCalc::Options opts;
+   BrewCalc::HopTargets targets;
+   BrewCalc::HopSearch search;
+   BrewCalc::Hop substitute;
+   BrewCalc::Fermentable grain;
+   BrewCalc::Results res;
+   std::vector<int> substituted;
+   unsigned int i;
+
+   grain.amount_kg = 5.0;
+   grain.yield_pct = 78.0;
+   rec.fermentables.push_back(grain);
+   for( i = 0; i < 3; ++i )
+   {
+      BrewCalc::Hop hop;
+      hop.alpha_pct = 6.0;
+      hop.amount_kg = 0.02;
+      hop.time_min = time_min[i];
+      hop.use = use[i];
+      rec.hops.push_back(hop);
+   }
+
+   // 40 IBU, 80% from the first addition, with a high alpha hop on the shelf.
+   targets.ibu = 40.0;
+   targets.split_pct.push_back(80.0);
+   targets.timeWindow_min = 10.0;
+   substitute.alpha_pct = 12.0;
+   targets.substitutes.push_back(substitute);
+   targets.substituteStock_kg.push_back(1.0);
+
+   search = BrewCalc::startHopSearch(rec, targets, opts);
+   while( BrewCalc::searchHops(search, 1000) )
+      ;
+   QVERIFY2( search.done == search.total, "Did not look at every schedule" );
+   QVERIFY2( !search.best.empty(), "Found no schedule" );
+
+   rec.hops = BrewCalc::bestHops(search, rec, targets, &substituted);
+   res = BrewCalc::calculate(rec, opts);
+   QVERIFY2( fuzzyComp(res.IBU, 40.0, 1e-6), "Missed the target IBU" );
+   QVERIFY2( fuzzyComp(res.hopIbus[0], 32.0, 1e-6), "Missed the target split" );
+   QVERIFY2( substituted[0] == 0, "Did not use the hop in stock" );
+   QVERIFY2( substituted[1] == -1 && rec.hops[1].time_min == 15.0, "Moved or swapped the late hop" );
+   QVERIFY2( rec.hops[2].amount_kg == 0.02 && substituted[2] == -1, "Changed the dry hop" );
+}
+
+void Testing::hopOptimizerTest()
+{
+   BrewCalc::Recipe rec = emptyCalcRecipe();
+   BrewCalc::HopTargets targets;
+   BrewCalc::Fermentable grain;
+   HopOptimizer optimizer;
+   QSignalSpy progress(&optimizer, SIGNAL(progress(int,double,double,double)));
+   QSignalSpy searched(&optimizer, SIGNAL(searched(int)));
+   int run, nextRun;
+   unsigned int i;
+
+   grain.amount_kg = 5.0;
+   grain.yield_pct = 78.0;
+   rec.fermentables.push_back(grain);
+   for( i = 0; i < 9; ++i )
+   {
+      BrewCalc::Hop hop;
+      hop.alpha_pct = 6.0;
+      hop.amount_kg = 0.02;
+      hop.time_min = 60.0;
+      hop.use = BrewCalc::Hop::Boil;
+      rec.hops.push_back(hop);
+   }
+
+   // Nine additions that all want two hops there is too little of, so
+   // little is ruled out and the search takes seconds.
+   targets.ibu = 60.0;
+   targets.timeWindow_min = 20.0;
+   for( i = 0; i < 2; ++i )
+   {
+      BrewCalc::Hop substitute;
+      substitute.alpha_pct = 10.0 + i;
+      targets.substitutes.push_back(substitute);
+      targets.substituteStock_kg.push_back(0.005);
+   }
+
+   run = optimizer.search(rec, targets, BrewCalc::Options());
+   optimizer.cancel();
+   optimizer.wait();
+   QVERIFY2( optimizer.result().done < optimizer.result().total, "Search was not cancelled" );
+   QVERIFY2( searched.size() == 1 && searched.last().at(0).toInt() == run, "Cancelled run did not say it was done" );
+   QVERIFY2( !progress.isEmpty() && progress.last().at(0).toInt() == run, "Cancelled run gave no progress" );
+   QVERIFY2( progress.last().at(1).toDouble() == optimizer.result().done, "Last progress is not where the search stopped" );
+
+   // Small enough to finish.
+   rec.hops.resize(2);
+   targets.substitutes.clear();
+   targets.substituteStock_kg.clear();
+   nextRun = optimizer.search(rec, targets, BrewCalc::Options());
+   optimizer.wait();
+   QVERIFY2( nextRun != run, "Two runs have the same number" );
+   QVERIFY2( optimizer.result().done == optimizer.result().total && !optimizer.result().best.empty(), "Search did not finish" );
+   QVERIFY2( searched.size() == 2 && searched.last().at(0).toInt() == nextRun, "Finished run did not say it was done" );
+   QVERIFY2( progress.last().at(0).toInt() == nextRun && progress.last().at(1).toDouble() == progress.last().at(2).toDouble(),
+             "Last progress is not the whole search" );
+}
+
+void Testing::hopScheduleTest()
+{
+   Recipe* rec = newAllGrainRecipe("TestRecipe_hopSchedule");
+   Hop* magnum = Database::instance().newHop();
+   HopScheduleTool tool;
+
+   magnum->setName("Magnum 14pct");
+   magnum->setAlpha_pct(14.0);
+   magnum->setUse(Hop::Boil);
+   magnum->setTime_min(60);
+   magnum->setInventoryAmount(1.0);
+
+   tool.setRecipe(rec);
+   tool.reset();
+   tool.ibuSpinBox->setValue(50.0);
+   tool.search();
+   QTRY_VERIFY( tool.pushButton_apply->isEnabled() );
+   tool.apply();
+   QVERIFY2( rec->hops().size() == 1 && rec->hops().first()->name() == cascade_4pct->name(), "Swapped the hop" );
+   QVERIFY2( fuzzyComp(rec->IBU(), 50.0, 0.05), "Missed the target IBU" );
+   QVERIFY2( !tool.pushButton_apply->isEnabled(), "Kept a schedule for the recipe as it was" );
+
+   // Hops in stock are cheaper than buying more.
+   tool.substituteCheckBox->setChecked(true);
+   tool.search();
+   QTRY_VERIFY( tool.pushButton_apply->isEnabled() );
+   tool.apply();
+   magnum->setInventoryAmount(0.0);
+   QVERIFY2( rec->hops().size() == 1 && fuzzyComp(rec->hops().first()->alpha_pct(), 14.0, 1e-9), "Did not use the hop in stock" );
+   QVERIFY2( fuzzyComp(rec->IBU(), 50.0, 0.05), "Missed the target IBU with the hop in stock" );
+}
+
+void Testing::libraryRecalcTest()
+{
+   Recipe* rec = newAllGrainRecipe("TestRecipe_recalc");
+   LibraryRecalculator recalc;
+   double tinsethIbu, og;
+   int run;
+
+   tinsethIbu = rec->IBU();
+   og = rec->og();
+
+   // As if the IBU formula were changed in the options.
+   Brewtarget::ibuFormula = Brewtarget::RAGER;
+   // Edited during the run, so it keeps the statistics it gave itself.
+   run = recalc.recalculate( QList<Recipe*>() << rec );
+   recalc.wait();
+   rec->setNotes("Edited while recalculating");
+   QVERIFY2( recalc.apply(run) == 0, "Overwrote a recipe edited during the run" );
+
+   run = recalc.recalculate( QList<Recipe*>() << rec );
+   recalc.wait();
+   QVERIFY2( recalc.apply(run - 1) == 0, "Applied a superseded run" );
+   QVERIFY2( recalc.apply(run) == 1, "Did not recalculate the recipe" );
+
+   // Both formulas are linear in grams and 1/volume, so only the time and gravity terms differ.
+   QVERIFY2( fuzzyComp(rec->IBU(),
+                       tinsethIbu * BrewCalc::rager(0.04, 85.0, 20.0, og, 60.0) / BrewCalc::tinseth(0.04, 85.0, 20.0, og, 60.0),
+                       1e-6),
+             "Wrong IBU after recalculating" );
+   QVERIFY2( fuzzyComp(rec->og(), og, 1e-9), "OG changed with the IBU formula" );
+}
+
+void Testing::storedStatsTest()
+{
+   Recipe* rec = newAllGrainRecipe("TestRecipe_stats");
+   BrewCalc::StyleStats stats;
+   double tinsethIbu;
+
+   // Reading a calculated property calculates and stores all of them.
+   QVERIFY2( rec->IBU() > 0.0, "No IBUs" );
+   QVERIFY2( rec->storedStats().calcStamp == Recipe::currentCalcStamp(), "Wrong calculation stamp" );
+   QVERIFY2( fuzzyComp(rec->storedStats().og, rec->og(), 1e-9), "Wrong stored OG" );
+   QVERIFY2( fuzzyComp(rec->storedStats().IBU, rec->IBU(), 1e-9), "Wrong stored IBU" );
+   QVERIFY2( fuzzyComp(rec->storedStats().ABV_pct, rec->ABV_pct(), 1e-9), "Wrong stored ABV" );
+
+   // And they are in the database, not just in memory.
+   QVERIFY2( fuzzyComp(Database::instance().get(Brewtarget::RECTABLE, rec->key(), "calc_ibu").toDouble(), rec->IBU(), 1e-9),
+             "IBU not written" );
+   QVERIFY2( fuzzyComp(Database::instance().get(Brewtarget::RECTABLE, rec->key(), "calc_color_srm").toDouble(), rec->color_srm(), 1e-9),
+             "Color not written" );
+   QVERIFY2( Database::instance().get(Brewtarget::RECTABLE, rec->key(), "calc_stamp").toInt() == Recipe::currentCalcStamp(),
+             "Stamp not written" );
+
+   // Changing the options makes them out of date.
+   tinsethIbu = rec->storedStats().IBU;
+   Brewtarget::ibuFormula = Brewtarget::RAGER;
+   QVERIFY2( Recipe::currentCalcStamp() != rec->storedStats().calcStamp, "Stamp ignores the IBU formula" );
+
+   // Matching styles brings them up to date first.
+   stats = StyleMatcher::stats(rec);
+   QVERIFY2( rec->storedStats().calcStamp == Recipe::currentCalcStamp(), "Styles matched on out of date statistics" );
+   QVERIFY2( stats.value[BrewCalc::StyleIbu] != tinsethIbu && stats.value[BrewCalc::StyleIbu] == rec->storedStats().IBU,
+             "Styles matched on the old IBUs" );
+}
+
+void Testing::styleMatchTest()
+{
+   std::vector<BrewCalc::StyleRanges> styles(3);
+   BrewCalc::StyleStats stats;
+   std::vector<BrewCalc::StyleMatch> matches;
+   unsigned int i;
+
+   // A pale ale, an IPA and a stout.
+   styles[0].min[BrewCalc::StyleOg] = 1.045; styles[0].max[BrewCalc::StyleOg] = 1.060;
+   styles[0].min[BrewCalc::StyleIbu] = 30.0; styles[0].max[BrewCalc::StyleIbu] = 50.0;
+   styles[0].min[BrewCalc::StyleColor] = 5.0; styles[0].max[BrewCalc::StyleColor] = 10.0;
+   styles[1].min[BrewCalc::StyleOg] = 1.056; styles[1].max[BrewCalc::StyleOg] = 1.070;
+   styles[1].min[BrewCalc::StyleIbu] = 40.0; styles[1].max[BrewCalc::StyleIbu] = 70.0;
+   styles[1].min[BrewCalc::StyleColor] = 6.0; styles[1].max[BrewCalc::StyleColor] = 14.0;
+   styles[2].min[BrewCalc::StyleOg] = 1.044; styles[2].max[BrewCalc::StyleOg] = 1.060;
+   styles[2].min[BrewCalc::StyleIbu] = 25.0; styles[2].max[BrewCalc::StyleIbu] = 45.0;
+   styles[2].min[BrewCalc::StyleColor] = 30.0; styles[2].max[BrewCalc::StyleColor] = 40.0;
+
+   // A pale beer that fits both ales, but is nearer the middle of the pale ale.
+   stats.value[BrewCalc::StyleOg] = 1.058;
+   stats.value[BrewCalc::StyleIbu] = 45.0;
+   stats.value[BrewCalc::StyleColor] = 8.0;
+
+   matches = BrewCalc::matchStyles(BrewCalc::indexStyles(styles), stats, 3);
+   QVERIFY2( matches.size() == 3, "Wrong number of matches" );
+   QVERIFY2( matches[0].style == 0 && matches[1].style == 1 && matches[2].style == 2, "Wrong ranking" );
+   QVERIFY2( matches[0].score <= 1.0 && matches[1].score <= 1.0, "Fitting styles scored as misses" );
+   QVERIFY2( matches[0].outOfRange == 0 && matches[1].outOfRange == 0, "Fitting styles out of range" );
+   QVERIFY2( matches[2].score > 1.0, "Stout scored as a fit" );
+   QVERIFY2( matches[2].outOfRange == (1u << BrewCalc::StyleColor), "Stout out of range on the wrong statistic" );
+
+   // The index scores the same as matching one style at a time.
+   for( i = 0; i < matches.size(); ++i )
+   {
+      BrewCalc::StyleMatch one = BrewCalc::matchStyle(styles[matches[i].style], stats);
+      QVERIFY2( fuzzyComp(one.score, matches[i].score, 1e-9), "Index and single match disagree" );
+      QVERIFY2( one.outOfRange == matches[i].outOfRange, "Index and single match disagree on the ranges" );
+   }
+}
+
+void Testing::similarRecipesTest()
+{
+   BrewCalc::NeighborIndex index;
+   std::vector<BrewCalc::Neighbor> nearest;
+   std::vector<double> point(2, 0.0);
+   BrewCalc::Recipe rec;
+   BrewCalc::Hop hop;
+   BrewCalc::StyleStats stats;
+   std::vector<unsigned int> cascade(1, 1);
+   std::vector<unsigned int> galena(1, 2);
+   std::vector<unsigned int> noYeast;
+   unsigned int i;
+
+   // Ids 10 to 13 at 0 to 3 on a line.
+   for( i = 0; i < 4; ++i )
+   {
+      point[0] = i;
+      BrewCalc::setNeighbor(index, 10 + i, point);
+   }
+
+   point[0] = 0.9;
+   nearest = BrewCalc::nearestNeighbors(index, point, 2, -1);
+   QVERIFY2( nearest.size() == 2 && nearest[0].id == 11 && nearest[1].id == 10, "Wrong nearest points" );
+   QVERIFY2( fuzzyComp(nearest[0].distance, 0.1, 1e-9), "Wrong distance" );
+
+   // Take one out and move another.
+   BrewCalc::removeNeighbor(index, 11);
+   point[0] = 0.8;
+   BrewCalc::setNeighbor(index, 13, point);
+
+   point[0] = 0.9;
+   nearest = BrewCalc::nearestNeighbors(index, point, 2, -1);
+   QVERIFY2( nearest.size() == 2 && nearest[0].id == 13 && nearest[1].id == 10, "Index did not follow the changes" );
+   nearest = BrewCalc::nearestNeighbors(index, point, 5, 13);
+   QVERIFY2( nearest.size() == 2 && nearest[0].id == 10 && nearest[1].id == 12, "Excluded point was found" );
+
+   // The same numbers with another hop are a different recipe.
+   hop.amount_kg = 0.03;
+   hop.use = BrewCalc::Hop::Boil;
+   hop.time_min = 60.0;
+   rec.hops.push_back(hop);
+   stats.value[BrewCalc::StyleOg] = 1.050;
+   stats.value[BrewCalc::StyleIbu] = 30.0;
+
+   std::vector<double> withCascade = BrewCalc::recipeFeatures(rec, stats, cascade, noYeast);
+   std::vector<double> withGalena = BrewCalc::recipeFeatures(rec, stats, galena, noYeast);
+   QVERIFY2( withCascade.size() == BrewCalc::NumRecipeFeatures, "Wrong number of features" );
+   QVERIFY2( withCascade[BrewCalc::FeatureHopTiming] > 0.0 && withCascade[BrewCalc::FeatureHopTiming + 3] == 0.0,
+             "60 minute hop is not bittering" );
+   QVERIFY2( withCascade[BrewCalc::FeatureOg] == withGalena[BrewCalc::FeatureOg] && withCascade != withGalena,
+             "Hop varieties make no difference" );
+}
+
+void Testing::statFilterTest()
+{
+   Recipe* light = newAllGrainRecipe("TestRecipe_filterLight");
+   Recipe* strong = newAllGrainRecipe("TestRecipe_filterStrong");
+   double og;
+   QString platoText;
+   bool parsed;
+
+   // More malt and, so that the text and numeric orders differ, over 100 IBU.
+   strong->fermentables().first()->setAmount_kg(8.0);
+   strong->hops().first()->setAmount_kg(0.4);
+   og = (light->og() + strong->og()) / 2.0;
+   QVERIFY2( light->IBU() < 100.0 && strong->IBU() >= 100.0, "Wrong IBUs for the sort" );
+
+   BtTreeModel model(0, BtTreeModel::RECIPEMASK);
+   BtTreeFilterProxyModel filter(0, BtTreeModel::RECIPEMASK);
+   filter.setSourceModel(&model);
+   QModelIndex lightNdx = model.findElement(light);
+   QModelIndex strongNdx = model.findElement(strong);
+   QVERIFY2( lightNdx.isValid() && strongNdx.isValid(), "Recipes are not in the tree" );
+
+   QVERIFY2( filter.setStatFilter(QString("og<%1 ibu>=10").arg(og, 0, 'f', 4)), "Did not parse a good filter" );
+   QVERIFY2( filter.mapFromSource(lightNdx).isValid() && !filter.mapFromSource(strongNdx).isValid(), "Wrong recipes shown" );
+
+   QVERIFY2( !filter.setStatFilter("og<<1.050"), "Parsed a bad filter" );
+   QVERIFY2( filter.mapFromSource(lightNdx).isValid() && !filter.mapFromSource(strongNdx).isValid(), "A bad filter changed the filter" );
+
+   // Gravity is read in whatever units the tree shows.
+   platoText = QString("og>%1").arg(BrewCalc::sgToPlato(og), 0, 'f', 2);
+   Brewtarget::thingToUnitSystem.insert(Unit::Density, UnitSystems::platoDensityUnitSystem());
+   parsed = filter.setStatFilter(platoText);
+   Brewtarget::thingToUnitSystem.insert(Unit::Density, UnitSystems::sgDensityUnitSystem());
+   QVERIFY2( parsed, "Did not parse a filter in Plato" );
+   QVERIFY2( !filter.mapFromSource(lightNdx).isValid() && filter.mapFromSource(strongNdx).isValid(), "Plato read as SG" );
+
+   QVERIFY2( filter.setStatFilter(""), "Did not parse an empty filter" );
+   QVERIFY2( filter.mapFromSource(lightNdx).isValid() && filter.mapFromSource(strongNdx).isValid(), "Empty filter hid recipes" );
+
+   // By number, not by the text in the column.
+   filter.sort(BtTreeItem::RECIPEIBUCOL, Qt::AscendingOrder);
+   QVERIFY2( filter.mapFromSource(lightNdx).row() < filter.mapFromSource(strongNdx).row(), "IBUs sorted as text" );
+}
+
+void Testing::instructionsTest()
+{
+   Recipe* rec = newAllGrainRecipe("TestRecipe_instructions");
+   MashStep* step;
+   QList<Instruction*> first, second;
+   QStringList names;
+   int changes, i;
+
+   // Two steps, so there are mash instructions to write too.
+   step = Database::instance().newMashStep(rec->mash());
+   step->setName("Conversion");
+   step->setType(MashStep::Infusion);
+   step->setInfuseAmount_l(14.0);
+   step->setStepTime_min(60);
+   step = Database::instance().newMashStep(rec->mash());
+   step->setName("Sparge");
+   step->setType(MashStep::Infusion);
+   step->setInfuseAmount_l(15.0);
+
+   // So the spy can keep the property each change is for.
+   qRegisterMetaType<QMetaProperty>();
+   QSignalSpy spy(rec, SIGNAL(changed(QMetaProperty,QVariant)));
+   rec->generateInstructions();
+   first = rec->instructions();
+
+   changes = 0;
+   for( i = 0; i < spy.size(); ++i )
+   {
+      if( qvariant_cast<QMetaProperty>(spy[i].at(0)).name() == QString("instructions") )
+         ++changes;
+   }
+   QVERIFY2( changes == 1, "Observers were not told once" );
+
+   QVERIFY2( !first.isEmpty(), "No instructions" );
+   for( i = 0; i < first.size(); ++i )
+   {
+      QVERIFY2( Database::instance().instructionNumber(first[i]) == i + 1, "Instructions are out of order" );
+      names.append(first[i]->name());
+   }
+   QVERIFY2( names.indexOf(QString("Start boil")) < names.indexOf(QString("Flameout")) && names.indexOf(QString("Start boil")) >= 0,
+             "Boil instructions are missing or out of order" );
+   QVERIFY2( names.contains(QString("Pitch yeast")) && names.contains(QString("Ferment")), "Fermentation instructions are missing" );
+
+   // Regenerating replaces them, not adds to them, and numbers from 1 again.
+   rec->generateInstructions();
+   second = rec->instructions();
+   QVERIFY2( second.size() == first.size(), "Regenerating changed the number of instructions" );
+   QVERIFY2( second.first()->key() != first.first()->key() && Database::instance().instructionNumber(first.first()) == 0,
+             "Old instructions are still in the recipe" );
+   QVERIFY2( Database::instance().instructionNumber(second.first()) == 1, "New instructions do not start at 1" );
+   for( i = 0; i < second.size(); ++i )
+      QVERIFY2( second[i]->name() == names[i], "Regenerated instructions differ" );
+}
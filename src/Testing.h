@@ -30,9 +30,11 @@
 class Equipment;
 class Hop;
 class Fermentable;
+class Recipe;
 
 #include "brewtarget.h"
 #include "pstdint.h"
+#include "BrewCalc.h"
 
 class Testing : public QObject
 {
@@ -61,6 +63,13 @@ private:
    Hop* cascade_4pct;
    //! \brief 70% yield, no moisture, 2 SRM
    Fermentable* twoRow;
+   //! \brief The IBU formula before each test, for tests that change it.
+   Brewtarget::IbuType ibuFormula;
+
+   //! \brief A new all-grain recipe on equipFiveGalNoLoss, with 5 kg of twoRow and 85 g of cascade_4pct.
+   Recipe* newAllGrainRecipe(QString const& name);
+   //! \brief A BrewCalc::Recipe of 20 L from a 25 L boil, 72% efficiency and 30 L of mash water, with no ingredients.
+   static BrewCalc::Recipe emptyCalcRecipe();
 
 private slots:
 
@@ -70,6 +79,10 @@ private slots:
    // Run once after all test cases
    void cleanupTestCase();
 
+   // Run before and after each test case
+   void init();
+   void cleanup();
+
    //! \brief Verify pstdint.h is sane
    void pstdintTest()
    {
@@ -103,6 +116,60 @@ private slots:
 
    //! \brief Verify post-boil losses do not affect OG
    void postBoilLossOgTest();
+
+   //! \brief Verify reducing inventory for several recipes at once
+   void inventoryReduceTest();
+
+   //! \brief Verify recipes are exported to files
+   void exportTest();
+
+   //! \brief Verify the value-only calculations without any database
+   void brewCalcTest();
+
+   //! \brief Verify the paged ingredient lists match names literally
+   void browseByNameTest();
+
+   //! \brief Verify the ingredient tables list a page at a time and follow deletes
+   void browsePagingTest();
+
+   //! \brief Verify the recipe relations follow adds, removes and copies
+   void recipeRelationsTest();
+
+   //! \brief Verify the fast gravity conversions against the root finder
+   void gravityConversionTest();
+
+   //! \brief Verify bulk moves and deletes reach every element and the trees
+   void bulkDeleteTest();
+
+   //! \brief Verify the grain bill solver hits its targets
+   void grainBillTest();
+
+   //! \brief Verify the hop schedule search hits its targets
+   void hopSearchTest();
+
+   //! \brief Verify the hop search thread reports progress, stops when cancelled and numbers its runs
+   void hopOptimizerTest();
+
+   //! \brief Verify the hop schedule dialog writes the schedule it found to the recipe
+   void hopScheduleTest();
+
+   //! \brief Verify recipes take on new statistics when the formulas change
+   void libraryRecalcTest();
+
+   //! \brief Verify recipes store the statistics the recipe tree shows
+   void storedStatsTest();
+
+   //! \brief Verify styles are matched and ranked by their ranges
+   void styleMatchTest();
+
+   //! \brief Verify the nearest recipes are found, and the index follows changes
+   void similarRecipesTest();
+
+   //! \brief Verify the recipe tree filters and sorts on the stored statistics
+   void statFilterTest();
+
+   //! \brief Verify instructions are replaced in order, with one change for observers
+   void instructionsTest();
 };
 
 #endif /*TESTING_H*/
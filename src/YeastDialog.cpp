@@ -39,6 +39,8 @@ YeastDialog::YeastDialog(MainWindow* parent)
 
    yeastTableModel = new YeastTableModel(tableWidget, false);
    yeastTableModel->setInventoryEditable(true);
+   // Big catalogs are listed a page at a time, as the table scrolls.
+   yeastTableModel->setPaged(true);
    yeastTableProxy = new YeastSortFilterProxyModel(tableWidget);
    yeastTableProxy->setSourceModel(yeastTableModel);
    tableWidget->setModel(yeastTableProxy);
@@ -221,6 +223,8 @@ void YeastDialog::newYeast()
 
 void YeastDialog::filterYeasts(QString searchExpression)
 {
+    // Rows not listed yet are invisible to the proxy, so ask the database too.
+    yeastTableModel->setNameFilter(searchExpression);
     yeastTableProxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
     yeastTableProxy->setFilterFixedString(searchExpression);
 }
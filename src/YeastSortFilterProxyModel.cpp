@@ -35,21 +35,23 @@ bool YeastSortFilterProxyModel::lessThan(const QModelIndex &left,
 {
     QVariant leftYeast = sourceModel()->data(left);
     QVariant rightYeast = sourceModel()->data(right);
-    Unit* unit = Units::liters;
     double lAmt, rAmt;
 
     switch( left.column() )
     {
     case YEASTINVENTORYCOL:
-      if (Brewtarget::qStringToSI(leftYeast.toString(),unit) == 0.0 && this->sortOrder() == Qt::AscendingOrder)
+      // Numbers come back in SI under Qt::UserRole.
+      lAmt = sourceModel()->data(left, Qt::UserRole).toDouble();
+      rAmt = sourceModel()->data(right, Qt::UserRole).toDouble();
+      if (lAmt == 0.0 && this->sortOrder() == Qt::AscendingOrder)
          return false;
       else
-         return Brewtarget::qStringToSI(leftYeast.toString(),unit) < Brewtarget::qStringToSI(rightYeast.toString(),unit);
+         return lAmt < rAmt;
        // This is a lie. I need to figure out if they are weights or volumes.
        // and then figure some reasonable way to compare weights to volumes.
        // Maybe lying isn't such a bad idea
     case YEASTAMOUNTCOL:
-      return Brewtarget::qStringToSI(leftYeast.toString(),unit) < Brewtarget::qStringToSI(rightYeast.toString(),unit);
+      return sourceModel()->data(left, Qt::UserRole).toDouble() < sourceModel()->data(right, Qt::UserRole).toDouble();
     case YEASTPRODIDCOL:
       lAmt = Brewtarget::toDouble( leftYeast.toString(), "YeastSortFilterProxyModel::lessThan");
       rAmt = Brewtarget::toDouble( rightYeast.toString(), "YeastSortFilterProxyModel::lessThan");
@@ -45,7 +45,9 @@ YeastTableModel::YeastTableModel(QTableView* parent, bool editable)
      editable(editable),
      _inventoryEditable(false),
      parentTableWidget(parent),
-     recObs(0)
+     recObs(0),
+     _paged(false),
+     _displayCache(YEASTNUMCOLS)
 {
    yeastObs.clear();
    setObjectName("yeastTableModel");
@@ -63,6 +65,8 @@ void YeastTableModel::addYeast(Yeast* yeast)
 {
    if( yeastObs.contains(yeast) )
       return;
+   // It may not have been listed yet.
+   _unfetched.removeOne(yeast);
    // If we are observing the database, ensure that the item is undeleted and
    // fit to display.
    if(
@@ -106,7 +110,13 @@ void YeastTableModel::observeDatabase(bool val)
       removeAll();
       connect( &(Database::instance()), SIGNAL(newYeastSignal(Yeast*)), this, SLOT(addYeast(Yeast*)) );
       connect( &(Database::instance()), SIGNAL(deletedYeastSignal(Yeast*)), this, SLOT(removeYeast(Yeast*)) );
-      addYeasts( Database::instance().yeasts() );
+      if( _paged )
+      {
+         _unfetched = Database::instance().yeastsByName(_nameFilter);
+         fetchMore();
+      }
+      else
+         addYeasts( Database::instance().yeasts() );
    }
    else
    {
@@ -143,6 +153,9 @@ void YeastTableModel::removeYeast(Yeast* yeast)
 {
    int i = yeastObs.indexOf(yeast);
 
+   _unfetched.removeOne(yeast);
+   _displayCache.remove(yeast);
+
    if( i >= 0 )
    {
       beginRemoveRows( QModelIndex(), i, i );
@@ -155,6 +168,8 @@ void YeastTableModel::removeYeast(Yeast* yeast)
 
 void YeastTableModel::removeAll()
 {
+   _unfetched.clear();
+   _displayCache.clear();
    if (yeastObs.size())
    {
       beginRemoveRows( QModelIndex(), 0, yeastObs.size()-1 );
@@ -166,6 +181,50 @@ void YeastTableModel::removeAll()
    }
 }
 
+void YeastTableModel::setPaged( bool var )
+{
+   _paged = var;
+}
+
+void YeastTableModel::setNameFilter( QString const& text )
+{
+   if( text == _nameFilter )
+      return;
+
+   _nameFilter = text;
+   if( _paged && recObs == 0 )
+   {
+      removeAll();
+      _unfetched = Database::instance().yeastsByName(_nameFilter);
+      fetchMore();
+   }
+}
+
+bool YeastTableModel::canFetchMore( const QModelIndex& parent ) const
+{
+   return !parent.isValid() && !_unfetched.isEmpty();
+}
+
+void YeastTableModel::fetchMore( const QModelIndex& parent )
+{
+   int i, size, n;
+
+   if( parent.isValid() || _unfetched.isEmpty() )
+      return;
+
+   // Nothing in _unfetched is listed yet, so no need to check for repeats.
+   size = yeastObs.size();
+   n = qMin(pageSize, _unfetched.size());
+   beginInsertRows( QModelIndex(), size, size+n-1 );
+   for( i = 0; i < n; ++i )
+   {
+      Yeast* item = _unfetched.takeFirst();
+      yeastObs.append(item);
+      connect( item, SIGNAL(changed(QMetaProperty,QVariant)), this, SLOT(changed(QMetaProperty,QVariant)) );
+   }
+   endInsertRows();
+}
+
 void YeastTableModel::changed(QMetaProperty prop, QVariant /*val*/)
 {
    int i;
@@ -174,6 +233,8 @@ void YeastTableModel::changed(QMetaProperty prop, QVariant /*val*/)
    Yeast* yeastSender = qobject_cast<Yeast*>(sender());
    if( yeastSender )
    {
+      _displayCache.remove(yeastSender);
+
       i = yeastObs.indexOf(yeastSender);
       if( i < 0 )
          return;
@@ -211,7 +272,7 @@ int YeastTableModel::columnCount(const QModelIndex& /*parent*/) const
 QVariant YeastTableModel::data( const QModelIndex& index, int role ) const
 {
    Yeast* row;
-   Unit::unitDisplay unit;
+   QVariant* cell;
 
    // Ensure the row is ok.
    if( index.row() >= (int)yeastObs.size() )
@@ -222,7 +283,23 @@ QVariant YeastTableModel::data( const QModelIndex& index, int role ) const
    else
       row = yeastObs[index.row()];
 
-   switch( index.column() )
+   // Inventory is left out. See DisplayCache.
+   if( index.column() == YEASTINVENTORYCOL )
+      return uncachedData(row, index.column(), role);
+
+   cell = _displayCache.cell(row, index.column(), role);
+   if( cell == 0 )
+      return uncachedData(row, index.column(), role);
+   if( !cell->isValid() )
+      *cell = uncachedData(row, index.column(), role);
+   return *cell;
+}
+
+QVariant YeastTableModel::uncachedData( Yeast* row, int col, int role ) const
+{
+   Unit::unitDisplay unit;
+
+   switch( col )
    {
       case YEASTNAMECOL:
          if( role != Qt::DisplayRole )
@@ -254,14 +331,18 @@ QVariant YeastTableModel::data( const QModelIndex& index, int role ) const
          else
             return QVariant();
       case YEASTINVENTORYCOL:
-         if( role != Qt::DisplayRole )
+         if( role == Qt::UserRole )
+            return QVariant(row->inventory());
+         else if( role != Qt::DisplayRole )
             return QVariant();
          return QVariant( row->inventory() );
       case YEASTAMOUNTCOL:
-         if( role != Qt::DisplayRole )
+         if( role == Qt::UserRole )
+            return QVariant(row->amount());
+         else if( role != Qt::DisplayRole )
             return QVariant();
 
-         unit  = displayUnit(index.column());
+         unit  = displayUnit(col);
 
          return QVariant(
                            Brewtarget::displayAmount( row->amount(),
@@ -273,7 +354,7 @@ QVariant YeastTableModel::data( const QModelIndex& index, int role ) const
                         );
 
       default :
-         Brewtarget::logW(tr("Bad column: %1").arg(index.column()));
+         Brewtarget::logW(tr("Bad column: %1").arg(col));
          return QVariant();
    }
 }
@@ -30,6 +30,7 @@
 #include "brewnote.h"
 #include "brewtarget.h"
 #include "Algorithms.h"
+#include "BrewCalc.h"
 #include "mashstep.h"
 #include "recipe.h"
 #include "equipment.h"
@@ -393,13 +394,7 @@ int BrewNote::key() const                  { return _key; }
 double BrewNote::calculateEffIntoBK_pct()
 {
    double effIntoBK;
-   double maxPoints, actualPoints;
-
-   // I don't think we need a lot of math here. Points has already been
-   // translated from SG into pure glucose points
-   maxPoints = projPoints() * projVolIntoBK_l();
-
-   actualPoints = (sg() - 1) * 1000 * volumeIntoBK_l();
+   double maxPoints = projPoints() * projVolIntoBK_l();
 
    if (maxPoints <= 0.0)
    {
@@ -407,7 +402,7 @@ double BrewNote::calculateEffIntoBK_pct()
       return 0.0;
    }
 
-   effIntoBK = actualPoints/maxPoints * 100;
+   effIntoBK = BrewCalc::effIntoBK_pct( projPoints(), projVolIntoBK_l(), sg(), volumeIntoBK_l() );
    setEffIntoBK_pct(effIntoBK);
 
    return effIntoBK;
@@ -418,11 +413,7 @@ double BrewNote::calculateEffIntoBK_pct()
 double BrewNote::calculateOg()
 {
    double cOG;
-   double points, expectedVol, actualVol;
-
-   points = (sg()-1) * 1000;
-   expectedVol = projVolIntoBK_l() - boilOff_l();
-   actualVol   = volumeIntoBK_l();
+   double expectedVol = projVolIntoBK_l() - boilOff_l();
 
    if ( expectedVol <= 0.0 )
    {
@@ -430,7 +421,7 @@ double BrewNote::calculateOg()
       return 0.0;
    }
 
-   cOG = 1+ ((points * actualVol / expectedVol) / 1000);
+   cOG = BrewCalc::projOg( sg(), projVolIntoBK_l(), boilOff_l(), volumeIntoBK_l() );
    setProjOg(cOG);
 
    return cOG;
@@ -438,13 +429,9 @@ double BrewNote::calculateOg()
 
 double BrewNote::calculateBrewHouseEff_pct()
 {
-   double expectedPoints, actualPoints;
    double brewhouseEff;
 
-   expectedPoints = projFermPoints() * projVolIntoFerm_l();
-   actualPoints = (og()-1.0) * 1000.0 * volumeIntoFerm_l();
-
-   brewhouseEff = actualPoints/expectedPoints * 100.0;
+   brewhouseEff = BrewCalc::brewhouseEff_pct( projFermPoints(), projVolIntoFerm_l(), og(), volumeIntoFerm_l() );
    setBrewhouseEff_pct(brewhouseEff);
 
    return brewhouseEff;
@@ -454,16 +441,9 @@ double BrewNote::calculateBrewHouseEff_pct()
 // on the actual OG, not the calculated.
 double BrewNote::calculateABV_pct()
 {
-   double atten_pct = projAtten();
    double calculatedABV;
-   double estFg;
-
-   // This looks weird, but the math works. (Yes, I am showing my work)
-   // 1 + [(og-1) * 1000 * (1.0 - %/100)] / 1000  =
-   // 1 + [(og - 1) * (1.0 - %/100)]
-   estFg = 1 + ((og()-1.0)*(1.0 - atten_pct/100.0));
 
-   calculatedABV = (og()-estFg)*130;
+   calculatedABV = BrewCalc::projABV_pct( og(), projAtten() );
    setProjABV_pct(calculatedABV);
 
    return calculatedABV;
@@ -473,7 +453,7 @@ double BrewNote::calculateActualABV_pct()
 {
    double abv;
 
-   abv = (og() - fg()) * 130;
+   abv = BrewCalc::actualABV_pct( og(), fg() );
    setABV(abv);
 
    return abv;
@@ -24,6 +24,7 @@
  */
 
 #include <iostream>
+#include <cstdlib>
 #include <QFile>
 #include <QIODevice>
 #include <QString>
@@ -47,6 +48,10 @@
 #include <QPixmap>
 #include <QSplashScreen>
 #include <QSettings>
+#include <QMutexLocker>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
 
 #include "brewtarget.h"
 #include "config.h"
@@ -71,6 +76,11 @@
 #include "PlatoDensityUnitSystem.h"
 
 #include "BtSplashScreen.h"
+#include "RecipeExporter.h"
+#include "RecipeCalculator.h"
+#include "SqlProfiler.h"
+#include "StartupTrace.h"
+#include "Logger.h"
 #include "MainWindow.h"
 #include "mash.h"
 #include "instruction.h"
@@ -82,6 +92,9 @@ QTranslator* Brewtarget::defaultTrans = new QTranslator();
 QTranslator* Brewtarget::btTrans = new QTranslator();
 QTextStream* Brewtarget::logStream = 0;
 QFile* Brewtarget::logFile = 0;
+QMutex Brewtarget::logMutex;
+Brewtarget::LogType Brewtarget::logLevel = Brewtarget::LogType_INFO;
+static QAtomicPointer<Logger> theLogger;
 bool Brewtarget::userDatabaseDidNotExist = false;
 QFile Brewtarget::pidFile;
 QDateTime Brewtarget::lastDbMergeRequest = QDateTime::fromString("1986-02-24T06:00:00", Qt::ISODate);
@@ -103,6 +116,7 @@ Brewtarget::ColorUnitType Brewtarget::colorUnit = Brewtarget::SRM;
 Brewtarget::DensityUnitType Brewtarget::densityUnit = Brewtarget::SG;
 
 QHash<int, UnitSystem*> Brewtarget::thingToUnitSystem;
+QAtomicInt Brewtarget::_optionsVersion(0);
 
 bool Brewtarget::ensureDirectoriesExist()
 {
@@ -198,15 +212,19 @@ bool Brewtarget::ensureDataFilesExist()
    // Log file
    logFile->setFileName(getUserDataDir() + "brewtarget_log.txt");
    if( logFile->open(QFile::WriteOnly | QFile::Truncate) )
+   {
       logStream = new QTextStream(logFile);
+      logger()->setStream(logStream);
+   }
    else
    {
       // Put the log in a temporary directory.
       logFile->setFileName(QDir::tempPath() + "/brewtarget_log.txt");
       if( logFile->open(QFile::WriteOnly | QFile::Truncate ) )
       {
-         logW(QString("Log is in a temporary directory: %1").arg(logFile->fileName()) );
          logStream = new QTextStream(logFile);
+         logger()->setStream(logStream);
+         logW(QString("Log is in a temporary directory: %1").arg(logFile->fileName()) );
       }
       else
          logW(QString("Could not create a log file."));
@@ -449,8 +467,10 @@ QString Brewtarget::getUserDataDir()
       return userDataDir + "/";
 }
 
-bool Brewtarget::initialize()
+bool Brewtarget::initialize(bool headless)
 {
+   StartupTrace::Scope scope("Brewtarget::initialize");
+
    // Need these for changed(QMetaProperty,QVariant) to be emitted across threads.
    qRegisterMetaType<QMetaProperty>();
    qRegisterMetaType<Equipment*>();
@@ -467,66 +487,82 @@ bool Brewtarget::initialize()
 
    // In Unix, make sure the user isn't running 2 copies.
 #if defined(Q_OS_LINUX)
-   pidFile.setFileName(QString("%1.pid").arg(getUserDataDir()));
-   if( pidFile.exists() )
+   if( !headless )
    {
-      // Read the pid.
-      qint64 pid;
-      pidFile.open(QIODevice::ReadOnly);
+      pidFile.setFileName(QString("%1.pid").arg(getUserDataDir()));
+      if( pidFile.exists() )
       {
-         QTextStream pidStream(&pidFile);
-         pidStream >> pid;
+         // Read the pid.
+         qint64 pid;
+         pidFile.open(QIODevice::ReadOnly);
+         {
+            QTextStream pidStream(&pidFile);
+            pidStream >> pid;
+         }
+         pidFile.close();
+
+         // If the pid is in the proc filesystem, another instance is running.
+         // Have to check /proc, because perhaps the last instance crashed without
+         // cleaning up after itself.
+         QDir procDir(QString("/proc/%1").arg(pid));
+         if( procDir.exists() )
+         {
+            std::cerr << "Brewtarget is already running. PID: " << pid << std::endl;
+            return false;
+         }
       }
-      pidFile.close();
 
-      // If the pid is in the proc filesystem, another instance is running.
-      // Have to check /proc, because perhaps the last instance crashed without
-      // cleaning up after itself.
-      QDir procDir(QString("/proc/%1").arg(pid));
-      if( procDir.exists() )
+      // Open the pidFile, erasing any contents, and write our pid.
+      pidFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
       {
-         std::cerr << "Brewtarget is already running. PID: " << pid << std::endl;
-         return false;
+         QTextStream pidStream(&pidFile);
+         pidStream << QCoreApplication::applicationPid();
       }
+      pidFile.close();
    }
-
-   // Open the pidFile, erasing any contents, and write our pid.
-   pidFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
-   {
-      QTextStream pidStream(&pidFile);
-      pidStream << QCoreApplication::applicationPid();
-   }
-   pidFile.close();
 #endif
    userDataDir = getConfigDir();
 
    // If the old options file exists, convert it. Otherwise, just get the
    // system options. I *think* this will work. The installer copies the old
    // one into the new place on Windows.
+   StartupTrace::Scope optionsScope("Brewtarget::readSystemOptions");
    if ( option("hadOldConfig", false).toBool() )
       convertPersistentOptions();
 
    readSystemOptions();
    loadMap();
+   optionsScope.end();
 
    // Make sure all the necessary directories and files we need exist before starting.
    bool success;
+   StartupTrace::Scope dirScope("Brewtarget::ensureDirectoriesExist");
    success = ensureDirectoriesExist() && ensureDataFilesExist();
+   dirScope.end();
    if(!success)
       return false;
 
+   StartupTrace::Scope translationScope("Brewtarget::loadTranslations");
    loadTranslations(); // Do internationalization.
+   translationScope.end();
 
 #if defined(Q_OS_MAC)
    qt_set_sequence_auto_mnemonic(true); // turns on Mac Keyboard shortcuts
 #endif
 
+   // The headless modes open the database they need themselves.
+   if( headless )
+      return true;
+
    // Check if the database was successfully loaded before
    // loading the main window.
    if (Database::instance().loadSuccessful())
    {
       if ( ! QSettings().contains("converted") )
+      {
+         StartupTrace::Scope convertScope("Database::convertFromXml");
          Database::instance().convertFromXml();
+      }
 
       return true;
    }
@@ -537,7 +573,14 @@ bool Brewtarget::initialize()
 
 void Brewtarget::cleanup()
 {
-   // Close log file.
+   if( SqlProfiler::enabled() )
+      SqlProfiler::logReport();
+   // The headless modes never get to a main window.
+   StartupTrace::finish();
+
+   // Close log file, once everything meant for it is in it.
+   logger()->flush();
+   logger()->setStream(0);
    if( logStream )
    {
       delete logStream;
@@ -557,7 +600,9 @@ void Brewtarget::cleanup()
 
    Database::dropInstance();
 #if defined(Q_OS_LINUX)
-   pidFile.remove();
+   // Headless runs never made one.
+   if( ! pidFile.fileName().isEmpty() )
+      pidFile.remove();
 #endif
 
 }
@@ -566,18 +611,28 @@ int Brewtarget::run()
 {
    int ret = 0;
 
+   StartupTrace::Scope splashScope("BtSplashScreen");
    BtSplashScreen splashScreen;
    splashScreen.show();
    qApp->processEvents();
+   splashScope.end();
    if( !initialize() )
    {
       cleanup();
       return 1;
    }
 
+   StartupTrace::Scope windowScope("MainWindow");
    _mainWindow = new MainWindow();
    _mainWindow->setVisible(true);
    splashScreen.finish(_mainWindow);
+   windowScope.end();
+   // Queued, since the logger emits from its own thread.
+   connect( logger(), SIGNAL(statusMessage(QString,int)),
+            _mainWindow->statusBar(), SLOT(showMessage(QString,int)),
+            Qt::QueuedConnection );
+   // Startup is over once the window is up.
+   StartupTrace::finish();
 
    checkForNewVersion(_mainWindow);
    do {
@@ -589,6 +644,117 @@ int Brewtarget::run()
    return ret;
 }
 
+int Brewtarget::exportRecipes(QString const& dir, QString const& format, QStringList const& names, int threads)
+{
+   RecipeExporter::Format fmt;
+   QList<Recipe*> recs;
+   int failures;
+
+   if( !RecipeExporter::formatFromName(format, &fmt) )
+   {
+      std::cerr << "Unknown export format: " << format.toUtf8().constData() << std::endl;
+      return 1;
+   }
+
+   Database::setReadOnly(true);
+   if( !initialize(true) || !Database::instance().loadSuccessful() )
+   {
+      cleanup();
+      return 1;
+   }
+
+   recs = RecipeExporter::selectRecipes(names);
+   if( recs.size() < names.size() )
+      logW(QString("Only %1 of the %2 requested recipes were found").arg(recs.size()).arg(names.size()));
+
+   RecipeExporter exporter(dir, fmt);
+   failures = exporter.exportRecipes(recs, threads);
+
+   cleanup();
+
+   return failures == 0 ? 0 : 1;
+}
+
+int Brewtarget::calcRecipes(QStringList const& inputs)
+{
+   QElapsedTimer timer;
+   QList<int> keys;
+   QStringList files;
+   QTextStream out(stdout);
+   RecipeCalculator calc(&out);
+   int failures = 0;
+   qint64 startup_ms;
+
+   timer.start();
+
+   foreach( QString input, inputs )
+   {
+      bool isKey;
+      int key = input.toInt(&isKey);
+      if( isKey )
+         keys.append(key);
+      else
+         files.append(input);
+   }
+
+   if( !initialize(true) )
+   {
+      cleanup();
+      return 1;
+   }
+   startup_ms = timer.elapsed();
+
+   // Recipes already in the database. Only the user's database is read-only
+   // here; the one for files below has to take the imports.
+   if( !keys.isEmpty() )
+   {
+      Database::setReadOnly(true);
+      if( Database::instance().loadSuccessful() )
+      {
+         foreach( int key, keys )
+            failures += calc.calcKey(key);
+      }
+      else
+         failures += keys.size();
+      Database::dropInstance();
+      Database::setReadOnly(false);
+   }
+
+   // BeerXML files go through a throwaway database.
+   if( !files.isEmpty() )
+   {
+      QTemporaryDir scratchDir;
+      QString scratch = QDir(scratchDir.path()).filePath("calc.sqlite");
+
+      if( scratchDir.isValid() && Database::createBlank(scratch) )
+      {
+         Database::setFileName(scratch);
+         if( Database::instance().loadSuccessful() )
+         {
+            foreach( QString file, files )
+               failures += calc.calcFile(file);
+         }
+         else
+            failures += files.size();
+         Database::dropInstance();
+         Database::setFileName(QString());
+      }
+      else
+      {
+         logE(QString("Could not create a scratch database in %1").arg(scratchDir.path()));
+         failures += files.size();
+      }
+   }
+
+   out.flush();
+   std::cerr << "Calculated " << inputs.size() << " inputs in " << timer.elapsed()
+             << " ms (" << startup_ms << " ms to start)" << std::endl;
+
+   cleanup();
+
+   return failures == 0 ? 0 : 1;
+}
+
 // Read the old options.xml file one more time, then move it out of the way.
 void Brewtarget::convertPersistentOptions()
 {
@@ -828,6 +994,17 @@ void Brewtarget::readSystemOptions()
    if( hasOption("language") )
       setLanguage(option("language","").toString());
 
+   //=====================Log Level====================
+   text = option("log_level", "info").toString();
+   if( text == "debug" )
+      logLevel = LogType_DEBUG;
+   else if( text == "warning" )
+      logLevel = LogType_WARNING;
+   else if( text == "error" )
+      logLevel = LogType_ERROR;
+   else
+      logLevel = LogType_INFO;
+
    //=======================Data Dir===========================
    if( hasOption("user_data_dir") )
       userDataDir = option("user_data_dir","").toString();
@@ -1027,22 +1204,55 @@ void Brewtarget::log(LogType lt, QString message)
 {
    QString m;
 
+   // Before formatting anything, since this may be called a lot.
+   if( lt < logLevel )
+      return;
+
    if( lt == LogType_WARNING )
       m = QString("WARNING: %1").arg(message);
    else if( lt == LogType_ERROR )
       m = QString("ERROR: %1").arg(message);
+   else if( lt == LogType_DEBUG )
+      m = QString("DEBUG: %1").arg(message);
    else
       m = message;
 
-   // First, write out to stderr.
-   std::cerr << m.toUtf8().constData() << std::endl;
-   // Then display it in the GUI's status bar.
-   if( _mainWindow && _mainWindow->statusBar() )
-      _mainWindow->statusBar()->showMessage(m, 3000);
+   // The logger writes it to stderr, the log file and the status bar.
+   logger()->post(m);
+}
 
-   // Now, write it to the log file if there is one.
-   if( logStream != 0 )
-      *logStream << m << "\n";
+void Brewtarget::setLogLevel( LogType lt )
+{
+   logLevel = lt;
+}
+
+Logger* Brewtarget::logger()
+{
+   Logger* ret = theLogger.loadAcquire();
+
+   // Only the first caller ever takes the lock.
+   if( ret == 0 )
+   {
+      QMutexLocker locker(&logMutex);
+      ret = theLogger.load();
+      if( ret == 0 )
+      {
+         ret = new Logger();
+         ret->start(QThread::LowPriority);
+         theLogger.storeRelease(ret);
+         // The headless modes leave through exit(), not cleanup().
+         atexit(stopLogger);
+      }
+   }
+
+   return ret;
+}
+
+void Brewtarget::stopLogger()
+{
+   Logger* l = theLogger.loadAcquire();
+   if( l )
+      l->stop();
 }
 
 void Brewtarget::logE( QString message )
@@ -1410,6 +1620,7 @@ void Brewtarget::setOption(QString attribute, QVariant value, const QString sect
 
 
    QSettings().setValue(name,value);
+   _optionsVersion.fetchAndAddRelease(1);
 }
 
 QVariant Brewtarget::option(QString attribute, QVariant default_value, QString section, iUnitOps ops)
@@ -1428,6 +1639,12 @@ void Brewtarget::removeOption(QString attribute)
 {
    if ( hasOption(attribute) )
         QSettings().remove(attribute);
+   _optionsVersion.fetchAndAddRelease(1);
+}
+
+unsigned int Brewtarget::optionsVersion()
+{
+   return static_cast<unsigned int>(_optionsVersion.loadAcquire());
 }
 
 QString Brewtarget::generateName(QString attribute, const QString section, iUnitOps ops)
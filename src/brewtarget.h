@@ -44,10 +44,14 @@ extern void qt_set_sequence_auto_mnemonic(bool b);
 #include <QMenu>
 #include <QMetaProperty>
 #include <QList>
+#include <QStringList>
+#include <QMutex>
+#include <QAtomicInt>
 #include "UnitSystem.h"
 
 class BeerXMLElement;
 class MainWindow;
+class Logger;
 
 // Need these for changed(QMetaProperty,QVariant) to be emitted across threads.
 Q_DECLARE_METATYPE( QMetaProperty )
@@ -74,8 +78,12 @@ class Brewtarget : public QObject
 public:
    Brewtarget();
 
-   //! \brief The log level of a message.
+   //! \brief The log level of a message, least important first.
    enum LogType{
+          //! Only for tracking down problems.
+          LogType_DEBUG,
+          //! Just information, logged as is.
+          LogType_INFO,
           //! Just a warning.
           LogType_WARNING,
           //! Full-blown error.
@@ -160,13 +168,39 @@ public:
    static QString getUserDataDir();
    //! \brief Blocking call that starts the application.
    static int run();
+   /*!
+    * \brief Blocking call that writes recipes to files in \c dir without
+    * starting the GUI.
+    *
+    * \param format is "html", "text" or "bbcode".
+    * \param names selects the recipes by name. All are written if it is empty.
+    * \param threads is the size of the thread pool. 0 picks one per core.
+    * \returns the process exit code.
+    */
+   static int exportRecipes(QString const& dir, QString const& format, QStringList const& names, int threads = 0);
+   /*!
+    * \brief Blocking call that prints the calculated statistics of recipes to
+    * stdout as JSON lines, without starting the GUI.
+    *
+    * \param inputs are BeerXML files, or keys of recipes in the database.
+    * Files are read into a scratch database, so the user's is never touched.
+    * \returns the process exit code.
+    */
+   static int calcRecipes(QStringList const& inputs);
 
    static double toDouble(QString text, bool* ok = 0);
    static double toDouble(const BeerXMLElement* element, QString attribute, QString caller);
    static double toDouble(QString text, QString caller);
 
-   //! \brief Log a message.
+   /*!
+    * \brief Log a message.
+    *
+    * Safe from any thread. The message is written later by the log's own
+    * thread, so this never waits on the disk or the GUI.
+    */
    static void log( LogType lt, QString message );
+   //! \brief Messages less important than \c lt are not logged.
+   static void setLogLevel( LogType lt );
    //! \brief Log an error message.
    static void logE( QString message );
    //! \brief Log a warning message.
@@ -289,6 +323,11 @@ public:
    static void  setOption(QString attribute, QVariant value, const QString section = QString(), iUnitOps ops = NOOP);
    static QVariant option(QString attribute, QVariant default_value = QVariant(), QString section = QString(), iUnitOps = NOOP);
    static void removeOption(QString attribute);
+   /*!
+    * \brief Increases with every setOption() or removeOption(). Caches of
+    * displayed values compare it to know when units may have changed.
+    */
+   static unsigned int optionsVersion();
 
    static QString generateName(QString attribute, const QString section, iUnitOps ops);
 
@@ -312,6 +351,12 @@ private:
    static QTranslator* btTrans;
    static QFile* logFile;
    static QTextStream* logStream;
+   static QMutex logMutex;
+   static LogType logLevel;
+   //! \brief The log's writer thread, started on first use.
+   static Logger* logger();
+   //! \brief Write out what is left in the log, at exit.
+   static void stopLogger();
    static QString currentLanguage;
    static QSettings btSettings;
    static bool userDatabaseDidNotExist;
@@ -347,6 +392,9 @@ private:
    static Unit::unitDisplay dateFormat;
    //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
+   //! Read from the pools too, hence atomic.
+   static QAtomicInt _optionsVersion;
+
    /*!
     * \brief Run before showing MainWindow, does all system setup.
     *
@@ -354,9 +402,12 @@ private:
     * ensures the data directories and files exist, loads translations,
     * and loads database.
     *
+    * If \c headless, no PID file is made and the database is left for the
+    * caller to open.
+    *
     * \returns false if anything goes awry, true if it's ok to start MainWindow
     */
-   static bool initialize();
+   static bool initialize(bool headless = false);
    /*!
     * \brief Run after QApplication exits to clean up shit, close database, etc.
     */
@@ -27,6 +27,7 @@
  */
 
 #include "database.h"
+#include "StartupTrace.h"
 
 #include <QList>
 #include <QDomDocument>
@@ -47,6 +48,7 @@
 #include <QDebug>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QSet>
 #include <QPushButton>
 #include <QCryptographicHash>
 #include <QPair>
@@ -57,6 +59,7 @@
 #include "fermentable.h"
 #include "hop.h"
 #include "instruction.h"
+#include "PreInstruction.h"
 #include "mash.h"
 #include "mashstep.h"
 #include "misc.h"
@@ -89,6 +92,8 @@ const QList<TableParams> Database::tableParams = Database::makeTableParams();
 
 QHash< QThread*, QString > Database::_threadToConnection;
 QMutex Database::_threadToConnectionMutex;
+bool Database::readOnly = false;
+QString Database::fileNameOverride;
 
 Database::Database()
 {
@@ -98,6 +103,7 @@ Database::Database()
 
    converted = false;   
    dirty = false;
+   batch = 0;
 
    loadWasSuccessful = load();
 }
@@ -128,9 +134,14 @@ bool Database::load()
    bool dbIsOpen;
    bool createFromScratch=false;
    bool schemaUpdated=false;
+   StartupTrace::Scope scope("Database::load");
+   StartupTrace::Scope filesScope("Database::load files");
    
    // Set file names.
-   dbFileName = (Brewtarget::getUserDataDir() + "database.sqlite");
+   if( fileNameOverride.isEmpty() )
+      dbFileName = (Brewtarget::getUserDataDir() + "database.sqlite");
+   else
+      dbFileName = fileNameOverride;
    dataDbFileName = (Brewtarget::getDataDir() + "default_db.sqlite");
    dbTempBackupFileName = (Brewtarget::getUserDataDir() + "tempBackupDatabase.sqlite");
    
@@ -139,54 +150,72 @@ bool Database::load()
    dataDbFile.setFileName(dataDbFileName);
    dbTempBackupFile.setFileName(dbTempBackupFileName);
    
-   // Cleanup the backup database if there was a previous error.
-   if( !cleanupBackupDatabase() )
-      return false;
-   
-   // If user restored the database from a backup, make the backup into the primary.
+   if( readOnly || !fileNameOverride.isEmpty() )
    {
-      QFile newdb(QString("%1.new").arg(dbFileName));
-      if( newdb.exists() )
+      // Nothing may be moved, copied or created, so the database has to exist.
+      if( !dbFile.exists() )
       {
-         dbFile.remove();
-         newdb.copy(dbFileName);
-         QFile::setPermissions( dbFileName, QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup );
-         newdb.remove();
+         Brewtarget::logE(QString("Database::load(): %1 does not exist").arg(dbFileName));
+         _threadToConnectionMutex.unlock();
+         return false;
       }
    }
-   
-   // If there's no dbFile, try to copy from dataDbFile.
-   if( !dbFile.exists() )
+   else
    {
-      Brewtarget::userDatabaseDidNotExist = true;
-      
-      // Have to wait until db is open before creating from scratch.
-      if( !dataDbFile.exists() )
-         createFromScratch = true;
-      else
+      // Cleanup the backup database if there was a previous error.
+      if( !cleanupBackupDatabase() )
+         return false;
+   
+      // If user restored the database from a backup, make the backup into the primary.
       {
-         dataDbFile.copy(dbFileName);
-         QFile::setPermissions( dbFileName, QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup );
+         QFile newdb(QString("%1.new").arg(dbFileName));
+         if( newdb.exists() )
+         {
+            dbFile.remove();
+            newdb.copy(dbFileName);
+            QFile::setPermissions( dbFileName, QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup );
+            newdb.remove();
+         }
       }
+   
+      // If there's no dbFile, try to copy from dataDbFile.
+      if( !dbFile.exists() )
+      {
+         Brewtarget::userDatabaseDidNotExist = true;
       
-      // Reset the last merge request.
-      Brewtarget::lastDbMergeRequest = QDateTime::currentDateTime();
-   }
+         // Have to wait until db is open before creating from scratch.
+         if( !dataDbFile.exists() )
+            createFromScratch = true;
+         else
+         {
+            dataDbFile.copy(dbFileName);
+            QFile::setPermissions( dbFileName, QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup );
+         }
+      
+         // Reset the last merge request.
+         Brewtarget::lastDbMergeRequest = QDateTime::currentDateTime();
+      }
 
-   // Create a copy of the database to revert to if the user decides not to make changes.
-   dbFile.copy(dbTempBackupFileName);
+      // Create a copy of the database to revert to if the user decides not to make changes.
+      dbFile.copy(dbTempBackupFileName);
+   }
+   filesScope.end();
    
    // Open SQLite db.
+   StartupTrace::Scope openScope("Database::load open");
    QSqlDatabase sqldb = QSqlDatabase::addDatabase("QSQLITE");
    sqldb.setDatabaseName(dbFileName);
+   if( readOnly )
+      sqldb.setConnectOptions("QSQLITE_OPEN_READONLY");
    dbIsOpen = sqldb.open();
    dbConName = sqldb.connectionName();
    if( ! dbIsOpen )
    {
       Brewtarget::logE(QString("Could not open %1 for reading.\n%2").arg(dbFileName).arg(sqldb.lastError().text()));
-      QMessageBox::critical(0,
-                            QObject::tr("Database Failure"),
-                            QString(QObject::tr("Failed to open the database '%1'.").arg(dbFileName)));
+      if( !readOnly )
+         QMessageBox::critical(0,
+                               QObject::tr("Database Failure"),
+                               QString(QObject::tr("Failed to open the database '%1'.").arg(dbFileName)));
 
       // TODO: if we can't open the database, what should we do?
       return false;
@@ -207,16 +236,23 @@ bool Database::load()
    // NOTE: synchronous=off reduces query time by an order of magnitude!
    QSqlQuery( "PRAGMA synchronous = off", sqlDatabase());
    QSqlQuery( "PRAGMA foreign_keys = on", sqlDatabase());
-   QSqlQuery( "PRAGMA locking_mode = EXCLUSIVE", sqlDatabase());
+   // Readers need to share the file with each other.
+   if( !readOnly )
+      QSqlQuery( "PRAGMA locking_mode = EXCLUSIVE", sqlDatabase());
    // Store temporary tables in memory.
    QSqlQuery( "PRAGMA temp_store = MEMORY", sqlDatabase());
+   openScope.end();
    
    // Update the database if need be. This has to happen before we do anything
    // else or we dump core 
    bool schemaErr = false;
+   StartupTrace::Scope schemaScope("Database::updateSchema");
    schemaUpdated = updateSchema(&schemaErr);
+   schemaScope.end();
    if( schemaErr )
    {
+      if( readOnly )
+         return false;
       QMessageBox::critical(
          0,
          QObject::tr("Database Failure"),
@@ -226,10 +262,14 @@ bool Database::load()
    }
    
    // Initialize the SELECT * query hashes.
+   StartupTrace::Scope selectScope("Database::selectAllHash");
    selectAll = Database::selectAllHash();
+   selectScope.end();
    
    // See if there are new ingredients that we need to merge from the data-space db.
-   if( dataDbFile.fileName() != dbFile.fileName()
+   if( ! readOnly
+      && fileNameOverride.isEmpty()
+      && dataDbFile.fileName() != dbFile.fileName()
       && ! Brewtarget::userDatabaseDidNotExist // Don't do this if we JUST copied the dataspace database.
       && QFileInfo(dataDbFile).lastModified() > Brewtarget::lastDbMergeRequest )
    {
@@ -245,6 +285,7 @@ bool Database::load()
          == QMessageBox::Yes
       )
       {
+         StartupTrace::Scope mergeScope("Database::updateDatabase");
          updateDatabase(dataDbFile.fileName());
       }
       
@@ -253,6 +294,7 @@ bool Database::load()
    }
    
    // Create and store all pointers.
+   StartupTrace::Scope populateScope("Database::populateElements");
    populateElements( allBrewNotes, Brewtarget::BREWNOTETABLE );
    populateElements( allEquipments, Brewtarget::EQUIPTABLE );
    populateElements( allFermentables, Brewtarget::FERMTABLE );
@@ -266,8 +308,24 @@ bool Database::load()
    populateElements( allYeasts, Brewtarget::YEASTTABLE );
    
    populateElements( allRecipes, Brewtarget::RECTABLE );
+   populateScope.end();
+   
+   StartupTrace::Scope inventoryScope("Database::populateInventory");
+   populateInventory();
+   inventoryScope.end();
+   
+   StartupTrace::Scope relationsScope("Database::populateRecipeRelations");
+   recipeRelationsMutex.lock();
+   populateRecipeRelations();
+   recipeRelationsMutex.unlock();
+   relationsScope.end();
+   
+   StartupTrace::Scope statsScope("Database::populateRecipeStats");
+   populateRecipeStats();
+   statsScope.end();
    
    // Connect fermentable,hop changed signals to their parent recipe.
+   StartupTrace::Scope signalScope("Database::load signals");
    QHash<int,Recipe*>::iterator i;
    QList<Fermentable*>::iterator j;
    QList<Hop*>::iterator k;
@@ -413,6 +471,8 @@ QSqlDatabase Database::sqlDatabase()
    // Create the new connection.
    QSqlDatabase sqldb = QSqlDatabase::addDatabase("QSQLITE",conName);
    sqldb.setDatabaseName(dbFileName);
+   if( readOnly )
+      sqldb.setConnectOptions("QSQLITE_OPEN_READONLY");
    if( ! sqldb.open() )
    {
       Brewtarget::logE(QString("Could not open %1 for reading.\n%2").arg(dbFileName).arg(sqldb.lastError().text()));
@@ -427,9 +487,19 @@ QSqlDatabase Database::sqlDatabase()
 
 void Database::unload(bool keepChanges)
 {
+   // The other threads' queries have to go before their connections do.
+   threadSelectAllMutex.lock();
+   threadSelectAll.clear();
+   threadSelectAllMutex.unlock();
+   selectAll.clear();
+
    QSqlDatabase::database( dbConName, false ).close();
    QSqlDatabase::removeDatabase( dbConName );
 
+   // We never made a backup, and there is nothing to revert.
+   if( readOnly || !fileNameOverride.isEmpty() )
+      return;
+
    if (!loadWasSuccessful || keepChanges)
    {
       // If load() failed or want to keep the changes, then
@@ -476,6 +546,48 @@ Database& Database::instance()
    return *dbInstance;
 }
 
+void Database::setReadOnly(bool ro)
+{
+   readOnly = ro;
+}
+
+bool Database::isReadOnly()
+{
+   return readOnly;
+}
+
+void Database::setFileName(QString const& fileName)
+{
+   fileNameOverride = fileName;
+}
+
+QSqlQuery& Database::selectAllQuery( Brewtarget::DBTable table )
+{
+   QThread* t = QThread::currentThread();
+   bool haveQueries;
+   
+   if( t == thread() )
+      return selectAll[table];
+   
+   threadSelectAllMutex.lock();
+   haveQueries = threadSelectAll.contains(t);
+   threadSelectAllMutex.unlock();
+   
+   // Prepare outside the lock, since sqlDatabase() takes its own.
+   if( !haveQueries )
+   {
+      QHash<Brewtarget::DBTable,QSqlQuery> queries = selectAllHash();
+      threadSelectAllMutex.lock();
+      threadSelectAll.insert(t, queries);
+      threadSelectAllMutex.unlock();
+   }
+   
+   // Only this thread ever touches its own queries, and the hash's nodes
+   // do not move when other threads insert theirs.
+   QMutexLocker locker(&threadSelectAllMutex);
+   return threadSelectAll[t][table];
+}
+
 void Database::dropInstance()
 {
    static QMutex mutex;
@@ -528,11 +640,18 @@ bool Database::restoreFromFile(QString newDbFileStr)
 // removeFromRecipe ===========================================================
 void Database::removeIngredientFromRecipe( Recipe* rec, BeerXMLElement* ing, QString propName, QString relTableName, QString ingKeyName )
 {
+   SqlProfiler::Timer timer("Database::removeIngredientFromRecipe");
    QSqlQuery q(sqlDatabase());
    q.setForwardOnly(true);
    q.prepare( QString("DELETE FROM `%1` WHERE `%2`='%3' AND recipe_id='%4'").arg(relTableName).arg(ingKeyName).arg(ing->_key).arg(rec->_key) );
    q.exec();
+   timer.stop(q);
    q.finish();
+   
+   unrelateFromRecipe( rec, ing );
+   // dec_ins_num renumbers the rest, and not necessarily in order.
+   if( qobject_cast<Instruction*>(ing) )
+      reloadRecipeInstructions( rec->_key );
  
    dirty = true; 
    emit rec->changed( rec->metaProperty(propName), QVariant() );
@@ -544,40 +663,47 @@ void Database::removeFromRecipe( Recipe* rec, BrewNote* b )
    sqlUpdate( Brewtarget::BREWNOTETABLE,
               "deleted=1",
               QString("id=%1").arg(b->_key) );
+   unrelateFromRecipe( rec, b );
    dirty = true; 
    emit deletedBrewNoteSignal(b);
+   emit deletedElementsSignal(QList<BeerXMLElement*>() << b);
 }
 
 void Database::removeFromRecipe( Recipe* rec, Hop* hop )
 {
    removeIngredientFromRecipe( rec, hop, "hops", "hop_in_recipe", "hop_id" );
    disconnect( hop, 0, rec, 0 );
-   rec->recalcAll();
+   if( ! deferRecalc(rec) )
+      rec->recalcAll();
 }
 
 void Database::removeFromRecipe( Recipe* rec, Fermentable* ferm )
 {
    removeIngredientFromRecipe( rec, ferm, "fermentables", "fermentable_in_recipe", "fermentable_id" );
    disconnect( ferm, 0, rec, 0 );
-   rec->recalcAll();
+   if( ! deferRecalc(rec) )
+      rec->recalcAll();
 }
 
 void Database::removeFromRecipe( Recipe* rec, Misc* m )
 {
    removeIngredientFromRecipe( rec, m, "miscs", "misc_in_recipe", "misc_id" );
-   rec->recalcAll();
+   if( ! deferRecalc(rec) )
+      rec->recalcAll();
 }
 
 void Database::removeFromRecipe( Recipe* rec, Yeast* y )
 {
    removeIngredientFromRecipe( rec, y, "yeasts", "yeast_in_recipe", "yeast_id" );
-   rec->recalcAll();
+   if( ! deferRecalc(rec) )
+      rec->recalcAll();
 }
 
 void Database::removeFromRecipe( Recipe* rec, Water* w )
 {
    removeIngredientFromRecipe( rec, w, "waters", "water_in_recipe", "water_id" );
-   rec->recalcAll();
+   if( ! deferRecalc(rec) )
+      rec->recalcAll();
 }
 
 void Database::removeFromRecipe( Recipe* rec, Instruction* ins )
@@ -653,6 +779,18 @@ void Database::swapInstructionOrder(Instruction* in1, Instruction* in2)
       sqlDatabase()
    );
    q.finish();
+   
+   {
+      QMutexLocker locker(&recipeRelationsMutex);
+      QHash<int,RecipeRelations>::iterator i;
+      for( i = recipeRelations.begin(); i != recipeRelations.end(); ++i )
+      {
+         int pos1 = i->instructions.indexOf(in1);
+         int pos2 = i->instructions.indexOf(in2);
+         if( pos1 >= 0 && pos2 >= 0 )
+            i->instructions.swap(pos1, pos2);
+      }
+   }
   
    dirty = true; 
    emit in1->changed( in1->metaProperty("instructionNumber") );
@@ -691,95 +829,274 @@ void Database::insertInstruction(Instruction* in, int pos)
       ).arg(pos).arg(in->_key)
    );
    q.finish();
+   reloadRecipeInstructions(parentRecipeKey);
   
    dirty = true; 
    emit in->changed( in->metaProperty("instructionNumber"), pos );
 }
 
-QList<BrewNote*> Database::brewNotes(Recipe const* parent)
+// Recipe relations ==========================================================
+void Database::populateRecipeRelations(int recipeKey)
 {
-   QList<BrewNote*> ret;
-   QString filterString = QString("recipe_id = %1 AND deleted = 0").arg(parent->_key);
+   QSqlQuery q( sqlDatabase() );
+   q.setForwardOnly(true);
+   QString recipeFilter;
+   QString relFilter;
+   
+   if( recipeKey == 0 )
+      recipeRelations.clear();
+   else
+   {
+      recipeRelations.remove(recipeKey);
+      recipeFilter = QString(" WHERE id = %1").arg(recipeKey);
+      relFilter = QString(" WHERE recipe_id = %1").arg(recipeKey);
+   }
    
-   getElements(ret, filterString, Brewtarget::BREWNOTETABLE, allBrewNotes);
+   SqlProfiler::Timer recTimer("Database::populateRecipeRelations");
+   q.exec( QString("SELECT id, equipment_id, mash_id, style_id FROM recipe%1").arg(recipeFilter) );
+   recTimer.stop(q);
+   while( q.next() )
+   {
+      RecipeRelations& rel = recipeRelations[q.record().value("id").toInt()];
+      rel.equipment = q.record().value("equipment_id").toInt();
+      rel.mash = q.record().value("mash_id").toInt();
+      rel.style = q.record().value("style_id").toInt();
+   }
    
-   return ret;
+   // Ordered by id, which is the order they went in.
+   SqlProfiler::Timer fermTimer("Database::populateRecipeRelations");
+   q.exec( QString("SELECT recipe_id, fermentable_id FROM fermentable_in_recipe%1 ORDER BY id").arg(relFilter) );
+   fermTimer.stop(q);
+   while( q.next() )
+   {
+      Fermentable* f = allFermentables.value(q.record().value(1).toInt());
+      if( f && recipeRelations.contains(q.record().value(0).toInt()) )
+         recipeRelations[q.record().value(0).toInt()].fermentables.append(f);
+   }
+   
+   SqlProfiler::Timer hopTimer("Database::populateRecipeRelations");
+   q.exec( QString("SELECT recipe_id, hop_id FROM hop_in_recipe%1 ORDER BY id").arg(relFilter) );
+   hopTimer.stop(q);
+   while( q.next() )
+   {
+      Hop* h = allHops.value(q.record().value(1).toInt());
+      if( h && recipeRelations.contains(q.record().value(0).toInt()) )
+         recipeRelations[q.record().value(0).toInt()].hops.append(h);
+   }
+   
+   SqlProfiler::Timer miscTimer("Database::populateRecipeRelations");
+   q.exec( QString("SELECT recipe_id, misc_id FROM misc_in_recipe%1 ORDER BY id").arg(relFilter) );
+   miscTimer.stop(q);
+   while( q.next() )
+   {
+      Misc* m = allMiscs.value(q.record().value(1).toInt());
+      if( m && recipeRelations.contains(q.record().value(0).toInt()) )
+         recipeRelations[q.record().value(0).toInt()].miscs.append(m);
+   }
+   
+   SqlProfiler::Timer waterTimer("Database::populateRecipeRelations");
+   q.exec( QString("SELECT recipe_id, water_id FROM water_in_recipe%1 ORDER BY id").arg(relFilter) );
+   waterTimer.stop(q);
+   while( q.next() )
+   {
+      Water* w = allWaters.value(q.record().value(1).toInt());
+      if( w && recipeRelations.contains(q.record().value(0).toInt()) )
+         recipeRelations[q.record().value(0).toInt()].waters.append(w);
+   }
+   
+   SqlProfiler::Timer yeastTimer("Database::populateRecipeRelations");
+   q.exec( QString("SELECT recipe_id, yeast_id FROM yeast_in_recipe%1 ORDER BY id").arg(relFilter) );
+   yeastTimer.stop(q);
+   while( q.next() )
+   {
+      Yeast* y = allYeasts.value(q.record().value(1).toInt());
+      if( y && recipeRelations.contains(q.record().value(0).toInt()) )
+         recipeRelations[q.record().value(0).toInt()].yeasts.append(y);
+   }
+   
+   SqlProfiler::Timer insTimer("Database::populateRecipeRelations");
+   q.exec( QString("SELECT recipe_id, instruction_id FROM instruction_in_recipe%1 ORDER BY recipe_id, instruction_number ASC").arg(relFilter) );
+   insTimer.stop(q);
+   while( q.next() )
+   {
+      Instruction* ins = allInstructions.value(q.record().value(1).toInt());
+      if( ins && recipeRelations.contains(q.record().value(0).toInt()) )
+         recipeRelations[q.record().value(0).toInt()].instructions.append(ins);
+   }
+   
+   SqlProfiler::Timer noteTimer("Database::populateRecipeRelations");
+   q.exec( QString("SELECT recipe_id, id FROM brewnote WHERE deleted = 0%1 ORDER BY id")
+           .arg(recipeKey == 0 ? QString() : QString(" AND recipe_id = %1").arg(recipeKey)) );
+   noteTimer.stop(q);
+   while( q.next() )
+   {
+      BrewNote* b = allBrewNotes.value(q.record().value(1).toInt());
+      if( b && recipeRelations.contains(q.record().value(0).toInt()) )
+         recipeRelations[q.record().value(0).toInt()].brewNotes.append(b);
+   }
+   
+   q.finish();
 }
 
-QList<Fermentable*> Database::fermentables(Recipe const* parent)
+Database::RecipeRelations& Database::relationsOf(Recipe const* rec)
 {
-   QList<Fermentable*> ret;
-   QString queryString = QString("SELECT fermentable_id FROM fermentable_in_recipe WHERE recipe_id = %1").arg(parent->_key);
-   QSqlQuery q( queryString, sqlDatabase() );//, sqldb );
+   if( !recipeRelations.contains(rec->_key) )
+      populateRecipeRelations(rec->_key);
    
-   while( q.next() )
-      ret.append(allFermentables[q.record().value("fermentable_id").toInt()]);
-   q.finish();
+   return recipeRelations[rec->_key];
+}
+
+void Database::relateToRecipe(Recipe const* rec, BeerXMLElement* ing)
+{
+   QMutexLocker locker(&recipeRelationsMutex);
    
-   return ret;
+   // Not read yet, so it will come from the tables, which already have ing.
+   if( rec == 0 || ing == 0 || !recipeRelations.contains(rec->_key) )
+      return;
+   
+   RecipeRelations& rel = recipeRelations[rec->_key];
+   switch( classNameToTable[ing->metaObject()->className()] )
+   {
+      case Brewtarget::BREWNOTETABLE:
+         rel.brewNotes.append(qobject_cast<BrewNote*>(ing));
+         break;
+      case Brewtarget::EQUIPTABLE:
+         rel.equipment = ing->_key;
+         break;
+      case Brewtarget::FERMTABLE:
+         rel.fermentables.append(qobject_cast<Fermentable*>(ing));
+         break;
+      case Brewtarget::HOPTABLE:
+         rel.hops.append(qobject_cast<Hop*>(ing));
+         break;
+      case Brewtarget::INSTRUCTIONTABLE:
+         // The inc_ins_num trigger puts it last.
+         rel.instructions.append(qobject_cast<Instruction*>(ing));
+         break;
+      case Brewtarget::MASHTABLE:
+         rel.mash = ing->_key;
+         break;
+      case Brewtarget::MISCTABLE:
+         rel.miscs.append(qobject_cast<Misc*>(ing));
+         break;
+      case Brewtarget::STYLETABLE:
+         rel.style = ing->_key;
+         break;
+      case Brewtarget::WATERTABLE:
+         rel.waters.append(qobject_cast<Water*>(ing));
+         break;
+      case Brewtarget::YEASTTABLE:
+         rel.yeasts.append(qobject_cast<Yeast*>(ing));
+         break;
+      default:
+         break;
+   }
 }
 
-QList<Hop*> Database::hops(Recipe const* parent)
+void Database::unrelateFromRecipe(Recipe const* rec, BeerXMLElement* ing)
 {
-   QList<Hop*> ret;
-   QString queryString = QString("SELECT hop_id FROM hop_in_recipe WHERE recipe_id = %1").arg(parent->_key);
-   QSqlQuery q( queryString, sqlDatabase() );//, sqldb );
+   QMutexLocker locker(&recipeRelationsMutex);
+   QHash<int,RecipeRelations>::iterator i;
    
-   while( q.next() )
-      ret.append(allHops[q.record().value("hop_id").toInt()]);
-   q.finish();
+   if( ing == 0 )
+      return;
    
-   return ret;
+   Brewtarget::DBTable table = classNameToTable[ing->metaObject()->className()];
+   for( i = recipeRelations.begin(); i != recipeRelations.end(); ++i )
+   {
+      if( rec && i.key() != rec->_key )
+         continue;
+      
+      switch( table )
+      {
+         case Brewtarget::BREWNOTETABLE:
+            i->brewNotes.removeOne(qobject_cast<BrewNote*>(ing));
+            break;
+         case Brewtarget::FERMTABLE:
+            i->fermentables.removeOne(qobject_cast<Fermentable*>(ing));
+            break;
+         case Brewtarget::HOPTABLE:
+            i->hops.removeOne(qobject_cast<Hop*>(ing));
+            break;
+         case Brewtarget::INSTRUCTIONTABLE:
+            i->instructions.removeOne(qobject_cast<Instruction*>(ing));
+            break;
+         case Brewtarget::MISCTABLE:
+            i->miscs.removeOne(qobject_cast<Misc*>(ing));
+            break;
+         case Brewtarget::WATERTABLE:
+            i->waters.removeOne(qobject_cast<Water*>(ing));
+            break;
+         case Brewtarget::YEASTTABLE:
+            i->yeasts.removeOne(qobject_cast<Yeast*>(ing));
+            break;
+         default:
+            break;
+      }
+   }
 }
 
-QList<Misc*> Database::miscs(Recipe const* parent)
+void Database::reloadRecipeInstructions(int recipeKey)
 {
-   QList<Misc*> ret;
-   QString queryString = QString("SELECT misc_id FROM misc_in_recipe WHERE recipe_id = %1").arg(parent->_key);
-   QSqlQuery q( queryString, sqlDatabase() );//, sqldb );
+   QList<Instruction*> ins;
    
+   SqlProfiler::Timer timer("Database::reloadRecipeInstructions");
+   QSqlQuery q( QString("SELECT instruction_id FROM instruction_in_recipe WHERE recipe_id = %1 ORDER BY instruction_number ASC").arg(recipeKey),
+                sqlDatabase() );
+   timer.stop(q);
    while( q.next() )
-      ret.append(allMiscs[q.record().value("misc_id").toInt()]);
+   {
+      Instruction* in = allInstructions.value(q.record().value("instruction_id").toInt());
+      if( in )
+         ins.append(in);
+   }
    q.finish();
    
-   return ret;
+   QMutexLocker locker(&recipeRelationsMutex);
+   if( recipeRelations.contains(recipeKey) )
+      recipeRelations[recipeKey].instructions = ins;
+}
+
+QList<BrewNote*> Database::brewNotes(Recipe const* parent)
+{
+   QMutexLocker locker(&recipeRelationsMutex);
+   return relationsOf(parent).brewNotes;
+}
+
+QList<Fermentable*> Database::fermentables(Recipe const* parent)
+{
+   QMutexLocker locker(&recipeRelationsMutex);
+   return relationsOf(parent).fermentables;
+}
+
+QList<Hop*> Database::hops(Recipe const* parent)
+{
+   QMutexLocker locker(&recipeRelationsMutex);
+   return relationsOf(parent).hops;
+}
+
+QList<Misc*> Database::miscs(Recipe const* parent)
+{
+   QMutexLocker locker(&recipeRelationsMutex);
+   return relationsOf(parent).miscs;
 }
 
 Equipment* Database::equipment(Recipe const* parent)
 {
-   int id = get( Brewtarget::RECTABLE, parent->key(), "equipment_id" ).toInt();
-   
-   if( allEquipments.contains(id) )
-      return allEquipments[id];
-   else
-      return 0;
+   QMutexLocker locker(&recipeRelationsMutex);
+   return allEquipments.value(relationsOf(parent).equipment, 0);
 }
 
 Style* Database::style(Recipe const* parent)
 {
-   int id;
-   
-   QString queryString = QString("SELECT style_id FROM recipe WHERE id = %1").arg(parent->_key);
-   QSqlQuery q( queryString, sqlDatabase() );//, sqldb );
-   
-   while( q.next() )
-      id = q.record().value("style_id").toInt();
-   q.finish();
-   
-   if( allStyles.contains(id) )
-      return allStyles[id];
-   else
-      return 0;
+   QMutexLocker locker(&recipeRelationsMutex);
+   return allStyles.value(relationsOf(parent).style, 0);
 }
 
 Mash* Database::mash( Recipe const* parent )
 {
-   int mashId = get( Brewtarget::RECTABLE, parent->key(), "mash_id" ).toInt();
-   
-   if( allMashs.contains(mashId) )
-      return allMashs[mashId];
-   else
-      return 0;
+   QMutexLocker locker(&recipeRelationsMutex);
+   return allMashs.value(relationsOf(parent).mash, 0);
 }
 
 QList<MashStep*> Database::mashSteps(Mash const* parent)
@@ -794,44 +1111,20 @@ QList<MashStep*> Database::mashSteps(Mash const* parent)
 
 QList<Instruction*> Database::instructions( Recipe const* parent )
 {
-   QList<Instruction*> ret;
-   QString queryString = QString(
-      "SELECT instruction_id FROM instruction_in_recipe WHERE recipe_id = %1 ORDER BY instruction_number ASC"
-   ).arg(parent->_key);
-   
-   QSqlQuery q( queryString, sqlDatabase() );//, sqldb );
-   
-   while( q.next() )
-      ret.append(allInstructions[q.record().value("instruction_id").toInt()]);
-   q.finish();
-   
-   return ret;
+   QMutexLocker locker(&recipeRelationsMutex);
+   return relationsOf(parent).instructions;
 }
 
 QList<Water*> Database::waters(Recipe const* parent)
 {
-   QList<Water*> ret;
-   QString queryString = QString("SELECT water_id FROM water_in_recipe WHERE recipe_id = %1").arg(parent->_key);
-   QSqlQuery q( queryString, sqlDatabase() );//, sqldb );
-   
-   while( q.next() )
-      ret.append(allWaters[q.record().value("water_id").toInt()]);
-   q.finish();
-   
-   return ret;
+   QMutexLocker locker(&recipeRelationsMutex);
+   return relationsOf(parent).waters;
 }
 
 QList<Yeast*> Database::yeasts(Recipe const* parent)
 {
-   QList<Yeast*> ret;
-   QString queryString = QString("SELECT yeast_id FROM yeast_in_recipe WHERE recipe_id = %1").arg(parent->_key);
-   QSqlQuery q( queryString, sqlDatabase() );//, sqldb );
-   
-   while( q.next() )
-      ret.append(allYeasts[q.record().value("yeast_id").toInt()]);
-   q.finish();
-   
-   return ret;
+   QMutexLocker locker(&recipeRelationsMutex);
+   return relationsOf(parent).yeasts;
 }
 
 // Named constructors =========================================================
@@ -840,10 +1133,12 @@ int Database::insertNewDefaultRecord( Brewtarget::DBTable table )
 {
    int key;
 
+   SqlProfiler::Timer timer("Database::insertNewDefaultRecord");
    QSqlQuery q(sqlDatabase());
    q.exec( QString("INSERT INTO `%1` DEFAULT VALUES")
               .arg(tableNames[table])
          );
+   timer.stop(q);
 
    if( q.numRowsAffected() < 1 )
    {
@@ -865,11 +1160,13 @@ int Database::insertNewMashStepRecord( Mash* parent )
 {
    int key;
    
+   SqlProfiler::Timer timer("Database::insertNewMashStepRecord");
    QSqlQuery q(sqlDatabase());//sqldb );
    q.setForwardOnly(true);
    q.exec( QString("INSERT INTO `%1` DEFAULT VALUES")
               .arg(tableNames[Brewtarget::MASHSTEPTABLE])
          );
+   timer.stop(q);
    if( q.numRowsAffected() < 1 )
    {
       Brewtarget::logE( QString("Database::insertNewDefaultRecord: could not insert a record into %1.").arg(tableNames[Brewtarget::MASHSTEPTABLE]) );
@@ -898,6 +1195,16 @@ int Database::insertNewMashStepRecord( Mash* parent )
 BrewNote* Database::newBrewNote(BrewNote* other, bool signal)
 {
    BrewNote* tmp = copy<BrewNote>(other, true, &allBrewNotes);
+   
+   // The copy has the same recipe_id.
+   recipeRelationsMutex.lock();
+   QHash<int,RecipeRelations>::iterator i;
+   for( i = recipeRelations.begin(); i != recipeRelations.end(); ++i )
+   {
+      if( i->brewNotes.contains(other) )
+         i->brewNotes.append(tmp);
+   }
+   recipeRelationsMutex.unlock();
   
    if ( signal )
    {
@@ -920,6 +1227,7 @@ BrewNote* Database::newBrewNote(Recipe* parent, bool signal)
    sqlUpdate( Brewtarget::BREWNOTETABLE,
               QString("recipe_id=%1").arg(parent->_key),
               QString("id=%2").arg(tmp->_key) );
+   relateToRecipe( parent, tmp );
 
    if ( signal ) 
    {
@@ -1006,6 +1314,90 @@ Hop* Database::newHop(Hop* other)
    return tmp;
 }
 
+QList<Instruction*> Database::replaceInstructions(Recipe* rec, QVector<PreInstruction> const& preins)
+{
+   QList<Instruction*> oldIns = instructions(rec);
+   QList<Instruction*> ret;
+   QList<int> keys;
+   QStringList oldKeys;
+   bool success = true;
+   
+   foreach( Instruction* ins, oldIns )
+      oldKeys.append( QString::number(ins->_key) );
+   
+   QSqlDatabase db = sqlDatabase();
+   db.transaction();
+   
+   QSqlQuery q(db);
+   success &= q.exec( QString("DELETE FROM instruction_in_recipe WHERE recipe_id=%1").arg(rec->_key) );
+   if( success && !oldKeys.isEmpty() )
+      success &= q.exec( QString("DELETE FROM instruction WHERE id IN (%1)").arg(oldKeys.join(",")) );
+   
+   // The inc_ins_num trigger numbers the instructions in insertion order.
+   QSqlQuery insertIns(db);
+   insertIns.prepare( "INSERT INTO instruction (name, directions, interval) VALUES (:name, :directions, :interval)" );
+   QSqlQuery insertRel(db);
+   insertRel.prepare( "INSERT INTO instruction_in_recipe (instruction_id, recipe_id) VALUES (:instruction, :recipe)" );
+   
+   foreach( PreInstruction pi, preins )
+   {
+      if( !success )
+         break;
+      
+      insertIns.bindValue(":name", pi.getTitle());
+      insertIns.bindValue(":directions", pi.getText());
+      insertIns.bindValue(":interval", pi.getTime());
+      if( !insertIns.exec() )
+      {
+         q = insertIns;
+         success = false;
+         break;
+      }
+      keys.append( insertIns.lastInsertId().toInt() );
+      
+      insertRel.bindValue(":instruction", keys.last());
+      insertRel.bindValue(":recipe", rec->_key);
+      if( !insertRel.exec() )
+      {
+         q = insertRel;
+         success = false;
+      }
+   }
+   
+   if( success )
+      db.commit();
+   else
+   {
+      Brewtarget::logE( QString("Database::replaceInstructions: %1.\n   \"%2\"").arg(q.lastError().text()).arg(q.lastQuery()) );
+      db.rollback();
+      return oldIns;
+   }
+   
+   foreach( Instruction* ins, oldIns )
+      allInstructions.remove(ins->_key);
+   
+   for( int i = 0; i < keys.size(); ++i )
+   {
+      Instruction* tmp = new Instruction();
+      tmp->_key = keys[i];
+      tmp->_table = Brewtarget::INSTRUCTIONTABLE;
+      foreach( QString const& reagent, PreInstruction(preins[i]).getReagents() )
+         tmp->addReagent(reagent);
+      allInstructions.insert(tmp->_key,tmp);
+      ret.append(tmp);
+   }
+   
+   recipeRelationsMutex.lock();
+   if( recipeRelations.contains(rec->_key) )
+      recipeRelations[rec->_key].instructions = ret;
+   recipeRelationsMutex.unlock();
+   
+   dirty = true;
+   emit changed( metaProperty("instructions"), QVariant() );
+   
+   return ret;
+}
+
 Instruction* Database::newInstruction(Recipe* rec)
 {
    // TODO: encapsulate in QUndoCommand.
@@ -1066,6 +1458,7 @@ Mash* Database::newMash(Recipe* parent)
    sqlUpdate( Brewtarget::RECTABLE,
               QString("mash_id=%1").arg(tmp->_key),
               QString("id=%1").arg(parent->_key) );
+   relateToRecipe( parent, tmp );
    
    dirty = true; 
    emit changed( metaProperty("mashs"), QVariant() );
@@ -1087,6 +1480,14 @@ Mash* Database::newMash(Mash* other, bool displace)
       sqlUpdate( Brewtarget::RECTABLE,
                  QString("mash_id=%1").arg(tmp->_key),
                  QString("mash_id=%1").arg(other->_key) );
+      
+      QMutexLocker locker(&recipeRelationsMutex);
+      QHash<int,RecipeRelations>::iterator i;
+      for( i = recipeRelations.begin(); i != recipeRelations.end(); ++i )
+      {
+         if( i->mash == other->_key )
+            i->mash = tmp->_key;
+      }
    }
    
    dirty = true; 
@@ -1146,6 +1547,11 @@ Recipe* Database::newRecipe(bool addMash)
    tmp->_table = Brewtarget::RECTABLE;
    allRecipes.insert(tmp->_key,tmp);
    
+   // Nothing in it yet, so no need to ask the tables.
+   recipeRelationsMutex.lock();
+   recipeRelations.insert(tmp->_key, RecipeRelations());
+   recipeRelationsMutex.unlock();
+   
    // Now, need to create a new mash for the recipe.
    if ( addMash )
       newMash( tmp );
@@ -1255,25 +1661,6 @@ Yeast* Database::newYeast(Yeast* other)
 
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-void Database::deleteRecord( Brewtarget::DBTable table, BeerXMLElement* object )
-{
-   // Assumes the table has a column called 'deleted'.
-   SetterCommand* command;
-   command = new SetterCommand(table,
-                         object->_key,
-                         "deleted",
-                         QVariant(1),
-                         object->metaProperty("deleted"),
-                         object,
-                         true);
-   // For now, immediately execute the command.
-   command->redo();
-   dirty = true; 
-   
-   // Push the command on the undo stack.
-   //commandStack.push(command);
-}
-
 void Database::duplicateMashSteps(Mash *oldMash, Mash *newMash)
 {
    QList<MashStep*> tmpMS = mashSteps(oldMash);
@@ -1300,274 +1687,246 @@ void Database::duplicateMashSteps(Mash *oldMash, Mash *newMash)
 }
 
 // Ever think I sometimes abuse multiple dispatch?
-void Database::remove(Equipment* equip)
-{
-   deleteRecord(Brewtarget::EQUIPTABLE,equip);
+void Database::remove(Equipment* equip) { deleteElements(QList<BeerXMLElement*>() << equip); }
+void Database::remove(Fermentable* ferm) { deleteElements(QList<BeerXMLElement*>() << ferm); }
+void Database::remove(Hop* hop) { deleteElements(QList<BeerXMLElement*>() << hop); }
+void Database::remove(Mash* mash) { deleteElements(QList<BeerXMLElement*>() << mash); }
+void Database::remove(MashStep* mashStep) { deleteElements(QList<BeerXMLElement*>() << mashStep); }
+void Database::remove(Misc* misc) { deleteElements(QList<BeerXMLElement*>() << misc); }
+void Database::remove(Recipe* rec) { deleteElements(QList<BeerXMLElement*>() << rec); }
+void Database::remove(Style* style) { deleteElements(QList<BeerXMLElement*>() << style); }
+void Database::remove(Water* water) { deleteElements(QList<BeerXMLElement*>() << water); }
+void Database::remove(Yeast* yeast) { deleteElements(QList<BeerXMLElement*>() << yeast); }
+void Database::remove(BrewNote* b) { deleteElements(QList<BeerXMLElement*>() << b); }
+
+void Database::remove(QList<Equipment*> equip) { deleteElements(toElements(equip)); }
+void Database::remove(QList<Fermentable*> ferm) { deleteElements(toElements(ferm)); }
+void Database::remove(QList<Hop*> hop) { deleteElements(toElements(hop)); }
+void Database::remove(QList<Mash*> mash) { deleteElements(toElements(mash)); }
+void Database::remove(QList<MashStep*> mashStep) { deleteElements(toElements(mashStep)); }
+void Database::remove(QList<Misc*> misc) { deleteElements(toElements(misc)); }
+void Database::remove(QList<Recipe*> rec) { deleteElements(toElements(rec)); }
+void Database::remove(QList<Style*> style) { deleteElements(toElements(style)); }
+void Database::remove(QList<Water*> water) { deleteElements(toElements(water)); }
+void Database::remove(QList<Yeast*> yeast) { deleteElements(toElements(yeast)); }
+void Database::remove(QList<BrewNote*> notes) { deleteElements(toElements(notes)); }
+
+bool Database::bulkUpdate(QList<BeerXMLElement*> const& elements, QString const& setClause, QVariant const& value)
+{
+   QHash< Brewtarget::DBTable, QStringList > keys;
+   QHash< Brewtarget::DBTable, QStringList >::const_iterator i;
+   bool success = true;
    
-   emit changed( metaProperty("equipments"), QVariant() );
-   emit deletedEquipmentSignal(equip);
-}
-
-void Database::remove(QList<Equipment*> equip)
-{
-   if ( equip.empty() )
-      return;
-
-   QList<Equipment*>::Iterator it = equip.begin();
-   while( it != equip.end() )
+   foreach( BeerXMLElement* elem, elements )
+      keys[elem->_table].append( QString::number(elem->_key) );
+   
+   QSqlDatabase db = sqlDatabase();
+   db.transaction();
+   
+   QSqlQuery q(db);
+   for( i = keys.constBegin(); i != keys.constEnd() && success; ++i )
    {
-      deleteRecord(Brewtarget::EQUIPTABLE,*it);
-      emit deletedEquipmentSignal(*it);
-      it++;
+      SqlProfiler::Timer timer("Database::bulkUpdate");
+      q.prepare( QString("UPDATE `%1` SET %2 WHERE id IN (%3)")
+                 .arg(tableNames[i.key()])
+                 .arg(setClause)
+                 .arg(i.value().join(",")) );
+      q.bindValue(":value", value);
+      success = q.exec();
+      timer.stop(q);
+   }
+   
+   if( success )
+      db.commit();
+   else
+   {
+      Brewtarget::logE( QString("Database::bulkUpdate: %1.\n   \"%2\"").arg(q.lastError().text()).arg(q.lastQuery()) );
+      db.rollback();
+      return false;
    }
-
-   emit changed( metaProperty("equipments"), QVariant() );
-}
-
-void Database::remove(Fermentable* ferm)
-{
-   deleteRecord(Brewtarget::FERMTABLE,ferm);
    
-   emit changed( metaProperty("fermentables"), QVariant());
-   emit deletedFermentableSignal(ferm);
+   dirty = true;
+   return true;
 }
 
-void Database::remove(QList<Fermentable*> ferm)
+void Database::deleteElements(QList<BeerXMLElement*> const& elements)
 {
-   if ( ferm.empty() )
+   QSet<Brewtarget::DBTable> tables;
+   
+   if( elements.isEmpty() || !bulkUpdate(elements, "deleted=:value", QVariant(1)) )
       return;
-
-   QList<Fermentable*>::Iterator it = ferm.begin();
-   while( it != ferm.end() )
+   
+   foreach( BeerXMLElement* elem, elements )
    {
-      deleteRecord(Brewtarget::FERMTABLE,*it);
-      emit deletedFermentableSignal(*it);
+      tables.insert(elem->_table);
+      emit elem->changed( elem->metaProperty("deleted"), QVariant(1) );
       
-      it++;
+      switch( elem->_table )
+      {
+         case Brewtarget::BREWNOTETABLE:
+            unrelateFromRecipe( 0, elem );
+            emit deletedBrewNoteSignal( qobject_cast<BrewNote*>(elem) );
+            break;
+         case Brewtarget::EQUIPTABLE:
+            emit deletedEquipmentSignal( qobject_cast<Equipment*>(elem) );
+            break;
+         case Brewtarget::FERMTABLE:
+            emit deletedFermentableSignal( qobject_cast<Fermentable*>(elem) );
+            break;
+         case Brewtarget::HOPTABLE:
+            emit deletedHopSignal( qobject_cast<Hop*>(elem) );
+            break;
+         case Brewtarget::MASHTABLE:
+            emit deletedMashSignal( qobject_cast<Mash*>(elem) );
+            break;
+         case Brewtarget::MISCTABLE:
+            emit deletedMiscSignal( qobject_cast<Misc*>(elem) );
+            break;
+         case Brewtarget::RECTABLE:
+            emit deletedRecipeSignal( qobject_cast<Recipe*>(elem) );
+            break;
+         case Brewtarget::STYLETABLE:
+            emit deletedStyleSignal( qobject_cast<Style*>(elem) );
+            break;
+         case Brewtarget::WATERTABLE:
+            emit deletedWaterSignal( qobject_cast<Water*>(elem) );
+            break;
+         case Brewtarget::YEASTTABLE:
+            emit deletedYeastSignal( qobject_cast<Yeast*>(elem) );
+            break;
+         default:
+            break;
+      }
    }
    
-   emit changed( metaProperty("fermentables"), QVariant());
+   foreach( Brewtarget::DBTable table, tables )
+      emitTableChanged(table);
+   emit deletedElementsSignal(elements);
 }
 
-void Database::remove(Hop* hop)
+void Database::moveToFolder(QList<BeerXMLElement*> const& elements, QString const& folder)
 {
-   deleteRecord(Brewtarget::HOPTABLE,hop);
+   if( elements.isEmpty() || !bulkUpdate(elements, "folder=:value", QVariant(folder)) )
+      return;
    
-   emit changed( metaProperty("hops"), QVariant() );
-   emit deletedHopSignal(hop);
-}
-
-void Database::remove(QList<Hop*> hop)
-{
-   if ( hop.empty() )
-      return;
-
-   QList<Hop*>::Iterator it = hop.begin();
-   while( it != hop.end() )
-   {
-      deleteRecord(Brewtarget::HOPTABLE,*it);
-      emit deletedHopSignal(*it);
-      
-      it++;
-   }
-
-   emit changed( metaProperty("hops"), QVariant() );
-}
-
-void Database::remove(Mash* mash)
-{
-   deleteRecord(Brewtarget::MASHTABLE,mash);
+   // Not changedFolder(), which would make the trees move them one by one.
+   foreach( BeerXMLElement* elem, elements )
+      emit elem->changed( elem->metaProperty("folder"), QVariant(folder) );
    
-   emit changed( metaProperty("mashs"), QVariant() );
-   emit deletedMashSignal(mash);
-}
-
-void Database::remove(BrewNote* b)
-{
-   deleteRecord(Brewtarget::BREWNOTETABLE,b);
-   emit deletedBrewNoteSignal(b);
-}
-
-void Database::remove(QList<BrewNote*> notes)
-{
-   if (notes.empty())
-      return;
-   foreach( BrewNote* b, notes )
-      remove(b);
+   emit movedElementsSignal(elements, folder);
 }
 
-void Database::remove(QList<Mash*> mash)
+void Database::emitTableChanged(Brewtarget::DBTable table)
 {
-   if ( mash.empty() )
-      return;
-
-   QList<Mash*>::Iterator it = mash.begin();
-   while( it != mash.end() )
+   switch( table )
    {
-      deleteRecord(Brewtarget::MASHTABLE,*it);
-      emit deletedMashSignal(*it);
-      it++;
+      case Brewtarget::BREWNOTETABLE:
+         emit changed( metaProperty("brewNotes"), QVariant() );
+         break;
+      case Brewtarget::EQUIPTABLE:
+         emit changed( metaProperty("equipments"), QVariant() );
+         break;
+      case Brewtarget::FERMTABLE:
+         emit changed( metaProperty("fermentables"), QVariant() );
+         break;
+      case Brewtarget::HOPTABLE:
+         emit changed( metaProperty("hops"), QVariant() );
+         break;
+      case Brewtarget::MASHTABLE:
+         emit changed( metaProperty("mashs"), QVariant() );
+         break;
+      case Brewtarget::MASHSTEPTABLE:
+         emit changed( metaProperty("mashSteps"), QVariant() );
+         break;
+      case Brewtarget::MISCTABLE:
+         emit changed( metaProperty("miscs"), QVariant() );
+         break;
+      case Brewtarget::RECTABLE:
+         emit changed( metaProperty("recipes"), QVariant() );
+         break;
+      case Brewtarget::STYLETABLE:
+         emit changed( metaProperty("styles"), QVariant() );
+         break;
+      case Brewtarget::WATERTABLE:
+         emit changed( metaProperty("waters"), QVariant() );
+         break;
+      case Brewtarget::YEASTTABLE:
+         emit changed( metaProperty("yeasts"), QVariant() );
+         break;
+      default:
+         break;
    }
-   emit changed( metaProperty("mashs"), QVariant() );
 }
 
-void Database::remove(MashStep* mashStep)
+QString Database::getDbFileName()
 {
-   deleteRecord(Brewtarget::MASHSTEPTABLE,mashStep);
+   // Ensure instance exists.
+   instance();
    
-   emit changed( metaProperty("mashSteps"), QVariant() );
-}
-
-void Database::remove(QList<MashStep*> mashStep)
-{
-   if ( mashStep.empty() )
-      return;
-
-   QList<MashStep*>::Iterator it = mashStep.begin();
-   while( it != mashStep.end() )
-   {
-      deleteRecord(Brewtarget::MASHSTEPTABLE,*it);
-      it++;
-   }
-   emit changed( metaProperty("mashSteps"), QVariant() );
+   return dbFileName;
 }
 
-void Database::remove(Misc* misc)
+void Database::updateEntry( Brewtarget::DBTable table, int key, const char* col_name, QVariant value, QMetaProperty prop, BeerXMLElement* object, bool notify )
 {
-   deleteRecord(Brewtarget::MISCTABLE,misc);
+   SetterCommand* command;
    
-   emit changed( metaProperty("miscs"), QVariant());
-   emit deletedMiscSignal(misc);
-}
-
-void Database::remove(QList<Misc*> misc)
-{
-   if ( misc.empty() )
+   // Recipes still store their recalculated og/fg when read; just drop those.
+   if( readOnly )
       return;
+   command = new SetterCommand(table,
+                               key,
+                               col_name,
+                               value,
+                               prop,
+                               object,
+                               notify);
 
-   QList<Misc*>::Iterator it = misc.begin();
-   while( it != misc.end() )
+   if( batch )
    {
-      deleteRecord(Brewtarget::MISCTABLE,*it);
-      emit deletedMiscSignal(*it);
-      it++;
-   }
-   emit changed( metaProperty("miscs"), QVariant());
-}
-
-void Database::remove(Recipe* rec)
-{
-   deleteRecord(Brewtarget::RECTABLE,rec);
-   
-   emit changed( metaProperty("recipes"), QVariant() );
-   emit deletedRecipeSignal(rec);
-}
-
-void Database::remove(QList<Recipe*> rec)
-{
-   if ( rec.empty() )
+      batch->mergeWith(command);
+      delete command;
       return;
-
-   QList<Recipe*>::Iterator it = rec.begin();
-   while( it != rec.end() )
-   {
-      deleteRecord(Brewtarget::RECTABLE,*it);
-      emit deletedRecipeSignal(*it);
-      it++;
    }
-   emit changed( metaProperty("recipes"), QVariant() );
-}
 
-void Database::remove(Style* style)
-{
-   deleteRecord(Brewtarget::STYLETABLE,style);
-   
-   emit changed( metaProperty("styles"), QVariant() );
-   emit deletedStyleSignal(style);
+   command->redo();
+   dirty = true; 
 }
 
-void Database::remove(QList<Style*> style)
+void Database::startBatch()
 {
-   if ( style.empty() )
+   if( batch )
       return;
-
-   QList<Style*>::Iterator it = style.begin();
-   while( it != style.end() )
-   {
-      deleteRecord(Brewtarget::STYLETABLE,*it);
-      emit deletedStyleSignal(*it);
-      it++;
-   }
-   emit changed( metaProperty("styles"), QVariant() );
+   batch = new SetterCommand();
 }
 
-void Database::remove(Water* water)
+void Database::finishBatch()
 {
-   deleteRecord(Brewtarget::WATERTABLE,water);
+   SetterCommand* command = batch;
+   QList<Recipe*> recalcs;
    
-   emit changed( metaProperty("waters"), QVariant());
-   emit deletedWaterSignal(water);
-}
-
-void Database::remove(QList<Water*> water)
-{
-   if ( water.empty() )
+   if( ! command )
       return;
-
-   QList<Water*>::Iterator it = water.begin();
-   while( it != water.end() )
-   {
-      deleteRecord(Brewtarget::WATERTABLE,*it);
-      emit deletedWaterSignal(*it);
-      it++;
-   }
-   emit changed( metaProperty("waters"), QVariant());
-}
-
-void Database::remove(Yeast* yeast)
-{
-   deleteRecord(Brewtarget::YEASTTABLE,yeast);
    
-   emit changed( metaProperty("yeasts"), QVariant());
-   emit deletedYeastSignal(yeast);
-}
-
-void Database::remove(QList<Yeast*> yeast)
-{
-   if ( yeast.empty() )
-      return;
-
-   QList<Yeast*>::Iterator it = yeast.begin();
-   while( it != yeast.end() )
-   {
-      deleteRecord(Brewtarget::YEASTTABLE,*it);
-      emit deletedYeastSignal(*it);
-      it++;
-   }
-   emit changed( metaProperty("yeasts"), QVariant());
-}
+   // Clear it first, so the slots of the changed signals write as usual.
+   batch = 0;
+   command->redo();
+   delete command;
+   dirty = true;
 
-QString Database::getDbFileName()
-{
-   // Ensure instance exists.
-   instance();
-   
-   return dbFileName;
+   // Now that the recipes have their final ingredients, once each.
+   recalcs = batchRecalcs;
+   batchRecalcs.clear();
+   foreach( Recipe* rec, recalcs )
+      rec->recalcAll();
 }
 
-void Database::updateEntry( Brewtarget::DBTable table, int key, const char* col_name, QVariant value, QMetaProperty prop, BeerXMLElement* object, bool notify )
+bool Database::deferRecalc( Recipe* rec )
 {
-   SetterCommand* command;
-   command = new SetterCommand(table,
-                               key,
-                               col_name,
-                               value,
-                               prop,
-                               object,
-                               notify);
-
-   command->redo();
-   dirty = true; 
+   if( ! batch )
+      return false;
+   if( ! batchRecalcs.contains(rec) )
+      batchRecalcs.append(rec);
+   return true;
 }
 
 // Inventory functions ========================================================
@@ -1595,11 +1954,8 @@ void Database::populateChildTablesByName(Brewtarget::DBTable table){
       ).arg(tableNames[table]).arg(name);
       QSqlQuery childrenq( queryString, sqlDatabase() );
       while (childrenq.next()) {
-         QString childID = childrenq.record().value("id").toString();
-         queryString = QString(
-            "INSERT OR REPLACE INTO %1 (parent_id, child_id) VALUES (%2, %3)"
-         ).arg(tableNames[tableToChildTable[table]]).arg(parentID).arg(childID);
-         QSqlQuery insertq( queryString, sqlDatabase() );
+         int childID = childrenq.record().value("id").toInt();
+         insertChildLink( tableNames[tableToChildTable[table]], table, parentID.toInt(), childID );
       }
    }
    
@@ -1613,20 +1969,7 @@ void Database::populateChildTablesByName(){
 }
 //Returns the key of the parent ingredient
 int Database::getParentID(Brewtarget::DBTable table, int childKey){
-   int ret;
-   //child_id is expected to be unique in table
-   QString queryString = QString(
-      "SELECT parent_id FROM %1 WHERE child_id = %2 LIMIT 1"
-   ).arg(tableNames[tableToChildTable[table]]).arg(childKey);
-   
-   QSqlQuery q( queryString, sqlDatabase() );
-   q.first();
-   ret = q.record().value("parent_id").toInt();
-   if(ret==0){
-      return childKey;
-   }else{
-      return ret;
-   }
+   return inventoryParent(table, childKey);
 }
 //Returns the key to the inventory table for a given ingredient
 int Database::getInventoryID(Brewtarget::DBTable table, int key){
@@ -1647,15 +1990,332 @@ Brewtarget::DBTable Database::getChildTable(Brewtarget::DBTable table){
 Brewtarget::DBTable Database::getInventoryTable(Brewtarget::DBTable table){
    return tableToInventoryTable[table];
 }
-//create a new inventory row
-void Database::newInventory(Brewtarget::DBTable invForTable, int invForID){
-   QString invTable = tableNames[tableToInventoryTable[invForTable]];
+void Database::populateInventory()
+{
+   QList<Brewtarget::DBTable> tables = tableToInventoryTable.keys();
    
-   QString queryString = QString(
-      "INSERT OR REPLACE INTO %1 (%2_id) VALUES (%3)"
-   ).arg(invTable).arg(tableNames[invForTable]).arg(getParentID(invForTable, invForID));
-   QSqlQuery q( queryString, sqlDatabase() );
+   inventoryParents.clear();
+   inventoryBalances.clear();
    
+   foreach( Brewtarget::DBTable table, tables )
+   {
+      QHash<int,int>& parents = inventoryParents[table];
+      QHash<int,double>& balances = inventoryBalances[table];
+      
+      QSqlQuery q( sqlDatabase() );
+      q.setForwardOnly(true);
+      
+      //child_id is expected to be unique in table, so the first parent wins.
+      SqlProfiler::Timer childTimer("Database::populateInventory");
+      q.exec( QString("SELECT parent_id, child_id FROM %1 ORDER BY id DESC")
+              .arg(tableNames[tableToChildTable[table]]) );
+      childTimer.stop(q);
+      while( q.next() )
+      {
+         int parent = q.record().value("parent_id").toInt();
+         if( parent != 0 )
+            parents.insert( q.record().value("child_id").toInt(), parent );
+      }
+      
+      SqlProfiler::Timer balanceTimer("Database::populateInventory");
+      q.exec( QString("SELECT %1_id, %2 FROM %3")
+              .arg(tableNames[table])
+              .arg(inventoryColumn(table))
+              .arg(tableNames[tableToInventoryTable[table]]) );
+      balanceTimer.stop(q);
+      while( q.next() )
+         balances.insert( q.record().value(0).toInt(), q.record().value(1).toDouble() );
+   }
+}
+
+void Database::populateRecipeStats()
+{
+   QSqlQuery q( sqlDatabase() );
+   q.setForwardOnly(true);
+   
+   SqlProfiler::Timer timer("Database::populateRecipeStats");
+   q.exec( QString("SELECT id, og, fg, calc_ibu, calc_color_srm, calc_abv_pct, calc_stamp FROM %1")
+           .arg(tableNames[Brewtarget::RECTABLE]) );
+   timer.stop(q);
+   while( q.next() )
+   {
+      Recipe* rec = allRecipes.value( q.value(0).toInt() );
+      if( !rec )
+         continue;
+      
+      rec->_storedStats.og = q.value(1).toDouble();
+      rec->_storedStats.fg = q.value(2).toDouble();
+      rec->_storedStats.IBU = q.value(3).toDouble();
+      rec->_storedStats.color_srm = q.value(4).toDouble();
+      rec->_storedStats.ABV_pct = q.value(5).toDouble();
+      rec->_storedStats.calcStamp = q.value(6).toInt();
+      rec->_storedStatsLoaded = true;
+   }
+}
+
+QString Database::inventoryColumn(Brewtarget::DBTable table)
+{
+   // Yeast inventory is done by quanta, not amount.
+   return (table == Brewtarget::YEASTTABLE) ? "quanta" : "amount";
+}
+
+int Database::inventoryParent(Brewtarget::DBTable table, int key) const
+{
+   return inventoryParents.value(table).value(key, key);
+}
+
+bool Database::insertChildLink(QString const& childTableName, Brewtarget::DBTable table, int parent, int child)
+{
+   QSqlQuery q( sqlDatabase() );
+   
+   q.prepare( QString("INSERT INTO `%1` (`parent_id`, `child_id`) VALUES (:parent, :child)")
+              .arg(childTableName) );
+   q.bindValue(":parent", parent);
+   q.bindValue(":child", child);
+   SqlProfiler::Timer timer("Database::insertChildLink");
+   bool inserted = q.exec();
+   timer.stop(q);
+   if( !inserted )
+   {
+      Brewtarget::logW( QString("Database::insertChildLink: %1.").arg(q.lastError().text()) );
+      return false;
+   }
+   q.finish();
+   
+   if( !tableToInventoryTable.contains(table) || parent == 0 || child == parent )
+      return true;
+   
+   // Keep the first parent, like populateInventory() does.
+   QHash<int,int>& parents = inventoryParents[table];
+   if( !parents.contains(child) )
+      parents.insert(child, parent);
+   return true;
+}
+
+BeerXMLElement* Database::inventoryElement(Brewtarget::DBTable table, int key) const
+{
+   switch( table )
+   {
+      case Brewtarget::FERMTABLE:
+         return allFermentables.value(key);
+      case Brewtarget::HOPTABLE:
+         return allHops.value(key);
+      case Brewtarget::MISCTABLE:
+         return allMiscs.value(key);
+      case Brewtarget::YEASTTABLE:
+         return allYeasts.value(key);
+      default:
+         return 0;
+   }
+}
+
+QVariant Database::inventory(Brewtarget::DBTable table, int key) const
+{
+   double amount = inventoryBalances.value(table).value(inventoryParent(table, key), 0.0);
+   
+   if( table == Brewtarget::YEASTTABLE )
+      return QVariant(static_cast<int>(amount));
+   return QVariant(amount);
+}
+
+bool Database::writeInventory(Brewtarget::DBTable table, int parent, double balance, double delta, int recipeKey, QString const& reason)
+{
+   QString invTable = tableNames[tableToInventoryTable[table]];
+   QVariant value = (table == Brewtarget::YEASTTABLE) ? QVariant(static_cast<int>(balance)) : QVariant(balance);
+   QSqlQuery q( sqlDatabase() );
+   
+   if( inventoryBalances[table].contains(parent) )
+   {
+      q.prepare( QString("UPDATE %1 SET %2 = :value WHERE %3_id = :parent")
+                 .arg(invTable).arg(inventoryColumn(table)).arg(tableNames[table]) );
+   }
+   else
+   {
+      q.prepare( QString("INSERT INTO %1 (%3_id, %2) VALUES (:parent, :value)")
+                 .arg(invTable).arg(inventoryColumn(table)).arg(tableNames[table]) );
+   }
+   q.bindValue(":value", value);
+   q.bindValue(":parent", parent);
+   SqlProfiler::Timer timer("Database::writeInventory");
+   bool written = q.exec();
+   timer.stop(q);
+   if( !written )
+   {
+      Brewtarget::logE( QString("Database::writeInventory: %1.\n   \"%2\"").arg(q.lastError().text()).arg(q.lastQuery()) );
+      return false;
+   }
+   q.finish();
+   
+   q.prepare( QString("INSERT INTO %1 (ingredient_table, ingredient_id, recipe_id, delta, balance, reason) "
+                      "VALUES (:table, :parent, :recipe, :delta, :balance, :reason)")
+              .arg(DatabaseSchemaHelper::tableInventoryLedger) );
+   q.bindValue(":table", tableNames[table]);
+   q.bindValue(":parent", parent);
+   q.bindValue(":recipe", recipeKey);
+   q.bindValue(":delta", delta);
+   q.bindValue(":balance", value);
+   q.bindValue(":reason", reason);
+   SqlProfiler::Timer ledgerTimer("Database::writeInventory");
+   written = q.exec();
+   ledgerTimer.stop(q);
+   if( !written )
+   {
+      Brewtarget::logE( QString("Database::writeInventory: %1.\n   \"%2\"").arg(q.lastError().text()).arg(q.lastQuery()) );
+      return false;
+   }
+   
+   inventoryBalances[table][parent] = value.toDouble();
+   return true;
+}
+
+void Database::setInventory(BeerXMLElement* ing, QVariant const& value, QMetaProperty prop, bool notify)
+{
+   Brewtarget::DBTable table = ing->_table;
+   int parent = inventoryParent(table, ing->_key);
+   double oldBalance = inventoryBalances.value(table).value(parent, 0.0);
+   double newBalance = value.toDouble();
+   
+   QSqlDatabase db = sqlDatabase();
+   db.transaction();
+   if( writeInventory(table, parent, newBalance, newBalance - oldBalance, 0, "set") )
+      db.commit();
+   else
+   {
+      db.rollback();
+      inventoryBalances[table][parent] = oldBalance;
+      return;
+   }
+   
+   dirty = true;
+   if( notify )
+   {
+      BeerXMLElement* owner = inventoryElement(table, parent);
+      
+      emit ing->changed(prop, value);
+      // The trees show the parent, and its inventory just changed too.
+      if( owner && owner != ing )
+         emit owner->changed(prop, value);
+   }
+}
+
+void Database::reduceInventory(QList<Recipe*> const& recs)
+{
+   // (table, parent) -> the ingredient to notify when done.
+   QHash< Brewtarget::DBTable, QHash<int,BeerXMLElement*> > touched;
+   // Running balances, so the same ingredient in several recipes is reduced cumulatively.
+   QHash< Brewtarget::DBTable, QHash<int,double> > balances = inventoryBalances;
+   QList< QPair<BeerXMLElement*,double> > uses;
+   QList<QPair<BeerXMLElement*,double> >::const_iterator it;
+   bool success = true;
+   
+   QSqlDatabase db = sqlDatabase();
+   db.transaction();
+   
+   foreach( Recipe* rec, recs )
+   {
+      if( rec == 0 )
+         continue;
+      
+      uses.clear();
+      foreach( Fermentable* f, fermentables(rec) )
+         uses.append( qMakePair(static_cast<BeerXMLElement*>(f), f->amount_kg()) );
+      foreach( Hop* h, hops(rec) )
+         uses.append( qMakePair(static_cast<BeerXMLElement*>(h), h->amount_kg()) );
+      foreach( Misc* m, miscs(rec) )
+         uses.append( qMakePair(static_cast<BeerXMLElement*>(m), m->amount()) );
+      //Yeast inventory is done by quanta not amount
+      foreach( Yeast* y, yeasts(rec) )
+         uses.append( qMakePair(static_cast<BeerXMLElement*>(y), 1.0) );
+      
+      for( it = uses.constBegin(); it != uses.constEnd() && success; ++it )
+      {
+         Brewtarget::DBTable table = it->first->_table;
+         int parent = inventoryParent(table, it->first->_key);
+         double oldBalance = balances[table].value(parent, 0.0);
+         double newBalance = qMax(0.0, oldBalance - it->second);
+         
+         balances[table][parent] = newBalance;
+         touched[table].insert(parent, it->first);
+         success &= writeInventory(table, parent, newBalance, newBalance - oldBalance, rec->_key, "brew");
+      }
+   }
+   
+   if( success )
+      db.commit();
+   else
+   {
+      Brewtarget::logE( "Database::reduceInventory: rolling back" );
+      db.rollback();
+      // The cache may hold balances from the rolled-back transaction.
+      populateInventory();
+      return;
+   }
+   
+   dirty = true;
+   
+   // One notification per affected ingredient.
+   QHash< Brewtarget::DBTable, QHash<int,BeerXMLElement*> >::const_iterator tIt;
+   QHash<int,BeerXMLElement*>::const_iterator pIt;
+   for( tIt = touched.constBegin(); tIt != touched.constEnd(); ++tIt )
+   {
+      for( pIt = tIt.value().constBegin(); pIt != tIt.value().constEnd(); ++pIt )
+      {
+         BeerXMLElement* ing = pIt.value();
+         BeerXMLElement* owner = inventoryElement(tIt.key(), pIt.key());
+         QVariant balance = inventory(tIt.key(), pIt.key());
+         
+         emit ing->changed( ing->metaProperty("inventory"), balance );
+         // The trees show the parent, and its inventory just changed too.
+         if( owner && owner != ing )
+            emit owner->changed( owner->metaProperty("inventory"), balance );
+      }
+   }
+}
+
+QList<Database::InventoryChange> Database::inventoryHistory(BeerXMLElement const* ing, QString const& reason, int limit)
+{
+   QList<InventoryChange> ret;
+   QString filter;
+   QSqlQuery q( sqlDatabase() );
+   
+   if( ing == 0 )
+      return ret;
+   
+   if( !reason.isEmpty() )
+      filter = " AND reason = :reason";
+   q.setForwardOnly(true);
+   q.prepare( QString("SELECT tstamp, delta, balance, recipe_id, reason FROM %1 "
+                      "WHERE ingredient_table = :table AND ingredient_id = :parent%2 ORDER BY id DESC%3")
+              .arg(DatabaseSchemaHelper::tableInventoryLedger)
+              .arg(filter)
+              .arg(limit > 0 ? QString(" LIMIT %1").arg(limit) : QString()) );
+   q.bindValue(":table", tableNames[ing->_table]);
+   q.bindValue(":parent", inventoryParent(ing->_table, ing->_key));
+   if( !reason.isEmpty() )
+      q.bindValue(":reason", reason);
+   SqlProfiler::Timer timer("Database::inventoryHistory");
+   bool ok = q.exec();
+   timer.stop(q);
+   if( !ok )
+   {
+      Brewtarget::logW( QString("Database::inventoryHistory: %1.").arg(q.lastError().text()) );
+      return ret;
+   }
+   
+   while( q.next() )
+   {
+      InventoryChange change;
+      // SQLite keeps CURRENT_TIMESTAMP in UTC.
+      change.when = QDateTime::fromString(q.value(0).toString(), "yyyy-MM-dd hh:mm:ss");
+      change.when.setTimeSpec(Qt::UTC);
+      change.when = change.when.toLocalTime();
+      change.delta = q.value(1).toDouble();
+      change.balance = q.value(2).toDouble();
+      change.recipeKey = q.value(3).toInt();
+      change.reason = q.value(4).toString();
+      ret.append(change);
+   }
+   return ret;
 }
 
 // Add to recipe ==============================================================
@@ -1678,6 +2338,7 @@ void Database::addToRecipe( Recipe* rec, Equipment* e, bool noCopy )
    sqlUpdate(Brewtarget::RECTABLE,
              QString("`equipment_id`='%1'").arg(newEquip->key()),
              QString("id='%1'").arg(rec->_key));
+   relateToRecipe(rec, newEquip);
 
    newEquip->setDisplay(false);
    
@@ -1707,7 +2368,7 @@ void Database::addToRecipe( Recipe* rec, Fermentable* ferm, bool noCopy )
    connect( newFerm, SIGNAL(changed(QMetaProperty,QVariant)), rec, SLOT(acceptFermChange(QMetaProperty,QVariant)) );
    // recalcAll is very expensive. When doing a massive import, don't do it
    // with every fermentable. Let it happen once
-   if (! noCopy ) 
+   if (! noCopy && ! deferRecalc(rec) )
       rec->recalcAll();
 }
 
@@ -1739,7 +2400,8 @@ void Database::addToRecipe( Recipe* rec, Hop* hop, bool noCopy )
                                          "hop_children",
                                          noCopy, &allHops );
    connect( newHop, SIGNAL(changed(QMetaProperty,QVariant)), rec, SLOT(acceptHopChange(QMetaProperty,QVariant)));
-   rec->recalcIBU();
+   if( ! deferRecalc(rec) )
+      rec->recalcIBU();
 }
 
 void Database::addToRecipe( Recipe* rec, QList<Hop*>hops )
@@ -1780,6 +2442,7 @@ void Database::addToRecipe( Recipe* rec, Mash* m, bool noCopy )
    sqlUpdate(Brewtarget::RECTABLE,
              QString("`mash_id`='%1'").arg(newMash->key()),
              QString("id='%1'").arg(rec->_key));
+   relateToRecipe(rec, newMash);
    
    // Emit a changed signal.
    dirty = true; 
@@ -1793,7 +2456,7 @@ void Database::addToRecipe( Recipe* rec, Mash* m, bool noCopy )
 void Database::addToRecipe( Recipe* rec, Misc* m, bool noCopy )
 {
    addIngredientToRecipe<Misc>( rec, m, "miscs", "misc_in_recipe", "misc_id", "misc_children", noCopy, &allMiscs );
-   if (! noCopy ) 
+   if (! noCopy && ! deferRecalc(rec) )
       rec->recalcAll();
 }
 
@@ -1815,7 +2478,7 @@ void Database::addToRecipe( Recipe* rec, QList<Misc*>miscs )
 void Database::addToRecipe( Recipe* rec, Water* w, bool noCopy )
 {
    addIngredientToRecipe<Water>( rec, w, "waters", "water_in_recipe", "water_id", "water_children", noCopy, &allWaters );
-   if (! noCopy ) 
+   if (! noCopy && ! deferRecalc(rec) )
       rec->recalcAll();
 }
 
@@ -1834,6 +2497,7 @@ void Database::addToRecipe( Recipe* rec, Style* s, bool noCopy )
    sqlUpdate(Brewtarget::RECTABLE,
              QString("`style_id`='%1'").arg(newStyle->key()),
              QString("id='%1'").arg(rec->_key));
+   relateToRecipe(rec, newStyle);
 
    newStyle->setDisplay(false);
    dirty = true; 
@@ -1852,7 +2516,7 @@ void Database::addToRecipe( Recipe* rec, Yeast* y, bool noCopy )
                                          "yeast_children",
                                          noCopy, &allYeasts );
    connect( newYeast, SIGNAL(changed(QMetaProperty,QVariant)), rec, SLOT(acceptYeastChange(QMetaProperty,QVariant)));
-   if ( ! noCopy )
+   if ( ! noCopy && ! deferRecalc(rec) )
    {
       rec->recalcOgFg();
       rec->recalcABV_pct();
@@ -1883,11 +2547,13 @@ void Database::addToRecipe( Recipe* rec, QList<Yeast*>yeasts )
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 void Database::sqlUpdate( Brewtarget::DBTable table, QString const& setClause, QString const& whereClause )
 {
+   SqlProfiler::Timer timer("Database::sqlUpdate");
    QSqlQuery q( QString("UPDATE `%1` SET %2 WHERE %3")
                 .arg(tableNames[table])
                 .arg(setClause)
                 .arg(whereClause),
                 sqlDatabase());
+   timer.stop(q);
    if( q.lastError().isValid() )
       Brewtarget::logE( QString("Database::sqlUpdate(): %1").arg(q.lastError().text()) );
    q.finish();
@@ -1896,10 +2562,12 @@ void Database::sqlUpdate( Brewtarget::DBTable table, QString const& setClause, Q
 
 void Database::sqlDelete( Brewtarget::DBTable table, QString const& whereClause )
 {
+   SqlProfiler::Timer timer("Database::sqlDelete");
    QSqlQuery q( QString("DELETE FROM `%1` WHERE %2")
                 .arg(tableNames[table])
                 .arg(whereClause),
                 sqlDatabase());
+   timer.stop(q);
    q.finish();
    dirty = true; 
 }
@@ -2074,12 +2742,68 @@ QList<Yeast*> Database::yeasts()
    return tmp;
 }
 
+// The filter for the *ByName() lists. getElements() has no way to bind
+// values, so the text is quoted here.
+static QString browseFilter( QString const& nameContains )
+{
+   QString filter("deleted=0 AND display=1");
+   QString pattern(nameContains);
+
+   if( !pattern.isEmpty() )
+   {
+      pattern.replace("\\", "\\\\");
+      pattern.replace("%", "\\%");
+      pattern.replace("_", "\\_");
+      pattern.replace("'", "''");
+      filter += QString(" AND name LIKE '%%1%' ESCAPE '\\'").arg(pattern);
+   }
+
+   return filter + " ORDER BY name";
+}
+
+QList<Fermentable*> Database::fermentablesByName( QString const& nameContains )
+{
+   QList<Fermentable*> tmp;
+   getElements( tmp, browseFilter(nameContains), Brewtarget::FERMTABLE, allFermentables );
+   return tmp;
+}
+
+QList<Hop*> Database::hopsByName( QString const& nameContains )
+{
+   QList<Hop*> tmp;
+   getElements( tmp, browseFilter(nameContains), Brewtarget::HOPTABLE, allHops );
+   return tmp;
+}
+
+QList<Misc*> Database::miscsByName( QString const& nameContains )
+{
+   QList<Misc*> tmp;
+   getElements( tmp, browseFilter(nameContains), Brewtarget::MISCTABLE, allMiscs );
+   return tmp;
+}
+
+QList<Yeast*> Database::yeastsByName( QString const& nameContains )
+{
+   QList<Yeast*> tmp;
+   getElements( tmp, browseFilter(nameContains), Brewtarget::YEASTTABLE, allYeasts );
+   return tmp;
+}
+
 bool Database::updateSchema(bool* err)
 {
    int currentVersion = DatabaseSchemaHelper::currentVersion( sqlDatabase() );
    int newVersion = DatabaseSchemaHelper::dbVersion;
    bool doUpdate = currentVersion < newVersion;
    
+   if( readOnly )
+   {
+      if( doUpdate )
+         Brewtarget::logE(QString("Database is at version %1 but needs %2. Open it in brewtarget once to update it.").arg(currentVersion).arg(newVersion));
+      if( err )
+         *err = doUpdate;
+      return false;
+   }
+   
    if( doUpdate )
    {
       bool success = DatabaseSchemaHelper::migrate( currentVersion, newVersion, sqlDatabase() );
@@ -2110,7 +2834,7 @@ bool Database::updateSchema(bool* err)
    return doUpdate;
 }
 
-bool Database::importFromXML(const QString& filename)
+bool Database::importFromXML(const QString& filename, QList<Recipe*>* recipes)
 {
    unsigned int count;
    int line, col;
@@ -2140,6 +2864,8 @@ bool Database::importFromXML(const QString& filename)
          Recipe* temp = recipeFromXml( list.at(i) );
          if ( ! temp->isValid() )
             ret = false;
+         if( recipes )
+            recipes->append(temp);
       }
    }
    else
@@ -3637,7 +4363,9 @@ int Database::getQualifiedHopTypeIndex(QString type, Hop* hop)
   if ( Hop::types.indexOf(type) < 0 )
   {
     // look for a valid hop type from our database to use
+    SqlProfiler::Timer timer("Database::getQualifiedHopTypeIndex");
     QSqlQuery q(QString("SELECT htype FROM hop WHERE name='%1' AND htype != ''").arg(hop->name()), sqlDatabase());
+    timer.stop(q);
     q.first();
     if ( q.isValid() )
     {
@@ -3665,7 +4393,9 @@ int Database::getQualifiedHopUseIndex(QString use, Hop* hop)
   if ( Hop::uses.indexOf(use) < 0 )
   {
     // look for a valid hop type from our database to use
+    SqlProfiler::Timer timer("Database::getQualifiedHopUseIndex");
     QSqlQuery q(QString("SELECT use FROM hop WHERE name='%1' AND use != ''").arg(hop->name()), sqlDatabase());
+    timer.stop(q);
     q.first();
     if ( q.isValid() )
     {
@@ -3873,7 +4603,9 @@ int Database::getQualifiedMiscTypeIndex(QString type, Misc* misc)
   if ( Misc::types.indexOf(type) < 0 )
   {
     // look for a valid hop type from our database to use
+    SqlProfiler::Timer timer("Database::getQualifiedMiscTypeIndex");
     QSqlQuery q(QString("SELECT mtype FROM misc WHERE name='%1' AND mtype != ''").arg(misc->name()), sqlDatabase());
+    timer.stop(q);
     q.first();
     if ( q.isValid() )
     {
@@ -3901,7 +4633,9 @@ int Database::getQualifiedMiscUseIndex(QString use, Misc* misc)
   if ( Misc::uses.indexOf(use) < 0 )
   {
     // look for a valid hop type from our database to use
+    SqlProfiler::Timer timer("Database::getQualifiedMiscUseIndex");
     QSqlQuery q(QString("SELECT use FROM misc WHERE name='%1' AND use != ''").arg(misc->name()), sqlDatabase());
+    timer.stop(q);
     q.first();
     if ( q.isValid() )
     {
@@ -45,8 +45,11 @@ class Database;
 #include <QDebug>
 #include <QRegExp>
 #include <QMap>
+#include <QVector>
+#include <QDateTime>
 #include "BeerXMLElement.h"
 #include "brewtarget.h"
+#include "SqlProfiler.h"
 #include "recipe.h"
 // Forward declarations
 class BrewNote;
@@ -58,12 +61,14 @@ class Instruction;
 class Mash;
 class MashStep;
 class Misc;
+class PreInstruction;
 //class Recipe;
 class Style;
 class Water;
 class Yeast;
 class QThread;
 class SetterCommandStack;
+class SetterCommand;
 
 typedef struct
 {
@@ -96,6 +101,19 @@ public:
    static Database& instance();
    //! Call this to delete the internal instance.
    static void dropInstance();
+   /*!
+    * \brief Open the database read-only, without backups, merges or schema
+    * updates. Must be called before the first \b instance(). Used by the
+    * headless modes so that worker threads can read concurrently.
+    */
+   static void setReadOnly(bool ro);
+   static bool isReadOnly();
+   /*!
+    * \brief Use \c fileName instead of the user's database, or go back to
+    * the user's database if it is empty. The file has to exist already, and
+    * is never backed up or merged. Must be called before the first \b instance().
+    */
+   static void setFileName(QString const& fileName);
    //! \brief Should be called when we are about to close down.
    void unload(bool keepChanges = true);
 
@@ -115,12 +133,31 @@ public:
     */
    void updateEntry( Brewtarget::DBTable table, int key, const char* col_name, QVariant value, QMetaProperty prop, BeerXMLElement* object, bool notify = true );
    
+   /*!
+    * From here to \b finishBatch(), \b updateEntry() collects the changes
+    * instead of writing each one, so reads still see the old values until
+    * then. Adding ingredients to a recipe or removing them still writes at
+    * once, since a copy needs its key, but the recipe is recalculated only
+    * in \b finishBatch(). Batches do not nest.
+    */
+   void startBatch();
+   /*!
+    * Write everything since \b startBatch() in a single transaction, then
+    * emit the changed signals in the order the changes were made, then
+    * recalculate the recipes whose ingredients were added or removed.
+    */
+   void finishBatch();
+   //! \brief True between \b startBatch() and \b finishBatch().
+   bool isBatching() const { return batch != 0; }
+   
    //! \brief Get the contents of the cell specified by table/key/col_name.
    QVariant get( Brewtarget::DBTable table, int key, const char* col_name )
    {
-      QSqlQuery& q = selectAll[table];
+      SqlProfiler::Timer timer("Database::get");
+      QSqlQuery& q = selectAllQuery(table);
       q.bindValue( ":id", key );
       q.exec();
+      timer.stop(q);
       if( !q.next() )
       {
          Brewtarget::logE( QString("Database::get(): %1").arg(q.lastError().text()) );
@@ -187,15 +224,50 @@ public:
    Brewtarget::DBTable getChildTable(Brewtarget::DBTable table);
    //! \returns the inventory table number from the hash
    Brewtarget::DBTable getInventoryTable(Brewtarget::DBTable table);
-   //! Inserts an new inventory row in the appropriate table
-   void newInventory(Brewtarget::DBTable invForTable, int invForID);
+   //! \returns the cached inventory of \b key in \b table, as stored for its parent ingredient
+   QVariant inventory(Brewtarget::DBTable table, int key) const;
+   /*!
+    * \brief Set the inventory of \b ing, recording the change in the
+    * inventory ledger.
+    * \param prop the property to notify with, if \b notify is true
+    */
+   void setInventory(BeerXMLElement* ing, QVariant const& value, QMetaProperty prop, bool notify = true);
+   /*!
+    * \brief Reduce the inventory by the ingredients used in each of \b recs.
+    *
+    * A recipe appearing N times in \b recs is reduced N times. All of the
+    * balances and ledger entries are written in a single transaction, and
+    * each affected ingredient is notified once. Balances never drop below 0.
+    */
+   void reduceInventory(QList<Recipe*> const& recs);
+   
+   //! One entry of the inventory ledger.
+   struct InventoryChange
+   {
+      QDateTime when;
+      double delta;
+      double balance;
+      //! The recipe brewed, or 0 if the inventory was set by hand.
+      int recipeKey;
+      //! "set" or "brew".
+      QString reason;
+   };
+   /*!
+    * \returns the ledger entries of the inventory \b ing draws on, newest first.
+    * \param reason if not empty, only entries with this reason.
+    * \param limit the most entries to return, or 0 for all of them.
+    */
+   QList<InventoryChange> inventoryHistory(BeerXMLElement const* ing, QString const& reason = QString(), int limit = 0);
       
    //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   
    //! \brief Copies all of the mashsteps from \c oldMash to \c newMash
    void duplicateMashSteps(Mash *oldMash, Mash *newMash);
-   //! Import ingredients from BeerXML documents.
-   bool importFromXML(const QString& filename);
+   /*!
+    * Import ingredients from BeerXML documents.
+    * \param recipes if not null, gets the recipes that were imported.
+    */
+   bool importFromXML(const QString& filename, QList<Recipe*>* recipes = 0);
    
    //! Get anything by key value.
    Recipe* recipe(int key);
@@ -270,6 +342,16 @@ public:
    void remove(QList<Water*> water);
    void remove(QList<Yeast*> yeast);
    void remove(QList<BrewNote*> notes);
+   
+   /*!
+    * Mark all of \b elements deleted, with one UPDATE per table in a single
+    * transaction. The per-type deleted signals still go out for each one,
+    * followed by one \b deletedElementsSignal() for the lot. The remove()
+    * overloads all end up here.
+    */
+   void deleteElements(QList<BeerXMLElement*> const& elements);
+   //! Put all of \b elements in \b folder, with one UPDATE per table and one \b movedElementsSignal().
+   void moveToFolder(QList<BeerXMLElement*> const& elements, QString const& folder);
 
    //! Get the recipe that this \b note is part of.
    Recipe* getParentRecipe( BrewNote const* note );
@@ -280,6 +362,15 @@ public:
    void swapInstructionOrder(Instruction* in1, Instruction* in2);
    //! Insert an instruction (already in a recipe) into position \b pos.
    void insertInstruction(Instruction* in, int pos);
+   /*!
+    * \brief Replace all of \b rec's instructions with new ones made from
+    * \b preins, in order, in a single transaction.
+    *
+    * Emits Database's changed("instructions") once. It is up to the caller
+    * to tell \b rec's observers.
+    * \returns the new instructions.
+    */
+   QList<Instruction*> replaceInstructions(Recipe* rec, QVector<PreInstruction> const& preins);
    //! \brief The instruction number of an instruction.
    int instructionNumber(Instruction const* in);
    
@@ -308,6 +399,17 @@ public:
    QList<Water*> waters();
    QList<Yeast*> yeasts();
    
+   /*!
+    * Non-deleted, displayed ingredients in name order, for browsing. If
+    * \b nameContains is not empty, only those whose names contain it,
+    * ignoring case. The filtering and sorting happen in the query, so
+    * nothing is read from the elements themselves.
+    */
+   QList<Fermentable*> fermentablesByName( QString const& nameContains = QString() );
+   QList<Hop*> hopsByName( QString const& nameContains = QString() );
+   QList<Misc*> miscsByName( QString const& nameContains = QString() );
+   QList<Yeast*> yeastsByName( QString const& nameContains = QString() );
+   
    //! \b returns a list of the brew notes in a recipe.
    QList<BrewNote*> brewNotes(Recipe const* parent);
    //! Return a list of all the fermentables in a recipe.
@@ -388,6 +490,11 @@ signals:
    void newMashStepSignal(MashStep*);
    void deletedMashStepSignal(MashStep*);
    
+   //! Once per \b deleteElements(), after the per-type signals.
+   void deletedElementsSignal(QList<BeerXMLElement*> elements);
+   //! Once per \b moveToFolder(), instead of each element's changedFolder().
+   void movedElementsSignal(QList<BeerXMLElement*> elements, QString folder);
+   
 private slots:
    //! Load database from file.
    bool load();
@@ -419,11 +526,17 @@ private:
    // Each thread should have its own connection to QSqlDatabase.
    static QHash< QThread*, QString > _threadToConnection;
    static QMutex _threadToConnectionMutex;
+   static bool readOnly;
+   static QString fileNameOverride;
 
    // Instance variables.
    bool loadWasSuccessful;
    bool converted;
    bool dirty;
+   //! The changes collected since \b startBatch(), or 0 if not batching.
+   SetterCommand* batch;
+   //! Recipes to recalculate in \b finishBatch().
+   QList<Recipe*> batchRecalcs;
 
    QHash< int, BrewNote* > allBrewNotes;
    QHash< int, Equipment* > allEquipments;
@@ -438,7 +551,80 @@ private:
    QHash< int, Water* > allWaters;
    QHash< int, Yeast* > allYeasts;
    QHash<Brewtarget::DBTable,QSqlQuery> selectAll;
-   
+   // The SELECT * queries of threads other than ours, on their own connections.
+   QHash< QThread*, QHash<Brewtarget::DBTable,QSqlQuery> > threadSelectAll;
+   QMutex threadSelectAllMutex;
+   
+   // Inventory caches, keyed on ingredient table (FERMTABLE, HOPTABLE, ...).
+   //! Maps child ingredient keys to their parent keys.
+   QHash< Brewtarget::DBTable, QHash<int,int> > inventoryParents;
+   //! Maps parent ingredient keys to their inventory. Only parents with an inventory row are present.
+   QHash< Brewtarget::DBTable, QHash<int,double> > inventoryBalances;
+   
+   //! Fill the inventory caches from the children and inventory tables.
+   void populateInventory();
+   //! Fill in every recipe's \b Recipe::storedStats() with one query.
+   void populateRecipeStats();
+   //! \returns the inventory column name for \b table ("amount" or "quanta").
+   static QString inventoryColumn(Brewtarget::DBTable table);
+   //! \returns the parent key of \b key in \b table from the cache.
+   int inventoryParent(Brewtarget::DBTable table, int key) const;
+   /*!
+    * \brief Link \b child to \b parent in \b childTableName, and record in
+    * the cache that \b child's inventory is held by \b parent. Everything
+    * that writes to the children tables goes through here.
+    */
+   bool insertChildLink(QString const& childTableName, Brewtarget::DBTable table, int parent, int child);
+   //! \returns the loaded ingredient with \b key in \b table, or 0.
+   BeerXMLElement* inventoryElement(Brewtarget::DBTable table, int key) const;
+   /*!
+    * \brief Write \b balance to the inventory row of \b parent, creating the
+    * row if needed, and append a ledger entry. Does not start a transaction.
+    */
+   bool writeInventory(Brewtarget::DBTable table, int parent, double balance, double delta, int recipeKey, QString const& reason);
+
+   //! What a recipe is made of, as the relational tables say.
+   struct RecipeRelations
+   {
+      RecipeRelations() : equipment(0), mash(0), style(0) {}
+
+      int equipment;
+      int mash;
+      int style;
+      QList<BrewNote*> brewNotes;
+      QList<Fermentable*> fermentables;
+      QList<Hop*> hops;
+      //! In instruction_number order.
+      QList<Instruction*> instructions;
+      QList<Misc*> miscs;
+      QList<Water*> waters;
+      QList<Yeast*> yeasts;
+   };
+
+   /*!
+    * Relation cache, keyed on recipe key. Whatever writes a relation updates
+    * the cached entry, if there is one. A recipe without an entry is read
+    * from the database the first time it is asked for, so code that writes
+    * the tables directly only has to drop the entry.
+    */
+   QHash<int,RecipeRelations> recipeRelations;
+   //! The export threads read the cache too.
+   QMutex recipeRelationsMutex;
+
+   /*!
+    * Fill the relation cache with one query per relational table. If
+    * \b recipeKey is not 0, (re)read only that recipe. Needs \b recipeRelationsMutex.
+    */
+   void populateRecipeRelations(int recipeKey = 0);
+   //! \returns the relations of \b rec, reading them if needed. Needs \b recipeRelationsMutex.
+   RecipeRelations& relationsOf(Recipe const* rec);
+   //! Put \b ing into the cached relations of \b rec.
+   void relateToRecipe(Recipe const* rec, BeerXMLElement* ing);
+   //! Take \b ing out of the cached relations of \b rec, or of every recipe if \b rec is 0.
+   void unrelateFromRecipe(Recipe const* rec, BeerXMLElement* ing);
+   //! Re-read the instruction order of \b rec, which the triggers may have changed.
+   void reloadRecipeInstructions(int recipeKey);
+
    //! Get the right database connection for the calling thread.
    static QSqlDatabase sqlDatabase();
    
@@ -449,11 +635,13 @@ private:
       BeerXMLElement* e;
       T* et;
       
+      SqlProfiler::Timer timer("Database::populateElements");
       QSqlQuery q(sqlDatabase());
       q.setForwardOnly(true);
       QString queryString = QString("SELECT id FROM `%1`").arg(tableNames[table]);
       q.prepare( queryString );
       q.exec();
+      timer.stop(q);
       
       while( q.next() )
       {
@@ -475,6 +663,7 @@ private:
    template <class T> void getElements( QList<T*>& list, QString filter, Brewtarget::DBTable table, QHash<int,T*> allElements )
    {
       int key;
+      SqlProfiler::Timer timer("Database::getElements");
       QSqlQuery q(sqlDatabase());
       q.setForwardOnly(true);
       QString queryString;
@@ -484,6 +673,7 @@ private:
          queryString = QString("SELECT id FROM `%1`").arg(tableNames[table]);
       q.prepare( queryString );
       q.exec();
+      timer.stop(q);
       
       while( q.next() )
       {
@@ -543,8 +733,22 @@ private:
     */
    int insertNewMashStepRecord( Mash* parent );
    
-   //! Mark the \b object in \b table as deleted.
-   void deleteRecord( Brewtarget::DBTable table, BeerXMLElement* object );
+   /*!
+    * Run "UPDATE t SET \b setClause WHERE id IN (...)" once for each table
+    * in \b elements, all in one transaction. \b value is bound to :value.
+    * \returns false, having rolled back, if any statement failed.
+    */
+   bool bulkUpdate( QList<BeerXMLElement*> const& elements, QString const& setClause, QVariant const& value );
+   //! Emit \b changed() for the Database property that lists \b table.
+   void emitTableChanged( Brewtarget::DBTable table );
+   
+   template<class T> static QList<BeerXMLElement*> toElements( QList<T*> const& list )
+   {
+      QList<BeerXMLElement*> ret;
+      foreach( T* t, list )
+         ret.append(t);
+      return ret;
+   }
    
    // TODO: encapsulate this in a QUndoCommand.
    /*!
@@ -581,11 +785,13 @@ private:
          return 0;
       
       // Ensure this ingredient is not already in the recipe.
+      SqlProfiler::Timer timer("Database::addIngredientToRecipe");
       QSqlQuery q(
                    QString("SELECT recipe_id from `%1` WHERE `%2`='%3' AND recipe_id='%4'")
                    .arg(relTableName).arg(ingKeyName).arg(ing->_key).arg(reinterpret_cast<BeerXMLElement*>(rec)->_key),
                    sqlDatabase()
                  );
+      timer.stop(q);
       if( q.next() )
       {
          q.finish();
@@ -617,9 +823,13 @@ private:
                );
       q.bindValue(":ingredient", newIng->key());
       q.bindValue(":recipe", rec->_key);
-      if( q.exec() )
+      SqlProfiler::Timer relTimer("Database::addIngredientToRecipe");
+      bool inserted = q.exec();
+      relTimer.stop(q);
+      if( inserted )
       {
          q.finish();
+         relateToRecipe( rec, newIng );
          emit rec->changed( rec->metaProperty(propName), QVariant() );
       }
       else
@@ -630,26 +840,19 @@ private:
      
      //Put this in the <ing_type>_children table.
      if(childTableName != "instruction_children"){
-       q.prepare( QString("INSERT INTO `%1` (`parent_id`, `child_id`) VALUES (:parent, :child)")
-               .arg(childTableName)
-              );
-       q.bindValue(":parent", ing->key());
-       q.bindValue(":child", newIng->key());
-       if( q.exec() )
-       {
-         q.finish();
+       if( insertChildLink( childTableName, classNameToTable[T::staticMetaObject.className()], ing->key(), newIng->key() ) )
          emit rec->changed( rec->metaProperty(propName), QVariant() );
-       }
-       else
-       {
-         q.finish();
-         Brewtarget::logW( QString("Database::addIngredientToRecipe: %1.").arg(q.lastError().text()) );
-       }
      }
       dirty = true; 
       return newIng;
    }
    
+   /*!
+    * \brief Leave recalculating \c rec to \b finishBatch(), if batching.
+    * \returns false if not batching, so the caller should recalculate now.
+    */
+   bool deferRecalc( Recipe* rec );
+
    //! Remove ingredient from a recipe.
    void removeIngredientFromRecipe( Recipe* rec, BeerXMLElement* ing, QString propName, QString relTableName, QString ingKeyName );
    
@@ -673,9 +876,11 @@ private:
       Brewtarget::DBTable t = classNameToTable[object->metaObject()->className()];
       QString tName = tableNames[t];
       
+      SqlProfiler::Timer timer("Database::copy");
       QSqlQuery q(QString("SELECT * FROM %1 WHERE id = %2").arg(tName).arg(object->_key),
                   sqlDatabase()
                  );
+      timer.stop(q);
       
       if( !q.next() )
       {
@@ -701,10 +906,12 @@ private:
       prepString.chop(1);
       // Create a new row.
       newKey = insertNewDefaultRecord(t);
+      SqlProfiler::Timer newTimer("Database::copy");
       q = QSqlQuery( QString("SELECT * FROM %1 WHERE id = %2")
                      .arg(tName).arg(newKey),
                      sqlDatabase()
                    );
+      newTimer.stop(q);
       q.next();
       QSqlRecord newRecord = q.record();
       q.finish();
@@ -731,7 +938,9 @@ private:
             q.bindValue(QString(":%1").arg(name), val);
       }
 
+      SqlProfiler::Timer updateTimer("Database::copy");
       q.exec();
+      updateTimer.stop(q);
       q.finish();
       
       // Update the hash if need be.
@@ -759,7 +968,10 @@ private:
 
    // Cleans up the backup database if it was leftover from an error.
    bool cleanupBackupDatabase();
-   
+
+   //! \returns the SELECT * query of \c table on the calling thread's connection.
+   QSqlQuery& selectAllQuery( Brewtarget::DBTable table );
+
    static QList<TableParams> makeTableParams();
    
    // Returns true if the schema gets updated, false otherwise.
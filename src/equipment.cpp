@@ -458,7 +458,7 @@ double Equipment::boilTime_min() const          { return get("boil_time").toDoub
 double Equipment::lauterDeadspace_l() const     { return get("lauter_deadspace").toDouble(); }
 double Equipment::topUpKettle_l() const         { return get("top_up_kettle").toDouble(); }
 double Equipment::hopUtilization_pct() const    { return get("hop_utilization").toDouble(); }
-double Equipment::grainAbsorption_LKg()         { return get("absorption").toDouble(); }
+double Equipment::grainAbsorption_LKg() const   { return get("absorption").toDouble(); }
 double Equipment::boilingPoint_c() const        { return get("boiling_point").toDouble(); }
 
 void Equipment::doCalculations()
@@ -472,7 +472,21 @@ void Equipment::doCalculations()
 
 double Equipment::wortEndOfBoil_l( double kettleWort_l ) const
 {
-   //return kettleWort_l * (1 - (boilTime_min/(double)60) * (evapRate_pctHr/(double)100) );
+   return BrewCalc::wortEndOfBoil_l( calcInput(), kettleWort_l );
+}
 
-   return kettleWort_l - (boilTime_min()/(double)60)*evapRate_lHr();
+BrewCalc::Equipment Equipment::calcInput() const
+{
+   BrewCalc::Equipment ret;
+
+   ret.boilTime_min = boilTime_min();
+   ret.evapRate_lHr = evapRate_lHr();
+   ret.lauterDeadspace_l = lauterDeadspace_l();
+   ret.topUpKettle_l = topUpKettle_l();
+   ret.topUpWater_l = topUpWater_l();
+   ret.trubChillerLoss_l = trubChillerLoss_l();
+   ret.grainAbsorption_LKg = grainAbsorption_LKg();
+   ret.hopUtilization_pct = hopUtilization_pct();
+
+   return ret;
 }
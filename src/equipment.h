@@ -24,6 +24,7 @@
 
 #include <QDomNode>
 #include "BeerXMLElement.h"
+#include "BrewCalc.h"
 
 /*!
  * \class Equipment
@@ -114,11 +115,13 @@ public:
    double topUpKettle_l() const;
    double hopUtilization_pct() const;
    QString notes() const;
-   double grainAbsorption_LKg();
+   double grainAbsorption_LKg() const;
    double boilingPoint_c() const;
 
    //! \brief Calculate how much wort is left immediately at knockout.
    double wortEndOfBoil_l( double kettleWort_l ) const;
+   //! \brief What \c BrewCalc needs to know about us.
+   BrewCalc::Equipment calcInput() const;
 
 signals:
    
@@ -302,13 +302,23 @@ bool Fermentable::isSugar() { return (type() == Sugar); }
 
 double Fermentable::equivSucrose_kg() const
 {
-   double ret = amount_kg() * yield_pct() * (1.0-moisture_pct()/100.0) / 100.0;
-   
-   // If this is a steeped grain...
-   if( type() == Grain && !isMashed() )
-      return 0.60 * ret; // Reduce the yield by 60%.
-   else
-      return ret;
+   return BrewCalc::equivSucrose_kg( calcInput() );
+}
+
+BrewCalc::Fermentable Fermentable::calcInput() const
+{
+   BrewCalc::Fermentable ret;
+
+   ret.type = static_cast<BrewCalc::Fermentable::Type>(type());
+   ret.amount_kg = amount_kg();
+   ret.yield_pct = yield_pct();
+   ret.moisture_pct = moisture_pct();
+   ret.color_srm = color_srm();
+   ret.ibuGalPerLb = ibuGalPerLb();
+   ret.isMashed = isMashed();
+   ret.addAfterBoil = addAfterBoil();
+
+   return ret;
 }
 
 // disabled per-cell work
@@ -27,6 +27,7 @@
 #include <QStringList>
 #include <QString>
 #include "BeerXMLElement.h"
+#include "BrewCalc.h"
 #include "unit.h"
 
 // Forward declarations.
@@ -146,6 +147,8 @@ public:
 
    // Calculated getters.
    double equivSucrose_kg() const;
+   //! \brief What \c BrewCalc needs to know about us.
+   BrewCalc::Fermentable calcInput() const;
 
    void setName( const QString& str );
    void setType( Type t );
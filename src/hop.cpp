@@ -305,6 +305,19 @@ double Hop::caryophyllene_pct()  const { return get("caryophyllene").toDouble();
 double Hop::cohumulone_pct()     const { return get("cohumulone").toDouble(); }
 double Hop::myrcene_pct()        const { return get("myrcene").toDouble(); }
 
+BrewCalc::Hop Hop::calcInput() const
+{
+   BrewCalc::Hop ret;
+
+   ret.alpha_pct = alpha_pct();
+   ret.amount_kg = amount_kg();
+   ret.time_min = time_min();
+   ret.use = static_cast<BrewCalc::Hop::Use>(use());
+   ret.form = static_cast<BrewCalc::Hop::Form>(form());
+
+   return ret;
+}
+
 // inventory still must be handled separately, and I'm still annoyed.
 double Hop::inventory() const
 {
@@ -26,6 +26,7 @@
 #include <QString>
 #include <QStringList>
 #include "BeerXMLElement.h"
+#include "BrewCalc.h"
 
 // Forward declarations.
 class Hop;
@@ -117,6 +118,9 @@ public:
    double caryophyllene_pct() const;
    double cohumulone_pct() const;
    double myrcene_pct() const;
+
+   //! \brief What \c BrewCalc needs to know about us.
+   BrewCalc::Hop calcInput() const;
    
    //set
    void setName( const QString& str );
@@ -24,13 +24,39 @@
 #include "config.h"
 #include "brewtarget.h"
 #include "database.h"
+#include "DatabaseGenerator.h"
+#include "SqlProfiler.h"
+#include "StartupTrace.h"
 
 void importFromXml(const QString & optionValue);
 void createBlankDb(const QString & optionValue);
+void exportRecipes(const QString & dir, const QString & format, const QStringList & names, const QString & threads);
+void calcRecipes(const QStringList & inputs);
+void generateDb(const QString & file, const QCommandLineParser & parser);
 
 int main(int argc, char **argv)
 {  
+   // Tracing has to start before anything worth tracing.
+   if( !qgetenv("BREWTARGET_TRACE").isEmpty() )
+      StartupTrace::start(QString::fromLocal8Bit(qgetenv("BREWTARGET_TRACE")));
+
+   // The headless modes must work without a display, e.g. from cron.
+   for( int i = 1; i < argc; ++i )
+   {
+      if( qstrcmp(argv[i], "--trace-startup") == 0 && i+1 < argc )
+         StartupTrace::start(QString::fromLocal8Bit(argv[i+1]));
+      else if( qstrncmp(argv[i], "--trace-startup=", 16) == 0 )
+         StartupTrace::start(QString::fromLocal8Bit(argv[i] + 16));
+
+      bool headless = qstrncmp(argv[i], "--export", 8) == 0 || qstrcmp(argv[i], "--calc") == 0
+                      || qstrncmp(argv[i], "--generate", 10) == 0;
+      if( headless && qgetenv("QT_QPA_PLATFORM").isEmpty() )
+         qputenv("QT_QPA_PLATFORM", "offscreen");
+   }
+
+   StartupTrace::Scope appScope("QApplication");
    QApplication app(argc, argv);
+   appScope.end();
    app.setOrganizationName("brewtarget");
    app.setApplicationName("brewtarget");
    app.setApplicationVersion(VERSIONSTRING);
@@ -41,14 +67,59 @@ int main(int argc, char **argv)
 
    const QCommandLineOption importFromXmlOption("from-xml", "Imports DB from XML", "file");
    const QCommandLineOption createBlankDBOption("create-blank", "Creates a blank DB", "file");
+   const QCommandLineOption exportOption("export", "Formats recipes into files in dir without starting the GUI", "dir");
+   const QCommandLineOption exportFormatOption("export-format", "Format for --export: html, text or bbcode", "format", "html");
+   const QCommandLineOption exportRecipeOption("export-recipe", "Recipe for --export; may be repeated. Default is all recipes", "name");
+   const QCommandLineOption exportThreadsOption("export-threads", "Threads writing files for --export. Default is one per core", "count", "0");
+   const QCommandLineOption calcOption("calc", "Prints the calculated statistics of the given recipes as JSON lines without starting the GUI");
+   const QCommandLineOption sqlProfileOption("sql-profile", "Logs query counts and latencies by call site at exit, and every query slower than ms", "ms");
+   const QCommandLineOption traceOption("trace-startup", "Writes how long each part of startup takes to file, for chrome://tracing. So does setting BREWTARGET_TRACE", "file");
+   const QCommandLineOption generateOption("generate-db", "Creates a DB filled with made-up recipes, for scaling tests", "file");
+   const QCommandLineOption generateRecipesOption("generate-recipes", "Recipes for --generate-db", "count", "1000");
+   const QCommandLineOption generateIngredientsOption("generate-ingredients", "Fermentables, hops, miscs and yeasts of each kind for --generate-db. Default scales with the recipes", "count", "0");
+   const QCommandLineOption generateMashesOption("generate-mashes", "Mash profiles for --generate-db", "count", "5");
+   const QCommandLineOption generateBrewNotesOption("generate-brewnotes", "Brew notes for --generate-db. Default is one for every other recipe", "count", "-1");
+   const QCommandLineOption generateFoldersOption("generate-folders", "Recipe folders for --generate-db", "count", "10");
+   const QCommandLineOption generateInventoryOption("generate-inventory", "Percent of ingredients in inventory for --generate-db", "percent", "50");
+   const QCommandLineOption generateSeedOption("generate-seed", "Random seed for --generate-db. The same seed gives the same DB", "seed", "1");
 
    parser.addOption(importFromXmlOption);
    parser.addOption(createBlankDBOption);
+   parser.addOption(exportOption);
+   parser.addOption(exportFormatOption);
+   parser.addOption(exportRecipeOption);
+   parser.addOption(exportThreadsOption);
+   parser.addOption(calcOption);
+   parser.addOption(sqlProfileOption);
+   parser.addOption(traceOption);
+   parser.addOption(generateOption);
+   parser.addOption(generateRecipesOption);
+   parser.addOption(generateIngredientsOption);
+   parser.addOption(generateMashesOption);
+   parser.addOption(generateBrewNotesOption);
+   parser.addOption(generateFoldersOption);
+   parser.addOption(generateInventoryOption);
+   parser.addOption(generateSeedOption);
+   parser.addPositionalArgument("inputs", "With --calc: BeerXML files or database recipe ids", "[inputs...]");
 
    parser.process(app);
 
+   // Before anything touches the database, so every query counts.
+   if (parser.isSet(sqlProfileOption))
+   {
+      SqlProfiler::setEnabled(true);
+      SqlProfiler::setSlowQuery_ms(parser.value(sqlProfileOption).toInt());
+   }
+
    if (parser.isSet(importFromXmlOption)) importFromXml(parser.value(importFromXmlOption));
    if (parser.isSet(createBlankDBOption)) createBlankDb(parser.value(createBlankDBOption));
+   if (parser.isSet(exportOption))
+      exportRecipes(parser.value(exportOption),
+                    parser.value(exportFormatOption),
+                    parser.values(exportRecipeOption),
+                    parser.value(exportThreadsOption));
+   if (parser.isSet(calcOption)) calcRecipes(parser.positionalArguments());
+   if (parser.isSet(generateOption)) generateDb(parser.value(generateOption), parser);
    
    return Brewtarget::run();
 }
@@ -66,3 +137,22 @@ void createBlankDb(const QString & optionValue) {
     Database::createBlank(optionValue);
     exit(0);
 }
+
+void exportRecipes(const QString & dir, const QString & format, const QStringList & names, const QString & threads) {
+    exit(Brewtarget::exportRecipes(dir, format, names, threads.toInt()));
+}
+
+void calcRecipes(const QStringList & inputs) {
+    exit(Brewtarget::calcRecipes(inputs));
+}
+
+void generateDb(const QString & file, const QCommandLineParser & parser) {
+    DatabaseGenerator generator(parser.value("generate-recipes").toInt(),
+                                parser.value("generate-seed").toUInt());
+    generator.setIngredients(parser.value("generate-ingredients").toInt());
+    generator.setMashes(parser.value("generate-mashes").toInt());
+    generator.setBrewNotes(parser.value("generate-brewnotes").toInt());
+    generator.setFolders(parser.value("generate-folders").toInt());
+    generator.setInventory_pct(parser.value("generate-inventory").toDouble());
+    exit(generator.generate(file) ? 0 : 1);
+}
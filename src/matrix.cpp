@@ -1,6 +1,6 @@
 /*
  * matrix.cpp is part of Brewtarget, and is Copyright the following
- * authors 2009-2014
+ * authors 2009-2015
  * - Philip Greggory Lee <rocketman768@gmail.com>
  *
  * Brewtarget is free software: you can redistribute it and/or modify
@@ -18,115 +18,86 @@
  */
 
 #include <iostream>
-#include <QVector>
+#include <vector>
+#include <algorithm>
 #include <cmath>
 #include "matrix.h"
 
-Matrix::~Matrix()
-{
-   delete [] _data;
-}
+//======================Class: Matrix=============================
 
 Matrix::Matrix( unsigned int rows, unsigned int cols )
+   : _rows(rows),
+     _cols(cols),
+     _data(rows*cols, 0.0)
 {
-   _rows = rows;
-   _cols = cols;
-   _data = new double[ rows * cols ];
 }
 
-Matrix::Matrix( const QVector<Matrix> &colVec )
+Matrix::Matrix( const std::vector<Matrix> &colVec )
+   : _rows(0),
+     _cols(colVec.size())
 {
    unsigned int i, j;
-   
-   _cols = colVec.size();
+
    if( _cols == 0 )
-   {
-      _rows = 0;
       return;
-   }
-   
-   _rows =  colVec[0]._rows;
-   
-   _data = new double[ _cols * _rows ];
-   
-   for( j = 0; static_cast<int>(j) < colVec.size(); ++j )
+
+   _rows = colVec[0]._rows;
+   _data.resize( _rows * _cols );
+
+   for( j = 0; j < _cols; ++j )
    {
       if( colVec[j]._rows != _rows )
       {
          std::cerr << "Matrix: dimension error in initialization\n";
          throw DimensionException( colVec[j]._rows, 0, true, false );
       }
-      
+
       for( i = 0; i < _rows; ++i )
-         setVal( i, j, colVec[j].getVal(i, 0) );
+         _data[ _cols*i + j ] = colVec[j].getVal(i, 0);
    }
 }
 
 Matrix::Matrix( const Matrix &m, unsigned int colStart, unsigned int colEnd )
+   : _rows(m._rows),
+     _cols(0)
 {
-   unsigned int i, j, k;
-   
-   _rows = m._rows;
-   _cols = colEnd - colStart + 1;
-   _data = new double[ _rows * _cols ];
-   
-   for( i = 0; i < _rows; ++i )
-      for( j=0, k=colStart; k <= colEnd; ++j,++k )
-         setVal( i, j, m.getVal(i, k) );
-}
+   unsigned int i, j;
 
-Matrix::Matrix( const Matrix &rhs )
-{
-   _rows = rhs._rows;
-   _cols = rhs._cols;
-   
-   unsigned int numElts = _rows*_cols;
-   unsigned int i;
-   
-   _data = new double[ _rows*_cols ];
-   for( i = 0; i < numElts; ++i )
-      _data[i] = rhs._data[i];
-}
+   if( colStart > colEnd || colEnd >= m._cols )
+   {
+      std::cerr << "Matrix: dimension error in initialization\n";
+      throw DimensionException( 0, m._cols, false, true );
+   }
 
-Matrix& Matrix::operator=( const Matrix &rhs )
-{
-   if( this == &rhs )
-      return *this;
-      
-   _rows = rhs._rows;
-   _cols = rhs._cols;
-   
-   unsigned int numElts = _rows*_cols;
-   unsigned int i;
-   
-   if( ! _data )
-      delete [] _data;
-   _data = new double[ _rows*_cols ];
-   for( i = 0; i < numElts; ++i )
-      _data[i] = rhs._data[i];
-      
-   return *this;
+   _cols = colEnd - colStart + 1;
+   _data.resize( _rows * _cols );
+
+   for( i = 0; i < _rows; ++i )
+   {
+      double const* src = m.row(i) + colStart;
+      double* dst = row(i);
+      for( j = 0; j < _cols; ++j )
+         dst[j] = src[j];
+   }
 }
 
 std::ostream& operator<<( std::ostream &os, const Matrix &rhs )
 {
    unsigned int i;
    unsigned int j;
-   double *ptr = rhs._data;
-   
+
    for( i = 0; i < rhs._rows; ++i )
    {
       os << "[ ";
-      for( j = 0; j < rhs._cols - 1; ++j )
+      for( j = 0; j < rhs._cols; ++j )
       {
-         os << *ptr << ", ";
-         ptr++;
+         os << rhs._data[ rhs._cols*i + j ];
+         if( j+1 < rhs._cols )
+            os << ", ";
       }
-      
-      os << *ptr << "]\n";
-      ptr++;
+      os << "]\n";
    }
-   
+
    return os;
 }
 
@@ -134,16 +105,16 @@ Matrix& Matrix::operator+=( const Matrix &rhs )
 {
    unsigned int numElts = _rows * _cols;
    unsigned int i;
-   
+
    if( !(_rows == rhs._rows && _cols == rhs._cols) )
    {
       std::cerr << "Matrix: dimension error with +=\n";
       throw DimensionException( rhs._rows, rhs._cols, true, true);
    }
-   
+
    for( i = 0; i < numElts; ++i )
       _data[i] += rhs._data[i];
-      
+
    return *this;
 }
 
@@ -151,44 +122,51 @@ Matrix& Matrix::operator-=( const Matrix &rhs )
 {
    unsigned int numElts = _rows * _cols;
    unsigned int i;
-   
+
    if( !(_rows == rhs._rows && _cols == rhs._cols) )
    {
       std::cerr << "Matrix: dimension error with -=\n";
       throw DimensionException( rhs._rows, rhs._cols, true, true);
    }
-   
+
    for( i = 0; i < numElts; ++i )
       _data[i] -= rhs._data[i];
-      
+
    return *this;
 }
 
 const Matrix Matrix::operator*( const Matrix &rhs ) const
 {
    unsigned int i, j, k;
-   double tmp;
-   
+
    if( rhs._rows != _cols )
    {
       std::cerr << "Matrix: dimension error with *\n";
       throw DimensionException( rhs._rows, 0, true, false );
    }
-   
+
    Matrix ret( _rows, rhs._cols );
-   
-   for( i = 0; i < ret._rows; ++i )
+   if( _cols == 0 || rhs._cols == 0 )
+      return ret;
+
+   // i-k-j order, so the inner loop runs along a row of rhs and of ret
+   // instead of down a column.
+   for( i = 0; i < _rows; ++i )
    {
-      for( j = 0; j < ret._cols; ++j )
+      double const* a = row(i);
+      double* r = ret.row(i);
+      for( k = 0; k < _cols; ++k )
       {
-         tmp = 0.0;
-         for( k = 0; k < _cols; ++k )
-            tmp += getVal( i, k ) * rhs.getVal( k, j );
-            
-         ret.setVal( i, j, tmp );
+         double aik = a[k];
+         double const* b = rhs.row(k);
+
+         if( aik == 0.0 )
+            continue;
+         for( j = 0; j < rhs._cols; ++j )
+            r[j] += aik * b[j];
       }
    }
-   
+
    return ret;
 }
 
@@ -206,117 +184,105 @@ const Matrix Matrix::operator-( const Matrix &other ) const
    return result;
 }
 
+Matrix Matrix::transpose() const
+{
+   unsigned int i, j;
+   Matrix ret( _cols, _rows );
+
+   for( i = 0; i < _rows; ++i )
+      for( j = 0; j < _cols; ++j )
+         ret._data[ _rows*j + i ] = _data[ _cols*i + j ];
+
+   return ret;
+}
+
 Matrix Matrix::getRow( unsigned int row ) const
 {
-   unsigned int i;
-   
    if( row >= _rows )
    {
       std::cerr << "Matrix: dimension error in getRow()\n";
       throw DimensionException( _rows, 0, true, false );
    }
-   
+
    Matrix ret( 1, _cols );
-   
-   for( i = 0; i < _cols; ++i )
-      ret.setVal( 0, i, getVal( row, i) );
-      
+   std::copy( _data.begin() + _cols*row, _data.begin() + _cols*(row+1), ret._data.begin() );
+
    return ret;
 }
 
 Matrix Matrix::getCol( unsigned int col ) const
 {
    unsigned int i;
-   
+
    if( col >= _cols )
    {
       std::cerr << "Matrix: dimension error in getCol()\n";
       throw DimensionException( 0, _cols, false, true );
    }
-   
+
    Matrix ret( _rows, 1 );
-   
+
    for( i = 0; i < _rows; ++i )
-      ret.setVal( i, 0, getVal(i, col) );
-   
-   return ret;
-}
+      ret._data[i] = _data[ _cols*i + col ];
 
-inline double Matrix::getVal( unsigned int row, unsigned int col ) const
-{
-   if( _cols*row + col < _rows*_cols )
-      return _data[ _cols*row + col ];
-   else
-   {
-      std::cerr << "Matrix: invalid access at _data[" << row << "][" << col << "]\n";
-      throw DimensionException( _rows, _cols, true, true );
-   }
+   return ret;
 }
 
-inline void Matrix::setVal( unsigned int row, unsigned int col, double val )
+void Matrix::throwBadAccess( unsigned int row, unsigned int col ) const
 {
-   if( _cols*row + col < _rows*_cols )
-      _data[ _cols*row + col ] = val;
-   else
-   {
-      std::cerr << "Matrix: invalid access at _data[" << row << "][" << col << "]\n";
-      throw DimensionException( _rows, _cols, true, true );
-   }
-
-   return;
+   std::cerr << "Matrix: invalid access at _data[" << row << "][" << col << "]\n";
+   throw DimensionException( _rows, _cols, true, true );
 }
 
 void Matrix::swapRows( unsigned int row1, unsigned int row2 )
 {
    unsigned int j;
-   double tmp;
-   
+
    if( row1 >= _rows || row2 >= _rows )
    {
       std::cerr << "Matrix: swapRows(): can't swap row " << row1 << " and row " << row2;
       throw DimensionException( _rows, 0, true, false );
    }
-   
+
+   if( row1 == row2 )
+      return;
+
+   double* r1 = row(row1);
+   double* r2 = row(row2);
    for( j = 0; j < _cols; ++j )
-   {
-      tmp = getVal( row1, j );
-      setVal( row1, j, getVal( row2, j ) );
-      setVal( row2, j, tmp );
-   }
+      std::swap( r1[j], r2[j] );
 }
 
 void Matrix::rref()
 {
-   unsigned int i,j,k,l,m;
+   unsigned int i,j,k,l;
    double pivot, mult;
 
-   k = 0;
-   for( i = 0; i < _rows && k < _cols; ++i )
+   i = 0;
+   for( k = 0; i < _rows && k < _cols; ++k )
    {
       // If this row's kth column is zero...
-      if( qAbs( getVal( i, k ) ) < EPSILON )
+      if( std::fabs( row(i)[k] ) < EPSILON )
       {
          // Search for nonzero entry in this column (after the ith row).
          for( l = i+1; l < _rows; ++l )
-            if( qAbs( getVal( l, k ) ) >= EPSILON )
+            if( std::fabs( row(l)[k] ) >= EPSILON )
                break;
 
-         // Make sure we didn't fall off the edge
+         // Make sure we didn't fall off the edge. If so, give up on this
+         // k and try the next one on the same row.
          if( l == _rows )
-         {
-            ++k; // Give up on this k and try the next one.
-            --i; // Need to subtract so next iteration continues on this row.
             continue;
-         }
 
          // Otherwise, swap rows.
          swapRows( i, l );
       }
 
       // Normalize the row so that a[i][k] = 1.
-      pivot = getVal( i, k );
+      double* ri = row(i);
+      pivot = ri[k];
       for( j = k; j < _cols; ++j )
-         setVal( i, j, getVal(i, j) / pivot );
+         ri[j] /= pivot;
 
       // Search for rows to add to.
       for( l = 0; l < _rows; ++l )
@@ -325,15 +291,16 @@ void Matrix::rref()
          if( l == i )
             continue;
 
-         if( qAbs( getVal( l, k ) ) >= EPSILON )
+         double* rl = row(l);
+         if( std::fabs( rl[k] ) >= EPSILON )
          {
-            mult = getVal(l,k);
-            for( m = 0; m < _cols; ++m )
-               setVal( l, m, getVal(l,m) - mult*getVal(i,m) );
+            mult = rl[k];
+            for( j = k; j < _cols; ++j )
+               rl[j] -= mult*ri[j];
          }
       }
 
-      ++k;
+      ++i;
    }
 }
 
@@ -342,103 +309,92 @@ void Matrix::rref()
 bool Matrix::hasNonZeroDiags() const
 {
    unsigned int i;
-   bool ret = true;
-   
-   for( i = 0; i < _rows && i < _cols; ++i )
-      ret = ret & ( qAbs(getVal(i,i)) >= EPSILON );
-      
-   return ret;
-}
 
-unsigned int Matrix::getRows() const
-{
-   return _rows;
-}
+   for( i = 0; i < _rows && i < _cols; ++i )
+      if( std::fabs( _data[ _cols*i + i ] ) < EPSILON )
+         return false;
 
-unsigned int Matrix::getCols() const
-{
-   return _cols;
+   return true;
 }
 
-void Matrix::setRow( unsigned int row, QVector<double> vec )
+void Matrix::setRow( unsigned int row, const std::vector<double> &vec )
 {
-   unsigned int j;
-   
-   if( vec.size() != static_cast<int>(_cols) )
+   if( vec.size() != _cols || row >= _rows )
    {
       std::cerr << "Matrix: setRow(): dimension error\n";
       throw DimensionException( 0, _cols, false, true );
    }
-   
-   for( j = 0; j < _cols; ++j )
-      setVal( row, j, vec[j] );
+
+   std::copy( vec.begin(), vec.end(), _data.begin() + _cols*row );
 }
 
-void Matrix::setCol( unsigned int col, QVector<double> vec )
+void Matrix::setCol( unsigned int col, const std::vector<double> &vec )
 {
    unsigned int i;
-   
-   if( vec.size() != static_cast<int>(_rows) )
+
+   if( vec.size() != _rows || col >= _cols )
    {
       std::cerr << "Matrix: setCol(): dimension error\n";
       throw DimensionException( _rows, 0, true, false );
    }
-   
+
    for( i = 0; i < _rows; ++i )
-      setVal( i, col, vec[i] );
+      _data[ _cols*i + col ] = vec[i];
+}
+
+double Matrix::norm() const
+{
+   double ret = 0.0;
+   unsigned int i;
+
+   for( i = 0; i < _data.size(); ++i )
+      ret += _data[i]*_data[i];
+
+   return std::sqrt(ret);
 }
 
 bool Matrix::hasInverse() const
 {
    if( _rows != _cols )
       return false;
-      
-   Matrix m( *this );
-   m.rref();
-   return m.hasNonZeroDiags();
+
+   return ! LUDecomposition(*this).isSingular();
 }
 
 Matrix Matrix::getIdentity( unsigned int n )
 {
    unsigned int i;
    Matrix m( n, n );
-   
+
    for( i = 0; i < n; ++i )
-      m.setVal( i, i, 1.0 );
- 
+      m._data[ n*i + i ] = 1.0;
+
    return m;
 }
 
 void Matrix::appendCols( const Matrix& other )
 {
-   unsigned int i, j, k;
-   double *oldData = _data;
-   unsigned int oldCols;
-   
+   unsigned int i, j;
+   unsigned int newCols = _cols + other._cols;
+   std::vector<double> newData( _rows * newCols );
+
    if( _rows != other._rows )
    {
       std::cerr << "Matrix: appendCols(): dimension error\n";
       throw DimensionException( other._rows, 0, true, false );
    }
-   
-   _data = new double[ _rows * (_cols + other._cols) ];
-   oldCols = _cols;
-   _cols += other._cols;
-   
-   
+
    // Put in the old values, and copy in the new
    for( i = 0; i < _rows; ++i )
    {
-      // Old values
-      for( j = 0; j < oldCols; ++j )
-         setVal(i, j, oldData[oldCols*i + j]);
-      // Appended values
-      for( j = oldCols, k=0; j < _cols; ++j, ++k )
-         setVal( i, j, other.getVal(i, k) );
+      for( j = 0; j < _cols; ++j )
+         newData[ newCols*i + j ] = _data[ _cols*i + j ];
+      for( j = 0; j < other._cols; ++j )
+         newData[ newCols*i + _cols + j ] = other._data[ other._cols*i + j ];
    }
-   
-   if( ! oldData )
-      delete [] oldData;
+
+   _data.swap(newData);
+   _cols = newCols;
 }
 
 Matrix Matrix::inverse() const
@@ -448,19 +404,462 @@ Matrix Matrix::inverse() const
       std::cerr << "Matrix: inverse(): must be square";
       throw DimensionException( _rows, _cols, true, true );
    }
-   
-   Matrix m( *this );
-   
-   m.appendCols(getIdentity(_rows));
-   m.rref();
 
-   if( ! m.hasNonZeroDiags() )
+   LUDecomposition lu( *this );
+   if( lu.isSingular() )
    {
       std::cerr << "Matrix: inverse(): did not have an inverse";
       throw IncomputableException();
    }
-   
-   Matrix inv( m, _cols, m._cols - 1);
-   return inv;
+
+   return lu.solve( getIdentity(_rows) );
+}
+
+Matrix Matrix::boundedLeastSquares( const Matrix &A, const Matrix &b, const Matrix &lower, const Matrix &upper )
+{
+   unsigned int const m = A._rows;
+   unsigned int const n = A._cols;
+   unsigned int i, j, t, iter;
+   // -1 at the lower bound, 1 at the upper one, 0 free.
+   std::vector<int> state(n, 0);
+   std::vector<unsigned int> freeVars;
+   std::vector<double> w(n);
+   // Freed, but rounding sent them straight back to their bound.
+   std::vector<bool> stuck(n, false);
+   Matrix x(n, 1);
+   double tol;
+   int justFreed = -1;
+   bool needSolve = false;
+
+   if( b._rows != m || b._cols != 1 || lower._rows != n || upper._rows != n || m < n )
+   {
+      std::cerr << "Matrix: boundedLeastSquares(): dimension error\n";
+      throw DimensionException( b._rows, b._cols, true, true );
+   }
+
+   // Start every variable that has a bound on it.
+   for( j = 0; j < n; ++j )
+   {
+      double lo = lower._data[j];
+      double hi = upper._data[j];
+
+      if( lo > hi )
+         throw IncomputableException();
+
+      if( lo > -HUGE_VAL )
+      {
+         x._data[j] = lo;
+         state[j] = -1;
+      }
+      else if( hi < HUGE_VAL )
+      {
+         x._data[j] = hi;
+         state[j] = 1;
+      }
+      else
+         needSolve = true;
+   }
+
+   // The gradient scales with both A and b.
+   tol = 1e-12 * A.norm() * (b.norm() + 1.0);
+
+   for( iter = 0; iter < 10*n + 10; ++iter )
+   {
+      if( !needSolve )
+      {
+         // w = A^T (b - A x) points downhill. Free the bound variable that
+         // most wants to move off its bound, or stop if none does.
+         int best = -1;
+         double bestW = tol;
+
+         std::fill( w.begin(), w.end(), 0.0 );
+         for( i = 0; i < m; ++i )
+         {
+            double const* a = A.row(i);
+            double r = b._data[i];
+            for( j = 0; j < n; ++j )
+               r -= a[j] * x._data[j];
+            for( j = 0; j < n; ++j )
+               w[j] += a[j] * r;
+         }
+
+         for( j = 0; j < n; ++j )
+         {
+            double wj = (state[j] == -1) ? w[j] : -w[j];
+            if( state[j] != 0 && !stuck[j] && lower._data[j] < upper._data[j] && wj > bestW )
+            {
+               best = j;
+               bestW = wj;
+            }
+         }
+
+         if( best < 0 )
+            break;
+
+         state[best] = 0;
+         justFreed = best;
+      }
+      needSolve = false;
+
+      // Solve for the free variables, with the bound ones moved over to b.
+      freeVars.clear();
+      for( j = 0; j < n; ++j )
+         if( state[j] == 0 )
+            freeVars.push_back(j);
+      if( freeVars.empty() )
+         continue;
+
+      Matrix Af( m, freeVars.size() );
+      Matrix bf( b );
+      for( i = 0; i < m; ++i )
+      {
+         double const* a = A.row(i);
+         double* af = Af.row(i);
+         for( j = 0; j < n; ++j )
+            if( state[j] != 0 )
+               bf._data[i] -= a[j] * x._data[j];
+         for( t = 0; t < freeVars.size(); ++t )
+            af[t] = a[freeVars[t]];
+      }
+
+      QRDecomposition qr( Af );
+      if( !qr.isFullRank() )
+      {
+         // Nothing better to be had with this one free.
+         if( justFreed < 0 )
+            break;
+         state[justFreed] = (x._data[justFreed] == upper._data[justFreed]) ? 1 : -1;
+         stuck[justFreed] = true;
+         justFreed = -1;
+         continue;
+      }
+      Matrix z = qr.solve( bf );
+
+      // Go as far toward z as the bounds let us.
+      double alpha = 1.0;
+      int hit = -1;
+      for( t = 0; t < freeVars.size(); ++t )
+      {
+         j = freeVars[t];
+         double a;
+         if( z._data[t] < lower._data[j] )
+            a = (lower._data[j] - x._data[j]) / (z._data[t] - x._data[j]);
+         else if( z._data[t] > upper._data[j] )
+            a = (upper._data[j] - x._data[j]) / (z._data[t] - x._data[j]);
+         else
+            continue;
+
+         if( a < alpha )
+         {
+            alpha = a;
+            hit = j;
+         }
+      }
+
+      // Rounding can make the one we just freed want straight back. Leave
+      // it be until something else moves, or we would free it forever.
+      if( hit >= 0 && hit == justFreed && alpha <= 0.0 )
+      {
+         state[justFreed] = (x._data[justFreed] == upper._data[justFreed]) ? 1 : -1;
+         stuck[justFreed] = true;
+         justFreed = -1;
+         continue;
+      }
+      justFreed = -1;
+      if( alpha > 0.0 )
+         std::fill( stuck.begin(), stuck.end(), false );
+
+      for( t = 0; t < freeVars.size(); ++t )
+      {
+         j = freeVars[t];
+         x._data[j] += alpha * (z._data[t] - x._data[j]);
+      }
+
+      if( hit < 0 )
+         continue;
+
+      // Whatever reached a bound gets pinned to it, and we solve again
+      // with the rest.
+      for( t = 0; t < freeVars.size(); ++t )
+      {
+         j = freeVars[t];
+         if( static_cast<int>(j) == hit || x._data[j] <= lower._data[j] || x._data[j] >= upper._data[j] )
+         {
+            if( z._data[t] < lower._data[j] || x._data[j] <= lower._data[j] )
+            {
+               x._data[j] = lower._data[j];
+               state[j] = -1;
+            }
+            else
+            {
+               x._data[j] = upper._data[j];
+               state[j] = 1;
+            }
+         }
+      }
+      needSolve = true;
+   }
+
+   return x;
+}
+
+//======================Class: LUDecomposition=============================
+
+LUDecomposition::LUDecomposition( const Matrix &a )
+   : _lu(a),
+     _perm(a.getRows()),
+     _sign(1),
+     _singular(false)
+{
+   unsigned int const n = a.getRows();
+   unsigned int i, j, k, p;
+   double maxAbs = 0.0;
+
+   if( a.getRows() != a.getCols() )
+   {
+      std::cerr << "LUDecomposition: must be square\n";
+      throw DimensionException( a.getRows(), a.getCols(), true, true );
+   }
+
+   for( i = 0; i < n; ++i )
+   {
+      _perm[i] = i;
+      for( j = 0; j < n; ++j )
+         maxAbs = std::max( maxAbs, std::fabs(_lu.row(i)[j]) );
+   }
+
+   for( k = 0; k < n; ++k )
+   {
+      // Partial pivoting: the biggest entry left in this column goes on the diagonal.
+      p = k;
+      for( i = k+1; i < n; ++i )
+         if( std::fabs(_lu.row(i)[k]) > std::fabs(_lu.row(p)[k]) )
+            p = i;
+      if( p != k )
+      {
+         _lu.swapRows( p, k );
+         std::swap( _perm[p], _perm[k] );
+         _sign = -_sign;
+      }
+
+      double const* rk = _lu.row(k);
+      if( std::fabs(rk[k]) <= 1e-12 * maxAbs || rk[k] == 0.0 )
+      {
+         _singular = true;
+         continue;
+      }
+
+      for( i = k+1; i < n; ++i )
+      {
+         double* ri = _lu.row(i);
+         double f = (ri[k] /= rk[k]);
+         if( f == 0.0 )
+            continue;
+         for( j = k+1; j < n; ++j )
+            ri[j] -= f * rk[j];
+      }
+   }
+}
+
+double LUDecomposition::determinant() const
+{
+   unsigned int i;
+   double ret = _sign;
+
+   for( i = 0; i < _lu.getRows(); ++i )
+      ret *= _lu.row(i)[i];
+
+   return ret;
+}
+
+Matrix LUDecomposition::solve( const Matrix &b ) const
+{
+   unsigned int const n = _lu.getRows();
+   unsigned int const nx = b.getCols();
+   unsigned int i, j, k;
+
+   if( b.getRows() != n )
+   {
+      std::cerr << "LUDecomposition: solve(): dimension error\n";
+      throw DimensionException( b.getRows(), 0, true, false );
+   }
+   if( _singular )
+      throw IncomputableException();
+
+   Matrix x( n, nx );
+   if( n == 0 || nx == 0 )
+      return x;
+
+   for( i = 0; i < n; ++i )
+   {
+      double const* src = b.row(_perm[i]);
+      double* dst = x.row(i);
+      for( j = 0; j < nx; ++j )
+         dst[j] = src[j];
+   }
+
+   // L y = P b, a whole row of right hand sides at a time...
+   for( i = 1; i < n; ++i )
+   {
+      double const* l = _lu.row(i);
+      double* xi = x.row(i);
+      for( k = 0; k < i; ++k )
+      {
+         double const* xk = x.row(k);
+         for( j = 0; j < nx; ++j )
+            xi[j] -= l[k] * xk[j];
+      }
+   }
+
+   // ...then U x = y.
+   for( i = n; i-- > 0; )
+   {
+      double const* u = _lu.row(i);
+      double* xi = x.row(i);
+      for( k = i+1; k < n; ++k )
+      {
+         double const* xk = x.row(k);
+         for( j = 0; j < nx; ++j )
+            xi[j] -= u[k] * xk[j];
+      }
+      for( j = 0; j < nx; ++j )
+         xi[j] /= u[i];
+   }
+
+   return x;
 }
 
+//======================Class: QRDecomposition=============================
+
+QRDecomposition::QRDecomposition( const Matrix &a )
+   : _qr(a),
+     _rDiag(a.getCols())
+{
+   unsigned int const m = a.getRows();
+   unsigned int const n = a.getCols();
+   unsigned int i, j, k;
+   std::vector<double> s(n);
+
+   if( m < n )
+   {
+      std::cerr << "QRDecomposition: needs at least as many rows as columns\n";
+      throw DimensionException( m, n, true, true );
+   }
+
+   for( k = 0; k < n; ++k )
+   {
+      double nrm = 0.0;
+
+      for( i = k; i < m; ++i )
+         nrm += _qr.row(i)[k] * _qr.row(i)[k];
+      nrm = std::sqrt(nrm);
+
+      if( nrm != 0.0 )
+      {
+         // Form the kth Householder vector in column k.
+         if( _qr.row(k)[k] < 0 )
+            nrm = -nrm;
+         for( i = k; i < m; ++i )
+            _qr.row(i)[k] /= nrm;
+         _qr.row(k)[k] += 1.0;
+
+         // Apply it to the columns to the right. The dot products for all of
+         // them are summed in one pass down the rows.
+         std::fill( s.begin() + k+1, s.end(), 0.0 );
+         for( i = k; i < m; ++i )
+         {
+            double const* r = _qr.row(i);
+            for( j = k+1; j < n; ++j )
+               s[j] += r[k] * r[j];
+         }
+         for( j = k+1; j < n; ++j )
+            s[j] = -s[j] / _qr.row(k)[k];
+         for( i = k; i < m; ++i )
+         {
+            double* r = _qr.row(i);
+            for( j = k+1; j < n; ++j )
+               r[j] += s[j] * r[k];
+         }
+      }
+      _rDiag[k] = -nrm;
+   }
+}
+
+bool QRDecomposition::isFullRank() const
+{
+   unsigned int j;
+   double maxAbs = 0.0;
+
+   for( j = 0; j < _rDiag.size(); ++j )
+      maxAbs = std::max( maxAbs, std::fabs(_rDiag[j]) );
+   for( j = 0; j < _rDiag.size(); ++j )
+      if( std::fabs(_rDiag[j]) <= 1e-12 * maxAbs || _rDiag[j] == 0.0 )
+         return false;
+
+   return true;
+}
+
+Matrix QRDecomposition::solve( const Matrix &b ) const
+{
+   unsigned int const m = _qr.getRows();
+   unsigned int const n = _qr.getCols();
+   unsigned int const nx = b.getCols();
+   unsigned int i, j, k;
+   std::vector<double> s(nx);
+
+   if( b.getRows() != m )
+   {
+      std::cerr << "QRDecomposition: solve(): dimension error\n";
+      throw DimensionException( b.getRows(), 0, true, false );
+   }
+   if( !isFullRank() )
+      throw IncomputableException();
+
+   Matrix x( b );
+   if( n == 0 || nx == 0 )
+      return Matrix( n, nx );
+
+   // Q^T b
+   for( k = 0; k < n; ++k )
+   {
+      std::fill( s.begin(), s.end(), 0.0 );
+      for( i = k; i < m; ++i )
+      {
+         double v = _qr.row(i)[k];
+         double const* xi = x.row(i);
+         for( j = 0; j < nx; ++j )
+            s[j] += v * xi[j];
+      }
+      for( j = 0; j < nx; ++j )
+         s[j] = -s[j] / _qr.row(k)[k];
+      for( i = k; i < m; ++i )
+      {
+         double v = _qr.row(i)[k];
+         double* xi = x.row(i);
+         for( j = 0; j < nx; ++j )
+            xi[j] += s[j] * v;
+      }
+   }
+
+   // R x = Q^T b
+   for( k = n; k-- > 0; )
+   {
+      double* xk = x.row(k);
+      for( j = 0; j < nx; ++j )
+         xk[j] /= _rDiag[k];
+      for( i = 0; i < k; ++i )
+      {
+         double v = _qr.row(i)[k];
+         double* xi = x.row(i);
+         for( j = 0; j < nx; ++j )
+            xi[j] -= xk[j] * v;
+      }
+   }
+
+   // Only the first n rows are the answer; the rest are the residual.
+   Matrix ret( n, nx );
+   for( i = 0; i < n; ++i )
+      std::copy( x.row(i), x.row(i) + nx, ret.row(i) );
+
+   return ret;
+}
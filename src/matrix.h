@@ -1,6 +1,6 @@
 /*
  * matrix.h is part of Brewtarget, and is Copyright the following
- * authors 2009-2014
+ * authors 2009-2015
  * - Philip Greggory Lee <rocketman768@gmail.com>
  *
  * Brewtarget is free software: you can redistribute it and/or modify
@@ -21,7 +21,7 @@
 #define _MATRIX_H
 
 #include <iostream>
-#include <QVector>
+#include <vector>
 #include <cmath>
 #include <exception>
 
@@ -29,53 +29,13 @@
 
 //======================Class Defns.=============================
 class Matrix;
+class LUDecomposition;
+class QRDecomposition;
 class DimensionException;
 class IncomputableException;
 
 std::ostream& operator<<( std::ostream &os, const Matrix &rhs );
 
-//======================Class: Matrix=============================
-class Matrix
-{
-   friend std::ostream& operator<<( std::ostream &os, const Matrix &rhs );
-
-   public:
-      ~Matrix(); // Destructor
-      Matrix( unsigned int rows, unsigned int cols ); // Constructor
-      Matrix( const QVector<Matrix> &colVec ); // Constructor
-      Matrix( const Matrix &m, unsigned int colStart, unsigned int colEnd ); // Constructor
-      Matrix( const Matrix &rhs ); // Copy constructor
-      
-      static Matrix getIdentity( unsigned int n ); // Gets n x n identity matrix.
-      
-      Matrix& operator=( const Matrix &rhs );
-      Matrix& operator+=( const Matrix &rhs );
-      Matrix& operator-=( const Matrix &rhs );
-      const Matrix operator+( const Matrix &other ) const;
-      const Matrix operator-( const Matrix &other ) const;
-      const Matrix operator*( const Matrix &rhs ) const;
-      Matrix getRow( unsigned int row ) const;
-      Matrix getCol( unsigned int col ) const;
-      unsigned int getRows() const;
-      unsigned int getCols() const;
-      inline double getVal( unsigned int row, unsigned int col ) const;
-      inline void setVal( unsigned int row, unsigned int col, double val );
-      void setRow( unsigned int row, QVector<double> vec );
-      void setCol( unsigned int col, QVector<double> vec );
-      Matrix inverse() const;
-      bool hasInverse() const;
-      
-      void rref();
-      bool hasNonZeroDiags() const;
-      void swapRows( unsigned int row1, unsigned int row2 );
-      void appendCols( const Matrix& other );
-      
-   private:
-      unsigned int _rows;
-      unsigned int _cols;
-      double *_data;
-};
-
 //======================Class: DimensionException=============================
 class DimensionException: public std::exception
 {
@@ -83,7 +43,7 @@ class DimensionException: public std::exception
    {
       return "Dimensions of argument were not expected.";
    }
-   
+
    public:
       DimensionException(unsigned int argRows, unsigned int argCols, bool rowsMatter, bool colsMatter )
       {
@@ -92,12 +52,12 @@ class DimensionException: public std::exception
          _rowsMatter = rowsMatter;
          _colsMatter = colsMatter;
       }
-      
+
       bool colsMatter(){ return _colsMatter; }
       bool rowsMatter(){ return _rowsMatter; }
       unsigned int getArgRows(){ return _argRows; }
       unsigned int getArgCols(){ return _argCols; }
-      
+
    private:
       unsigned int _argRows;
       unsigned int _argCols;
@@ -114,5 +74,140 @@ class IncomputableException: public std::exception
    }
 };
 
-#endif
+//======================Class: Matrix=============================
+/*!
+ * \class Matrix
+ * \author Philip G. Lee
+ *
+ * \brief A dense matrix of doubles, stored one row after another.
+ *
+ * New matrices are all zeros. \b getVal() and \b setVal() check their
+ * indices and throw a DimensionException; \b row() does not, and is what
+ * the loops in here use to walk each row in memory order. Vectors are
+ * matrices with one column.
+ */
+class Matrix
+{
+   friend std::ostream& operator<<( std::ostream &os, const Matrix &rhs );
+
+   public:
+      Matrix( unsigned int rows = 0, unsigned int cols = 0 ); // Constructor
+      Matrix( const std::vector<Matrix> &colVec ); // Constructor
+      Matrix( const Matrix &m, unsigned int colStart, unsigned int colEnd ); // Constructor
+
+      static Matrix getIdentity( unsigned int n ); // Gets n x n identity matrix.
+
+      Matrix& operator+=( const Matrix &rhs );
+      Matrix& operator-=( const Matrix &rhs );
+      const Matrix operator+( const Matrix &other ) const;
+      const Matrix operator-( const Matrix &other ) const;
+      const Matrix operator*( const Matrix &rhs ) const;
+      Matrix transpose() const;
+      Matrix getRow( unsigned int row ) const;
+      Matrix getCol( unsigned int col ) const;
+      unsigned int getRows() const { return _rows; }
+      unsigned int getCols() const { return _cols; }
+
+      double getVal( unsigned int row, unsigned int col ) const
+      {
+         if( row >= _rows || col >= _cols )
+            throwBadAccess( row, col );
+         return _data[ _cols*row + col ];
+      }
+
+      void setVal( unsigned int row, unsigned int col, double val )
+      {
+         if( row >= _rows || col >= _cols )
+            throwBadAccess( row, col );
+         _data[ _cols*row + col ] = val;
+      }
+
+      //! \brief Start of \c row, unchecked. Only for matrices with columns.
+      double* row( unsigned int row ) { return &_data[ _cols*row ]; }
+      double const* row( unsigned int row ) const { return &_data[ _cols*row ]; }
+
+      void setRow( unsigned int row, const std::vector<double> &vec );
+      void setCol( unsigned int col, const std::vector<double> &vec );
+      //! \brief Square root of the sum of squares of all the entries.
+      double norm() const;
+      Matrix inverse() const;
+      bool hasInverse() const;
+
+      void rref();
+      bool hasNonZeroDiags() const;
+      void swapRows( unsigned int row1, unsigned int row2 );
+      void appendCols( const Matrix& other );
+
+      /*!
+       * \brief Bounded least squares.
+       *
+       * \returns the x that minimizes |A x - b| with \c lower <= x <= \c upper,
+       * by the active set method of Stark and Parker. Each step solves the
+       * unbounded problem on the free variables with a QR decomposition.
+       * \param A m x n, where m >= n
+       * \param b m x 1
+       * \param lower n x 1. Use -HUGE_VAL for no bound.
+       * \param upper n x 1. Use HUGE_VAL for no bound.
+       */
+      static Matrix boundedLeastSquares( const Matrix &A, const Matrix &b, const Matrix &lower, const Matrix &upper );
+
+   private:
+      void throwBadAccess( unsigned int row, unsigned int col ) const;
+
+      unsigned int _rows;
+      unsigned int _cols;
+      std::vector<double> _data;
+};
+
+//======================Class: LUDecomposition=============================
+/*!
+ * \class LUDecomposition
+ * \author Philip G. Lee
+ *
+ * \brief P A = L U with partial pivoting, for solving square systems.
+ *
+ * Factor once, then \b solve() for as many right hand sides as you like.
+ */
+class LUDecomposition
+{
+   public:
+      //! \brief Factors \c a. Throws a DimensionException if it is not square.
+      LUDecomposition( const Matrix &a );
 
+      bool isSingular() const { return _singular; }
+      double determinant() const;
+      //! \returns x where A x = \c b. Throws an IncomputableException if A is singular.
+      Matrix solve( const Matrix &b ) const;
+
+   private:
+      // L below the diagonal, with its unit diagonal left out, and U on and above it.
+      Matrix _lu;
+      std::vector<unsigned int> _perm;
+      int _sign;
+      bool _singular;
+};
+
+//======================Class: QRDecomposition=============================
+/*!
+ * \class QRDecomposition
+ * \author Philip G. Lee
+ *
+ * \brief A = Q R by Householder reflections, for least squares.
+ */
+class QRDecomposition
+{
+   public:
+      //! \brief Factors \c a. Throws a DimensionException if it has more columns than rows.
+      QRDecomposition( const Matrix &a );
+
+      bool isFullRank() const;
+      //! \returns x that minimizes |A x - \c b|. Throws an IncomputableException if A is not full rank.
+      Matrix solve( const Matrix &b ) const;
+
+   private:
+      // R above the diagonal and the Householder vectors on and below it.
+      Matrix _qr;
+      std::vector<double> _rDiag;
+};
+
+#endif
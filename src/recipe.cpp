@@ -127,12 +127,15 @@ Recipe::Recipe()
      _SRMColor(255,255,0),
      _og(1.000),
      _fg(1.000),
-     _uninitializedCalcs(true)
+     _uninitializedCalcs(true),
+     _storedStatsLoaded(false)
 {
    setObjectName("Recipe"); 
 }
 
-Recipe::Recipe( Recipe const& other ) : BeerXMLElement(other)
+Recipe::Recipe( Recipe const& other )
+   : BeerXMLElement(other),
+     _storedStatsLoaded(false)
 {
    setObjectName("Recipe"); 
 }
@@ -168,15 +171,12 @@ void Recipe::insertInstruction(Instruction* ins, int pos)
    Database::instance().insertInstruction(ins,pos);
 }
 
-Instruction* Recipe::mashFermentableIns()
+void Recipe::mashFermentableIns(QVector<PreInstruction>& ins)
 {
-   Instruction* ins;
    QString str,tmp;
    int i;
 
    /*** Add grains ***/
-   ins = Database::instance().newInstruction(this);
-   ins->setName(tr("Add grains"));
    str = tr("Add ");
    QList<QString> reagents = getReagents(fermentables());
 
@@ -184,32 +184,24 @@ Instruction* Recipe::mashFermentableIns()
       str += reagents.at(i);
 
    str += tr("to the mash tun.");
-   ins->setDirections(str);
-
-   return ins;
-
+   ins.append(PreInstruction(str, tr("Add grains"), 0.0));
 }
 
-Instruction* Recipe::mashWaterIns(unsigned int size)
+void Recipe::mashWaterIns(unsigned int size, QVector<PreInstruction>& ins)
 {
-   Instruction* ins;
    QString str, tmp;
    int i;
 
    if( mash() == 0 )
-      return 0;
+      return;
    
-   ins = Database::instance().newInstruction(this);
-   ins->setName(tr("Heat water"));
    str = tr("Bring ");
    QList<QString> reagents = getReagents(mash()->mashSteps());
    for( i = 0; i < reagents.size(); ++i )
       str += reagents.at(i);
 
    str += tr("for upcoming infusions.");
-   ins->setDirections(str);
-
-   return ins;
+   ins.append(PreInstruction(str, tr("Heat water"), 0.0));
 }
 
 QVector<PreInstruction> Recipe::mashInstructions(double timeRemaining, double totalWaterAdded_l, unsigned int size)
@@ -338,9 +330,8 @@ QVector<PreInstruction> Recipe::miscSteps(Misc::Use type)
    return preins;
 }
 
-Instruction* Recipe::firstWortHopsIns()
+void Recipe::firstWortHopsIns(QVector<PreInstruction>& ins)
 {
-   Instruction* ins;
    QString str;
    QList<QString> reagents;
 
@@ -354,19 +345,14 @@ Instruction* Recipe::firstWortHopsIns()
          str += reagents.at(i);
 
       str += ".";
-      ins = Database::instance().newInstruction(this);
-      ins->setName(tr("First wort hopping"));
-      ins->setDirections(str);
-      return ins;
+      ins.append(PreInstruction(str, tr("First wort hopping"), 0.0));
    }
-   return 0;
 }
 
-Instruction* Recipe::topOffIns()
+void Recipe::topOffIns(QVector<PreInstruction>& ins)
 {
    double wortInBoil_l = 0.0;
    QString str,tmp;
-   Instruction* ins;
 
    Equipment* e = equipment();
    if( e != 0 )
@@ -383,14 +369,11 @@ Instruction* Recipe::topOffIns()
 
          str += tmp;
 
-         ins = Database::instance().newInstruction(this);
-         ins->setName(tr("Pre-boil"));
-         ins->setDirections(str);
-         ins->addReagent(tmp);
-         return ins;
+         PreInstruction pi(str, tr("Pre-boil"), 0.0);
+         pi.addReagent(tmp);
+         ins.append(pi);
       }
    }
-   return 0;
 }
 
 bool Recipe::hasBoilFermentable()
@@ -445,7 +428,7 @@ PreInstruction Recipe::boilFermentablesPre(double timeRemaining)
    return PreInstruction(str, tr("Boil/steep fermentables"), timeRemaining);
 }
 
-bool Recipe::isFermentableSugar(Fermentable *fermy)
+bool Recipe::isFermentableSugar(Fermentable *fermy) const
 {
   if (fermy->type() == Fermentable::Sugar && fermy->name() == "Milk Sugar (Lactose)" )
     return false;
@@ -477,9 +460,8 @@ PreInstruction Recipe::addExtracts(double timeRemaining)
    return PreInstruction(str, tr("Add Extracts to water"), timeRemaining);
 }
 
-Instruction* Recipe::postboilFermentablesIns()
+void Recipe::postboilFermentablesIns(QVector<PreInstruction>& ins)
 {
-   Instruction* ins;
    QString str,tmp;
    unsigned int i;
    int size;
@@ -504,22 +486,15 @@ Instruction* Recipe::postboilFermentablesIns()
 
    if( hasFerms )
    {
-      ins = Database::instance().newInstruction(this);
-      ins->setName(tr("Knockout additions"));
-      ins->setDirections(str);
-      ins->addReagent(tmp);
-      return ins;
-   }
-   else
-   {
-      return 0;
+      PreInstruction pi(str, tr("Knockout additions"), 0.0);
+      pi.addReagent(tmp);
+      ins.append(pi);
    }
 }
 
-Instruction* Recipe::postboilIns()
+void Recipe::postboilIns(QVector<PreInstruction>& ins)
 {
    QString str;
-   Instruction* ins;
    double wort_l = 0.0;
    double wortInBoil_l = 0.0;
 
@@ -543,45 +518,27 @@ Instruction* Recipe::postboilIns()
       str += tr("\nThe final volume in the primary is %1.")
              .arg(Brewtarget::displayAmount(wort_l,"tab_recipe", "batchSize_l",  Units::liters));
 
-      ins = Database::instance().newInstruction(this);
-      ins->setName(tr("Post boil"));
-      ins->setDirections(str);
-      return ins;
-   }
-   else
-   {
-      return 0;
+      ins.append(PreInstruction(str, tr("Post boil"), 0.0));
    }
 }
 
-void Recipe::addPreinstructions( QVector<PreInstruction> preins )
+void Recipe::addPreinstructions( QVector<PreInstruction> preins, QVector<PreInstruction>& ins )
 {
-   unsigned int i;
-   Instruction* ins;
-
     // Add instructions in descending mash time order.
     qSort( preins.begin(), preins.end(), qGreater<PreInstruction>() );
-    for( i=0; static_cast<int>(i) < preins.size(); ++i )
-    {
-       PreInstruction pi = preins[i];
-       ins = Database::instance().newInstruction(this);
-       ins->setName(pi.getTitle());
-       ins->setDirections(pi.getText());
-       ins->setInterval(pi.getTime());
-    }
+    ins += preins;
 }
 
 void Recipe::generateInstructions()
 {
-   Instruction* ins;
    QString str, tmp;
    unsigned int i, size;
    double timeRemaining;
    double totalWaterAdded_l = 0.0;
 
-   if ( ! instructions().empty() )
-      clearInstructions();
-
+   // Build all the instructions in memory first, then replace the old ones
+   // in one go. Creating them one at a time costs several queries apiece.
+   QVector<PreInstruction> ins;
    QVector<PreInstruction> preinstructions;
 
    // Mash instructions
@@ -590,10 +547,10 @@ void Recipe::generateInstructions()
    if( size > 0 )
    {
      /*** prepare mashed fermentables ***/
-     mashFermentableIns();
+     mashFermentableIns(ins);
 
      /*** Prepare water additions ***/
-     mashWaterIns(size);
+     mashWaterIns(size, ins);
 
      timeRemaining = mash()->totalTime();
 
@@ -607,15 +564,15 @@ void Recipe::generateInstructions()
      preinstructions += miscSteps(Misc::Mash);
 
      /*** Add the preinstructions into the instructions ***/
-     addPreinstructions(preinstructions);
+     addPreinstructions(preinstructions, ins);
 
    } // END mash instructions.
 
    // First wort hopping
-   firstWortHopsIns();
+   firstWortHopsIns(ins);
     
    // Need to top up the kettle before boil?
-   topOffIns();
+   topOffIns(ins);
 
    // Boil instructions
    preinstructions.clear();   
@@ -632,10 +589,7 @@ void Recipe::generateInstructions()
    }
    
    str = tr("Bring the wort to a boil and hold for %1.").arg(Brewtarget::displayAmount( timeRemaining, "tab_recipe", "boilTime_min", Units::minutes));
-   ins = Database::instance().newInstruction(this);
-   ins->setName(tr("Start boil"));
-   ins->setInterval(timeRemaining);
-   ins->setDirections(str);
+   ins.append(PreInstruction(str, tr("Start boil"), timeRemaining));
    
    /*** Get fermentables unless we haven't added yet ***/
    if ( hasBoilFermentable() )
@@ -654,26 +608,24 @@ void Recipe::generateInstructions()
    // END boil instructions.
 
    // Add instructions in descending mash time order.
-   addPreinstructions(preinstructions);
+   addPreinstructions(preinstructions, ins);
 
    // FLAMEOUT
-   ins = Database::instance().newInstruction(this);
-   ins->setName(tr("Flameout"));
-   ins->setDirections(tr("Stop boiling the wort."));
+   ins.append(PreInstruction(tr("Stop boiling the wort."), tr("Flameout"), 0.0));
 
    // Steeped aroma hops
    preinstructions.clear();
    preinstructions += hopSteps(Hop::UseAroma);
-   addPreinstructions(preinstructions);
+   addPreinstructions(preinstructions, ins);
    
    // Fermentation instructions
    preinstructions.clear();
 
    /*** Fermentables added after boil ***/
-   postboilFermentablesIns();
+   postboilFermentablesIns(ins);
 
    /*** post boil ***/
-   postboilIns();
+   postboilIns(ins);
    
    /*** Primary yeast ***/
    str = tr("Cool wort and pitch ");
@@ -685,34 +637,29 @@ void Recipe::generateInstructions()
          str += tr("%1 %2 yeast, ").arg(yeast->name()).arg(yeast->typeStringTr());
    }
    str += tr("to the primary.");
-   ins = Database::instance().newInstruction(this);
-   ins->setName(tr("Pitch yeast"));
-   ins->setDirections(str);
+   ins.append(PreInstruction(str, tr("Pitch yeast"), 0.0));
    /*** End primary yeast ***/
 
    /*** Primary misc ***/
-   addPreinstructions(miscSteps(Misc::Primary));
+   addPreinstructions(miscSteps(Misc::Primary), ins);
 
    str = tr("Let ferment until FG is %1.")
          .arg(Brewtarget::displayAmount(fg(), "tab_recipe", "fg", Units::sp_grav, 3));
-   ins = Database::instance().newInstruction(this);
-   ins->setName(tr("Ferment"));
-   ins->setDirections(str);
+   ins.append(PreInstruction(str, tr("Ferment"), 0.0));
 
    str = tr("Transfer beer to secondary.");
-   ins = Database::instance().newInstruction(this);
-   ins->setName(tr("Transfer to secondary"));
-   ins->setDirections(str);
+   ins.append(PreInstruction(str, tr("Transfer to secondary"), 0.0));
 
    /*** Secondary misc ***/
-   addPreinstructions(miscSteps(Misc::Secondary));
+   addPreinstructions(miscSteps(Misc::Secondary), ins);
 
    /*** Dry hopping ***/
-   addPreinstructions(hopSteps(Hop::Dry_Hop));
+   addPreinstructions(hopSteps(Hop::Dry_Hop), ins);
 
-   // END fermentation instructions. Let everybody know that now is the time
-   // to update instructions
-   emit changed( metaProperty("instructions"), instructions().size() );
+   // END fermentation instructions. Write them all in one transaction, then
+   // let everybody know that now is the time to update instructions.
+   QList<Instruction*> newIns = Database::instance().replaceInstructions(this, ins);
+   emit changed( metaProperty("instructions"), newIns.size() );
 }
 
 QString Recipe::nextAddToBoil(double& time)
@@ -1259,6 +1206,70 @@ double Recipe::points()
    return (_og-1.0)*1e3;
 }
 
+Recipe::StoredStats::StoredStats()
+   : og(1.000),
+     fg(1.000),
+     IBU(0),
+     color_srm(0),
+     ABV_pct(0),
+     calcStamp(0)
+{
+}
+
+Recipe::StoredStats const& Recipe::storedStats() const
+{
+   if( !_storedStatsLoaded )
+   {
+      _storedStats.og = get("og").toDouble();
+      _storedStats.fg = get("fg").toDouble();
+      _storedStats.IBU = get("calc_ibu").toDouble();
+      _storedStats.color_srm = get("calc_color_srm").toDouble();
+      _storedStats.ABV_pct = get("calc_abv_pct").toDouble();
+      _storedStats.calcStamp = get("calc_stamp").toInt();
+      _storedStatsLoaded = true;
+   }
+   return _storedStats;
+}
+
+int Recipe::currentCalcStamp()
+{
+   return BrewCalc::calcStamp(calcOptions());
+}
+
+void Recipe::storeStats( int stamp )
+{
+   StoredStats const& old = storedStats();
+   bool batched;
+
+   if( _IBU == old.IBU && _color_srm == old.color_srm && _ABV_pct == old.ABV_pct &&
+       _og == old.og && _fg == old.fg && stamp == old.calcStamp )
+      return;
+
+   // og and fg were written when they changed. Write the rest together,
+   // unless someone else is already batching.
+   batched = Database::instance().isBatching();
+   if( !batched )
+      Database::instance().startBatch();
+   if( _IBU != old.IBU )
+      Database::instance().updateEntry( _table, _key, "calc_ibu", _IBU, QMetaProperty(), this, false );
+   if( _color_srm != old.color_srm )
+      Database::instance().updateEntry( _table, _key, "calc_color_srm", _color_srm, QMetaProperty(), this, false );
+   if( _ABV_pct != old.ABV_pct )
+      Database::instance().updateEntry( _table, _key, "calc_abv_pct", _ABV_pct, QMetaProperty(), this, false );
+   if( stamp != old.calcStamp )
+      Database::instance().updateEntry( _table, _key, "calc_stamp", stamp, QMetaProperty(), this, false );
+   if( !batched )
+      Database::instance().finishBatch();
+
+   _storedStats.og = _og;
+   _storedStats.fg = _fg;
+   _storedStats.IBU = _IBU;
+   _storedStats.color_srm = _color_srm;
+   _storedStats.ABV_pct = _ABV_pct;
+   _storedStats.calcStamp = stamp;
+   emit changedStoredStats();
+}
+
 //=========================Relational Getters=============================
 
 Style* Recipe::style() const
@@ -1387,6 +1398,61 @@ double Recipe::batchSizeNoLosses_l()
 
 //==============================Recalculators==================================
 
+BrewCalc::Recipe Recipe::calcInput() const
+{
+   BrewCalc::Recipe ret;
+   BrewCalc::Fermentable ferm;
+   BrewCalc::Yeast yeast;
+   Equipment* equip = equipment();
+   Mash* m = mash();
+
+   ret.batchSize_l = batchSize_l();
+   ret.boilSize_l = boilSize_l();
+   ret.efficiency_pct = efficiency_pct();
+
+   if( equip )
+   {
+      ret.hasEquipment = true;
+      ret.equipment = equip->calcInput();
+   }
+
+   if( m )
+   {
+      ret.hasMash = true;
+      ret.mash.totalMashWater_l = m->totalMashWater_l();
+   }
+
+   foreach( Fermentable* f, fermentables() )
+   {
+      ferm = f->calcInput();
+      ferm.isFermentable = isFermentableSugar(f);
+      ret.fermentables.push_back(ferm);
+   }
+
+   foreach( Hop* h, hops() )
+      ret.hops.push_back(h->calcInput());
+
+   foreach( Yeast* y, yeasts() )
+   {
+      yeast.attenuation_pct = y->attenuation_pct();
+      ret.yeasts.push_back(yeast);
+   }
+
+   return ret;
+}
+
+BrewCalc::Options Recipe::calcOptions()
+{
+   BrewCalc::Options ret;
+
+   ret.ibuFormula = IbuMethods::formula();
+   ret.colorFormula = ColorMethods::formula();
+   ret.firstWortHopAdjustment = Brewtarget::toDouble(Brewtarget::option("firstWortHopAdjustment", 1.1).toString(), "Recipe::calcOptions()");
+   ret.mashHopAdjustment = Brewtarget::toDouble(Brewtarget::option("mashHopAdjustment", 0).toString(), "Recipe::calcOptions()");
+
+   return ret;
+}
+
 void Recipe::recalcAll()
 {
    // WARNING
@@ -1398,88 +1464,100 @@ void Recipe::recalcAll()
    if( !_recalcMutex.tryLock() )
       return;
    
-   // Times are in seconds, and are cumulative.
-   recalcGrainsInMash_kg(); // 0.01
-   recalcGrains_kg(); // 0.03
-   recalcVolumeEstimates(); // 0.06
-   recalcColor_srm(); // 0.08
-   recalcSRMColor(); // 0.08
-   recalcOgFg(); // 0.11
-   recalcABV_pct(); // 0.12
-   recalcBoilGrav(); // 0.14
-   recalcIBU(); // 0.15
+   // Read everything out of the database once, instead of once per step.
+   BrewCalc::Recipe in = calcInput();
+
+   recalcGrainsInMash_kg(in);
+   recalcGrains_kg(in);
+   recalcVolumeEstimates(in);
+   recalcColor_srm(in);
+   recalcSRMColor();
+   recalcOgFg(in);
+   recalcABV_pct();
+   recalcBoilGrav(in);
+   recalcIBU(in);
    recalcCalories();
+   storeStats( currentCalcStamp() );
    
    _uninitializedCalcs = false;
    
    _recalcMutex.unlock();
 }
 
+void Recipe::setCalcResults( BrewCalc::Results const& res, int calcStamp )
+{
+   if( !_recalcMutex.tryLock() )
+      return;
+
+   // Same order as recalcAll().
+   applyGrainsInMash_kg(res.grainsInMash_kg);
+   applyGrains_kg(res.grains_kg);
+   applyVolumeEstimates(res.volumes);
+   applyColor_srm(res.color_srm);
+   recalcSRMColor();
+   applyOgFg(res.gravities);
+   applyABV_pct(res.ABV_pct);
+   applyBoilGrav(res.boilGrav);
+   applyIBU(res.IBU, res.hopIbus);
+   applyCalories(res.calories12oz);
+   storeStats( calcStamp );
+
+   _uninitializedCalcs = false;
+
+   _recalcMutex.unlock();
+}
+
 void Recipe::recalcABV_pct()
 {
-   double ret;
+   applyABV_pct( BrewCalc::ABV_pct(_og_fermentable, _fg_fermentable) );
+}
 
-   // The complex formula, and variations comes from Ritchie Products Ltd, (Zymurgy, Summer 1995, vol. 18, no. 2)
-   // Michael L. Hall’s article Brew by the Numbers: Add Up What’s in Your Beer, and Designing Great Beers by Daniels.
-   ret = (76.08 * (_og_fermentable - _fg_fermentable) / (1.775 - _og_fermentable)) * (_fg_fermentable / 0.794);
-  
-   if ( ret != _ABV_pct ) 
+void Recipe::applyABV_pct( double abv )
+{
+   if ( abv != _ABV_pct ) 
    {
-      _ABV_pct = ret;
+      _ABV_pct = abv;
       emit changed( metaProperty("ABV_pct"), _ABV_pct );
    }
 }
 
 void Recipe::recalcColor_srm()
 {
-   Fermentable *ferm;
-   double mcu = 0.0;
-   double ret;
-   unsigned int i;
+   recalcColor_srm( calcInput() );
+}
 
-   QList<Fermentable*> ferms = fermentables();
-   for( i = 0; static_cast<int>(i) < ferms.size(); ++i )
-   {
-      ferm = ferms[i];
-      // Conversion factor for lb/gal to kg/l = 8.34538.
-      mcu += ferm->color_srm()*8.34538 * ferm->amount_kg()/_finalVolumeNoLosses_l;
-   }
+void Recipe::recalcColor_srm( BrewCalc::Recipe const& in )
+{
+   applyColor_srm( BrewCalc::color_srm(in, _finalVolumeNoLosses_l, ColorMethods::formula()) );
+}
 
-   ret = ColorMethods::mcuToSrm(mcu);
- 
-   if ( _color_srm != ret ) 
+void Recipe::applyColor_srm( double srm )
+{
+   if ( _color_srm != srm ) 
    {
-      _color_srm = ret;
+      _color_srm = srm;
       emit changed( metaProperty("color_srm"), _color_srm );
    }
-
 }
 
 void Recipe::recalcIBU()
 {
-   unsigned int i;
-   double ibus = 0.0;
-   double tmp = 0.0;
-   
-   // Bitterness due to hops...
-   _ibus.clear();
-   QList<Hop*> hhops = hops();
-   for( i = 0; static_cast<int>(i) < hhops.size(); ++i )
-   {
-      tmp = ibuFromHop(hhops[i]);
-      _ibus.append(tmp);
-      ibus += tmp;
-   }
+   recalcIBU( calcInput() );
+}
 
-   // Bitterness due to hopped extracts...
-   QList<Fermentable*> ferms = fermentables();
-   for( i = 0; static_cast<int>(i) < ferms.size(); ++i )
-   {
-      // Conversion factor for lb/gal to kg/l = 8.34538.
-      ibus +=
-              ferms[i]->ibuGalPerLb() *
-              (ferms[i]->amount_kg() / batchSize_l()) / 8.34538;
-   }
+void Recipe::recalcIBU( BrewCalc::Recipe const& in )
+{
+   std::vector<double> hopIbus;
+   double ibus = BrewCalc::IBU(in, _og, _finalVolumeNoLosses_l, calcOptions(), &hopIbus);
+
+   applyIBU( ibus, hopIbus );
+}
+
+void Recipe::applyIBU( double ibus, std::vector<double> const& hopIbus )
+{
+   _ibus.clear();
+   for( std::vector<double>::const_iterator i = hopIbus.begin(); i != hopIbus.end(); ++i )
+      _ibus.append(*i);
 
    if ( ibus != _IBU ) 
    {
@@ -1490,138 +1568,79 @@ void Recipe::recalcIBU()
 
 void Recipe::recalcVolumeEstimates()
 {
-   double waterAdded_l;
-   double absorption_lKg;
-   double tmp = 0.0;
-   double tmp_wfm = 0.0;
-   double tmp_bv = 0.0;
-   double tmp_fv = 0.0;
-   double tmp_pbv = 0.0;
-
-   // wortFromMash_l ==========================
-   if( mash() == 0 )
-      _wortFromMash_l = 0.0;
-   else
-   {
-   
-      waterAdded_l = mash()->totalMashWater_l();
-      if( equipment() != 0 )
-         absorption_lKg = equipment()->grainAbsorption_LKg();
-      else
-         absorption_lKg = PhysicalConstants::grainAbsorption_Lkg;
+   recalcVolumeEstimates( calcInput() );
+}
 
-      tmp_wfm = (waterAdded_l - absorption_lKg * _grainsInMash_kg);
-   }
-   
-   // boilVolume_l ==============================
-   
-   if( equipment() != 0 )
-      tmp = tmp_wfm - equipment()->lauterDeadspace_l() + equipment()->topUpKettle_l();
-   else
-      tmp = tmp_wfm;
-   
-   // Need to account for extract/sugar volume also.
-   QList<Fermentable*> ferms = fermentables();
-   foreach( Fermentable* f, ferms )
-   {
-      Fermentable::Type type = f->type();
-      if( type == Fermentable::Extract )
-         tmp += f->amount_kg() / PhysicalConstants::liquidExtractDensity_kgL;
-      else if( type == Fermentable::Sugar )
-         tmp += f->amount_kg() / PhysicalConstants::sucroseDensity_kgL;
-      else if( type == Fermentable::Dry_Extract )
-         tmp += f->amount_kg() / PhysicalConstants::dryExtractDensity_kgL;
-   }
-   
-   if( tmp <= 0.0 )
-      tmp = boilSize_l(); // Give up.
- 
-   tmp_bv = tmp;
-   
-   // finalVolume_l ==============================
-   
-   // NOTE: the following figure is not based on the other volume estimates
-   // since we want to show og,fg,ibus,etc. as if the collected wort is correct.
-   _finalVolumeNoLosses_l = batchSizeNoLosses_l();
-   if( equipment() != 0 )
-   {
-      //_finalVolumeNoLosses_l = equipment()->wortEndOfBoil_l(tmp_bv) + equipment()->topUpWater_l();
-      tmp_fv = equipment()->wortEndOfBoil_l(tmp_bv) + equipment()->topUpWater_l() - equipment()->trubChillerLoss_l();
-   }
-   else
-   {
-      _finalVolume_l = tmp_bv - 4.0; // This is just shooting in the dark. Can't do much without an equipment.
-      //_finalVolumeNoLosses_l = _finalVolume_l;
-   }
-   
-   // postBoilVolume_l ===========================
+void Recipe::recalcVolumeEstimates( BrewCalc::Recipe const& in )
+{
+   applyVolumeEstimates( BrewCalc::volumes(in, _grainsInMash_kg) );
+}
 
-   if( equipment() != 0 )
-      tmp_pbv = equipment()->wortEndOfBoil_l( tmp_bv );
-   else
-      tmp_pbv = batchSize_l(); // Give up.
+void Recipe::applyVolumeEstimates( BrewCalc::Volumes const& vols )
+{
+   // NOTE: this is not based on the other volume estimates since we want to
+   // show og,fg,ibus,etc. as if the collected wort is correct.
+   _finalVolumeNoLosses_l = vols.finalVolumeNoLosses_l;
 
-   if ( tmp_wfm != _wortFromMash_l )
+   if ( vols.wortFromMash_l != _wortFromMash_l )
    {
-      _wortFromMash_l = tmp_wfm;
+      _wortFromMash_l = vols.wortFromMash_l;
       emit changed( metaProperty("wortFromMash_l"), _wortFromMash_l );
    }
 
-   if ( tmp_bv != _boilVolume_l )
+   if ( vols.boilVolume_l != _boilVolume_l )
    {
-      _boilVolume_l = tmp_bv;
+      _boilVolume_l = vols.boilVolume_l;
       emit changed( metaProperty("boilVolume_l"), _boilVolume_l );
    }
    
-   if ( tmp_fv != _finalVolume_l )
+   if ( vols.finalVolume_l != _finalVolume_l )
    {
-      _finalVolume_l = tmp_fv;
+      _finalVolume_l = vols.finalVolume_l;
       emit changed( metaProperty("finalVolume_l"), _finalVolume_l );
    }
 
-   if ( tmp_pbv != _postBoilVolume_l )
+   if ( vols.postBoilVolume_l != _postBoilVolume_l )
    {
-      _postBoilVolume_l = tmp_pbv;
+      _postBoilVolume_l = vols.postBoilVolume_l;
       emit changed( metaProperty("postBoilVolume_l"), _postBoilVolume_l );
    }
 }
 
 void Recipe::recalcGrainsInMash_kg()
 {
-   unsigned int i, size;
-   double ret = 0.0;
-   Fermentable* ferm;
-   
-   QList<Fermentable*> ferms = fermentables();
-   size = ferms.size();
-   for( i = 0; i < size; ++i )
-   {
-      ferm = ferms[i];
-      
-      if( ferm->type() == Fermentable::Grain && ferm->isMashed() )
-         ret += ferm->amount_kg();
-   }
+   recalcGrainsInMash_kg( calcInput() );
+}
+
+void Recipe::recalcGrainsInMash_kg( BrewCalc::Recipe const& in )
+{
+   applyGrainsInMash_kg( BrewCalc::grainsInMash_kg(in) );
+}
 
-   if ( ret != _grainsInMash_kg ) 
+void Recipe::applyGrainsInMash_kg( double kg )
+{
+   if ( kg != _grainsInMash_kg ) 
    {
-      _grainsInMash_kg = ret;
+      _grainsInMash_kg = kg;
       emit changed( metaProperty("grainsInMash_kg"), _grainsInMash_kg );
    }
 }
 
 void Recipe::recalcGrains_kg()
 {
-   unsigned int i, size;
-   double ret = 0.0;
+   recalcGrains_kg( calcInput() );
+}
 
-   QList<Fermentable*> ferms = fermentables();
-   size = ferms.size();
-   for( i = 0; i < size; ++i )
-      ret += ferms[i]->amount_kg();
+void Recipe::recalcGrains_kg( BrewCalc::Recipe const& in )
+{
+   applyGrains_kg( BrewCalc::grains_kg(in) );
+}
 
-   if ( ret != _grains_kg ) 
+void Recipe::applyGrains_kg( double kg )
+{
+   if ( kg != _grains_kg ) 
    {
-      _grains_kg = ret;
+      _grains_kg = kg;
       emit changed( metaProperty("grains_kg"), _grains_kg );
    }
 }
@@ -1637,38 +1656,16 @@ void Recipe::recalcSRMColor()
    }
 }
 
-// the formula in here are taken from http://hbd.org/ensmingr/
 void Recipe::recalcCalories()
 {
-   double startPlato, finishPlato, RE, abw, oog, ffg, tmp;
-
-   oog = _og;
-   ffg = _fg;
-
-   // Need to translate OG and FG into plato
-   startPlato  = -463.37 + ( 668.72 * oog ) - (205.35 * oog * oog);
-   finishPlato = -463.37 + ( 668.72 * ffg ) - (205.35 * ffg * ffg);
-
-   // RE (real extract)
-   RE = (0.1808 * startPlato) + (0.8192 * finishPlato);
-
-   // Alcohol by weight?
-   abw = (startPlato-RE)/(2.0665 - (0.010665 * startPlato));
-
-   // The final results of this formular are calories per 100 ml. 
-   // The 3.55 puts it in terms of 12 oz. I really should have stored it
-   // without that adjust.
-   tmp = ((6.9*abw) + 4.0 * (RE-0.1)) * ffg * 3.55;
-
-   //! If there are no fermentables in the recipe, if there is no mash, etc.,
-   //  then the calories/12 oz ends up negative. Since negative doesn't make
-   //  sense, set it to 0
-   if ( tmp < 0 )
-      tmp = 0;
+   applyCalories( BrewCalc::calories12oz(_og, _fg) );
+}
 
-   if ( tmp != _calories ) 
+void Recipe::applyCalories( double cal )
+{
+   if ( cal != _calories ) 
    {
-      _calories = tmp;
+      _calories = cal;
       emit changed( metaProperty("calories"), _calories );
    }
 }
@@ -1678,47 +1675,14 @@ void Recipe::recalcCalories()
 // split that calcuation out of recalcOgFg();
 QHash<QString,double> Recipe::calcTotalPoints()
 {
-   int i;
-   double sugar_kg_ignoreEfficiency = 0.0;
-   double sugar_kg                  = 0.0;
-   double nonFermetableSugars_kg    = 0.0;
-   double lateAddition_kg           = 0.0;
-   double lateAddition_kg_ignoreEff = 0.0;
-
-   Fermentable* ferm;
-
-   QList<Fermentable*> ferms = fermentables();
+   BrewCalc::Sugars sugars = BrewCalc::totalPoints( calcInput() );
    QHash<QString,double> ret;
    
-   for( i = 0; static_cast<int>(i) < ferms.size(); ++i )
-   {
-      ferm = ferms[i];
-
-      // If we have some sort of non-grain, we have to ignore efficiency.
-      if( ferm->isSugar() || ferm->isExtract() )
-      {
-         sugar_kg_ignoreEfficiency += ferm->equivSucrose_kg();
-
-         if (ferm->addAfterBoil())
-            lateAddition_kg_ignoreEff += ferm->equivSucrose_kg();
-
-         if ( !isFermentableSugar(ferm) )
-           nonFermetableSugars_kg += ferm->equivSucrose_kg();
-      }
-      else
-      {
-         sugar_kg += ferm->equivSucrose_kg();
-
-         if (ferm->addAfterBoil())
-            lateAddition_kg += ferm->equivSucrose_kg();
-      }
-   }   
-   
-   ret.insert("sugar_kg", sugar_kg);
-   ret.insert("nonFermetableSugars_kg", nonFermetableSugars_kg);
-   ret.insert("sugar_kg_ignoreEfficiency", sugar_kg_ignoreEfficiency);
-   ret.insert("lateAddition_kg", lateAddition_kg);
-   ret.insert("lateAddition_kg_ignoreEff", lateAddition_kg_ignoreEff);
+   ret.insert("sugar_kg", sugars.sugar_kg);
+   ret.insert("nonFermetableSugars_kg", sugars.nonFermentableSugars_kg);
+   ret.insert("sugar_kg_ignoreEfficiency", sugars.sugar_kg_ignoreEfficiency);
+   ret.insert("lateAddition_kg", sugars.lateAddition_kg);
+   ret.insert("lateAddition_kg_ignoreEff", sugars.lateAddition_kg_ignoreEff);
 
    return ret;
 
@@ -1726,50 +1690,35 @@ QHash<QString,double> Recipe::calcTotalPoints()
 
 void Recipe::recalcBoilGrav()
 {
-   double sugar_kg = 0.0;
-   double sugar_kg_ignoreEfficiency = 0.0;
-   double lateAddition_kg           = 0.0;
-   double lateAddition_kg_ignoreEff = 0.0;
-   double ret;
-   QHash<QString,double> sugars;
-
-   sugars = calcTotalPoints();
-   sugar_kg = sugars.value("sugar_kg");
-   sugar_kg_ignoreEfficiency = sugars.value("sugar_kg_ignoreEfficiency");
-   lateAddition_kg = sugars.value("lateAddition_kg");
-   lateAddition_kg_ignoreEff = sugars.value("lateAddition_kg_ignoreEff");
-   
-   // Since the efficiency refers to how much sugar we get into the fermenter,
-   // we need to adjust for that here.
-   sugar_kg = (efficiency_pct()/100.0 * (sugar_kg - lateAddition_kg) + sugar_kg_ignoreEfficiency - lateAddition_kg_ignoreEff);
+   recalcBoilGrav( calcInput() );
+}
+
+void Recipe::recalcBoilGrav( BrewCalc::Recipe const& in )
+{
+   applyBoilGrav( BrewCalc::boilGrav(in) );
+}
 
-   ret = Algorithms::PlatoToSG_20C20C( Algorithms::getPlato(sugar_kg, boilSize_l()) );
- 
-   if ( ret != _boilGrav )
+void Recipe::applyBoilGrav( double grav )
+{
+   if ( grav != _boilGrav )
    {
-      _boilGrav = ret;
+      _boilGrav = grav;
       emit changed( metaProperty("boilGrav"), _boilGrav );
    }
 }
 
 void Recipe::recalcOgFg()
 {
-   unsigned int i;
-   double plato;
-   double sugar_kg = 0;
-   double sugar_kg_ignoreEfficiency = 0.0;
-   double nonFermetableSugars_kg = 0.0;
-   double kettleWort_l = 0.0;
-   double postBoilWort_l = 0.0;
-   double ratio = 0.0;
-   double ferm_kg = 0.0;
-   double attenuation_pct = 0.0;
-   double tmp_og, tmp_fg, tmp_pnts, tmp_ferm_pnts;
-   Yeast* yeast;
-   QHash<QString,double> sugars;
-  
-   _og_fermentable = _fg_fermentable = 0.0;
+   recalcOgFg( calcInput() );
+}
+
+void Recipe::recalcOgFg( BrewCalc::Recipe const& in )
+{
+   applyOgFg( BrewCalc::ogFg(in, _wortFromMash_l, _finalVolumeNoLosses_l) );
+}
 
+void Recipe::applyOgFg( BrewCalc::Gravities const& grav )
+{
    // The first time through really has to get the _og and _fg from the
    // database, not use the initialized values of 1. I (maf) tried putting
    // this in the initialize, but it just hung. So I moved it here, but only
@@ -1780,80 +1729,12 @@ void Recipe::recalcOgFg()
       _fg = Brewtarget::toDouble(this,"fg","Recipe::recalcOgFg()");
    }
 
-   // Find out how much sugar we have.
-   sugars = calcTotalPoints();
-   sugar_kg                  = sugars.value("sugar_kg");
-   sugar_kg_ignoreEfficiency = sugars.value("sugar_kg_ignoreEfficiency");
-   nonFermetableSugars_kg    = sugars.value("nonFermetableSugars_kg");
-
-   // We might lose some sugar in the form of Trub/Chiller loss and lauter deadspace.
-   if( equipment() != 0 )
-   {
-      
-      kettleWort_l = (_wortFromMash_l - equipment()->lauterDeadspace_l()) + equipment()->topUpKettle_l();
-      postBoilWort_l = equipment()->wortEndOfBoil_l(kettleWort_l);
-      ratio = (postBoilWort_l - equipment()->trubChillerLoss_l()) / postBoilWort_l;
-      if( ratio > 1.0 ) // Usually happens when we don't have a mash yet.
-         ratio = 1.0;
-      else if( ratio < 0.0 )
-         ratio = 0.0;
-      else if( Algorithms::isNan(ratio) )
-         ratio = 1.0;
-      // Ignore this again since it should be included in efficiency.
-      //sugar_kg *= ratio;
-      sugar_kg_ignoreEfficiency *= ratio;
-      if ( nonFermetableSugars_kg != 0.0 )
-         nonFermetableSugars_kg *= ratio;
-   }
-
-   sugar_kg = sugar_kg * efficiency_pct()/100.0 + sugar_kg_ignoreEfficiency;
-   plato = Algorithms::getPlato( sugar_kg, _finalVolumeNoLosses_l);
-
-   tmp_og = Algorithms::PlatoToSG_20C20C( plato );
-   tmp_pnts = (tmp_og-1)*1000.0;
-   if ( nonFermetableSugars_kg != 0.0 )
-   {
-      ferm_kg = sugar_kg - nonFermetableSugars_kg;
-      plato = Algorithms::getPlato( ferm_kg, _finalVolumeNoLosses_l);
-      _og_fermentable = Algorithms::PlatoToSG_20C20C( plato );
-      plato = Algorithms::getPlato( nonFermetableSugars_kg, _finalVolumeNoLosses_l); 
-      tmp_ferm_pnts = ((Algorithms::PlatoToSG_20C20C( plato ))-1)*1000.0;
-   }
-   else
-   {
-      _og_fermentable = tmp_og;
-      tmp_ferm_pnts = 0;
-   }
-
-   // Calculage FG
-   QList<Yeast*> yeasties = yeasts();
-   for( i = 0; static_cast<int>(i) < yeasties.size(); ++i )
-   {
-      yeast = yeasties[i];
-      // Get the yeast with the greatest attenuation.
-      if( yeast->attenuation_pct() > attenuation_pct )
-         attenuation_pct = yeast->attenuation_pct();
-   }
-   if( yeasties.size() > 0 && attenuation_pct <= 0.0 ) // This means we have yeast, but they neglected to provide attenuation percentages.
-      attenuation_pct = 75.0; // 75% is an average attenuation.
-   
-   if ( nonFermetableSugars_kg != 0.0 )
-   {
-      tmp_ferm_pnts = (tmp_pnts-tmp_ferm_pnts) * (1.0 - attenuation_pct/100.0);
-      tmp_pnts *= (1.0 - attenuation_pct/100.0);
-      tmp_fg =  1 + tmp_pnts/1000.0;
-      _fg_fermentable =  1 + tmp_ferm_pnts/1000.0;
-   }
-   else
-   {
-      tmp_pnts *= (1.0 - attenuation_pct/100.0);
-      tmp_fg =  1 + tmp_pnts/1000.0;
-      _fg_fermentable = tmp_fg;
-   }
+   _og_fermentable = grav.og_fermentable;
+   _fg_fermentable = grav.fg_fermentable;
    
-   if ( _og != tmp_og ) 
+   if ( _og != grav.og ) 
    {
-      _og     = tmp_og;
+      _og     = grav.og;
       // NOTE: We don't want to do this on the first load of the recipe. The
       // _og is initialized to 1, and we calculate that to be something
       // different. So this code is being triggered and the OG and FG are
@@ -1865,9 +1746,9 @@ void Recipe::recalcOgFg()
       emit changed( metaProperty("points"), (_og-1.0)*1e3 );
    }
 
-   if ( tmp_fg != _fg ) 
+   if ( grav.fg != _fg ) 
    {
-      _fg     = tmp_fg;
+      _fg     = grav.fg;
       set( "fg", "fg", _fg, false );
       emit changed( metaProperty("fg"), _fg );
    }
@@ -1877,63 +1758,20 @@ void Recipe::recalcOgFg()
 
 double Recipe::ibuFromHop(Hop const* hop)
 {
+   BrewCalc::Recipe in;
    Equipment* equip = equipment();
-   double ibus = 0.0;
-   double fwhAdjust = Brewtarget::toDouble(Brewtarget::option("firstWortHopAdjustment", 1.1).toString(), "Recipe::ibmFromHop()");
-   double mashHopAdjust = Brewtarget::toDouble(Brewtarget::option("mashHopAdjustment", 0).toString(), "Recipe::ibmFromHop()");
    
    if( hop == 0 )
       return 0.0;
    
-   double AArating = hop->alpha_pct()/100.0;
-   double grams = hop->amount_kg()*1000.0;
-   double minutes = hop->time_min();
-   // Assume 100% utilization until further notice
-   double hopUtilization = 1.0;
-   // Assume 60 min boil until further notice
-   int boilTime = 60;
-
-   // NOTE: we used to carefully calculate the average boil gravity and use it in the
-   // IBU calculations. However, due to John Palmer
-   // (http://homebrew.stackexchange.com/questions/7343/does-wort-gravity-affect-hop-utilization),
-   // it seems more appropriate to just use the OG directly, since it is the total
-   // amount of break material that truly affects the IBUs.
-   
+   // Only the equipment matters here, so don't bother with the ingredients.
    if( equip )
    {
-      hopUtilization = equip->hopUtilization_pct() / 100.0;
-      boilTime = equip->boilTime_min();
+      in.hasEquipment = true;
+      in.equipment = equip->calcInput();
    }
-   
-   if( hop->use() == Hop::Boil)
-      ibus = IbuMethods::getIbus( AArating, grams, _finalVolumeNoLosses_l, _og, minutes );
-   else if( hop->use() == Hop::First_Wort )
-      ibus = fwhAdjust * IbuMethods::getIbus( AArating, grams, _finalVolumeNoLosses_l, _og, boilTime );
-   else if( hop->use() == Hop::Mash && mashHopAdjust > 0.0 )
-      ibus = mashHopAdjust * IbuMethods::getIbus( AArating, grams, _finalVolumeNoLosses_l, _og, boilTime );
-
-   // Adjust for hop form. Tinseth's table was created from whole cone data,
-   // and it seems other formulae are optimized that way as well. So, the
-   // utilization is considered unadjusted for whole cones, and adjusted
-   // up for plugs and pellets.
-   //
-   // - http://www.realbeer.com/hops/FAQ.html
-   // - https://groups.google.com/forum/#!topic/brewtarget-help/mv2qvWBC4sU
-   switch( hop->form() ) {
-   case Hop::Plug:
-      hopUtilization *= 1.02;
-      break;
-   case Hop::Pellet:
-      hopUtilization *= 1.10;
-      break;
-   default:
-      break;
-   }
-
-   // Adjust for hop utilization. 
-   ibus *= hopUtilization;
-
-   return ibus;
+
+   return BrewCalc::ibuFromHop( hop->calcInput(), in, _og, _finalVolumeNoLosses_l, calcOptions() );
 }
 
 bool Recipe::isValidType( const QString &str )
@@ -2042,23 +1880,32 @@ void Recipe::acceptFermChange(Fermentable *ferm)
 void Recipe::acceptHopChange(QMetaProperty prop, QVariant val)
 {
    recalcIBU();
+   // Only part was redone, so only store if the rest is already there.
+   if( !_uninitializedCalcs )
+      storeStats( currentCalcStamp() );
 }
 
 void Recipe::acceptHopChange(Hop* hop) 
 {
    recalcIBU();
+   if( !_uninitializedCalcs )
+      storeStats( currentCalcStamp() );
 }
 
 void Recipe::acceptYeastChange(QMetaProperty prop, QVariant val)
 {
    recalcOgFg();
    recalcABV_pct();
+   if( !_uninitializedCalcs )
+      storeStats( currentCalcStamp() );
 }
 
 void Recipe::acceptYeastChange(Yeast* yeast)
 {
    recalcOgFg();
    recalcABV_pct();
+   if( !_uninitializedCalcs )
+      storeStats( currentCalcStamp() );
 }
 
 void Recipe::acceptMashChange(QMetaProperty prop, QVariant val)
@@ -33,6 +33,7 @@ class Recipe;
 #include <QDate>
 #include <QMutex>
 #include "BeerXMLElement.h"
+#include "BrewCalc.h"
 #include "hop.h" // Dammit! Have to include these for Hop::Use and Misc::Use.
 #include "misc.h"
 #include "brewnote.h"
@@ -74,6 +75,7 @@ public:
    friend bool operator<(Recipe &r1, Recipe &r2 );
    friend bool operator==(Recipe &r1, Recipe &r2 );
    friend class RecipeFormatter;
+   friend class Benchmark;
    
    // NOTE: move to database?
    //! \brief Retains only the name, but sets everything else to defaults.
@@ -278,6 +280,44 @@ public:
    double grains_kg();
    QList<double> IBUs();
    
+   //! \brief The statistics stored with the recipe, so they can be shown without recalculating.
+   struct StoredStats
+   {
+      StoredStats();
+      
+      double og;
+      double fg;
+      double IBU;
+      double color_srm;
+      double ABV_pct;
+      //! \brief \b BrewCalc::calcStamp() of the options they were worked out with, or 0 if never.
+      int calcStamp;
+   };
+   
+   /*!
+    * \brief The statistics as last stored. Never recalculates, so they are
+    * out of date if \c calcStamp is not \b currentCalcStamp().
+    */
+   StoredStats const& storedStats() const;
+   //! \brief \b BrewCalc::calcStamp() of the options as they are now.
+   static int currentCalcStamp();
+   
+   /*! \brief Snapshot of everything \c BrewCalc needs from us and our
+    *  ingredients, so the calculations can run off the main thread. Reads
+    *  the database, so only call it from the main thread. The private
+    *  recalculators that take one skip those reads, so \c recalcAll() only
+    *  does them once.
+    */
+   BrewCalc::Recipe calcInput() const;
+   //! \brief The user's options that change the calculations.
+   static BrewCalc::Options calcOptions();
+   /*!
+    * \brief Take on \c res, worked out elsewhere from \b calcInput() and
+    * options with the given \c calcStamp, as if recalcAll() had done it.
+    * Emits changed() for whatever is different, and writes og/fg if they are.
+    */
+   void setCalcResults( BrewCalc::Results const& res, int calcStamp );
+   
    // Relational getters
    QList<Hop*> hops() const;
    QList<Instruction*> instructions() const;
@@ -299,7 +339,7 @@ public:
    PreInstruction boilFermentablesPre(double timeRemaining);
    bool hasBoilFermentable();
    bool hasBoilExtract();
-   bool isFermentableSugar(Fermentable*);
+   bool isFermentableSugar(Fermentable*) const;
    PreInstruction addExtracts(double timeRemaining);
    
    // Helpers
@@ -313,6 +353,8 @@ public:
 signals:
    //! \brief Emitted when \c name() changes.
    void changedName(const QString&);
+   //! \brief Emitted when \c storedStats() changes.
+   void changedStoredStats();
    
 public slots:
    void acceptEquipChange(QMetaProperty prop, QVariant val);
@@ -390,6 +432,11 @@ private:
    QMutex _uninitializedCalcsMutex;
    QMutex _recalcMutex;
    
+   // Read from the database the first time storedStats() is called, unless
+   // the database has already filled them in.
+   mutable StoredStats _storedStats;
+   mutable bool _storedStatsLoaded;
+   
    // Batch size without losses.
    double batchSizeNoLosses_l();
    
@@ -404,33 +451,57 @@ private:
    Q_INVOKABLE void recalcABV_pct();
    // Emits changed(color_srm). Depends on: _finalVolume_l
    Q_INVOKABLE void recalcColor_srm();
+   void recalcColor_srm( BrewCalc::Recipe const& in );
    // Emits changed(boilGrav). Depends on: _postBoilVolume_l, _boilVolume_l
    Q_INVOKABLE void recalcBoilGrav();
+   void recalcBoilGrav( BrewCalc::Recipe const& in );
    // Emits changed(IBU). Depends on: _batchSize_l, _boilGrav, _boilVolume_l, _finalVolume_l
    Q_INVOKABLE void recalcIBU();
+   void recalcIBU( BrewCalc::Recipe const& in );
    // Emits changed(wortFromMash_l), changed(boilVolume_l), changed(finalVolume_l), changed(postBoilVolume_l). Depends on: _grainsInMash_kg
    Q_INVOKABLE void recalcVolumeEstimates();
+   void recalcVolumeEstimates( BrewCalc::Recipe const& in );
    // Emits changed(grainsInMash_kg). Depends on: --.
    Q_INVOKABLE void recalcGrainsInMash_kg();
+   void recalcGrainsInMash_kg( BrewCalc::Recipe const& in );
    // Emits changed(grains_kg). Depends on: --.
    Q_INVOKABLE void recalcGrains_kg();
+   void recalcGrains_kg( BrewCalc::Recipe const& in );
    // Emits changed(SRMColor). Depends on: _color_srm.
    Q_INVOKABLE void recalcSRMColor();
    // Emits changed(calories). Depends on: _og, _fg.
    Q_INVOKABLE void recalcCalories();
    // Emits changed(og), changed(fg). Depends on: _wortFromMash_l, _finalVolume_l
    Q_INVOKABLE void recalcOgFg();
-   
-   // Adds instructions to the recipe.
-   Instruction* postboilFermentablesIns();
-   Instruction* postboilIns();
-   Instruction* mashFermentableIns();
-   Instruction* mashWaterIns(unsigned int size);
-   Instruction* firstWortHopsIns();
-   Instruction* topOffIns();
+   void recalcOgFg( BrewCalc::Recipe const& in );
+   /* The other half of each recalculator: store what it worked out, and
+    * emit changed() and write the database for whatever is different.
+    * Shared with setCalcResults(), so the two always agree.
+    */
+   void applyABV_pct( double abv );
+   void applyColor_srm( double srm );
+   void applyBoilGrav( double grav );
+   void applyIBU( double ibus, std::vector<double> const& hopIbus );
+   void applyVolumeEstimates( BrewCalc::Volumes const& vols );
+   void applyGrainsInMash_kg( double kg );
+   void applyGrains_kg( double kg );
+   void applyCalories( double cal );
+   void applyOgFg( BrewCalc::Gravities const& grav );
+   // Writes the statistics just worked out with options of \c calcStamp,
+   // if they differ from storedStats().
+   void storeStats( int calcStamp );
+
+   // Append instructions to \c ins. Nothing is written to the database.
+   void postboilFermentablesIns(QVector<PreInstruction>& ins);
+   void postboilIns(QVector<PreInstruction>& ins);
+   void mashFermentableIns(QVector<PreInstruction>& ins);
+   void mashWaterIns(unsigned int size, QVector<PreInstruction>& ins);
+   void firstWortHopsIns(QVector<PreInstruction>& ins);
+   void topOffIns(QVector<PreInstruction>& ins);
    
    //void setDefaults();
-   void addPreinstructions( QVector<PreInstruction> preins );
+   //! Appends \c preins to \c ins in descending time order.
+   void addPreinstructions( QVector<PreInstruction> preins, QVector<PreInstruction>& ins );
    bool isValidType( const QString &str );
    
    static QHash<QString,QString> tagToProp;